@@ -0,0 +1,178 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/decodedsoundcache.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/hash-str.h"
+#include "common/memstream.h"
+
+namespace Audio {
+
+bool DecodedSoundCache::Key_EqualTo::operator()(const Key &x, const Key &y) const {
+	return x.offset == y.offset && x.params == y.params && x.source == y.source;
+}
+
+uint DecodedSoundCache::Key_Hash::operator()(const Key &x) const {
+	return Common::hashit(x.source.c_str()) ^ (x.offset * 1000003u) ^ (x.params * 7919u);
+}
+
+DecodedSoundCache::DecodedSoundCache(uint32 memoryBudget, uint32 maxSoundSize) :
+		_memoryBudget(memoryBudget), _maxSoundSize(maxSoundSize) {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+DecodedSoundCache::~DecodedSoundCache() {
+	clear();
+}
+
+SeekableAudioStream *DecodedSoundCache::createStream(const Key &key) {
+	Common::StackLock lock(_mutex);
+
+	EntryMap::iterator i = _map.find(key);
+	if (i == _map.end()) {
+		_stats.misses++;
+		return nullptr;
+	}
+
+	// Move the sound to the front of the LRU list
+	if (i->_value != _entries.begin()) {
+		_entries.push_front(*i->_value);
+		_entries.erase(i->_value);
+		i->_value = _entries.begin();
+	}
+
+	_stats.hits++;
+	return createStream(*i->_value);
+}
+
+SeekableAudioStream *DecodedSoundCache::addStream(const Key &key, SeekableAudioStream *stream) {
+	if (!stream)
+		return nullptr;
+
+	const int channels = stream->isStereo() ? 2 : 1;
+	const uint64 numSamples = (uint64)stream->getLength().convertToFramerate(stream->getRate()).totalNumberOfFrames() * channels;
+
+	if (numSamples == 0 || numSamples * 2 > MIN(_maxSoundSize, _memoryBudget)) {
+		Common::StackLock lock(_mutex);
+		_stats.uncacheable++;
+		return stream;
+	}
+
+	// Decode without holding the mutex, this is the expensive part
+	Entry entry;
+	entry.key = key;
+	entry.rate = stream->getRate();
+	entry.flags = FLAG_16BITS;
+	if (channels == 2)
+		entry.flags |= FLAG_STEREO;
+#ifdef SCUMM_LITTLE_ENDIAN
+	entry.flags |= FLAG_LITTLE_ENDIAN;
+#endif
+
+	byte *data = new byte[numSamples * 2];
+	int16 *samples = (int16 *)data;
+	uint32 decoded = 0;
+	while (decoded < numSamples && !stream->endOfData()) {
+		const int count = stream->readBuffer(samples + decoded, numSamples - decoded);
+		if (count <= 0)
+			break;
+		decoded += count;
+	}
+	delete stream;
+
+	// Only keep complete frames
+	decoded -= decoded % channels;
+	entry.size = decoded * 2;
+	entry.data = Common::SharedPtr<byte>(data, Common::ArrayDeleter<byte>());
+
+	Common::StackLock lock(_mutex);
+
+	// Another thread may have added the same sound in the meantime
+	EntryMap::iterator i = _map.find(key);
+	if (i != _map.end()) {
+		_stats.bytesUsed -= i->_value->size;
+		_stats.numSounds--;
+		_entries.erase(i->_value);
+		_map.erase(i);
+	}
+
+	evict(entry.size);
+
+	_entries.push_front(entry);
+	_map[key] = _entries.begin();
+	_stats.bytesUsed += entry.size;
+	_stats.numSounds++;
+
+	return createStream(entry);
+}
+
+bool DecodedSoundCache::contains(const Key &key) const {
+	Common::StackLock lock(_mutex);
+	return _map.contains(key);
+}
+
+void DecodedSoundCache::clear() {
+	Common::StackLock lock(_mutex);
+	_map.clear();
+	_entries.clear();
+	_stats.bytesUsed = 0;
+	_stats.numSounds = 0;
+}
+
+void DecodedSoundCache::setMemoryBudget(uint32 memoryBudget) {
+	Common::StackLock lock(_mutex);
+	_memoryBudget = memoryBudget;
+	evict(0);
+}
+
+DecodedSoundCache::Stats DecodedSoundCache::getStats() const {
+	Common::StackLock lock(_mutex);
+	return _stats;
+}
+
+void DecodedSoundCache::resetStats() {
+	Common::StackLock lock(_mutex);
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.uncacheable = 0;
+	_stats.evictions = 0;
+}
+
+SeekableAudioStream *DecodedSoundCache::createStream(const Entry &entry) const {
+	// The memory stream shares the data with the cache, so no copy is made
+	Common::SeekableReadStream *data = new Common::MemoryReadStream(entry.data, 0, entry.size);
+	return makeRawStream(data, entry.rate, entry.flags, DisposeAfterUse::YES);
+}
+
+void DecodedSoundCache::evict(uint32 required) {
+	while (!_entries.empty() && _stats.bytesUsed + required > _memoryBudget) {
+		const Entry &last = _entries.back();
+		_stats.bytesUsed -= last.size;
+		_stats.numSounds--;
+		_stats.evictions++;
+		_map.erase(last.key);
+		_entries.pop_back();
+	}
+}
+
+} // End of namespace Audio
@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_DECODEDSOUNDCACHE_H
+#define AUDIO_DECODEDSOUNDCACHE_H
+
+#include "common/scummsys.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+#include "common/ptr.h"
+#include "common/str.h"
+
+namespace Audio {
+
+/**
+ * @defgroup audio_decodedsoundcache Decoded sound cache
+ * @ingroup audio
+ *
+ * @brief Cache for the decoded PCM data of short, compressed sounds.
+ * @{
+ */
+
+class SeekableAudioStream;
+
+/**
+ * Keeps the decoded PCM data of short compressed sounds around, so that
+ * sound effects which are played over and over again only have to be
+ * decoded once.
+ *
+ * Typical use, e.g. for a sound effect stored in an archive:
+ *
+ * @code
+ * DecodedSoundCache::Key key(resourceName, offset);
+ * SeekableAudioStream *stream = _cache.createStream(key);
+ * if (!stream)
+ *     stream = _cache.addStream(key, makeVorbisStream(file, DisposeAfterUse::YES));
+ * @endcode
+ *
+ * The cached sounds are returned as raw streams reading from memory shared
+ * with the cache. Evicting a sound from the cache while it is playing is
+ * safe; the memory is released once the last stream playing it is gone.
+ *
+ * All methods may be called from different threads.
+ */
+class DecodedSoundCache : Common::NonCopyable {
+public:
+	/**
+	 * Identifies a sound. The source is usually the name of the file or
+	 * resource the sound is stored in, the offset its position inside of
+	 * it. The params are free for the caller to distinguish e.g. different
+	 * codec settings for the same data.
+	 */
+	struct Key {
+		Common::String source;
+		uint32 offset;
+		uint32 params;
+
+		Key() : offset(0), params(0) {}
+		Key(const Common::String &s, uint32 o = 0, uint32 p = 0) : source(s), offset(o), params(p) {}
+	};
+
+	struct Stats {
+		uint32 hits;        ///< createStream() calls which found the sound.
+		uint32 misses;      ///< createStream() calls which did not find the sound.
+		uint32 uncacheable; ///< addStream() calls with sounds too big or of unknown length.
+		uint32 evictions;   ///< Sounds removed to stay within the memory budget.
+		uint32 numSounds;   ///< Number of sounds currently cached.
+		uint32 bytesUsed;   ///< Memory used by the currently cached sounds.
+	};
+
+	/**
+	 * @param memoryBudget  Maximum number of bytes of decoded data to keep.
+	 * @param maxSoundSize  Size in bytes of the decoded data of the largest
+	 *                      sound which is cached.
+	 */
+	DecodedSoundCache(uint32 memoryBudget = 4 * 1024 * 1024, uint32 maxSoundSize = 512 * 1024);
+	~DecodedSoundCache();
+
+	/**
+	 * Create a stream playing a cached sound.
+	 *
+	 * @return The stream, or nullptr if the sound is not cached.
+	 */
+	SeekableAudioStream *createStream(const Key &key);
+
+	/**
+	 * Decode a sound into the cache and return a stream playing it.
+	 *
+	 * The stream passed in is consumed: if the sound is cached, it is
+	 * decoded completely and deleted, and a stream playing the cached data
+	 * is returned instead. Sounds which are too big or whose length is
+	 * unknown are not cached, and the stream passed in is returned as is.
+	 *
+	 * @param key     Key to store the sound under.
+	 * @param stream  The decoder stream, positioned at the start of the sound.
+	 */
+	SeekableAudioStream *addStream(const Key &key, SeekableAudioStream *stream);
+
+	/** Check whether a sound is cached, without affecting the LRU order. */
+	bool contains(const Key &key) const;
+
+	/** Remove all sounds from the cache. */
+	void clear();
+
+	/** Change the memory budget, evicting sounds as needed. */
+	void setMemoryBudget(uint32 memoryBudget);
+
+	Stats getStats() const;
+	void resetStats();
+
+private:
+	struct Entry {
+		Key key;
+		Common::SharedPtr<byte> data;
+		uint32 size;
+		int rate;
+		byte flags;
+	};
+
+	typedef Common::List<Entry> EntryList;
+
+	struct Key_EqualTo {
+		bool operator()(const Key &x, const Key &y) const;
+	};
+
+	struct Key_Hash {
+		uint operator()(const Key &x) const;
+	};
+
+	typedef Common::HashMap<Key, EntryList::iterator, Key_Hash, Key_EqualTo> EntryMap;
+
+	SeekableAudioStream *createStream(const Entry &entry) const;
+	void evict(uint32 required);
+
+	mutable Common::Mutex _mutex;
+
+	// Most recently used sounds come first
+	EntryList _entries;
+	EntryMap _map;
+
+	uint32 _memoryBudget;
+	const uint32 _maxSoundSize;
+	Stats _stats;
+};
+
+/** @} */
+
+} // End of namespace Audio
+
+#endif
@@ -64,25 +64,48 @@ bool ADPCMStream::rewind() {
 	return true;
 }
 
+uint32 ADPCMStream::readData(byte *data, uint32 size) {
+	if (_stream->eos())
+		return 0;
+
+	const int64 left = _endpos - _stream->pos();
+	if (left <= 0)
+		return 0;
+
+	return _stream->read(data, MIN<int64>(size, left));
+}
+
 
 #pragma mark -
 
 
 int Oki_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
+	int samples = 0;
+	byte data[kReadBufferSize];
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			data = _stream->readByte();
-			_decodedSamples[0] = decodeOKI((data >> 4) & 0x0f);
-			_decodedSamples[1] = decodeOKI((data >> 0) & 0x0f);
-			_decodedSampleCount = 2;
+	// Return the sample left over from the last call first
+	if (_decodedSampleCount != 0 && numSamples > 0) {
+		buffer[samples++] = _decodedSamples[1];
+		_decodedSampleCount = 0;
+	}
+
+	// Decode whole bytes straight into the buffer
+	while (numSamples - samples >= 2) {
+		const uint32 count = readData(data, MIN<uint32>((numSamples - samples) / 2, sizeof(data)));
+		if (count == 0)
+			break;
+
+		for (uint32 i = 0; i < count; i++) {
+			buffer[samples++] = decodeOKI((data[i] >> 4) & 0x0f);
+			buffer[samples++] = decodeOKI((data[i] >> 0) & 0x0f);
 		}
+	}
 
-		// (1 - (count - 1)) ensures that _decodedSamples acts as a FIFO of depth 2
-		buffer[samples] = _decodedSamples[1 - (_decodedSampleCount - 1)];
-		_decodedSampleCount--;
+	// Keep the second sample of the last byte for the next call
+	if (samples < numSamples && readData(data, 1)) {
+		buffer[samples++] = decodeOKI((data[0] >> 4) & 0x0f);
+		_decodedSamples[1] = decodeOKI((data[0] >> 0) & 0x0f);
+		_decodedSampleCount = 1;
 	}
 
 	return samples;
@@ -121,10 +144,10 @@ int16 Oki_ADPCMStream::decodeOKI(byte code) {
 
 
 int XA_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte *data = new byte[128];
+	int samples = 0;
+	byte data[128];
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
+	while (samples < numSamples && !endOfData()) {
 		if (_decodedSampleCount == 0) {
 			uint32 bytesLeft = _stream->size() - _stream->pos();
 			if (bytesLeft < 128) {
@@ -138,12 +161,14 @@ int XA_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 			_decodedSampleIndex = 0;
 		}
 
-		// _decodedSamples acts as a FIFO of depth 2 or 4;
-		buffer[samples] = _decodedSamples[_decodedSampleIndex++];
-		_decodedSampleCount--;
+		// Copy as much of the decoded sound group as fits
+		const int count = MIN<int>(numSamples - samples, _decodedSampleCount);
+		memcpy(buffer + samples, _decodedSamples + _decodedSampleIndex, count * sizeof(int16));
+		samples += count;
+		_decodedSampleIndex += count;
+		_decodedSampleCount -= count;
 	}
 
-	delete[] data;
 	return samples;
 }
 
@@ -221,20 +246,33 @@ void XA_ADPCMStream::decodeXA(const byte *src) {
 
 
 int DVI_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
+	const int secondChannel = (_channels == 2) ? 1 : 0;
+	int samples = 0;
+	byte data[kReadBufferSize];
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			data = _stream->readByte();
-			_decodedSamples[0] = decodeIMA((data >> 4) & 0x0f, 0);
-			_decodedSamples[1] = decodeIMA((data >> 0) & 0x0f, _channels == 2 ? 1 : 0);
-			_decodedSampleCount = 2;
+	// Return the sample left over from the last call first
+	if (_decodedSampleCount != 0 && numSamples > 0) {
+		buffer[samples++] = _decodedSamples[1];
+		_decodedSampleCount = 0;
+	}
+
+	// Decode whole bytes straight into the buffer
+	while (numSamples - samples >= 2) {
+		const uint32 count = readData(data, MIN<uint32>((numSamples - samples) / 2, sizeof(data)));
+		if (count == 0)
+			break;
+
+		for (uint32 i = 0; i < count; i++) {
+			buffer[samples++] = decodeIMA((data[i] >> 4) & 0x0f, 0);
+			buffer[samples++] = decodeIMA((data[i] >> 0) & 0x0f, secondChannel);
 		}
+	}
 
-		// (1 - (count - 1)) ensures that _decodedSamples acts as a FIFO of depth 2
-		buffer[samples] = _decodedSamples[1 - (_decodedSampleCount - 1)];
-		_decodedSampleCount--;
+	// Keep the second sample of the last byte for the next call
+	if (samples < numSamples && readData(data, 1)) {
+		buffer[samples++] = decodeIMA((data[0] >> 4) & 0x0f, 0);
+		_decodedSamples[1] = decodeIMA((data[0] >> 0) & 0x0f, secondChannel);
+		_decodedSampleCount = 1;
 	}
 
 	return samples;
@@ -253,6 +291,8 @@ int Apple_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 	// Number of samples per channel
 	int chanSamples = numSamples / _channels;
 
+	byte data[kReadBufferSize];
+
 	for (int i = 0; i < _channels; i++) {
 		_stream->seek(_streamPos[i]);
 
@@ -275,23 +315,41 @@ int Apple_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 				_blockPos[i] = 2;
 			}
 
-			if (_chunkPos[i] == 0) {
-				// Decode data
-				byte data = _stream->readByte();
-				_buffer[i][0] = decodeIMA(data &  0x0F, i);
-				_buffer[i][1] = decodeIMA(data >>    4, i);
-			}
+			if (_chunkPos[i] == 0 && chanSamples - samples[i] >= 2) {
+				// Decode the whole bytes left in the block straight into the buffer
+				const uint32 count = readData(data, MIN<uint32>(MIN<uint32>((chanSamples - samples[i]) / 2, _blockAlign - _blockPos[i]), sizeof(data)));
+				if (count == 0)
+					break;
+
+				// The original is interleaved block-wise, we want it sample-wise
+				int16 *dst = buffer + _channels * samples[i] + i;
+				for (uint32 j = 0; j < count; j++) {
+					dst[0] = decodeIMA(data[j] & 0x0F, i);
+					dst[_channels] = decodeIMA(data[j] >> 4, i);
+					dst += _channels * 2;
+				}
 
-			// The original is interleaved block-wise, we want it sample-wise
-			buffer[_channels * samples[i] + i] = _buffer[i][_chunkPos[i]];
+				samples[i] += count * 2;
+				_blockPos[i] += count;
+			} else {
+				if (_chunkPos[i] == 0) {
+					// Decode data
+					byte byteData = _stream->readByte();
+					_buffer[i][0] = decodeIMA(byteData &  0x0F, i);
+					_buffer[i][1] = decodeIMA(byteData >>    4, i);
+				}
 
-			if (++_chunkPos[i] > 1) {
-				// We're about to decode the next byte, so advance the block position
-				_chunkPos[i] = 0;
-				_blockPos[i]++;
-			}
+				// The original is interleaved block-wise, we want it sample-wise
+				buffer[_channels * samples[i] + i] = _buffer[i][_chunkPos[i]];
+
+				if (++_chunkPos[i] > 1) {
+					// We're about to decode the next byte, so advance the block position
+					_chunkPos[i] = 0;
+					_blockPos[i]++;
+				}
 
-			samples[i]++;
+				samples[i]++;
+			}
 
 			if (_channels == 2)
 				if (_blockPos[i] == _blockAlign)
@@ -316,6 +374,20 @@ int MSIma_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 
 	int samples = 0;
 
+	// Return the samples left over from the last call first
+	while (samples < numSamples && _samplesLeft[0] != 0) {
+		for (int i = 0; i < _channels; i++) {
+			buffer[samples + i] = _buffer[i][8 - _samplesLeft[i]];
+			_samplesLeft[i]--;
+		}
+
+		samples += _channels;
+	}
+
+	// The stream encodes four bytes per channel at a time
+	const uint32 setSize = _channels * 4;
+	byte data[kReadBufferSize];
+
 	while (samples < numSamples && !_stream->eos() && _stream->pos() < _endpos) {
 		if (_blockPos[0] == _blockAlign) {
 			for (int i = 0; i < _channels; i++) {
@@ -327,14 +399,39 @@ int MSIma_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 			_blockPos[0] = _channels * 4;
 		}
 
+		// Decode as many complete sets of samples as fit straight into the buffer
+		const uint32 numSets = MIN<uint32>(MIN<uint32>((numSamples - samples) / (setSize * 2), (_blockAlign - _blockPos[0]) / setSize), sizeof(data) / setSize);
+		if (numSets != 0) {
+			const uint32 count = readData(data, numSets * setSize) / setSize;
+			if (count == 0)
+				break;
+
+			_blockPos[0] += count * setSize;
+
+			for (uint32 set = 0; set < count; set++) {
+				for (int i = 0; i < _channels; i++) {
+					const byte *src = data + set * setSize + i * 4;
+					int16 *dst = buffer + samples + i;
+
+					for (int j = 0; j < 4; j++) {
+						dst[(j * 2) * _channels] = decodeIMA(src[j] & 0x0f, i);
+						dst[(j * 2 + 1) * _channels] = decodeIMA((src[j] >> 4) & 0x0f, i);
+					}
+				}
+
+				samples += _channels * 8;
+			}
+			continue;
+		}
+
 		// Decode a set of samples
 		for (int i = 0; i < _channels; i++) {
 			// The stream encodes four bytes per channel at a time
 			for (int j = 0; j < 4; j++) {
-				byte data = _stream->readByte();
+				byte byteData = _stream->readByte();
 				_blockPos[0]++;
-				_buffer[i][j * 2] = decodeIMA(data & 0x0f, i);
-				_buffer[i][j * 2 + 1] = decodeIMA((data >> 4) & 0x0f, i);
+				_buffer[i][j * 2] = decodeIMA(byteData & 0x0f, i);
+				_buffer[i][j * 2 + 1] = decodeIMA((byteData >> 4) & 0x0f, i);
 				_samplesLeft[i] += 2;
 			}
 		}
@@ -388,11 +485,11 @@ int16 MS_ADPCMStream::decodeMS(ADPCMChannelStatus *c, byte code) {
 }
 
 int MS_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
+	int samples = 0;
+	byte data[kReadBufferSize];
 	int i;
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
+	while (samples < numSamples && !endOfData()) {
 		if (_decodedSampleCount == 0) {
 			if (_blockPos[0] == _blockAlign) {
 				// read block header
@@ -415,18 +512,34 @@ int MS_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 					_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample1;
 
 				_blockPos[0] = _channels * 7;
+			} else if (numSamples - samples >= 2) {
+				// Decode the whole bytes left in the block straight into the buffer
+				const uint32 count = readData(data, MIN<uint32>(MIN<uint32>((numSamples - samples) / 2, _blockAlign - _blockPos[0]), sizeof(data)));
+				if (count == 0)
+					break;
+
+				_blockPos[0] += count;
+
+				for (uint32 j = 0; j < count; j++) {
+					buffer[samples++] = decodeMS(&_status.ch[0], (data[j] >> 4) & 0x0f);
+					buffer[samples++] = decodeMS(&_status.ch[_channels - 1], data[j] & 0x0f);
+				}
+				continue;
 			} else {
-				data = _stream->readByte();
+				data[0] = _stream->readByte();
 				_blockPos[0]++;
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[0], (data >> 4) & 0x0f);
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[_channels - 1], data & 0x0f);
+				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[0], (data[0] >> 4) & 0x0f);
+				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[_channels - 1], data[0] & 0x0f);
 			}
 			_decodedSampleIndex = 0;
 		}
 
-		// _decodedSamples acts as a FIFO of depth 2 or 4;
-		buffer[samples] = _decodedSamples[_decodedSampleIndex++];
-		_decodedSampleCount--;
+		// _decodedSamples acts as a FIFO of depth 2 or 4
+		const int count = MIN<int>(numSamples - samples, _decodedSampleCount);
+		memcpy(buffer + samples, _decodedSamples + _decodedSampleIndex, count * sizeof(int16));
+		samples += count;
+		_decodedSampleIndex += count;
+		_decodedSampleCount -= count;
 	}
 
 	return samples;
@@ -435,13 +548,13 @@ int MS_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 
 #pragma mark -
 
-#define DK3_READ_NIBBLE(channelNo) \
+#define DK3_READ_NIBBLE(channelNo, nextByte) \
 do { \
 	if (_topNibble) { \
 		_nibble = _lastByte >> 4; \
 		_topNibble = false; \
 	} else { \
-		_lastByte = _stream->readByte(); \
+		_lastByte = nextByte; \
 		_nibble = _lastByte & 0xf; \
 		_topNibble = true; \
 		--blockBytesLeft; \
@@ -462,6 +575,7 @@ int DK3_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 		blockBytesLeft = 0;
 	}
 
+	byte data[kReadBufferSize];
 	int samples = 0;
 	while (samples < numSamples && audioBytesLeft) {
 		if (blockBytesLeft == 0) {
@@ -492,21 +606,61 @@ int DK3_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 			audioBytesLeft -= 16;
 		}
 
-		DK3_READ_NIBBLE(0);
-		DK3_READ_NIBBLE(1);
+		// Read as much of the block as possible, and decode the sets of four
+		// samples which are complete in there. Unused bytes go back to the
+		// stream afterwards.
+		const uint32 size = _stream->read(data, MIN<uint32>(MIN(blockBytesLeft, audioBytesLeft), sizeof(data)));
+		const byte *src = data;
+		const byte *end = data + size;
+		const int startSamples = samples;
+
+		while (samples < numSamples && end - src >= (_topNibble ? 1 : 2)) {
+			DK3_READ_NIBBLE(0, *src++);
+			DK3_READ_NIBBLE(1, *src++);
+
+			*buffer++ = _status.ima_ch[0].last + _status.ima_ch[1].last;
+			*buffer++ = _status.ima_ch[0].last - _status.ima_ch[1].last;
+
+			DK3_READ_NIBBLE(0, *src++);
+
+			*buffer++ = _status.ima_ch[0].last + _status.ima_ch[1].last;
+			*buffer++ = _status.ima_ch[0].last - _status.ima_ch[1].last;
+
+			samples += 4;
+
+			// if the last sample of a block ends on an odd byte, the encoder adds
+			// an extra alignment byte
+			if (!_topNibble && blockBytesLeft == 1) {
+				if (src < end)
+					src++;
+				else
+					_stream->skip(1);
+				--blockBytesLeft;
+				--audioBytesLeft;
+			}
+		}
+
+		if (src < end)
+			_stream->seek(src - end, SEEK_CUR);
+
+		if (samples != startSamples || samples >= numSamples)
+			continue;
+
+		// The rest of the block does not hold a complete set of samples, so
+		// read its nibbles one at a time
+		DK3_READ_NIBBLE(0, _stream->readByte());
+		DK3_READ_NIBBLE(1, _stream->readByte());
 
 		*buffer++ = _status.ima_ch[0].last + _status.ima_ch[1].last;
 		*buffer++ = _status.ima_ch[0].last - _status.ima_ch[1].last;
 
-		DK3_READ_NIBBLE(0);
+		DK3_READ_NIBBLE(0, _stream->readByte());
 
 		*buffer++ = _status.ima_ch[0].last + _status.ima_ch[1].last;
 		*buffer++ = _status.ima_ch[0].last - _status.ima_ch[1].last;
 
 		samples += 4;
 
-		// if the last sample of a block ends on an odd byte, the encoder adds
-		// an extra alignment byte
 		if (!_topNibble && blockBytesLeft == 1) {
 			_stream->skip(1);
 			--blockBytesLeft;
@@ -545,18 +699,6 @@ const int16 Ima_ADPCMStream::_imaTable[89] = {
 	32767
 };
 
-int16 Ima_ADPCMStream::decodeIMA(byte code, int channel) {
-	int32 E = (2 * (code & 0x7) + 1) * _imaTable[_status.ima_ch[channel].stepIndex] / 8;
-	int32 diff = (code & 0x08) ? -E : E;
-	int32 samp = CLIP<int32>(_status.ima_ch[channel].last + diff, -32768, 32767);
-
-	_status.ima_ch[channel].last = samp;
-	_status.ima_ch[channel].stepIndex += _stepAdjustTable[code];
-	_status.ima_ch[channel].stepIndex = CLIP<int32>(_status.ima_ch[channel].stepIndex, 0, ARRAYSIZE(_imaTable) - 1);
-
-	return samp;
-}
-
 SeekableAudioStream *makeADPCMStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 size, ADPCMType type, int rate, int channels, uint32 blockAlign) {
 	// If size is 0, report the entire size of the stream
 	if (!size)
@@ -35,6 +35,7 @@
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 
 namespace Audio {
 
@@ -59,6 +60,18 @@ protected:
 
 	virtual void reset();
 
+	/**
+	 * Read up to size bytes of ADPCM data into a buffer, stopping at the
+	 * end of the data. Used by the decoders to work on whole runs of
+	 * bytes instead of reading them one at a time.
+	 *
+	 * @return The number of bytes read.
+	 */
+	uint32 readData(byte *data, uint32 size);
+
+	/** Size of the stack buffers used with readData(). */
+	static const uint32 kReadBufferSize = 512;
+
 public:
 	ADPCMStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 size, int rate, int channels, uint32 blockAlign);
 
@@ -117,7 +130,19 @@ private:
 
 class Ima_ADPCMStream : public ADPCMStream {
 protected:
-	int16 decodeIMA(byte code, int channel = 0); // Default to using the left channel/using one channel
+	int16 decodeIMA(byte code, int channel = 0) { // Default to using the left channel/using one channel
+		return decodeIMA(code, _status.ima_ch[channel].last, _status.ima_ch[channel].stepIndex);
+	}
+
+	static inline int16 decodeIMA(byte code, int32 &last, int32 &stepIndex) {
+		const int32 E = (2 * (code & 0x7) + 1) * _imaTable[stepIndex] / 8;
+		const int32 diff = (code & 0x08) ? -E : E;
+		last = CLIP<int32>(last + diff, -32768, 32767);
+
+		stepIndex = CLIP<int32>(stepIndex + _stepAdjustTable[code], 0, ARRAYSIZE(_imaTable) - 1);
+
+		return last;
+	}
 
 public:
 	Ima_ADPCMStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 size, int rate, int channels, uint32 blockAlign)
@@ -220,6 +220,16 @@ public:
 	 */
 	virtual uint16 sysExNoDelay(const byte *msg, uint16 length) { sysEx(msg, length); return 0; }
 
+	/**
+	 * Set the time, in microseconds from the start of the current timer
+	 * period, at which the following events are to be played. MidiParser
+	 * calls this before each event it sends from onTimer, so drivers which
+	 * render audio in blocks can play events with sample accuracy instead
+	 * of at the timer tick. Drivers which ignore this play events as soon
+	 * as they are received.
+	 */
+	virtual void setEventDelay(uint32 delay) { }
+
 	// TODO: Document this.
 	virtual void metaEvent(byte type, byte *data, uint16 length) { }
 
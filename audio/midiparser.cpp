@@ -209,6 +209,7 @@ void MidiParser::onTimer() {
 		for (i = ARRAYSIZE(_hangingNotes); i; --i, ++ptr) {
 			if (ptr->timeLeft) {
 				if (ptr->timeLeft <= _timerRate) {
+					_driver->setEventDelay(ptr->timeLeft);
 					sendToDriver(0x80 | ptr->channel, ptr->note, 0);
 					ptr->timeLeft = 0;
 					--_hangingNotesCount;
@@ -244,6 +245,8 @@ void MidiParser::onTimer() {
 					activeNote(info.channel(), info.basic.param1, true);
 			}
 
+			_driver->setEventDelay(eventTime > _position._playTime ? eventTime - _position._playTime : 0);
+
 			// Player::metaEvent() in SCUMM will delete the parser object,
 			// so return immediately if that might have happened.
 			bool ret = processEvent(info);
@@ -260,6 +263,9 @@ void MidiParser::onTimer() {
 		}
 	}
 
+	// Events sent after this, e.g. by the timer proc, are not scheduled
+	_driver->setEventDelay(0);
+
 	if (!_abortParse) {
 		_position._playTime = endTime;
 		_position._playTick = (_position._playTime - _position._lastEventTime) / _psecPerTick + _position._lastEventTick;
@@ -46,15 +46,17 @@ public:
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given mix bus.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param data    mix bus where to add the data, in the mixer's output
+	 *                format
+	 * @param scratch buffer for the output of the rate converter, which
+	 *                must have room for len stereo sample pairs
+	 * @param len     number of sample *pairs* (or mono samples) to mix
+	 * @param stats   timing statistics to update, or nullptr
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *data, int16 *scratch, uint len, MixerTimingStats *stats);
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -167,6 +169,17 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Fills in the time spent by this channel since it started, or since
+	 * the last call to resetTiming().
+	 */
+	void getTiming(MixerTimingStats::ChannelTiming &timing) const;
+
+	/**
+	 * Resets the time spent by this channel.
+	 */
+	void resetTiming();
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
@@ -180,6 +193,9 @@ private:
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
+	/** The converter swaps the stereo channels before the volume is applied */
+	bool _reverseStereo;
+
 	Mixer *_mixer;
 
 	uint32 _samplesConsumed;
@@ -188,16 +204,49 @@ private:
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
 
+	uint32 _mixCalls;
+	uint64 _readTime;
+	uint64 _mixTime;
+
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
 };
 
+/**
+ * Forwards the reads of a rate converter to a channel's stream, and
+ * measures the time they take.
+ */
+class TimedAudioStream : public AudioStream {
+public:
+	TimedAudioStream(AudioStream &stream) : _stream(stream), _time(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const uint64 start = g_system->getMicros();
+		const int samples = _stream.readBuffer(buffer, numSamples);
+		_time += g_system->getMicros() - start;
+		return samples;
+	}
+
+	bool isStereo() const override { return _stream.isStereo(); }
+	int getRate() const override { return _stream.getRate(); }
+	bool endOfData() const override { return _stream.endOfData(); }
+	bool endOfStream() const override { return _stream.endOfStream(); }
+
+	/** Time spent in reading the stream, in microseconds */
+	uint64 getTime() const { return _time; }
+
+private:
+	AudioStream &_stream;
+	uint64 _time;
+};
+
 #pragma mark -
 #pragma mark --- Mixer ---
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _timingStatsEnabled(false), _lastCallbackStart(0) {
 
 	assert(sampleRate > 0);
 
@@ -303,15 +352,16 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 	Common::StackLock lock(_mutex);
 
+	const uint64 startTime = _timingStatsEnabled ? g_system->getMicros() : 0;
+	MixerTimingStats *stats = _timingStatsEnabled ? &_timingStats : nullptr;
+
 	int16 *buf = (int16 *)samples;
 
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, len);
-
 	// we store 16-bit samples
+	const uint numSamples = len >> 1;
 	if (_stereo) {
 		assert(len % 4 == 0);
 		len >>= 2;
@@ -320,6 +370,31 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 		len >>= 1;
 	}
 
+	// The channels are mixed into 32-bit buses, and the rate converters
+	// always produce stereo samples in the scratch buffer
+	if (_mixBuffer.size() < numSamples)
+		_mixBuffer.resize(numSamples);
+	if (_channelBuffer.size() < len * 2)
+		_channelBuffer.resize(len * 2);
+
+	int32 *mixBuf = _mixBuffer.data();
+	memset(mixBuf, 0, numSamples * sizeof(int32));
+
+	// Sound types with an effect get a bus of their own, which is added to
+	// the final mix after the effect processed it
+	int32 *buses[ARRAYSIZE(_soundTypeSettings)];
+	for (int i = 0; i < ARRAYSIZE(_soundTypeSettings); i++) {
+		SoundTypeSettings &settings = _soundTypeSettings[i];
+		if (settings.effect) {
+			if (settings.effectBuffer.size() < numSamples)
+				settings.effectBuffer.resize(numSamples);
+			buses[i] = settings.effectBuffer.data();
+			memset(buses[i], 0, numSamples * sizeof(int32));
+		} else {
+			buses[i] = mixBuf;
+		}
+	}
+
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
@@ -328,13 +403,52 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 				delete _channels[i];
 				_channels[i] = nullptr;
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				tmp = _channels[i]->mix(buses[_channels[i]->getType()], _channelBuffer.data(), len, stats);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	for (int i = 0; i < ARRAYSIZE(_soundTypeSettings); i++) {
+		if (buses[i] == mixBuf)
+			continue;
+
+		_soundTypeSettings[i].effect->process(buses[i], len, _stereo);
+
+		const int32 *src = buses[i];
+		for (uint j = 0; j < numSamples; j++)
+			mixBuf[j] += src[j];
+	}
+
+	// Clamp the sum of all channels once
+	for (uint i = 0; i < numSamples; i++) {
+		const int32 val = CLIP<int32>(mixBuf[i], ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		buf[i] = (int16)(val ^ 0x8000);
+#else
+		buf[i] = (int16)val;
+#endif
+	}
+
+	if (stats) {
+		const uint64 endTime = g_system->getMicros();
+		const uint64 period = (uint64)len * 1000000 / _sampleRate;
+
+		stats->callbacks++;
+		stats->frames += len;
+		stats->callback.add(endTime - startTime);
+		if (endTime - startTime > period)
+			stats->underruns++;
+
+		if (_lastCallbackStart) {
+			stats->interval.add(startTime - _lastCallbackStart);
+			if (startTime - _lastCallbackStart > period * 2)
+				stats->lateCallbacks++;
+		}
+		_lastCallbackStart = startTime;
+	}
+
 	return res;
 }
 
@@ -567,6 +681,59 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	return _soundTypeSettings[type].volume;
 }
 
+void MixerImpl::setSoundTypeEffect(SoundType type, MixerEffect *effect) {
+	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
+	_soundTypeSettings[type].effect = effect;
+	if (!effect)
+		_soundTypeSettings[type].effectBuffer.clear();
+}
+
+void MixerImpl::enableTimingStats(bool enable) {
+	Common::StackLock lock(_mutex);
+
+	if (enable && !_timingStatsEnabled) {
+		_timingStats.reset();
+		_lastCallbackStart = 0;
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i])
+				_channels[i]->resetTiming();
+		}
+	}
+	_timingStatsEnabled = enable;
+}
+
+bool MixerImpl::isTimingStatsEnabled() const {
+	Common::StackLock lock(_mutex);
+	return _timingStatsEnabled;
+}
+
+void MixerImpl::getTimingStats(MixerTimingStats &stats) {
+	Common::StackLock lock(_mutex);
+
+	stats = _timingStats;
+	stats.channels.clear();
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i]) {
+			MixerTimingStats::ChannelTiming timing;
+			_channels[i]->getTiming(timing);
+			stats.channels.push_back(timing);
+		}
+	}
+}
+
+void MixerImpl::resetTimingStats() {
+	Common::StackLock lock(_mutex);
+
+	_timingStats.reset();
+	_lastCallbackStart = 0;
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i])
+			_channels[i]->resetTiming();
+	}
+}
+
 
 #pragma mark -
 #pragma mark --- Channel implementations ---
@@ -576,13 +743,16 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
+	  _pauseStartTime(0), _pauseTime(0), _mixCalls(0), _readTime(0), _mixTime(0), _converter(nullptr), _volL(0), _volR(0), _reverseStereo(false),
 	  _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
-	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo);
+	// Get a rate converter instance. It always produces stereo samples,
+	// which are downmixed when adding them to the mix bus for mono output,
+	// so that the volume of each side can be applied first.
+	_reverseStereo = reverseStereo && _stream->isStereo() && mixer->getOutputStereo();
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), true, _reverseStereo);
 }
 
 Channel::~Channel() {
@@ -707,7 +877,26 @@ void Channel::loop() {
 	}
 }
 
-int Channel::mix(int16 *data, uint len) {
+/**
+ * Add stereo samples to a stereo mix bus, using the same volume scaling as
+ * the rate converters.
+ */
+static void addStereoSamples(int32 *dst, const int16 *src, uint len, int volL, int volR) {
+	for (uint i = 0; i < len; i++) {
+		dst[i * 2    ] += (src[i * 2    ] * volL) / Mixer::kMaxMixerVolume;
+		dst[i * 2 + 1] += (src[i * 2 + 1] * volR) / Mixer::kMaxMixerVolume;
+	}
+}
+
+/**
+ * Downmix stereo samples and add them to a mono mix bus.
+ */
+static void addMonoSamples(int32 *dst, const int16 *src, uint len, int volL, int volR) {
+	for (uint i = 0; i < len; i++)
+		dst[i] += ((src[i * 2] * volL) / Mixer::kMaxMixerVolume + (src[i * 2 + 1] * volR) / Mixer::kMaxMixerVolume) / 2;
+}
+
+int Channel::mix(int32 *data, int16 *scratch, uint len, MixerTimingStats *stats) {
 	assert(_stream);
 	assert(_converter);
 
@@ -716,11 +905,59 @@ int Channel::mix(int16 *data, uint len) {
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->convert(*_stream, data, len, _volL, _volR);
+
+		const uint64 startTime = stats ? g_system->getMicros() : 0;
+
+		// The converter adds its output to the buffer at full volume, the
+		// channel volume is applied when adding it to the mix bus
+		memset(scratch, 0, len * 2 * sizeof(int16));
+		uint64 readTime = 0;
+		if (stats) {
+			TimedAudioStream timedStream(*_stream);
+			res = _converter->convert(timedStream, scratch, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+			readTime = timedStream.getTime();
+		} else {
+			res = _converter->convert(*_stream, scratch, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+		}
 		_samplesDecoded += res;
+
+		if (res > 0 && (_volL || _volR)) {
+			if (!_mixer->getOutputStereo())
+				addMonoSamples(data, scratch, res, _volL, _volR);
+			else if (_reverseStereo)
+				addStereoSamples(data, scratch, res, _volR, _volL);
+			else
+				addStereoSamples(data, scratch, res, _volL, _volR);
+		}
+
+		if (stats) {
+			const uint64 mixTime = g_system->getMicros() - startTime - readTime;
+			stats->read[_type].add(readTime);
+			stats->mix[_type].add(mixTime);
+			_readTime += readTime;
+			_mixTime += mixTime;
+			_mixCalls++;
+		}
 	}
 
 	return res;
 }
 
+void Channel::getTiming(MixerTimingStats::ChannelTiming &timing) const {
+	timing.handle = _handle._val;
+	timing.id = _id;
+	timing.type = _type;
+	timing.rate = _stream->getRate();
+	timing.stereo = _stream->isStereo();
+	timing.calls = _mixCalls;
+	timing.readTime = _readTime;
+	timing.mixTime = _mixTime;
+}
+
+void Channel::resetTiming() {
+	_mixCalls = 0;
+	_readTime = 0;
+	_mixTime = 0;
+}
+
 } // End of namespace Audio
@@ -31,6 +31,7 @@ namespace Audio {
 class AudioStream;
 class Channel;
 class Timestamp;
+struct MixerTimingStats;
 
 /**
  * @defgroup audio_mixer Mixer
@@ -52,6 +53,30 @@ class SoundHandle {
 	uint32 _val = 0xffffffff;
 };
 
+/**
+ * An effect that processes the mixed output of all channels of one sound
+ * type, before it is added to the final mix.
+ *
+ * @see Mixer::setSoundTypeEffect
+ */
+class MixerEffect {
+public:
+	virtual ~MixerEffect() {}
+
+	/**
+	 * Process the samples of a sound type in place. This is called from the
+	 * mixer callback with the mixer mutex held, for every mixer callback
+	 * while the effect is installed, even when no channel of the sound type
+	 * is playing.
+	 *
+	 * @param buffer     Interleaved samples in the range of 16-bit samples.
+	 *                   They are not clamped yet, so they may exceed it.
+	 * @param numFrames  Number of sample frames in the buffer.
+	 * @param stereo     Whether the buffer contains stereo sample pairs.
+	 */
+	virtual void process(int32 *buffer, uint numFrames, bool stereo) = 0;
+};
+
 /**
  * The main audio mixer that handles mixing of an arbitrary number of
  * audio streams (in the form of AudioStream instances).
@@ -321,6 +346,44 @@ public:
 	 */
 	virtual int getVolumeForSoundType(SoundType type) const = 0;
 
+	/**
+	 * Install an effect that processes the mixed output of all channels
+	 * of the given sound type.
+	 *
+	 * The mixer does not take ownership of the effect. It has to stay
+	 * valid until it is replaced or removed again.
+	 *
+	 * @param type    Sound type.
+	 * @param effect  The effect to use, or nullptr to remove the current one.
+	 */
+	virtual void setSoundTypeEffect(SoundType type, MixerEffect *effect) = 0;
+
+	/**
+	 * Enable or disable collecting timing statistics of the mixer callback.
+	 * Enabling them resets the statistics collected so far.
+	 *
+	 * @see MixerTimingStats
+	 */
+	virtual void enableTimingStats(bool enable) = 0;
+
+	/**
+	 * Check whether timing statistics are collected.
+	 */
+	virtual bool isTimingStatsEnabled() const = 0;
+
+	/**
+	 * Get the timing statistics collected so far, including the times of
+	 * the currently active channels.
+	 *
+	 * @param stats  Receives a copy of the statistics.
+	 */
+	virtual void getTimingStats(MixerTimingStats &stats) = 0;
+
+	/**
+	 * Reset the timing statistics, including those of the active channels.
+	 */
+	virtual void resetTimingStats() = 0;
+
 	/**
 	 * Return the output sample rate of the system.
 	 *
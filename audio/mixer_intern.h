@@ -23,8 +23,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/mixer_stats.h"
 
 namespace Audio {
 
@@ -70,15 +72,31 @@ private:
 	uint32 _handleSeed;
 
 	struct SoundTypeSettings {
-		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
+		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume), effect(nullptr) {}
 
 		bool mute;
 		int volume;
+		MixerEffect *effect;
+		/** Mix bus of the channels of this type, only used with an effect. */
+		Common::Array<int32> effectBuffer;
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * The final mix bus. The channels are summed up here without clamping,
+	 * which is only done once when the result is written to the output.
+	 */
+	Common::Array<int32> _mixBuffer;
+	/** Output of the rate converter of the channel currently being mixed. */
+	Common::Array<int16> _channelBuffer;
+
+	bool _timingStatsEnabled;
+	MixerTimingStats _timingStats;
+	/** Start time of the previous callback, 0 if there was none yet. */
+	uint64 _lastCallbackStart;
+
 
 public:
 
@@ -132,6 +150,13 @@ public:
 	virtual void setVolumeForSoundType(SoundType type, int volume);
 	virtual int getVolumeForSoundType(SoundType type) const;
 
+	virtual void setSoundTypeEffect(SoundType type, MixerEffect *effect);
+
+	virtual void enableTimingStats(bool enable);
+	virtual bool isTimingStatsEnabled() const;
+	virtual void getTimingStats(MixerTimingStats &stats);
+	virtual void resetTimingStats();
+
 	virtual uint getOutputRate() const;
 	virtual bool getOutputStereo() const;
 	virtual uint getOutputBufSize() const;
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/system.h"
+
+#include "audio/mixer_intern.h"
+#include "audio/mixer_render.h"
+
+namespace Audio {
+
+enum {
+	kRenderChunkFrames = 1024,
+	kWAVHeaderSize = 44
+};
+
+MixerRenderer::MixerRenderer(MixerImpl *mixer, Common::SeekableWriteStream *output, DisposeAfterUse::Flag disposeOutput)
+	: _mixer(mixer), _output(output), _disposeOutput(disposeOutput), _finished(false), _frames(0), _mixTime(0) {
+	assert(mixer);
+	assert(output);
+
+	_channels = _mixer->getOutputStereo() ? 2 : 1;
+	_buffer = new int16[kRenderChunkFrames * _channels];
+
+	// The sizes are filled in by finish()
+	writeHeader(0);
+}
+
+MixerRenderer::~MixerRenderer() {
+	finish();
+
+	delete[] _buffer;
+	if (_disposeOutput == DisposeAfterUse::YES)
+		delete _output;
+}
+
+void MixerRenderer::writeHeader(uint32 dataSize) {
+	const uint32 rate = _mixer->getOutputRate();
+
+	_output->writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	_output->writeUint32LE(kWAVHeaderSize - 8 + dataSize);
+	_output->writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+	_output->writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	_output->writeUint32LE(16);
+	_output->writeUint16LE(1); // PCM
+	_output->writeUint16LE(_channels);
+	_output->writeUint32LE(rate);
+	_output->writeUint32LE(rate * _channels * 2);
+	_output->writeUint16LE(_channels * 2);
+	_output->writeUint16LE(16);
+	_output->writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	_output->writeUint32LE(dataSize);
+}
+
+bool MixerRenderer::render(uint32 numFrames) {
+	assert(!_finished);
+
+	while (numFrames > 0) {
+		const uint32 frames = MIN<uint32>(numFrames, kRenderChunkFrames);
+		const uint32 numSamples = frames * _channels;
+
+		const uint64 start = g_system->getMicros();
+		_mixer->mixCallback((byte *)_buffer, numSamples * sizeof(int16));
+		_mixTime += g_system->getMicros() - start;
+
+#ifdef SCUMM_BIG_ENDIAN
+		for (uint32 i = 0; i < numSamples; i++)
+			WRITE_LE_INT16(&_buffer[i], _buffer[i]);
+#endif
+		if (_output->write(_buffer, numSamples * sizeof(int16)) != numSamples * sizeof(int16))
+			return false;
+
+		_frames += frames;
+		numFrames -= frames;
+	}
+
+	return true;
+}
+
+bool MixerRenderer::finish() {
+	if (_finished)
+		return !_output->err();
+	_finished = true;
+
+	const int64 end = _output->pos();
+	if (_output->seek(0)) {
+		writeHeader(_frames * _channels * 2);
+		_output->seek(end);
+	}
+
+	return _output->flush() && !_output->err();
+}
+
+uint32 MixerRenderer::getRenderedMillis() const {
+	return (uint32)((uint64)_frames * 1000 / _mixer->getOutputRate());
+}
+
+double MixerRenderer::getRealtimeFactor() const {
+	if (!_mixTime)
+		return 0.0;
+	return (double)_frames * 1000000.0 / _mixer->getOutputRate() / _mixTime;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIXER_RENDER_H
+#define AUDIO_MIXER_RENDER_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/types.h"
+
+namespace Common {
+class SeekableWriteStream;
+}
+
+namespace Audio {
+
+class MixerImpl;
+
+/**
+ * @defgroup audio_mixer_render Mixer rendering
+ * @ingroup audio
+ *
+ * @brief Rendering of the mixer output into a WAV file, without an audio device.
+ * @{
+ */
+
+/**
+ * Renders the output of a mixer into a 16-bit PCM WAV file, by calling
+ * MixerImpl::mixCallback() directly instead of waiting for an audio device
+ * to do so. This allows to render audio as fast as possible, e.g. to compare
+ * the output of a decoder or synth before and after a change, or to measure
+ * how fast it is.
+ */
+class MixerRenderer : Common::NonCopyable {
+public:
+	/**
+	 * Create a renderer and write the WAV header.
+	 *
+	 * @param mixer          The mixer to render. It must not be pulled by an
+	 *                       audio device at the same time.
+	 * @param output         Stream the WAV file is written to.
+	 * @param disposeOutput  Whether to delete the stream in the destructor.
+	 */
+	MixerRenderer(MixerImpl *mixer, Common::SeekableWriteStream *output, DisposeAfterUse::Flag disposeOutput = DisposeAfterUse::YES);
+	~MixerRenderer();
+
+	/**
+	 * Mix the given number of sample frames and append them to the file.
+	 *
+	 * @return false if writing failed.
+	 */
+	bool render(uint32 numFrames);
+
+	/**
+	 * Update the sizes in the WAV header and flush the output. Called by
+	 * the destructor, if it was not called before.
+	 *
+	 * @return false if writing failed.
+	 */
+	bool finish();
+
+	/** Number of sample frames rendered so far. */
+	uint32 getFramesRendered() const { return _frames; }
+
+	/** Length of the rendered audio, in milliseconds. */
+	uint32 getRenderedMillis() const;
+
+	/** Time spent in the mixer callback, in microseconds. */
+	uint64 getMixTime() const { return _mixTime; }
+
+	/**
+	 * How much faster than real time the mixer rendered the audio, i.e.
+	 * the length of the rendered audio divided by the time the mixer
+	 * callback took.
+	 */
+	double getRealtimeFactor() const;
+
+private:
+	void writeHeader(uint32 dataSize);
+
+	MixerImpl *_mixer;
+	Common::SeekableWriteStream *_output;
+	DisposeAfterUse::Flag _disposeOutput;
+	bool _finished;
+
+	uint _channels;
+	uint32 _frames;
+	uint64 _mixTime;
+	int16 *_buffer;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
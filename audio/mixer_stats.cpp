@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/math.h"
+
+#include "audio/mixer_stats.h"
+
+namespace Audio {
+
+static const char *const soundTypeNames[MixerTimingStats::kNumSoundTypes] = {
+	"plain", "music", "sfx", "speech"
+};
+
+void MixerTimingStats::Histogram::reset() {
+	count = 0;
+	total = 0;
+	max = 0;
+	memset(buckets, 0, sizeof(buckets));
+}
+
+void MixerTimingStats::Histogram::add(uint64 micros) {
+	const uint32 value = (uint32)MIN<uint64>(micros, 0xFFFFFFFF);
+	const int bucket = value ? MIN<int>(Common::intLog2(value) + 1, kNumBuckets - 1) : 0;
+
+	count++;
+	total += micros;
+	max = MAX(max, value);
+	buckets[bucket]++;
+}
+
+uint32 MixerTimingStats::Histogram::percentile(uint percent) const {
+	uint64 sum = 0;
+	for (int i = 0; i < kNumBuckets - 1; i++) {
+		sum += buckets[i];
+		if (sum * 100 >= (uint64)count * percent)
+			return MIN<uint32>(1 << i, max);
+	}
+	return max;
+}
+
+void MixerTimingStats::reset() {
+	callback.reset();
+	interval.reset();
+	for (int i = 0; i < kNumSoundTypes; i++) {
+		read[i].reset();
+		mix[i].reset();
+	}
+	callbacks = 0;
+	frames = 0;
+	underruns = 0;
+	lateCallbacks = 0;
+	channels.clear();
+}
+
+static Common::String histogramToString(const char *name, const MixerTimingStats::Histogram &histogram) {
+	return Common::String::format("%-12s %8u calls, avg %6u us, 50%% <= %6u us, 99%% <= %6u us, max %6u us\n",
+	                              name, histogram.count, histogram.average(), histogram.percentile(50), histogram.percentile(99), histogram.max);
+}
+
+Common::String MixerTimingStats::toString() const {
+	Common::String result = Common::String::format("%u callbacks, %llu frames, %u underruns, %u late callbacks\n",
+	                                               callbacks, (unsigned long long)frames, underruns, lateCallbacks);
+	result += histogramToString("callback", callback);
+	result += histogramToString("interval", interval);
+
+	for (int i = 0; i < kNumSoundTypes; i++) {
+		if (read[i].count) {
+			result += histogramToString(Common::String::format("read %s", soundTypeNames[i]).c_str(), read[i]);
+			result += histogramToString(Common::String::format("mix %s", soundTypeNames[i]).c_str(), mix[i]);
+		}
+	}
+
+	for (uint i = 0; i < channels.size(); i++) {
+		const ChannelTiming &channel = channels[i];
+		result += Common::String::format("channel %u (id %d, %s, %d Hz %s): %u calls, read %llu us, mix %llu us\n",
+		                                 channel.handle, channel.id, soundTypeNames[channel.type], channel.rate,
+		                                 channel.stereo ? "stereo" : "mono", channel.calls,
+		                                 (unsigned long long)channel.readTime, (unsigned long long)channel.mixTime);
+	}
+
+	return result;
+}
+
+static Common::String histogramToJSON(const MixerTimingStats::Histogram &histogram) {
+	Common::String result = Common::String::format("{\"count\": %u, \"total\": %llu, \"max\": %u, \"buckets\": [",
+	                                               histogram.count, (unsigned long long)histogram.total, histogram.max);
+	for (int i = 0; i < MixerTimingStats::kNumBuckets; i++)
+		result += Common::String::format(i ? ", %u" : "%u", histogram.buckets[i]);
+	result += "]}";
+	return result;
+}
+
+Common::String MixerTimingStats::dump() const {
+	Common::String result = Common::String::format("{\n\t\"callbacks\": %u,\n\t\"frames\": %llu,\n\t\"underruns\": %u,\n\t\"lateCallbacks\": %u,\n",
+	                                               callbacks, (unsigned long long)frames, underruns, lateCallbacks);
+	result += "\t\"callback\": " + histogramToJSON(callback) + ",\n";
+	result += "\t\"interval\": " + histogramToJSON(interval) + ",\n";
+
+	const Histogram *const perType[] = { read, mix };
+	const char *const perTypeNames[] = { "read", "mix" };
+	for (int i = 0; i < ARRAYSIZE(perType); i++) {
+		result += Common::String::format("\t\"%s\": {\n", perTypeNames[i]);
+		for (int j = 0; j < kNumSoundTypes; j++)
+			result += Common::String::format("\t\t\"%s\": ", soundTypeNames[j]) + histogramToJSON(perType[i][j]) + (j + 1 < kNumSoundTypes ? ",\n" : "\n");
+		result += "\t},\n";
+	}
+
+	result += "\t\"channels\": [";
+	for (uint i = 0; i < channels.size(); i++) {
+		const ChannelTiming &channel = channels[i];
+		result += Common::String::format("%s\n\t\t{\"handle\": %u, \"id\": %d, \"type\": \"%s\", \"rate\": %d, \"stereo\": %s, \"calls\": %u, \"readTime\": %llu, \"mixTime\": %llu}",
+		                                 i ? "," : "", channel.handle, channel.id, soundTypeNames[channel.type], channel.rate,
+		                                 channel.stereo ? "true" : "false", channel.calls,
+		                                 (unsigned long long)channel.readTime, (unsigned long long)channel.mixTime);
+	}
+	result += channels.empty() ? "]\n}\n" : "\n\t]\n}\n";
+
+	return result;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,133 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIXER_STATS_H
+#define AUDIO_MIXER_STATS_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/str.h"
+
+#include "audio/mixer.h"
+
+namespace Audio {
+
+/**
+ * @defgroup audio_mixer_stats Mixer timing statistics
+ * @ingroup audio
+ *
+ * @brief Timing statistics of the mixer callback, to find out where the
+ *        audio processing time goes when the output stutters.
+ * @{
+ */
+
+/**
+ * Timing statistics of the mixer callback. All durations are in
+ * microseconds, measured with OSystem::getMicros().
+ *
+ * @see Mixer::enableTimingStats
+ */
+struct MixerTimingStats {
+	enum {
+		kNumBuckets = 20,
+		kNumSoundTypes = 4
+	};
+
+	/**
+	 * Histogram of durations. Bucket 0 counts durations below 1us, bucket i
+	 * the durations from 2^(i-1)us up to 2^i us. The last bucket also counts
+	 * all longer durations.
+	 */
+	struct Histogram {
+		uint32 count;
+		uint64 total;
+		uint32 max;
+		uint32 buckets[kNumBuckets];
+
+		Histogram() { reset(); }
+
+		void reset();
+		void add(uint64 micros);
+
+		/** Average duration, 0 if nothing was added yet. */
+		uint32 average() const { return count ? (uint32)(total / count) : 0; }
+
+		/**
+		 * Approximate the given percentile, as the upper bound of the bucket
+		 * it falls into.
+		 */
+		uint32 percentile(uint percent) const;
+	};
+
+	/** Time spent by a single channel, since it started or since the last reset. */
+	struct ChannelTiming {
+		uint32 handle;
+		int id;
+		Mixer::SoundType type;
+		int rate;
+		bool stereo;
+		uint32 calls;
+		uint64 readTime;
+		uint64 mixTime;
+	};
+
+	/** Duration of the whole mixer callback. */
+	Histogram callback;
+	/** Time between the start of two consecutive callbacks. */
+	Histogram interval;
+	/** Time each channel spent in reading its stream, per sound type. */
+	Histogram read[kNumSoundTypes];
+	/**
+	 * Time each channel spent in rate conversion and adding its samples to
+	 * the mix, without the stream reads, per sound type.
+	 */
+	Histogram mix[kNumSoundTypes];
+
+	/** Number of callbacks. */
+	uint32 callbacks;
+	/** Number of sample frames mixed. */
+	uint64 frames;
+	/** Callbacks which took longer than the audio they produced lasts. */
+	uint32 underruns;
+	/**
+	 * Callbacks which started more than two buffer periods after the
+	 * previous one, so the audio device most likely ran dry in between.
+	 */
+	uint32 lateCallbacks;
+
+	/** The active channels when the statistics were queried. */
+	Common::Array<ChannelTiming> channels;
+
+	MixerTimingStats() { reset(); }
+
+	void reset();
+
+	/** Human readable summary, for the debugger console. */
+	Common::String toString() const;
+
+	/** Machine readable dump of all values, in JSON format. */
+	Common::String dump() const;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
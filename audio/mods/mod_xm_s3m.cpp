@@ -102,8 +102,10 @@ private:
 	int _initialDataLength;
 	bool _finished;
 
-	// mix buffer to keep a partially consumed decoded tick.
+	// mix buffer, reused for every tick. It also keeps a partially consumed decoded tick.
 	int *_mixBuffer;
+	int _mixBufferLength;	// allocated length of _mixBuffer
+	int _mixBufferPos;		// position of the first sample kept in _mixBuffer
 	int _mixBufferSamples;	// number of samples kept in _mixBuffer
 
 	static const int FP_SHIFT;
@@ -125,6 +127,8 @@ private:
 	// Sample
 	void downsample(int *buf, int count);
 	void resample(const Channel &channel, int *mixBuf, int offset, int count, int sampleRate);
+	template<bool interpolation>
+	static void resampleSpan(const int16 *sampleData, int *mixBuf, int count, int &samIdx, int &samFra, int step, int lGain, int rGain);
 	void updateSampleIdx(Channel &channel, int count, int sampleRate);
 
 	// Channel
@@ -181,7 +185,7 @@ const short ModXmS3mStream::sinetable[] = {
 ModXmS3mStream::ModXmS3mStream(Common::SeekableReadStream *stream, int initialPos, int rate, int interpolation) :
 	_rampBuf(nullptr), _playCount(nullptr), _channels(nullptr),
 	_mixBuffer(nullptr), _sampleRate(rate), _interpolation(interpolation),
-	_seqPos(initialPos), _mixBufferSamples(0), _finished(false) {
+	_seqPos(initialPos), _mixBufferLength(0), _mixBufferPos(0), _mixBufferSamples(0), _finished(false) {
 	if (!_module.load(*stream)) {
 		warning("It's not a valid Mod/S3m/Xm sound file");
 		_loadSuccess = false;
@@ -1168,62 +1172,69 @@ int ModXmS3mStream::seek(int samplePos) {
 	return currentPos;
 }
 
+template<bool interpolation>
+void ModXmS3mStream::resampleSpan(const int16 *sampleData, int *mixBuf, int count, int &samIdx, int &samFra, int step, int lGain, int rGain) {
+	int idx = samIdx, fra = samFra;
+	for (int i = 0; i < count; i++) {
+		int y = sampleData[idx];
+		if (interpolation) {
+			const int m = sampleData[idx + 1] - y;
+			y += (m * fra) >> FP_SHIFT;
+		}
+		*mixBuf++ += (y * lGain) >> FP_SHIFT;
+		*mixBuf++ += (y * rGain) >> FP_SHIFT;
+		fra += step;
+		idx += fra >> FP_SHIFT;
+		fra &= FP_MASK;
+	}
+	samIdx = idx;
+	samFra = fra;
+}
+
 void ModXmS3mStream::resample(const Channel &channel, int *mixBuf, int offset, int count, int sampleRate) {
 	Sample *sample = channel.sample;
-	int lGain = 0, rGain = 0, samIdx = 0, samFra = 0, step = 0;
-	int loopLen = 0, loopEnd = 0, outIdx = 0, outEnd = 0, y = 0, m = 0, c = 0;
-	int16 *sampleData = channel.sample->data;
-	if (channel.ampl > 0) {
-		lGain = channel.ampl * (255 - channel.pann) >> 8;
-		rGain = channel.ampl * channel.pann >> 8;
-		samIdx = channel.sampleIdx;
-		samFra = channel.sampleFra;
-		step = (channel.freq << (FP_SHIFT - 3)) / (sampleRate >> 3);
-		loopLen = sample->loopLength;
-		loopEnd = sample->loopStart + loopLen;
-		outIdx = offset * 2;
-		outEnd = (offset + count) * 2;
-		if (_interpolation) {
-			while (outIdx < outEnd) {
-				if (samIdx >= loopEnd) {
-					if (loopLen > 1) {
-						while (samIdx >= loopEnd) {
-							samIdx -= loopLen;
-						}
-					} else {
-						break;
-					}
-				}
-				c = sampleData[samIdx];
-				m = sampleData[samIdx + 1] - c;
-				y = ((m * samFra) >> FP_SHIFT) + c;
-				mixBuf[outIdx++] += (y * lGain) >> FP_SHIFT;
-				mixBuf[outIdx++] += (y * rGain) >> FP_SHIFT;
-				samFra += step;
-				samIdx += samFra >> FP_SHIFT;
-				samFra &= FP_MASK;
-			}
-		} else {
-			while (outIdx < outEnd) {
-				if (samIdx >= loopEnd) {
-					if (loopLen > 1) {
-						while (samIdx >= loopEnd) {
-							samIdx -= loopLen;
-						}
-					} else {
-						break;
-					}
+	if (channel.ampl <= 0)
+		return;
+
+	const int lGain = channel.ampl * (255 - channel.pann) >> 8;
+	const int rGain = channel.ampl * channel.pann >> 8;
+	int samIdx = channel.sampleIdx;
+	int samFra = channel.sampleFra;
+	const int step = (channel.freq << (FP_SHIFT - 3)) / (sampleRate >> 3);
+	const int loopLen = sample->loopLength;
+	const int loopEnd = sample->loopStart + loopLen;
+	const int16 *sampleData = sample->data;
+	int outIdx = offset * 2;
+	const int outEnd = (offset + count) * 2;
+
+	while (outIdx < outEnd) {
+		if (samIdx >= loopEnd) {
+			if (loopLen > 1) {
+				while (samIdx >= loopEnd) {
+					samIdx -= loopLen;
 				}
-				if (samIdx < 0)
-					samIdx = 0;
-				y = sampleData[samIdx];
-				mixBuf[outIdx++] += (y * lGain) >> FP_SHIFT;
-				mixBuf[outIdx++] += (y * rGain) >> FP_SHIFT;
-				samFra += step;
-				samIdx += samFra >> FP_SHIFT;
-				samFra &= FP_MASK;
+			} else {
+				break;
 			}
 		}
+		if (!_interpolation && samIdx < 0)
+			samIdx = 0;
+
+		// Mix everything up to the end of the sample loop in one go
+		int span = (outEnd - outIdx) / 2;
+		if (step > 0) {
+			const int64 left = ((int64)(loopEnd - samIdx) << FP_SHIFT) - samFra;
+			span = (int)MIN<int64>(span, (left + step - 1) / step);
+		} else if (step < 0) {
+			// Going backwards, check every sample
+			span = 1;
+		}
+
+		if (_interpolation)
+			resampleSpan<true>(sampleData, mixBuf + outIdx, span, samIdx, samFra, step, lGain, rGain);
+		else
+			resampleSpan<false>(sampleData, mixBuf + outIdx, span, samIdx, samFra, step, lGain, rGain);
+		outIdx += span * 2;
 	}
 }
 
@@ -1263,13 +1274,6 @@ void ModXmS3mStream::downsample(int *buf, int count) {
 
 /* Generates audio and returns the number of stereo samples written into mixBuf. */
 int ModXmS3mStream::getAudio(int *mixBuf) {
-	if (_mixBuffer) {
-		memcpy(mixBuf, _mixBuffer, _mixBufferSamples * sizeof(int));
-		delete []_mixBuffer;
-		_mixBuffer = nullptr;
-		return _mixBufferSamples;
-	}
-
 	int tickLen = calculateTickLength();
 	/* Clear output buffer. */
 	memset(mixBuf, 0, (tickLen + 65) * 4 * sizeof(int));
@@ -1288,29 +1292,28 @@ int ModXmS3mStream::getAudio(int *mixBuf) {
 int ModXmS3mStream::readBuffer(int16 *buffer, const int numSamples) {
 	int samplesRead = 0;
 	while (samplesRead < numSamples && _dataLeft > 0) {
-		int *mixBuf = new int[calculateMixBufLength()];
-		int samples = getAudio(mixBuf);
-		if (samplesRead + samples > numSamples) {
-			_mixBufferSamples = samplesRead + samples - numSamples;
-			samples -= _mixBufferSamples;
-			_mixBuffer = new int[_mixBufferSamples];
-			memcpy(_mixBuffer, mixBuf + samples, _mixBufferSamples * sizeof(int));
+		if (_mixBufferSamples == 0) {
+			// The tick length depends on the tempo
+			const int length = calculateMixBufLength();
+			if (length > _mixBufferLength) {
+				delete[] _mixBuffer;
+				_mixBuffer = new int[length];
+				_mixBufferLength = length;
+			}
+			_mixBufferSamples = getAudio(_mixBuffer);
+			_mixBufferPos = 0;
 		}
+
+		const int samples = MIN(numSamples - samplesRead, _mixBufferSamples);
+		const int *mixBuf = _mixBuffer + _mixBufferPos;
 		for (int idx = 0; idx < samples; ++idx) {
-			int ampl = mixBuf[idx];
-			if (ampl > 32767) {
-				ampl = 32767;
-			}
-			if (ampl < -32768) {
-				ampl = -32768;
-			}
-			*buffer++ = ampl;
+			*buffer++ = CLIP(mixBuf[idx], -32768, 32767);
 		}
+		_mixBufferPos += samples;
+		_mixBufferSamples -= samples;
 		samplesRead += samples;
 
 		_dataLeft -= samples * 2;
-
-		delete []mixBuf; // free
 	}
 
 	if (_dataLeft <= 0 && !_finished) {
@@ -380,7 +380,9 @@ bool ModuleModXmS3m::loadMod(Common::SeekableReadStream &st) {
 		if (!sample.length) {
 			sample.data = nullptr;
 		} else {
-			sample.data = new int16[sample.length + 1];
+			// The extra sample is read by the interpolation, it stays silent for
+			// unlooped samples
+			sample.data = new int16[sample.length + 1]();
 			readSampleSint8(st, sample.length, sample.data);
 			sample.data[sample.loopStart + sample.loopLength] = sample.data[sample.loopStart];
 		}
@@ -581,7 +583,7 @@ bool ModuleModXmS3m::loadXm(Common::SeekableReadStream &st) {
 			// load sample data
 			st.seek(offset, SEEK_SET);
 			offset += samDataBytes; // increment
-			sample.data = new int16[samDataSamples + 1];
+			sample.data = new int16[samDataSamples + 1]();
 			if (sixteenBit) {
 				readSampleSint16LE(st, samDataSamples, sample.data);
 			} else {
@@ -698,7 +700,7 @@ bool ModuleModXmS3m::loadS3m(Common::SeekableReadStream &st) {
 			st.read(instrum.name, 28);
 
 			// load sample data
-			sample.data = new int16[sampleLength + 1];
+			sample.data = new int16[sampleLength + 1]();
 			st.seek(sampleOffset, SEEK_SET);
 			if (sixteenBit) {
 				readSampleSint16LE(st, sampleLength, sample.data);
@@ -33,11 +33,9 @@
 #include <math.h>
 
 #include "common/scummsys.h"
-#include "common/translation.h"
 
 #include "audio/mixer.h"
 #include "audio/mods/paula.h"
-#include "audio/null.h"
 
 namespace Audio {
 
@@ -157,11 +155,16 @@ inline int32 filter(int32 input, Paula::FilterState &state, int voice) {
 	return CLIP<int32>(state.ledFilter ? ledOutput : normalOutput, -32768, 32767);
 }
 
-template<bool stereo>
-inline int mixBuffer(int16 *&buf, const int8 *data, Paula::Offset &offset, frac_t rate, int neededSamples, uint bufSize, byte volume, byte panning, Paula::FilterState &filterState, int voice) {
-	int samples;
-	for (samples = 0; samples < neededSamples && offset.int_off < bufSize; ++samples) {
-		const int32 tmp = filter(((int32) data[offset.int_off]) * volume, filterState, voice);
+template<bool stereo, bool filtered>
+inline void mixSpan(int16 *&buf, const int8 *data, Paula::Offset &offset, frac_t rate, int numSamples, byte volume, byte panning, Paula::FilterState &filterState, int voice) {
+	uint intOff = offset.int_off;
+	frac_t remOff = offset.rem_off;
+
+	for (int samples = 0; samples < numSamples; ++samples) {
+		int32 tmp = ((int32) data[intOff]) * volume;
+		if (filtered)
+			tmp = filter(tmp, filterState, voice);
+
 		if (stereo) {
 			*buf++ += (tmp * (255 - panning)) >> 7;
 			*buf++ += (tmp * (panning)) >> 7;
@@ -169,13 +172,35 @@ inline int mixBuffer(int16 *&buf, const int8 *data, Paula::Offset &offset, frac_
 			*buf++ += tmp;
 
 		// Step to next source sample
-		offset.rem_off += rate;
-		if (offset.rem_off >= (frac_t)FRAC_ONE) {
-			offset.int_off += fracToInt(offset.rem_off);
-			offset.rem_off &= FRAC_LO_MASK;
-		}
+		remOff += rate;
+		intOff += fracToInt(remOff);
+		remOff &= FRAC_LO_MASK;
+	}
+
+	offset.int_off = intOff;
+	offset.rem_off = remOff;
+}
+
+template<bool stereo>
+inline int mixBuffer(int16 *&buf, const int8 *data, Paula::Offset &offset, frac_t rate, int neededSamples, uint bufSize, byte volume, byte panning, Paula::FilterState &filterState, int voice) {
+	if (offset.int_off >= bufSize)
+		return 0;
+
+	// Compute how many samples are left until the end of the buffer is
+	// reached, so the mixing loop does not need to check for it
+	int samples = neededSamples;
+	if (rate > 0) {
+		const uint64 left = ((uint64)(bufSize - offset.int_off) << FRAC_BITS) - offset.rem_off;
+		const uint64 steps = (left + rate - 1) / rate;
+		if (steps < (uint64)neededSamples)
+			samples = (int)steps;
 	}
 
+	if (filterState.mode == Paula::kFilterModeNone)
+		mixSpan<stereo, false>(buf, data, offset, rate, samples, volume, panning, filterState, voice);
+	else
+		mixSpan<stereo, true>(buf, data, offset, rate, samples, volume, panning, filterState, voice);
+
 	return samples;
 }
 
@@ -302,33 +327,3 @@ float Paula::filterCalculateA0(int rate, int cutoff) {
 
 } // End of namespace Audio
 
-
-//	Plugin interface
-//	(This can only create a null driver since apple II gs support seeems not to be implemented
-//  and also is not part of the midi driver architecture. But we need the plugin for the options
-//  menu in the launcher and for MidiDriver::detectDevice() which is more or less used by all engines.)
-
-class AmigaMusicPlugin : public NullMusicPlugin {
-public:
-	const char *getName() const override {
-		return _s("Amiga Audio emulator");
-	}
-
-	const char *getId() const override {
-		return "amiga";
-	}
-
-	MusicDevices getDevices() const override;
-};
-
-MusicDevices AmigaMusicPlugin::getDevices() const {
-	MusicDevices devices;
-	devices.push_back(MusicDevice(this, "", MT_AMIGA));
-	return devices;
-}
-
-//#if PLUGIN_ENABLED_DYNAMIC(AMIGA)
-	//REGISTER_PLUGIN_DYNAMIC(AMIGA, PLUGIN_TYPE_MUSIC, AmigaMusicPlugin);
-//#else
-	REGISTER_PLUGIN_STATIC(AMIGA, PLUGIN_TYPE_MUSIC, AmigaMusicPlugin);
-//#endif
@@ -3,9 +3,11 @@ MODULE := audio
 MODULE_OBJS := \
 	adlib.o \
 	adlib_ms.o \
+	amiga_plugin.o \
 	audiostream.o \
 	casio.o \
 	cms.o \
+	decodedsoundcache.o \
 	fmopl.o \
 	mac_plugin.o \
 	mididrv.o \
@@ -18,6 +20,8 @@ MODULE_OBJS := \
 	miles_adlib.o \
 	miles_midi.o \
 	mixer.o \
+	mixer_render.o \
+	mixer_stats.o \
 	mpu401.o \
 	mt32gm.o \
 	musicplugin.o \
@@ -68,6 +72,7 @@ MODULE_OBJS := \
 	softsynth/fmtowns_pc98/towns_pc98_fmsynth.o \
 	softsynth/fmtowns_pc98/towns_pc98_plugins.o \
 	softsynth/appleiigs.o \
+	softsynth/emumidi.o \
 	softsynth/fluidsynth.o \
 	softsynth/mt32.o \
 	softsynth/eas.o \
@@ -77,6 +82,7 @@ MODULE_OBJS := \
 	soundfont/rawfile.o \
 	soundfont/rifffile.o \
 	soundfont/sf2file.o \
+	soundfont/sf2stream.o \
 	soundfont/synthfile.o \
 	soundfont/vgmcoll.o \
 	soundfont/vgminstrset.o \
@@ -81,7 +81,7 @@ public:
 	 * Convert the provided AudioStream to the target sample rate.
 	 * 
 	 * @param input			The AudioStream to read data from.
-	 * @param outBuffer		The buffer that the resampled audio will be written to. Must have size of at least @p numSamples.
+	 * @param outBuffer		The buffer that the resampled audio will be added to, as signed samples. Must have size of at least @p numSamples.
 	 * @param numSamples	The desired number of samples to be written into the buffer.
 	 * @param vol_l			Volume for left channel.
 	 * @param vol_r			Volume for right channel.
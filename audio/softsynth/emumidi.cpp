@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+bool MidiDriver_Emulated::isTimerCallbackThread() {
+	// Other threads may send events while the timer callback runs, but
+	// only the events of the callback itself have a known render position.
+	// The callback holds _timerMutex, so it is the only thread which can
+	// take it while _inTimerCallback is set. Don't wait for the mutex, the
+	// callback may be waiting for a lock held by the calling thread.
+	if (!_timerMutex.tryLock())
+		return false;
+
+	const bool result = _inTimerCallback;
+	_timerMutex.unlock();
+	return result;
+}
+
+void MidiDriver_Emulated::setEventDelay(uint32 delay) {
+	if (!_sampleAccurate || !isTimerCallbackThread())
+		return;
+
+	_eventDelay = (uint32)((uint64)delay * getRate() / 1000000);
+}
+
+uint32 MidiDriver_Emulated::getEventDelay() {
+	if (!_sampleAccurate || !isTimerCallbackThread())
+		return 0;
+
+	return _eventDelay;
+}
+
+bool MidiDriver_Emulated::queueEvent(uint32 b) {
+	const uint32 delay = getEventDelay();
+	if (!delay)
+		return false;
+
+	QueuedEvent event;
+	event.time = _samplePosition + delay;
+	event.b = b;
+	insertEvent(event);
+	return true;
+}
+
+void MidiDriver_Emulated::insertEvent(const QueuedEvent &event) {
+	// Keep the queue sorted by time. Events with the same time stay in the
+	// order they were sent in.
+	uint i = _eventQueue.size();
+	while (i > 0 && (int32)(_eventQueue[i - 1].time - event.time) > 0)
+		--i;
+	_eventQueue.insert_at(i, event);
+}
+
+void MidiDriver_Emulated::playQueuedEvents() {
+	uint count = 0;
+	while (count < _eventQueue.size() && (int32)(_eventQueue[count].time - _samplePosition) <= 0)
+		send(_eventQueue[count++].b);
+
+	if (count)
+		_eventQueue.erase(_eventQueue.begin(), _eventQueue.begin() + count);
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		// Split the block at the next queued event
+		if (!_eventQueue.empty() && step > (int)(_eventQueue[0].time - _samplePosition))
+			step = _eventQueue[0].time - _samplePosition;
+
+		generateSamples(data, step);
+		_samplePosition += step;
+
+		if (!_eventQueue.empty())
+			playQueuedEvents();
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			_timerMutex.lock();
+			_inTimerCallback = true;
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+
+			onTimer();
+			_inTimerCallback = false;
+			_eventDelay = 0;
+			_timerMutex.unlock();
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+
+	return numSamples;
+}
@@ -25,6 +25,8 @@
 #include "audio/audiostream.h"
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
+#include "common/array.h"
+#include "common/mutex.h"
 
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
@@ -43,12 +45,54 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	// Sample accurate event scheduling. The event delay and the queue are
+	// only used from the mixer thread, inside of readBuffer.
+	struct QueuedEvent {
+		uint32 time; // Sample frame to play the event at
+		uint32 b;
+	};
+
+	// Held by the mixer thread while it runs the timer callback
+	Common::Mutex _timerMutex;
+	bool _inTimerCallback;
+	uint32 _eventDelay;     // In sample frames
+	uint32 _samplePosition; // In sample frames
+	Common::Array<QueuedEvent> _eventQueue;
+
+	bool isTimerCallbackThread();
+	void insertEvent(const QueuedEvent &event);
+	void playQueuedEvents();
+
 protected:
 	int _baseFreq;
 
+	/**
+	 * If set before calling open(), MIDI events sent with a delay during
+	 * the timer callback are played at the exact sample frame given by the
+	 * delay. Events sent from other threads are played immediately.
+	 *
+	 * The subclass has to pass its events through queueEvent(), or
+	 * schedule them itself using getEventDelay().
+	 */
+	bool _sampleAccurate;
+
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Delay of the event currently being sent, in sample frames after the
+	 * current render position. This is only non-zero in sample accurate
+	 * mode, for events sent from the timer callback.
+	 */
+	uint32 getEventDelay();
+
+	/**
+	 * Queue a MIDI event to be sent again at its exact sample position.
+	 * To be called at the start of send(); if this returns true, the
+	 * event has been queued and send() must return without playing it.
+	 */
+	bool queueEvent(uint32 b);
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -57,7 +101,11 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
-		_baseFreq(250) {
+		_inTimerCallback(false),
+		_eventDelay(0),
+		_samplePosition(0),
+		_baseFreq(250),
+		_sampleAccurate(false) {
 	}
 
 	// MidiDriver API
@@ -86,35 +134,10 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
+	void setEventDelay(uint32 delay) override;
 
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
@@ -246,6 +246,10 @@ static void *SoundFontMemLoader_open(const char *filename) {
 		return nullptr;
 	}
 	sscanf(filename, "&%p", &p);
+
+	// With dynamic sample loading, the SoundFont is opened again for every
+	// preset whose samples are loaded
+	((Common::SeekableReadStream *) p)->seek(0, SEEK_SET);
 	return p;
 }
 
@@ -266,7 +270,7 @@ static int SoundFontMemLoader_seek(void *handle, long offset, int origin) {
 }
 
 static int SoundFontMemLoader_close(void *handle) {
-	delete (Common::SeekableReadStream *) handle;
+	// The stream is owned by the driver
 	return FLUID_OK;
 }
 
@@ -363,6 +367,15 @@ int MidiDriver_FluidSynth::open() {
 	setNum("synth.gain", gain);
 	setNum("synth.sample-rate", _outputRate);
 
+	// Only load the samples of the presets selected on a channel, instead
+	// of all samples of the SoundFont. FluidSynth loads them on the program
+	// change, and frees them once no channel uses the preset anymore.
+#if FS_API_VERSION >= 0x0200 && !defined(USE_FLUIDLITE)
+	const bool dynamicSampleLoading = ConfMan.getBool("fluidsynth_misc_dynamic_sample_loading");
+	if (dynamicSampleLoading)
+		setInt("synth.dynamic-sample-loading", 1);
+#endif
+
 	_synth = new_fluid_synth(_settings);
 
 	if (ConfMan.getBool("fluidsynth_chorus_activate")) {
@@ -481,12 +494,22 @@ int MidiDriver_FluidSynth::open() {
 
 	_soundFont = fluid_synth_sfload(_synth, soundfont.c_str(), 1);
 
+#if defined(FS_HAS_STREAM_SUPPORT) && !defined(USE_FLUIDLITE)
+	// The in-memory SoundFont is only read again by dynamic sample loading
+	if (isUsingInMemorySoundFontData && (_soundFont == -1 || !dynamicSampleLoading)) {
+		delete _engineSoundFontData;
+		_engineSoundFontData = nullptr;
+	}
+#endif
+
 	if (_soundFont == -1) {
 		GUI::MessageDialog dialog(Common::U32String::format(_("FluidSynth: Failed loading custom SoundFont '%s'. Music is off."), soundfont.c_str()));
 		dialog.runModal();
 		return MERR_DEVICE_NOT_AVAILABLE;
 	}
 
+	_sampleAccurate = ConfMan.getBool("midi_sample_accurate");
+
 	MidiDriver_Emulated::open();
 
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
@@ -506,12 +529,20 @@ void MidiDriver_FluidSynth::close() {
 
 	delete_fluid_synth(_synth);
 	delete_fluid_settings(_settings);
+
+#if defined(FS_HAS_STREAM_SUPPORT) && !defined(USE_FLUIDLITE)
+	delete _engineSoundFontData;
+	_engineSoundFontData = nullptr;
+#endif
 }
 
 void MidiDriver_FluidSynth::send(uint32 b) {
 	if (!_isOpen)
 		return;
 
+	if (queueEvent(b))
+		return;
+
 	midiDriverCommonSend(b);
 
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
@@ -34,6 +34,7 @@
 #include "common/events.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/timer.h"
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
@@ -118,6 +119,32 @@ private:
 
 	int _outputRate;
 
+	// Render-ahead mode, enabled by the "mt32_render_ahead" setting. The
+	// synth is run from a timer callback which keeps a ring of rendered
+	// frames filled, and the mixer callback only copies from the ring.
+	// MIDI events are queued in MUNT with a timestamp delayed by the ring
+	// size, so they keep their position relative to the mixer output.
+	// All fields below are protected by _mutex.
+	enum {
+		kRenderAheadChunk = 256 // Frames rendered per mutex lock
+	};
+
+	bool _renderAhead;
+	int16 *_ring;
+	uint32 _ringSize;       // Size of the ring in stereo frames
+	uint32 _framesPerTick;  // Most frames rendered by one timer callback
+	uint32 _framesRendered; // Frames produced by the synth so far
+	uint32 _framesPlayed;   // Frames handed to the mixer so far
+
+	static MidiDriver_MT32 *_renderAheadDriver;
+
+	static void renderAheadTimerProc(void *refCon);
+	void startRenderAhead(int latency);
+	void stopRenderAhead();
+	void renderAhead();
+	uint32 getEventTimestamp();
+	void writeSysex(byte device, const byte *data, uint32 len);
+
 protected:
 	void generateSamples(int16 *buf, int len) override;
 
@@ -155,8 +182,16 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 	_outputRate = 0;
 	_controlData = nullptr;
 	_pcmData = nullptr;
+	_renderAhead = false;
+	_ring = nullptr;
+	_ringSize = 0;
+	_framesPerTick = 0;
+	_framesRendered = 0;
+	_framesPlayed = 0;
 }
 
+MidiDriver_MT32 *MidiDriver_MT32::_renderAheadDriver = nullptr;
+
 MidiDriver_MT32::~MidiDriver_MT32() {
 	close();
 }
@@ -218,6 +253,13 @@ int MidiDriver_MT32::open() {
 	// AudioStream.
 	_outputRate = _service.getActualStereoOutputSamplerate();
 
+	int renderAheadLatency = ConfMan.getInt("mt32_render_ahead");
+	if (renderAheadLatency > 0)
+		startRenderAhead(renderAheadLatency);
+
+	// MUNT schedules the delayed events itself, see getEventTimestamp()
+	_sampleAccurate = ConfMan.getBool("midi_sample_accurate");
+
 	MidiDriver_Emulated::open();
 
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
@@ -229,7 +271,10 @@ void MidiDriver_MT32::send(uint32 b) {
 	midiDriverCommonSend(b);
 
 	Common::StackLock lock(_mutex);
-	_service.playMsg(b);
+	if (_renderAhead || getEventDelay())
+		_service.playMsgAt(b, getEventTimestamp());
+	else
+		_service.playMsg(b);
 }
 
 // Indiana Jones and the Fate of Atlantis (including the demo) uses
@@ -240,14 +285,17 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 	}
 	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
 	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	writeSysex(channel, benderRangeSysex, 4);
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 	midiDriverCommonSysEx(msg, length);
 	if (msg[0] == 0xf0) {
 		Common::StackLock lock(_mutex);
-		_service.playSysex(msg, length);
+		if (_renderAhead || getEventDelay())
+			_service.playSysexAt(msg, length, getEventTimestamp());
+		else
+			_service.playSysex(msg, length);
 	} else {
 		enum {
 			SYSEX_CMD_DT1 = 0x12,
@@ -256,7 +304,7 @@ void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 
 		if (msg[3] == SYSEX_CMD_DT1 || msg[3] == SYSEX_CMD_DAT) {
 			Common::StackLock lock(_mutex);
-			_service.writeSysex(msg[1], msg + 4, length - 5);
+			writeSysex(msg[1], msg + 4, length - 5);
 		} else {
 			warning("Unused sysEx command %d", msg[3]);
 		}
@@ -273,6 +321,8 @@ void MidiDriver_MT32::close() {
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
 
+	stopRenderAhead();
+
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
 	_service.freeContext();
@@ -284,9 +334,143 @@ void MidiDriver_MT32::close() {
 
 void MidiDriver_MT32::generateSamples(int16 *data, int len) {
 	Common::StackLock lock(_mutex);
+
+	if (_renderAhead) {
+		// Take as much as possible from the ring. Anything missing is
+		// rendered right here: either the render-ahead timer fell behind,
+		// or it is suspended because the synth is idle, in which case
+		// MUNT merely produces silence.
+		while (len > 0 && _framesRendered != _framesPlayed) {
+			const uint32 pos = _framesPlayed % _ringSize;
+			const uint32 count = MIN<uint32>(MIN<uint32>(len, _framesRendered - _framesPlayed), _ringSize - pos);
+
+			memcpy(data, _ring + pos * 2, count * 2 * sizeof(int16));
+			data += count * 2;
+			len -= count;
+			_framesPlayed += count;
+		}
+
+		if (len <= 0)
+			return;
+
+		_framesRendered += len;
+		_framesPlayed += len;
+	}
+
 	_service.renderBit16s(data, len);
 }
 
+void MidiDriver_MT32::startRenderAhead(int latency) {
+	if (_renderAheadDriver) {
+		warning("MT-32 render-ahead is already used by another driver instance");
+		return;
+	}
+
+	latency = CLIP(latency, 1, 1000);
+	_ringSize = MAX<uint32>((uint32)_outputRate * latency / 1000, kRenderAheadChunk);
+	_ring = new int16[_ringSize * 2];
+	_framesRendered = 0;
+	_framesPlayed = 0;
+	_renderAhead = true;
+	_renderAheadDriver = this;
+
+	debug(4, "MT-32 render-ahead enabled with %d ms latency", latency);
+
+	// Wake up several times per latency period, so that the ring never
+	// drains completely, but no more often than every millisecond.
+	const int interval = CLIP(latency / 4, 1, 10) * 1000;
+	// The timer manager runs the other timer callbacks after this one, so
+	// each call only renders two periods' worth. That still refills the
+	// ring after it drained, without stalling them for a full ring.
+	_framesPerTick = MAX<uint32>((uint32)((uint64)_outputRate * interval * 2 / 1000000), kRenderAheadChunk);
+	g_system->getTimerManager()->installTimerProc(renderAheadTimerProc, interval, this, "MT32renderAhead");
+}
+
+void MidiDriver_MT32::stopRenderAhead() {
+	if (!_renderAhead)
+		return;
+
+	// This waits for a running timer callback to finish
+	g_system->getTimerManager()->removeTimerProc(renderAheadTimerProc);
+	_renderAheadDriver = nullptr;
+
+	Common::StackLock lock(_mutex);
+	_renderAhead = false;
+	delete[] _ring;
+	_ring = nullptr;
+	_ringSize = 0;
+}
+
+void MidiDriver_MT32::renderAheadTimerProc(void *refCon) {
+	static_cast<MidiDriver_MT32 *>(refCon)->renderAhead();
+}
+
+void MidiDriver_MT32::renderAhead() {
+	// Render in small chunks and release the mutex in between, so that
+	// the mixer callback never waits for more than one chunk.
+	for (uint32 rendered = 0; rendered < _framesPerTick; ) {
+		Common::StackLock lock(_mutex);
+
+		const uint32 filled = _framesRendered - _framesPlayed;
+		if (filled == _ringSize)
+			break;
+
+		// Suspend while the synth is idle. Once the ring has drained, the
+		// mixer callback produces the silence itself; MUNT keeps reporting
+		// the synth as active while there are queued MIDI events, which
+		// wakes us up again.
+		if (filled == 0 && !_service.isActive())
+			break;
+
+		const uint32 pos = _framesRendered % _ringSize;
+		const uint32 count = MIN<uint32>(MIN<uint32>(_ringSize - filled, _ringSize - pos), kRenderAheadChunk);
+
+		_service.renderBit16s(_ring + pos * 2, count);
+		_framesRendered += count;
+		rendered += count;
+	}
+}
+
+uint32 MidiDriver_MT32::getEventTimestamp() {
+	// Deliver every event a full ring size after the current mixer
+	// position. The synth is never further ahead than that, so the event
+	// is neither late nor does its timing depend on the fill level.
+	// In sample accurate mode, the delay of the event within the current
+	// timer period is added on top.
+	uint32 delay = getEventDelay();
+	if (_renderAhead)
+		delay += _ringSize - (_framesRendered - _framesPlayed);
+	return _service.getInternalRenderedSampleCount() + (uint32)((uint64)delay * MT32Emu::SAMPLE_RATE / _outputRate);
+}
+
+void MidiDriver_MT32::writeSysex(byte device, const byte *data, uint32 len) {
+	if (!_renderAhead && !getEventDelay()) {
+		_service.writeSysex(device, data, len);
+		return;
+	}
+
+	// MUNT applies direct writes immediately, i.e. at the render position,
+	// which is ahead of the mixer or before the event's delay. Send them as a DT1 message through the
+	// event queue instead, so they stay in order with the other events.
+	Common::Array<byte> sysex;
+	sysex.resize(len + 7);
+	sysex[0] = 0xF0;
+	sysex[1] = 0x41; // Roland
+	sysex[2] = device;
+	sysex[3] = 0x16; // MT-32
+	sysex[4] = 0x12; // DT1
+
+	byte checksum = 0;
+	for (uint32 i = 0; i < len; i++) {
+		sysex[5 + i] = data[i];
+		checksum += data[i];
+	}
+	sysex[len + 5] = (128 - (checksum & 0x7F)) & 0x7F;
+	sysex[len + 6] = 0xF7;
+
+	_service.playSysexAt(sysex.data(), sysex.size(), getEventTimestamp());
+}
+
 uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	switch (prop) {
 	case PROP_CHANNEL_MASK:
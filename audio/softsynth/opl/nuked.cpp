@@ -379,6 +379,17 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     Bit8u reset = 0;
     slot->eg_out = slot->eg_rout + (slot->reg_tl << 2)
                  + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + *slot->trem;
+    // Shortcut for released operators whose envelope is off, which is the
+    // state of every unused operator. This gives the same result as the
+    // full calculation below, where the envelope stays off and no rate
+    // applies.
+    if (slot->eg_gen == envelope_gen_num_release && !slot->key
+        && (slot->eg_rout & 0x1f8) == 0x1f8)
+    {
+        slot->pg_reset = 0;
+        slot->eg_rout = 0x1ff;
+        return;
+    }
     if (slot->key && slot->eg_gen == envelope_gen_num_release)
     {
         reset = 1;
@@ -671,9 +682,34 @@ static void OPL3_SlotWriteE0(opl3_slot *slot, Bit8u data)
     }
 }
 
+//
+// Sign of the waveforms, indexed by waveform and bits 8-9 of the phase
+//
+
+static const Bit16s envelope_sign[8][4] = {
+    { 0, 0, -1, -1 },
+    { 0, 0, 0, 0 },
+    { 0, 0, 0, 0 },
+    { 0, 0, 0, 0 },
+    { 0, -1, 0, 0 },
+    { 0, 0, 0, 0 },
+    { 0, 0, -1, -1 },
+    { 0, 0, -1, -1 }
+};
+
 static void OPL3_SlotGenerate(opl3_slot *slot)
 {
-    slot->out = envelope_sin[slot->reg_wf](slot->pg_phase_out + *slot->mod, slot->eg_out);
+    Bit16u phase = slot->pg_phase_out + *slot->mod;
+    // An attenuation of 0x180 or more shifts every exprom entry down to 0,
+    // whatever the waveform, so only the sign is left. Most operators are
+    // in this state most of the time (silent or released), so this skips
+    // the table lookups for them. The result is the same as below.
+    if (slot->eg_out >= 0x180)
+    {
+        slot->out = envelope_sign[slot->reg_wf][(phase >> 8) & 0x03];
+        return;
+    }
+    slot->out = envelope_sin[slot->reg_wf](phase, slot->eg_out);
 }
 
 static void OPL3_SlotCalcFB(opl3_slot *slot)
@@ -78,6 +78,8 @@ public:
 	}
 
 	virtual ~ListTypeChunk() {
+		for (Common::List<Chunk *>::iterator iter = _childChunks.begin(); iter != _childChunks.end(); iter++)
+			delete *iter;
 		_childChunks.erase(_childChunks.begin(), _childChunks.end());
 	}
 
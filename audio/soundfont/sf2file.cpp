@@ -60,43 +60,80 @@ SF2InfoListChunk::SF2InfoListChunk(Common::String name) : LISTChunk("INFO") {
 //  SF2File
 //  *******
 
-SF2File::SF2File(SynthFile *synthfile) : RiffFile(synthfile->_name, "sfbk") {
-	//***********
-	// INFO chunk
-	//***********
-	AddChildChunk(new SF2InfoListChunk(_name));
-
-	// sdta chunk and its child smpl chunk containing all samples
-	LISTChunk *sdtaCk = new LISTChunk("sdta");
-	Chunk *smplCk = new Chunk("smpl");
-
+SF2SampleChunk::SF2SampleChunk(SynthFile *synthfile, bool lazy) : Chunk("smpl") {
 	// Concatanate all of the samples together and add the result to the smpl chunk data
 	size_t numWaves = synthfile->_vWaves.size();
-	smplCk->_size = 0;
+	_size = 0;
 	for (size_t i = 0; i < numWaves; i++) {
 		SynthWave *wave = synthfile->_vWaves[i];
 		wave->ConvertTo16bitSigned();
-		smplCk->_size +=
-				wave->_dataSize + (46 * 2);  // plus the 46 padding samples required by sf2 spec
+		_offsets.push_back(_size);
+		_sizes.push_back(wave->_dataSize);
+		_size += wave->_dataSize + (46 * 2);  // plus the 46 padding samples required by sf2 spec
 	}
-	smplCk->_data = new uint8[smplCk->_size];
-	uint32 bufPtr = 0;
+
+	if (lazy) {
+		// The waves are taken over from the synthfile in SF2File
+		_waves = synthfile->_vWaves;
+		return;
+	}
+
+	_data = new uint8[_size];
 	for (size_t i = 0; i < numWaves; i++) {
-		SynthWave *wave = synthfile->_vWaves[i];
+		synthfile->_vWaves[i]->ReadData(_data + _offsets[i]);
+		memset(_data + _offsets[i] + _sizes[i], 0, 46 * 2);
+	}
+}
+
+SF2SampleChunk::~SF2SampleChunk() {
+	for (size_t i = 0; i < _waves.size(); i++)
+		delete _waves[i];
+}
+
+void SF2SampleChunk::Write(uint8 *buffer) {
+	if (_data) {
+		Chunk::Write(buffer);
+		return;
+	}
 
-		memcpy(smplCk->_data + bufPtr, wave->_data, wave->_dataSize);
-		memset(smplCk->_data + bufPtr + wave->_dataSize, 0, 46 * 2);
-		bufPtr += wave->_dataSize + (46 * 2);  // plus the 46 padding samples required by sf2 spec
+	memcpy(buffer, _id, 4);
+	*(uint32 *)(buffer + 4) = _size;
+	for (uint32 i = 0; i < _waves.size(); i++) {
+		ReadWave(i, buffer + 8 + _offsets[i]);
+		memset(buffer + 8 + _offsets[i] + _sizes[i], 0, 46 * 2);
 	}
+}
 
-	sdtaCk->AddChildChunk(smplCk);
-	this->AddChildChunk(sdtaCk);
+void SF2SampleChunk::ReadWave(uint32 index, uint8 *buffer) const {
+	if (_data)
+		memcpy(buffer, _data + _offsets[index], _sizes[index]);
+	else
+		_waves[index]->ReadData(buffer);
+}
+
+//  *******
+//  SF2File
+//  *******
+
+SF2File::SF2File(SynthFile *synthfile, bool lazySamples) : RiffFile(synthfile->_name, "sfbk") {
+	//***********
+	// INFO chunk
+	//***********
+	_infoCk = AddChildChunk(new SF2InfoListChunk(_name));
+
+	// sdta chunk and its child smpl chunk containing all samples
+	_sdtaCk = new LISTChunk("sdta");
+	_smplCk = new SF2SampleChunk(synthfile, lazySamples);
+
+	_sdtaCk->AddChildChunk(_smplCk);
+	this->AddChildChunk(_sdtaCk);
 
 	//***********
 	// pdta chunk
 	//***********
 
 	LISTChunk *pdtaCk = new LISTChunk("pdta");
+	_pdtaCk = pdtaCk;
 
 	//***********
 	// phdr chunk
@@ -455,10 +492,45 @@ SF2File::SF2File(SynthFile *synthfile) : RiffFile(synthfile->_name, "sfbk") {
 	pdtaCk->AddChildChunk(shdrCk);
 
 	this->AddChildChunk(pdtaCk);
+
+	// The sample chunk decodes the waves on demand from now on
+	if (lazySamples)
+		synthfile->_vWaves.clear();
 }
 
 SF2File::~SF2File() {}
 
+uint32 SF2File::GetHeaderSize() {
+	// RIFF header, INFO chunk, sdta header and smpl header
+	return 12 + _infoCk->GetSize() + 12 + 8;
+}
+
+uint32 SF2File::GetTrailerSize() {
+	return _pdtaCk->GetSize();
+}
+
+void SF2File::WriteHeader(uint8 *buffer) {
+	memcpy(buffer, _id, 4);
+	*(uint32 *)(buffer + 4) = GetSize() - 8;
+	memcpy(buffer + 8, _type, 4);
+	buffer += 12;
+
+	_infoCk->Write(buffer);
+	buffer += _infoCk->GetSize();
+
+	memcpy(buffer, _sdtaCk->_id, 4);
+	*(uint32 *)(buffer + 4) = _sdtaCk->GetSize() - 8;
+	memcpy(buffer + 8, _sdtaCk->_type, 4);
+	buffer += 12;
+
+	memcpy(buffer, _smplCk->_id, 4);
+	*(uint32 *)(buffer + 4) = _smplCk->GetSize() - 8;
+}
+
+void SF2File::WriteTrailer(uint8 *buffer) {
+	_pdtaCk->Write(buffer);
+}
+
 const void *SF2File::SaveToMem() {
 	uint8 *buf = new uint8[this->GetSize()];
 	this->Write(buf);
@@ -381,17 +381,63 @@ public:
 	SF2sdtaChunk();
 };
 
+class SynthFile;
+class SynthWave;
+
+// The smpl chunk. Its data is either stored as a whole, or decoded wave by
+// wave from the waves' source samples when it is written or read.
+class SF2SampleChunk : public Chunk {
+public:
+	SF2SampleChunk(SynthFile *synthfile, bool lazy);
+	~SF2SampleChunk() override;
+
+	void Write(uint8 *buffer) override;
+
+	bool IsLazy() const { return _data == nullptr; }
+
+	uint32 GetNumWaves() const { return _offsets.size(); }
+	uint32 GetWaveOffset(uint32 index) const { return _offsets[index]; }
+	uint32 GetWaveSize(uint32 index) const { return _sizes[index]; }
+
+	// Writes GetWaveSize() bytes, without the padding after the wave
+	void ReadWave(uint32 index, uint8 *buffer) const;
+
+private:
+	// Byte offsets and sizes of the waves within the chunk data
+	Common::Array<uint32> _offsets;
+	Common::Array<uint32> _sizes;
+	Common::Array<SynthWave *> _waves;
+};
+
 inline void WriteLIST(Common::Array<uint8> &buf, Common::String listName, uint32 listSize);
 inline void AlignName(Common::String &name);
 
-class SynthFile;
-
 class SF2File : public RiffFile {
 public:
-	SF2File(SynthFile *synthfile);
+	// If lazySamples is set, the sample data is not copied into the file,
+	// but decoded from the source samples of the synthfile's waves when it
+	// is needed. The waves are taken over from the synthfile in that case.
+	SF2File(SynthFile *synthfile, bool lazySamples = false);
 	~SF2File(void);
 
 	const void *SaveToMem();
+
+	SF2SampleChunk *GetSampleChunk() { return _smplCk; }
+
+	// Size of the file up to the start of the sample data, and the size of
+	// the part after it
+	uint32 GetHeaderSize();
+	uint32 GetTrailerSize();
+
+	// Write the file without the sample data
+	void WriteHeader(uint8 *buffer);
+	void WriteTrailer(uint8 *buffer);
+
+private:
+	Chunk *_infoCk;
+	LISTChunk *_sdtaCk;
+	SF2SampleChunk *_smplCk;
+	LISTChunk *_pdtaCk;
 };
 
 #endif // AUDIO_SOUNDFONT_SF2FILE_H
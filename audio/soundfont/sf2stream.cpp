@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/debug.h"
+#include "audio/soundfont/common.h"
+#include "audio/soundfont/rawfile.h"
+#include "audio/soundfont/sf2file.h"
+#include "audio/soundfont/sf2stream.h"
+#include "audio/soundfont/vgminstrset.h"
+
+SF2SampleStream::SF2SampleStream(SF2File *file, uint32 cacheSize) :
+		_file(file), _instrSet(nullptr), _rawFile(nullptr), _pos(0), _eos(false),
+		_cacheSize(cacheSize), _useCounter(0) {
+	memset(&_stats, 0, sizeof(_stats));
+
+	SF2SampleChunk *smplCk = _file->GetSampleChunk();
+	_sampleSize = smplCk->GetSize() - 8;
+	_stats.sampleBytes = _sampleSize;
+
+	_header.resize(_file->GetHeaderSize());
+	_file->WriteHeader(_header.data());
+	_trailer.resize(_file->GetTrailerSize());
+	_file->WriteTrailer(_trailer.data());
+	_size = _header.size() + _sampleSize + _trailer.size();
+	assert(_size == _file->GetSize());
+
+	CachedWave empty = { nullptr, 0 };
+	_cache.resize(smplCk->GetNumWaves(), empty);
+}
+
+SF2SampleStream::~SF2SampleStream() {
+	debug(2, "SF2SampleStream: %u bytes of samples, %u decoded in %u waves, peak %u resident, %u cache hits, %u evictions",
+		  _stats.sampleBytes, _stats.decodedBytes, _stats.decodes, _stats.peakResidentBytes, _stats.hits, _stats.evictions);
+
+	for (uint32 i = 0; i < _cache.size(); i++)
+		delete[] _cache[i].data;
+
+	// The waves of the file refer to the samples of the instrument set
+	delete _file;
+	delete _instrSet;
+	delete _rawFile;
+}
+
+void SF2SampleStream::setSourceFiles(VGMInstrSet *instrSet, RawFile *rawFile) {
+	_instrSet = instrSet;
+	_rawFile = rawFile;
+}
+
+uint32 SF2SampleStream::read(void *dataPtr, uint32 dataSize) {
+	uint8 *buffer = (uint8 *)dataPtr;
+	const uint32 headerSize = _header.size();
+	uint32 total = 0;
+
+	while (dataSize > 0 && _pos < _size) {
+		uint32 count;
+		if (_pos < headerSize) {
+			count = MIN(dataSize, headerSize - _pos);
+			memcpy(buffer, _header.data() + _pos, count);
+		} else if (_pos < headerSize + _sampleSize) {
+			count = readSamples(buffer, _pos - headerSize, MIN(dataSize, headerSize + _sampleSize - _pos));
+		} else {
+			const uint32 offset = _pos - headerSize - _sampleSize;
+			count = MIN(dataSize, _trailer.size() - offset);
+			memcpy(buffer, _trailer.data() + offset, count);
+		}
+
+		buffer += count;
+		dataSize -= count;
+		total += count;
+		_pos += count;
+	}
+
+	if (dataSize > 0)
+		_eos = true;
+	return total;
+}
+
+bool SF2SampleStream::seek(int64 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset += _size;
+		break;
+	case SEEK_CUR:
+		offset += _pos;
+		break;
+	default:
+		break;
+	}
+
+	if (offset < 0 || offset > _size)
+		return false;
+
+	_pos = offset;
+	_eos = false;
+	return true;
+}
+
+uint32 SF2SampleStream::readSamples(uint8 *buffer, uint32 offset, uint32 length) {
+	SF2SampleChunk *smplCk = _file->GetSampleChunk();
+	const uint32 numWaves = smplCk->GetNumWaves();
+
+	// Find the last wave starting at or before the offset
+	uint32 lo = 0, hi = numWaves;
+	while (hi - lo > 1) {
+		const uint32 mid = (lo + hi) / 2;
+		if (smplCk->GetWaveOffset(mid) <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	const uint32 waveOffset = numWaves ? smplCk->GetWaveOffset(lo) : 0;
+	const uint32 waveSize = numWaves ? smplCk->GetWaveSize(lo) : 0;
+	if (offset >= waveOffset + waveSize) {
+		// The padding after the wave
+		const uint32 next = (lo + 1 < numWaves) ? smplCk->GetWaveOffset(lo + 1) : _sampleSize;
+		const uint32 count = MIN(length, next - offset);
+		memset(buffer, 0, count);
+		return count;
+	}
+
+	const uint32 start = offset - waveOffset;
+	const uint32 count = MIN(length, waveSize - start);
+	if (start == 0 && count == waveSize && !_cache[lo].data) {
+		smplCk->ReadWave(lo, buffer);
+		_stats.decodes++;
+		_stats.decodedBytes += waveSize;
+		return count;
+	}
+
+	memcpy(buffer, getWave(lo) + start, count);
+	return count;
+}
+
+const uint8 *SF2SampleStream::getWave(uint32 index) {
+	CachedWave &wave = _cache[index];
+	wave.lastUse = ++_useCounter;
+	if (wave.data) {
+		_stats.hits++;
+		return wave.data;
+	}
+
+	SF2SampleChunk *smplCk = _file->GetSampleChunk();
+	const uint32 size = smplCk->GetWaveSize(index);
+	evict(size);
+
+	wave.data = new uint8[size];
+	smplCk->ReadWave(index, wave.data);
+	_stats.decodes++;
+	_stats.decodedBytes += size;
+	_stats.residentBytes += size;
+	_stats.peakResidentBytes = MAX(_stats.peakResidentBytes, _stats.residentBytes);
+	return wave.data;
+}
+
+void SF2SampleStream::evict(uint32 required) {
+	SF2SampleChunk *smplCk = _file->GetSampleChunk();
+
+	while (_stats.residentBytes > 0 && _stats.residentBytes + required > _cacheSize) {
+		uint32 oldest = 0;
+		uint32 oldestUse = 0xFFFFFFFF;
+		for (uint32 i = 0; i < _cache.size(); i++) {
+			if (_cache[i].data && _cache[i].lastUse < oldestUse) {
+				oldest = i;
+				oldestUse = _cache[i].lastUse;
+			}
+		}
+
+		delete[] _cache[oldest].data;
+		_cache[oldest].data = nullptr;
+		_stats.residentBytes -= smplCk->GetWaveSize(oldest);
+		_stats.evictions++;
+	}
+}
@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_SOUNDFONT_SF2STREAM_H
+#define AUDIO_SOUNDFONT_SF2STREAM_H
+
+#include "common/array.h"
+#include "common/stream.h"
+#include "common/types.h"
+
+class SF2File;
+class RawFile;
+class VGMInstrSet;
+
+/**
+ * Read stream of a SoundFont created with lazy samples, see
+ * VGMColl::CreateSF2File.
+ *
+ * Only the file header and the preset data are kept in memory. The sample
+ * data is decoded wave by wave when it is read. Reads of whole waves, as
+ * done by SoundFont loaders, are decoded straight into the caller's buffer.
+ * Waves read in parts are kept in a cache of bounded size, from which the
+ * least recently used waves are evicted. A wave bigger than the cache is
+ * kept on its own.
+ *
+ * This makes it possible to hand a large instrument set to a synth without
+ * also keeping the complete SoundFont in memory, and together with
+ * FluidSynth's dynamic sample loading, only the samples of the presets in
+ * use are ever decoded.
+ */
+class SF2SampleStream : public Common::SeekableReadStream {
+public:
+	struct Stats {
+		uint32 sampleBytes;       ///< Size of the sample data of the SoundFont.
+		uint32 residentBytes;     ///< Size of the waves currently in the cache.
+		uint32 peakResidentBytes; ///< Maximum of residentBytes so far.
+		uint32 decodedBytes;      ///< Total size of the waves decoded so far.
+		uint32 decodes;           ///< Number of times a wave was decoded.
+		uint32 hits;              ///< Partial wave reads served from the cache.
+		uint32 evictions;         ///< Waves removed from the cache.
+	};
+
+	/**
+	 * @param file       The SoundFont, which is deleted with the stream.
+	 * @param cacheSize  Maximum size in bytes of the decoded waves to keep.
+	 */
+	SF2SampleStream(SF2File *file, uint32 cacheSize = 1024 * 1024);
+	~SF2SampleStream() override;
+
+	/**
+	 * Take over the files the samples are decoded from, so they are
+	 * deleted with the stream.
+	 */
+	void setSourceFiles(VGMInstrSet *instrSet, RawFile *rawFile);
+
+	const Stats &getStats() const { return _stats; }
+
+	// SeekableReadStream API
+	bool eos() const override { return _eos; }
+	void clearErr() override { _eos = false; }
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+	bool seek(int64 offset, int whence = SEEK_SET) override;
+
+private:
+	struct CachedWave {
+		uint8 *data;
+		uint32 lastUse;
+	};
+
+	uint32 readSamples(uint8 *buffer, uint32 offset, uint32 length);
+	const uint8 *getWave(uint32 index);
+	void evict(uint32 required);
+
+	SF2File *_file;
+	VGMInstrSet *_instrSet;
+	RawFile *_rawFile;
+
+	Common::Array<uint8> _header;
+	Common::Array<uint8> _trailer;
+	uint32 _sampleSize;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+
+	Common::Array<CachedWave> _cache;
+	uint32 _cacheSize;
+	uint32 _useCounter;
+	Stats _stats;
+};
+
+#endif // AUDIO_SOUNDFONT_SF2STREAM_H
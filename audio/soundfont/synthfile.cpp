@@ -171,15 +171,41 @@ void SynthWave::ConvertTo16bitSigned() {
 		this->_wBlockAlign = 16 / 8 * this->_wChannels;
 		this->_dwAveBytesPerSec *= 2;
 
-		int16 *newData = new int16[this->_dataSize];
-		for (unsigned int i = 0; i < this->_dataSize; i++)
-			newData[i] = ((int16) this->_data[i] - 128) << 8;
-		delete[] this->_data;
-		this->_data = (uint8 *) newData;
+		// Waves decoded on demand are converted in ReadData
+		if (this->_data) {
+			int16 *newData = new int16[this->_dataSize];
+			for (unsigned int i = 0; i < this->_dataSize; i++)
+				newData[i] = ((int16) this->_data[i] - 128) << 8;
+			delete[] this->_data;
+			this->_data = (uint8 *) newData;
+		}
 		this->_dataSize *= 2;
 	}
 }
 
+void SynthWave::ReadData(uint8 *buffer) const {
+	if (_data || !_source) {
+		if (_data)
+			memcpy(buffer, _data, _dataSize);
+		else
+			memset(buffer, 0, _dataSize);
+		return;
+	}
+
+	if (_source->_bps != 8 || _wBitsPerSample == 8) {
+		_source->ConvertToStdWave(buffer);
+		return;
+	}
+
+	// Decode into the second half of the buffer, then widen in place
+	const uint32 numSamples = _dataSize / 2;
+	uint8 *src = buffer + numSamples;
+	_source->ConvertToStdWave(src);
+	int16 *dst = (int16 *) buffer;
+	for (uint32 i = 0; i < numSamples; i++)
+		dst[i] = ((int16) src[i] - 128) << 8;
+}
+
 SynthWave::~SynthWave() {
 	delete _sampinfo;
 	delete[] _data;
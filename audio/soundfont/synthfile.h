@@ -163,7 +163,7 @@ public:
 
 class SynthWave {
 public:
-	SynthWave(void) : _sampinfo(NULL), _data(NULL), _name("Untitled Wave") {
+	SynthWave(void) : _sampinfo(NULL), _data(NULL), _source(NULL), _name("Untitled Wave") {
 		RiffFile::AlignName(_name);
 	}
 
@@ -178,6 +178,7 @@ public:
 			  _wBitsPerSample(bitsPerSample),
 			  _dataSize(waveDataSize),
 			  _data(waveData),
+			  _source(NULL),
 			  _sampinfo(NULL),
 			  _name(waveName) {
 		RiffFile::AlignName(_name);
@@ -188,6 +189,11 @@ public:
 	SynthSampInfo *AddSampInfo(void);
 	void ConvertTo16bitSigned();
 
+	// Waves without data are decoded from their source sample on demand.
+	// Writes _dataSize bytes of the wave to buffer.
+	void SetSource(VGMSamp *source) { _source = source; }
+	void ReadData(uint8 *buffer) const;
+
 public:
 	SynthSampInfo *_sampinfo;
 
@@ -200,6 +206,7 @@ public:
 
 	uint32 _dataSize;
 	uint8 *_data;
+	VGMSamp *_source;
 
 	Common::String _name;
 };
@@ -48,7 +48,7 @@ double ConvertPercentAmplitudeToAttenDB_SF2(double percent) {
 }
 
 void VGMColl::UnpackSampColl(SynthFile &synthfile, VGMSampColl *sampColl,
-							 Common::Array<VGMSamp *> &finalSamps) {
+							 Common::Array<VGMSamp *> &finalSamps, bool lazySamples) {
 	assert(sampColl != nullptr);
 
 	size_t nSamples = sampColl->_samples.size();
@@ -61,14 +61,18 @@ void VGMColl::UnpackSampColl(SynthFile &synthfile, VGMSampColl *sampColl,
 		else
 			bufSize = (uint32) ceil((double) samp->_dataLength * samp->GetCompressionRatio());
 
-		uint8 *uncompSampBuf =
-				new uint8[bufSize];  // create a new memory space for the uncompressed wave
-		samp->ConvertToStdWave(uncompSampBuf);  // and uncompress into that space
+		uint8 *uncompSampBuf = nullptr;
+		if (!lazySamples) {
+			uncompSampBuf = new uint8[bufSize];  // create a new memory space for the uncompressed wave
+			samp->ConvertToStdWave(uncompSampBuf);  // and uncompress into that space
+		}
 
 		uint16 blockAlign = samp->_bps / 8 * samp->_channels;
 		SynthWave *wave =
 				synthfile.AddWave(1, samp->_channels, samp->_rate, samp->_rate * blockAlign, blockAlign,
 								  samp->_bps, bufSize, uncompSampBuf, (samp->_name));
+		if (lazySamples)
+			wave->SetSource(samp);
 		finalSamps.push_back(samp);
 
 		// If we don't have any loop information, then don't create a sampInfo structure for the
@@ -93,19 +97,19 @@ void VGMColl::UnpackSampColl(SynthFile &synthfile, VGMSampColl *sampColl,
 	}
 }
 
-SF2File *VGMColl::CreateSF2File(VGMInstrSet *theInstrSet) {
-	SynthFile *synthfile = CreateSynthFile(theInstrSet);
+SF2File *VGMColl::CreateSF2File(VGMInstrSet *theInstrSet, bool lazySamples) {
+	SynthFile *synthfile = CreateSynthFile(theInstrSet, lazySamples);
 	if (!synthfile) {
 		debug("SF2 conversion aborted");
 		return nullptr;
 	}
 
-	SF2File *sf2file = new SF2File(synthfile);
+	SF2File *sf2file = new SF2File(synthfile, lazySamples);
 	delete synthfile;
 	return sf2file;
 }
 
-SynthFile *VGMColl::CreateSynthFile(VGMInstrSet *theInstrSet) {
+SynthFile *VGMColl::CreateSynthFile(VGMInstrSet *theInstrSet, bool lazySamples) {
 	Common::Array<VGMInstrSet *> instrsets;
 	instrsets.push_back(theInstrSet);
 	if (instrsets.empty()) {
@@ -123,7 +127,7 @@ SynthFile *VGMColl::CreateSynthFile(VGMInstrSet *theInstrSet) {
 		VGMSampColl *instrset_sampcoll = instrsets[i]->_sampColl;
 		if (instrset_sampcoll) {
 			finalSampColls.push_back(instrset_sampcoll);
-			UnpackSampColl(*synthfile, instrset_sampcoll, finalSamps);
+			UnpackSampColl(*synthfile, instrset_sampcoll, finalSamps, lazySamples);
 		}
 	}
 
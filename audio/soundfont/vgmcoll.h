@@ -37,12 +37,15 @@ class SynthFile;
 
 class VGMColl {
 public:
-	SF2File *CreateSF2File(VGMInstrSet *theInstrSet);
+	// With lazySamples, the samples are only decoded when the sample data
+	// of the SF2 file is written or read, see SF2SampleStream. The
+	// instrument set then has to outlive the returned file.
+	SF2File *CreateSF2File(VGMInstrSet *theInstrSet, bool lazySamples = false);
 
 private:
-	SynthFile *CreateSynthFile(VGMInstrSet *theInstrSet);
+	SynthFile *CreateSynthFile(VGMInstrSet *theInstrSet, bool lazySamples);
 	void UnpackSampColl(SynthFile &synthfile, VGMSampColl *sampColl,
-						Common::Array<VGMSamp *> &finalSamps);
+						Common::Array<VGMSamp *> &finalSamps, bool lazySamples);
 };
 
 #endif // AUDIO_SOUNDFONT_VGMCOLL_H
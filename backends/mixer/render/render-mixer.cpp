@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "backends/mixer/render/render-mixer.h"
+
+#include "audio/mixer_render.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/file.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+
+RenderMixerManager::RenderMixerManager() : MixerManager(), _outputRate(44100), _maxFrames(0), _startTime(0), _renderer(nullptr) {
+	if (ConfMan.hasKey("output_rate") && ConfMan.getInt("output_rate") > 0)
+		_outputRate = ConfMan.getInt("output_rate");
+}
+
+RenderMixerManager::~RenderMixerManager() {
+	if (_renderer) {
+		g_system->getTimerManager()->removeTimerProc(&timerProc);
+
+		debug("Rendered %u ms of audio, %.2fx realtime", _renderer->getRenderedMillis(), _renderer->getRealtimeFactor());
+		if (!_renderer->finish())
+			warning("Failed to write '%s'", ConfMan.get("render_audio").c_str());
+		delete _renderer;
+	}
+}
+
+void RenderMixerManager::init() {
+	_mixer = new Audio::MixerImpl(_outputRate, true, 1024);
+	_mixer->setReady(true);
+}
+
+void RenderMixerManager::start() {
+	assert(_mixer);
+
+	// Rendering an input file is done as fast as possible by the caller
+	if (ConfMan.hasKey("render_input"))
+		return;
+
+	const Common::String filename = ConfMan.get("render_audio");
+	Common::DumpFile *file = new Common::DumpFile();
+	if (!file->open(Common::Path(filename, Common::Path::kNativeSeparator))) {
+		warning("Failed to open '%s' for writing", filename.c_str());
+		delete file;
+		return;
+	}
+
+	if (ConfMan.hasKey("render_duration"))
+		_maxFrames = ConfMan.getInt("render_duration") * _outputRate;
+
+	_renderer = new Audio::MixerRenderer(_mixer, file);
+	_startTime = g_system->getMillis(true);
+	g_system->getTimerManager()->installTimerProc(&timerProc, 10000, this, "renderMixer");
+}
+
+void RenderMixerManager::timerProc(void *refCon) {
+	((RenderMixerManager *)refCon)->update();
+}
+
+void RenderMixerManager::update() {
+	if (_audioSuspended)
+		return;
+
+	// Produce as much audio as a device would have played by now
+	uint32 frames = (uint32)((uint64)(g_system->getMillis(true) - _startTime) * _outputRate / 1000);
+	if (_maxFrames)
+		frames = MIN(frames, _maxFrames);
+
+	if (frames > _renderer->getFramesRendered())
+		_renderer->render(frames - _renderer->getFramesRendered());
+}
+
+void RenderMixerManager::suspendAudio() {
+	_audioSuspended = true;
+}
+
+int RenderMixerManager::resumeAudio() {
+	if (!_audioSuspended)
+		return -2;
+	_audioSuspended = false;
+	return 0;
+}
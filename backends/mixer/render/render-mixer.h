@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BACKENDS_MIXER_RENDER_H
+#define BACKENDS_MIXER_RENDER_H
+
+#include "backends/mixer/mixer.h"
+
+namespace Audio {
+class MixerRenderer;
+}
+
+/**
+ * Mixer manager without an audio device, used with --render-audio.
+ *
+ * The mixer is pulled by a timer in real time, and its output is written
+ * into the WAV file given by the "render_audio" config key, for at most
+ * "render_duration" seconds. With the "render_input" key, nothing pulls the
+ * mixer, so that the caller can render the input file as fast as possible.
+ */
+class RenderMixerManager : public MixerManager {
+public:
+	RenderMixerManager();
+	virtual ~RenderMixerManager();
+
+	void init() override;
+
+	/**
+	 * Start rendering into the file. This has to be called after init(),
+	 * once the timer manager is available.
+	 */
+	void start();
+
+	void suspendAudio() override;
+	int resumeAudio() override;
+
+private:
+	static void timerProc(void *refCon);
+	void update();
+
+	uint32 _outputRate;
+	uint32 _maxFrames;
+	uint32 _startTime;
+	Audio::MixerRenderer *_renderer;
+};
+
+#endif
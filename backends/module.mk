@@ -191,6 +191,7 @@ MODULE_OBJS += \
 	graphics/surfacesdl/surfacesdl-graphics.o \
 	mixer/sdl/sdl-mixer.o \
 	mixer/null/null-mixer.o \
+	mixer/render/render-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	timer/sdl/sdl-timer.o
 
@@ -424,7 +425,8 @@ endif
 
 ifeq ($(BACKEND),null)
 MODULE_OBJS += \
-	mixer/null/null-mixer.o
+	mixer/null/null-mixer.o \
+	mixer/render/render-mixer.o
 endif
 
 ifdef MIYOO
@@ -33,6 +33,7 @@ public:
 	virtual ~NullMutexInternal() {}
 	virtual bool lock() { return true; }
 	virtual bool unlock() { return true; }
+	virtual bool tryLock() { return true; }
 };
 
 #endif
@@ -39,6 +39,7 @@ public:
 
 	bool lock() override;
 	bool unlock() override;
+	bool tryLock() override;
 
 private:
 	pthread_mutex_t _mutex;
@@ -79,6 +80,10 @@ bool PthreadMutexInternal::unlock() {
 	}
 }
 
+bool PthreadMutexInternal::tryLock() {
+	return pthread_mutex_trylock(&_mutex) == 0;
+}
+
 Common::MutexInternal *createPthreadMutexInternal() {
 	return new PthreadMutexInternal();
 }
@@ -36,6 +36,9 @@ public:
 
 	bool lock() override { return (SDL_mutexP(_mutex) == 0); }
 	bool unlock() override { return (SDL_mutexV(_mutex) == 0); }
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	bool tryLock() override { return (SDL_TryLockMutex(_mutex) == 0); }
+#endif
 
 private:
 	SDL_mutex *_mutex;
@@ -48,14 +48,16 @@ typedef void (*sighandler_t)(int);
 
 #if defined(USE_NULL_DRIVER)
 #include "backends/modular-backend.h"
+#include "common/config-manager.h"
 #include "backends/mutex/null/null-mutex.h"
+#include "backends/mixer/null/null-mixer.h"
+#include "backends/mixer/render/render-mixer.h"
 #include "base/main.h"
 
 #ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
-#include "backends/mixer/null/null-mixer.h"
 #include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
@@ -86,6 +88,7 @@ public:
 
 	virtual Common::MutexInternal *createMutex();
 	virtual uint32 getMillis(bool skipRecord = false);
+	virtual uint64 getMicros();
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
 
@@ -95,6 +98,11 @@ public:
 
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority);
 
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	void initMixer();
+	void initTimer();
+#endif
+
 private:
 #ifdef POSIX
 	timeval _startTime;
@@ -151,9 +159,17 @@ void OSystem_NULL::initBackend() {
 	_eventManager = new DefaultEventManager(this);
 	_savefileManager = new DefaultSaveFileManager();
 	_graphicsManager = new NullGraphicsManager();
-	_mixerManager = new NullMixerManager();
-	// Setup and start mixer
-	_mixerManager->init();
+	if (ConfMan.hasKey("render_audio")) {
+		// Render the audio into a file instead of discarding it
+		RenderMixerManager *mixerManager = new RenderMixerManager();
+		mixerManager->init();
+		mixerManager->start();
+		_mixerManager = mixerManager;
+	} else {
+		_mixerManager = new NullMixerManager();
+		// Setup and start mixer
+		_mixerManager->init();
+	}
 #endif
 
 	BaseBackend::initBackend();
@@ -162,7 +178,9 @@ void OSystem_NULL::initBackend() {
 bool OSystem_NULL::pollEvent(Common::Event &event) {
 #ifndef NULL_DRIVER_USE_FOR_TEST
 	((DefaultTimerManager *)getTimerManager())->checkTimers();
-	((NullMixerManager *)_mixerManager)->update(1);
+	// The render mixer manager is pulled by a timer
+	if (_mixerManager->isNullDevice())
+		((NullMixerManager *)_mixerManager)->update(1);
 
 #ifdef POSIX
 	if (intReceived) {
@@ -205,6 +223,18 @@ uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #endif
 }
 
+uint64 OSystem_NULL::getMicros() {
+#ifdef POSIX
+	timeval curTime;
+
+	gettimeofday(&curTime, 0);
+
+	return (uint64)(curTime.tv_sec - _startTime.tv_sec) * 1000000 + (curTime.tv_usec - _startTime.tv_usec);
+#else
+	return (uint64)getMillis(true) * 1000;
+#endif
+}
+
 void OSystem_NULL::delayMillis(uint msecs) {
 #ifdef POSIX
 	usleep(msecs * 1000);
@@ -42,6 +42,7 @@
 #endif
 
 #include "backends/mixer/null/null-mixer.h"
+#include "backends/mixer/render/render-mixer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/events/sdl/legacy-sdl-events.h"
 #include "backends/keymapper/hardware-input.h"
@@ -300,16 +301,25 @@ void OSystem_SDL::initBackend() {
 	if (_savefileManager == nullptr)
 		_savefileManager = new DefaultSaveFileManager();
 
+	bool renderAudio = false;
 	if (_mixerManager == nullptr) {
-		_mixerManager = new SdlMixerManager();
-		// Setup and start mixer
-		_mixerManager->init();
+		if (ConfMan.hasKey("render_audio")) {
+			// Render the audio into a file instead of playing it
+			_mixerManager = new RenderMixerManager();
+			_mixerManager->init();
+			renderAudio = true;
+		} else {
+			_mixerManager = new SdlMixerManager();
+			// Setup and start mixer
+			_mixerManager->init();
+		}
 
 		if (_mixerManager->getMixer() == nullptr) {
 			// Audio was unavailable or disabled
 			delete _mixerManager;
 			_mixerManager = new NullMixerManager();
 			_mixerManager->init();
+			renderAudio = false;
 		}
 	}
 
@@ -322,6 +332,10 @@ void OSystem_SDL::initBackend() {
 		_timerManager = new SdlTimerManager();
 #endif
 
+	// The rendering is driven by a timer
+	if (renderAudio)
+		((RenderMixerManager *)_mixerManager)->start();
+
 	_audiocdManager = createAudioCDManager();
 
 	// Setup a custom program icon.
@@ -734,6 +748,18 @@ uint32 OSystem_SDL::getMillis(bool skipRecord) {
 	return millis;
 }
 
+uint64 OSystem_SDL::getMicros() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	const uint64 frequency = SDL_GetPerformanceFrequency();
+	const uint64 counter = SDL_GetPerformanceCounter();
+
+	// Split the conversion to avoid an overflow with high frequencies
+	return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
+#else
+	return (uint64)SDL_GetTicks() * 1000;
+#endif
+}
+
 void OSystem_SDL::delayMillis(uint msecs) {
 #ifdef ENABLE_EVENTRECORDER
 	if (!g_eventRec.processDelayMillis())
@@ -32,6 +32,7 @@
 
 #include "common/config-manager.h"
 #include "common/fs.h"
+#include "common/file.h"
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/rendermode.h"
@@ -42,7 +43,21 @@
 
 #include "gui/ThemeEngine.h"
 
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "audio/mixer_intern.h"
+#include "audio/mixer_render.h"
 #include "audio/musicplugin.h"
+#include "audio/fmopl.h"
+#include "audio/softsynth/emumidi.h"
+#include "audio/decoders/aiff.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/voc.h"
+#include "audio/decoders/vorbis.h"
+#include "audio/decoders/wave.h"
+#include "audio/mods/mod_xm_s3m.h"
 
 #include "graphics/renderer.h"
 
@@ -168,6 +183,13 @@ static const char HELP_STRING4[] =
 	"  --native-mt32            True Roland MT-32 (disable GM emulation)\n"
 	"  --dump-midi              Dumps MIDI events to 'dump.mid', until quitting from game\n"
 	"                           (if file already exists, it will be overwritten)\n"
+	"  --render-audio=FILE      Render the audio into the WAV file FILE instead of playing\n"
+	"                           it (if file already exists, it will be overwritten)\n"
+	"  --render-duration=SECONDS Stop rendering the audio after SECONDS seconds (default:\n"
+	"                           until quitting, or until the end of --render-input)\n"
+	"  --render-input=FILE      Render the MIDI, module or audio file FILE as fast as\n"
+	"                           possible with --render-audio, and exit (MIDI files\n"
+	"                           need an emulated MIDI device)\n"
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-channels=CHANNELS Select output channel count (e.g. 2 for stereo)\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
@@ -206,6 +228,10 @@ static const char HELP_STRING4[] =
 #if defined(ENABLE_SKY) || defined(ENABLE_QUEEN)
 	"  --alt-intro              Use alternative intro for CD versions of Beneath a\n"
 	"                           Steel Sky and Flight of the Amazon Queen\n"
+#endif
+#if defined(ENABLE_PLAYGROUND3D)
+	"  --benchmark=NUM          Draw each test scene of Playground 3D NUM times without\n"
+	"                           frame limit, show the timings and quit\n"
 #endif
 	"  --copy-protection        Enable copy protection in games, when\n"
 	"                           ScummVM disables it by default.\n"
@@ -321,6 +347,8 @@ void registerDefaults() {
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
+	ConfMan.registerDefault("mt32_render_ahead", 0);
+	ConfMan.registerDefault("midi_sample_accurate", false);
 	ConfMan.registerDefault("gm_device", "auto");
 	ConfMan.registerDefault("opl2lpt_parport", "null");
 
@@ -363,6 +391,9 @@ void registerDefaults() {
 #if defined(ENABLE_SKY) || defined(ENABLE_QUEEN)
 	ConfMan.registerDefault("alt_intro", false);
 #endif
+#if defined(ENABLE_PLAYGROUND3D)
+	ConfMan.registerDefault("benchmark", 0);
+#endif
 
 	// Miscellaneous
 	ConfMan.registerDefault("joystick_num", 0);
@@ -406,6 +437,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("fluidsynth_reverb_level", 90);
 
 	ConfMan.registerDefault("fluidsynth_misc_interpolation", "4th");
+	ConfMan.registerDefault("fluidsynth_misc_dynamic_sample_loading", false);
 #endif
 #ifdef USE_DISCORD
 	ConfMan.registerDefault("discord_rpc", true);
@@ -881,6 +913,21 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("dump-midi")
 			END_OPTION
 
+			DO_LONG_OPTION("render-audio")
+			END_OPTION
+
+			DO_LONG_OPTION_INT("render-duration")
+			END_OPTION
+
+			DO_LONG_OPTION("render-input")
+				Common::FSNode path(Common::Path(option, Common::Path::kNativeSeparator));
+				if (!path.exists()) {
+					usage("Non-existent render input file path '%s'", option);
+				} else if (!path.isReadable()) {
+					usage("Non-readable render input file path '%s'", option);
+				}
+			END_OPTION
+
 			DO_LONG_OPTION_BOOL("enable-gs")
 			END_OPTION
 
@@ -1004,6 +1051,11 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			END_OPTION
 #endif
 
+#if defined(ENABLE_PLAYGROUND3D)
+			DO_LONG_OPTION_INT("benchmark")
+			END_OPTION
+#endif
+
 			DO_LONG_OPTION_INT("engine-speed")
 			END_OPTION
 
@@ -2181,4 +2233,168 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	return false;
 }
 
+/** Create an audio stream for the file given by --render-input. */
+static Audio::AudioStream *createRenderStream(Common::SeekableReadStream *input, const Common::String &name, int rate) {
+	const uint32 tag = input->readUint32BE();
+	input->seek(0);
+
+	switch (tag) {
+	case MKTAG('R', 'I', 'F', 'F'):
+		return Audio::makeWAVStream(input, DisposeAfterUse::YES);
+	case MKTAG('F', 'O', 'R', 'M'):
+		return Audio::makeAIFFStream(input, DisposeAfterUse::YES);
+	case MKTAG('C', 'r', 'e', 'a'):
+		return Audio::makeVOCStream(input, Audio::FLAG_UNSIGNED, DisposeAfterUse::YES);
+#ifdef USE_FLAC
+	case MKTAG('f', 'L', 'a', 'C'):
+		return Audio::makeFLACStream(input, DisposeAfterUse::YES);
+#endif
+#ifdef USE_VORBIS
+	case MKTAG('O', 'g', 'g', 'S'):
+		return Audio::makeVorbisStream(input, DisposeAfterUse::YES);
+#endif
+	default:
+		break;
+	}
+
+#ifdef USE_MAD
+	if (name.hasSuffixIgnoreCase(".mp3"))
+		return Audio::makeMP3Stream(input, DisposeAfterUse::YES);
+#endif
+
+	// Everything else has to be a module
+	return Audio::makeModXmS3mStream(input, DisposeAfterUse::YES, 0, rate, 0);
+}
+
+/**
+ * Check whether the given MIDI driver renders through the mixer. Only
+ * those drivers also run their timer callback from the mixer. Hardware
+ * devices would play the music themselves at real time speed, and leave
+ * the rendered file silent.
+ */
+static bool isEmulatedMidiDriver(MidiDriver *driver, MidiDriver::DeviceHandle device) {
+	if (dynamic_cast<MidiDriver_Emulated *>(driver))
+		return true;
+
+	// The AdLib driver depends on the selected OPL driver
+	if (MidiDriver::getMusicType(device) == MT_ADLIB) {
+		const OPL::Config::EmulatorDescription *opl = OPL::Config::findDriver(OPL::Config::detect(OPL::Config::kOpl2));
+		if (!opl)
+			return false;
+
+		const Common::String name = opl->name;
+		return name == "mame" || name == "db" || name == "nuked";
+	}
+
+	return false;
+}
+
+Common::Error renderAudioInput() {
+	const Common::String inputName = ConfMan.get("render_input");
+	const Common::String outputName = ConfMan.get("render_audio");
+	if (outputName.empty())
+		return Common::Error(Common::kUnknownError, "--render-input needs an output file given by --render-audio");
+
+	Audio::MixerImpl *mixer = dynamic_cast<Audio::MixerImpl *>(g_system->getMixer());
+	if (!mixer)
+		return Common::Error(Common::kAudioDeviceInitFailed);
+
+	Common::FSNode node(Common::Path(inputName, Common::Path::kNativeSeparator));
+	Common::SeekableReadStream *input = node.createReadStream();
+	if (!input)
+		return Common::Error(Common::kReadingFailed, inputName);
+
+	Common::DumpFile *output = new Common::DumpFile();
+	if (!output->open(Common::Path(outputName, Common::Path::kNativeSeparator))) {
+		delete output;
+		delete input;
+		return Common::Error(Common::kWritingFailed, outputName);
+	}
+
+	MidiDriver *driver = nullptr;
+	MidiParser *parser = nullptr;
+	byte *midiData = nullptr;
+	Audio::SoundHandle handle;
+
+	if (input->readUint32BE() == MKTAG('M', 'T', 'h', 'd')) {
+		const uint32 size = input->size();
+		midiData = new byte[size];
+		input->seek(0);
+		input->read(midiData, size);
+		delete input;
+
+		const MidiDriver::DeviceHandle device = MidiDriver::detectDevice(MDT_MIDI | MDT_ADLIB | MDT_PREFER_GM);
+		driver = MidiDriver::createMidi(device);
+		if (driver && !isEmulatedMidiDriver(driver, device)) {
+			const Common::String deviceName = MidiDriver::getDeviceString(device, MidiDriver::kDriverName);
+			delete driver;
+			delete[] midiData;
+			delete output;
+			return Common::Error(Common::kAudioDeviceInitFailed, deviceName + " is not an emulated MIDI device and cannot be rendered");
+		}
+
+		parser = MidiParser::createParser_SMF();
+		if (!driver || driver->open() != 0 || !parser->loadMusic(midiData, size)) {
+			delete parser;
+			delete driver;
+			delete[] midiData;
+			delete output;
+			return Common::Error(Common::kUnknownError, "Failed to play " + inputName);
+		}
+
+		parser->setTrack(0);
+		parser->setMidiDriver(driver);
+		parser->setTimerRate(driver->getBaseTempo());
+		driver->setTimerCallback(parser, MidiParser::timerCallback);
+		printf("Rendering %s with %s\n", inputName.c_str(), MidiDriver::getDeviceString(device, MidiDriver::kDriverName).c_str());
+	} else {
+		Audio::AudioStream *stream = createRenderStream(input, inputName, mixer->getOutputRate());
+		if (!stream) {
+			delete output;
+			return Common::Error(Common::kUnknownError, "Unsupported file format of " + inputName);
+		}
+		g_system->getMixer()->playStream(Audio::Mixer::kPlainSoundType, &handle, stream);
+	}
+
+	const uint32 rate = mixer->getOutputRate();
+	// Without --render-duration, render until the input has ended
+	const uint32 maxFrames = ConfMan.hasKey("render_duration") ? ConfMan.getInt("render_duration") * rate : 0;
+
+	// Keep rendering for a second after the end of a MIDI file, so that
+	// the last notes can decay
+	uint32 endFrames = 0;
+
+	Audio::MixerRenderer renderer(mixer, output);
+	const uint32 startTime = g_system->getMillis();
+	bool success = true;
+	while (success && (!maxFrames || renderer.getFramesRendered() < maxFrames) && endFrames < rate) {
+		const uint32 frames = maxFrames ? MIN<uint32>(4096, maxFrames - renderer.getFramesRendered()) : 4096;
+		success = renderer.render(frames);
+
+		if (parser ? !parser->isPlaying() : !mixer->isSoundHandleActive(handle))
+			endFrames += parser ? frames : rate;
+	}
+	success = renderer.finish() && success;
+	const uint32 time = MAX<uint32>(g_system->getMillis() - startTime, 1);
+
+	if (parser) {
+		parser->unloadMusic();
+		driver->setTimerCallback(nullptr, nullptr);
+		driver->close();
+		delete parser;
+		delete driver;
+		delete[] midiData;
+	}
+	mixer->stopAll();
+
+	if (!success)
+		return Common::Error(Common::kWritingFailed, outputName);
+
+	printf("Rendered %u ms of audio into %s in %u ms, %.2fx realtime (%.2fx in the mixer)\n",
+	       renderer.getRenderedMillis(), outputName.c_str(), time,
+	       (double)renderer.getRenderedMillis() / time, renderer.getRealtimeFactor());
+
+	return Common::kNoError;
+}
+
 } // End of namespace Base
@@ -54,6 +54,16 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
  */
 bool processSettings(Common::String &command, Common::StringMap &settings, Common::Error &err);
 
+/**
+ * Render the MIDI, module or audio file given by --render-input into the
+ * WAV file given by --render-audio, as fast as possible, and report how
+ * much faster than real time this was.
+ *
+ * This needs the mixer of the backend, so it has to be called after the
+ * backend was initialized.
+ */
+Common::Error renderAudioInput();
+
 } // End of namespace Base
 
 #endif
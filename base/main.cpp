@@ -630,6 +630,19 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	// Now as the event manager is created, setup the keymapper
 	setupKeymapper(system);
 
+	// Render an audio file instead of starting the launcher
+	if (ConfMan.hasKey("render_input")) {
+		res = Base::renderAudioInput();
+		if (res.getCode() != Common::kNoError)
+			warning("%s", res.getDesc().c_str());
+
+		PluginManager::instance().unloadDetectionPlugin();
+		PluginManager::instance().unloadAllPlugins();
+		PluginManager::destroy();
+
+		return res.getCode();
+	}
+
 #ifdef USE_UPDATES
 	if (!ConfMan.hasKey("updates_check") && g_system->getUpdateManager()) {
 		GUI::UpdatesDialog dlg;
@@ -176,6 +176,23 @@ char Archive::getPathSeparator() const {
 	return '/';
 }
 
+SharedArchiveContents SharedArchiveContents::slice(uint32 offset, uint32 size) const {
+	assert(!_missingFile && !_bypass);
+	assert(offset <= _contentSize && size <= _contentSize - offset);
+	assert(_strongRef || _contentSize == 0);
+
+	return SharedArchiveContents(_strongRef, _offset + offset, size);
+}
+
+SeekableReadStream *SharedArchiveContents::createReadStream() const {
+	if (_missingFile)
+		return nullptr;
+	if (_contentSize != 0 && !_strongRef)
+		return nullptr;
+
+	return new MemoryReadStream(_strongRef, _offset, _contentSize);
+}
+
 SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMember(const Path &path) const {
 	return createReadStreamForMemberImpl(path, false, Common::AltStreamType::Invalid);
 }
@@ -228,7 +245,7 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 		return nullptr;
 
 	// Now we have a valid contents reference. Make stream for it.
-	Common::MemoryReadStream *memStream = new Common::MemoryReadStream(entry->getContents(), entry->getSize());
+	SeekableReadStream *memStream = entry->createReadStream();
 
 	// If the entry was just created and it's too big for strong caching,
 	// mark the copy in cache as weak
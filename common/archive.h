@@ -224,18 +224,36 @@ class MemcachingCaseInsensitiveArchive;
 class SharedArchiveContents {
 public:
 	SharedArchiveContents(byte *contents, uint32 contentSize) :
-		_strongRef(contents, ArrayDeleter<byte>()), _weakRef(_strongRef),
+		_strongRef(contents, ArrayDeleter<byte>()), _weakRef(_strongRef), _offset(0),
 		_contentSize(contentSize), _missingFile(false), _bypass(nullptr) {}
-	SharedArchiveContents() : _strongRef(nullptr), _weakRef(nullptr), _contentSize(0), _missingFile(true), _bypass(nullptr) {}
+	/**
+	 * Refer to @p contentSize bytes at @p offset inside of a shared buffer,
+	 * e.g. a member of an archive which is kept in memory as a whole.
+	 */
+	SharedArchiveContents(const SharedPtr<byte> &buffer, uint32 offset, uint32 contentSize) :
+		_strongRef(buffer), _weakRef(_strongRef), _offset(offset),
+		_contentSize(contentSize), _missingFile(false), _bypass(nullptr) {}
+	SharedArchiveContents() : _strongRef(nullptr), _weakRef(nullptr), _offset(0), _contentSize(0), _missingFile(true), _bypass(nullptr) {}
 	static SharedArchiveContents bypass(SeekableReadStream *stream) {
 		return SharedArchiveContents(stream);
 	}
 
+	/**
+	 * Return contents referring to a part of these contents, without
+	 * copying any data. The contents must be strongly referenced.
+	 */
+	SharedArchiveContents slice(uint32 offset, uint32 size) const;
+
+	/**
+	 * Create a stream reading the contents, without copying any data.
+	 * Returns nullptr for missing files and expired weak references.
+	 */
+	SeekableReadStream *createReadStream() const;
+
 private:
-	SharedArchiveContents(SeekableReadStream *stream) : _strongRef(nullptr), _weakRef(nullptr), _contentSize(0), _missingFile(false), _bypass(stream) {}
+	SharedArchiveContents(SeekableReadStream *stream) : _strongRef(nullptr), _weakRef(nullptr), _offset(0), _contentSize(0), _missingFile(false), _bypass(stream) {}
 
 	bool isFileMissing() const { return _missingFile; }
-	SharedPtr<byte> getContents() const { return _strongRef; }
 	uint32 getSize() const { return _contentSize; }
 
 	bool makeStrong() {
@@ -256,6 +274,7 @@ private:
 
 	SharedPtr<byte> _strongRef;
 	WeakPtr<byte> _weakRef;
+	uint32 _offset;
 	uint32 _contentSize;
 	bool _missingFile;
 	SeekableReadStream *_bypass;
@@ -0,0 +1,132 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/arena.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+Arena::Arena(size_t pageSize, size_t defaultAlignment)
+	: _pageSize(pageSize), _defaultAlignment(defaultAlignment), _curPage(0), _curOffset(0) {
+	assert(_pageSize > 0);
+	assert(_defaultAlignment > 0 && (_defaultAlignment & (_defaultAlignment - 1)) == 0);
+
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+Arena::~Arena() {
+	for (uint i = 0; i < _pages.size(); ++i)
+		::free(_pages[i].start);
+}
+
+void *Arena::allocateSlow(size_t size, size_t alignment) {
+	// Worst case space needed when the page start is badly aligned
+	const size_t needed = size + alignment - 1;
+
+	// The current page (if any) is full, continue with the next one. Pages
+	// after the current one are left over from before a reset or rewind and
+	// can be reused if they are big enough. Otherwise a new page is inserted
+	// in front of them, so that they remain available for later requests.
+	uint next = _curPage;
+	if (_curPage < _pages.size())
+		next++;
+
+	if (next >= _pages.size() || _pages[next].size < needed) {
+		Page page;
+		page.size = MAX(_pageSize, needed);
+		page.start = (byte *)::malloc(page.size);
+		if (!page.start)
+			error("Arena::allocate: Failed to allocate %u bytes", (uint)page.size);
+
+		_pages.insert_at(next, page);
+		_stats.bytesReserved += page.size;
+		_stats.numPageAllocs++;
+	}
+
+	_curPage = next;
+	_curOffset = 0;
+	_stats.bytesInUse = usedBytes(_curPage, 0);
+
+	const Page &page = _pages[_curPage];
+	const size_t offset = alignOffset(page.start, 0, alignment);
+	assert(offset + size <= page.size);
+
+	_stats.numAllocations++;
+	_stats.totalBytes += size;
+	addInUse(offset + size);
+	_curOffset = offset + size;
+	return page.start + offset;
+}
+
+char *Arena::copyString(const char *str) {
+	const size_t len = strlen(str) + 1;
+	char *result = (char *)allocate(len, 1);
+	memcpy(result, str, len);
+	return result;
+}
+
+size_t Arena::usedBytes(uint page, size_t offset) const {
+	size_t result = offset;
+	for (uint i = 0; i < page && i < _pages.size(); ++i)
+		result += _pages[i].size;
+	return result;
+}
+
+void Arena::rewind(const Marker &marker) {
+	assert(marker.page < _curPage || (marker.page == _curPage && marker.offset <= _curOffset));
+
+	_curPage = marker.page;
+	_curOffset = marker.offset;
+	_stats.bytesInUse = usedBytes(_curPage, _curOffset);
+}
+
+void Arena::reset() {
+	_curPage = 0;
+	_curOffset = 0;
+	_stats.bytesInUse = 0;
+	_stats.numResets++;
+}
+
+void Arena::freeUnusedPages() {
+	// Everything past the current page is unused. The current page itself
+	// is only unused if nothing has been allocated from it.
+	uint keep = _curPage;
+	if (_curPage < _pages.size() && _curOffset > 0)
+		keep++;
+
+	for (uint i = keep; i < _pages.size(); ++i) {
+		_stats.bytesReserved -= _pages[i].size;
+		::free(_pages[i].start);
+	}
+	_pages.resize(keep);
+}
+
+void Arena::resetStats() {
+	const size_t bytesInUse = _stats.bytesInUse;
+	const size_t bytesReserved = _stats.bytesReserved;
+
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.bytesInUse = bytesInUse;
+	_stats.peakBytesInUse = bytesInUse;
+	_stats.bytesReserved = bytesReserved;
+}
+
+} // End of namespace Common
@@ -0,0 +1,265 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_arena Memory arena
+ * @ingroup common_memory
+ *
+ * @brief API for bump allocation of short-lived objects.
+ * @{
+ */
+
+/**
+ * A bump ("arena") allocator for short-lived, variable-sized allocations.
+ *
+ * Allocating from an arena is a pointer increment in the common case.
+ * Individual allocations are never freed; instead the whole arena is reset
+ * (e.g. once per frame or when leaving a room), or rewound to a previously
+ * taken marker. The memory pages backing the arena are kept across resets,
+ * so an arena that is reused every frame stops touching the global heap
+ * once it has grown to its working set size.
+ *
+ * Note that the arena never runs destructors. Only allocate objects whose
+ * destructor is trivial, or destroy them manually before resetting.
+ */
+class Arena : NonCopyable {
+public:
+	/**
+	 * Position inside the arena, as returned by getMarker().
+	 */
+	struct Marker {
+		uint page;
+		size_t offset;
+	};
+
+	/**
+	 * Allocation statistics, useful to decide on page sizes and to find
+	 * out how much allocation traffic has been moved off the heap.
+	 */
+	struct Stats {
+		size_t bytesInUse;       ///< Bytes currently handed out, including alignment padding.
+		size_t peakBytesInUse;   ///< Highest value of bytesInUse since the last resetStats().
+		size_t bytesReserved;    ///< Total size of all pages owned by the arena.
+		uint64 totalBytes;       ///< Bytes requested since the last resetStats().
+		uint32 numAllocations;   ///< Number of allocate() calls since the last resetStats().
+		uint32 numPageAllocs;    ///< Number of pages obtained from the heap since the last resetStats().
+		uint32 numResets;        ///< Number of reset() calls since the last resetStats().
+	};
+
+	/**
+	 * Create a new arena.
+	 *
+	 * @param pageSize          Size of the pages requested from the heap. Requests
+	 *                          bigger than this get a dedicated page.
+	 * @param defaultAlignment  Alignment used by allocate() when none is given.
+	 *                          Must be a power of two.
+	 */
+	explicit Arena(size_t pageSize = 64 * 1024, size_t defaultAlignment = 2 * sizeof(void *));
+	~Arena();
+
+	/**
+	 * Allocate a block of memory from the arena.
+	 *
+	 * @param size       Number of bytes to allocate.
+	 * @param alignment  Required alignment (power of two), or 0 for the default.
+	 *
+	 * @return Pointer to the memory block. The block stays valid until the
+	 *         arena is reset, rewound past it, or destroyed.
+	 */
+	void *allocate(size_t size, size_t alignment = 0) {
+		if (alignment == 0)
+			alignment = _defaultAlignment;
+		assert((alignment & (alignment - 1)) == 0);
+
+		if (_curPage < _pages.size()) {
+			const Page &page = _pages[_curPage];
+			const size_t offset = alignOffset(page.start, _curOffset, alignment);
+			if (offset + size <= page.size) {
+				_stats.numAllocations++;
+				_stats.totalBytes += size;
+				addInUse(offset + size - _curOffset);
+				_curOffset = offset + size;
+				return page.start + offset;
+			}
+		}
+
+		return allocateSlow(size, alignment);
+	}
+
+	/**
+	 * Allocate uninitialized storage for @p count objects of type T.
+	 */
+	template<class T>
+	T *allocArray(size_t count) {
+		return (T *)allocate(sizeof(T) * count, alignof(T));
+	}
+
+	/**
+	 * Construct an object of type T inside the arena.
+	 * The destructor of the object is never called by the arena.
+	 */
+	template<class T, class... TArgs>
+	T *newObject(TArgs &&...args) {
+		return new ((void *)allocate(sizeof(T), alignof(T))) T(Common::forward<TArgs>(args)...);
+	}
+
+	/**
+	 * Copy a string into the arena, including its terminating zero.
+	 */
+	char *copyString(const char *str);
+
+	/**
+	 * Return the current position of the arena. Passing it to rewind()
+	 * releases everything allocated after this call.
+	 */
+	Marker getMarker() const {
+		Marker marker = { _curPage, _curOffset };
+		return marker;
+	}
+
+	/**
+	 * Release all allocations made since @p marker was taken.
+	 */
+	void rewind(const Marker &marker);
+
+	/**
+	 * Release all allocations. The pages are kept and reused by future
+	 * allocations.
+	 */
+	void reset();
+
+	/**
+	 * Return all pages which are currently unused to the heap. Pages
+	 * in use by live allocations are kept.
+	 */
+	void freeUnusedPages();
+
+	/** Return the allocation statistics. */
+	const Stats &getStats() const { return _stats; }
+
+	/** Clear the counters in the statistics, except for the current usage. */
+	void resetStats();
+
+	/** Return the page size of this arena. */
+	size_t getPageSize() const { return _pageSize; }
+
+private:
+	struct Page {
+		byte *start;
+		size_t size;
+	};
+
+	static size_t alignOffset(const byte *base, size_t offset, size_t alignment) {
+		const size_t addr = (size_t)(base + offset);
+		return offset + (((addr + alignment - 1) & ~(alignment - 1)) - addr);
+	}
+
+	void addInUse(size_t bytes) {
+		_stats.bytesInUse += bytes;
+		if (_stats.bytesInUse > _stats.peakBytesInUse)
+			_stats.peakBytesInUse = _stats.bytesInUse;
+	}
+
+	void *allocateSlow(size_t size, size_t alignment);
+	size_t usedBytes(uint page, size_t offset) const;
+
+	const size_t _pageSize;
+	const size_t _defaultAlignment;
+
+	Array<Page> _pages;
+	uint _curPage;
+	size_t _curOffset;
+
+	Stats _stats;
+};
+
+/**
+ * Rewinds an arena to its state at construction time when going out of
+ * scope. Use this for temporaries inside a function or a frame.
+ */
+class ArenaScope : NonCopyable {
+public:
+	explicit ArenaScope(Arena &arena) : _arena(arena), _marker(arena.getMarker()) {}
+	~ArenaScope() { _arena.rewind(_marker); }
+
+	Arena &getArena() { return _arena; }
+
+private:
+	Arena &_arena;
+	Arena::Marker _marker;
+};
+
+/**
+ * Allocator adaptor handing out typed storage from an arena, following the
+ * interface of the standard library allocators. deallocate() is a no-op; the
+ * memory is released together with the arena.
+ */
+template<class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef size_t size_type;
+
+	template<class U>
+	struct rebind {
+		typedef ArenaAllocator<U> other;
+	};
+
+	explicit ArenaAllocator(Arena &arena) : _arena(&arena) {}
+	template<class U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.getArena()) {}
+
+	T *allocate(size_t count) { return _arena->allocArray<T>(count); }
+	void deallocate(T *, size_t) {}
+
+	template<class U, class... TArgs>
+	void construct(U *ptr, TArgs &&...args) { new ((void *)ptr) U(Common::forward<TArgs>(args)...); }
+	template<class U>
+	void destroy(U *ptr) { ptr->~U(); }
+
+	Arena *getArena() const { return _arena; }
+
+	template<class U>
+	bool operator==(const ArenaAllocator<U> &other) const { return _arena == other.getArena(); }
+	template<class U>
+	bool operator!=(const ArenaAllocator<U> &other) const { return _arena != other.getArena(); }
+
+private:
+	Arena *_arena;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
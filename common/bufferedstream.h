@@ -66,6 +66,54 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  */
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
 
+/**
+ * A seekable stream which keeps a window of blocks following the current
+ * read position filled, so that reading from slow storage does not block
+ * on every buffer refill.
+ *
+ * @see wrapReadAheadStream
+ */
+class ReadAheadStream : public SeekableReadStream {
+public:
+	/** Statistics collected by a read-ahead stream. */
+	struct Stats {
+		uint32 hits;       ///< Reads served from a block which was already filled.
+		uint32 stalls;     ///< Reads which had to wait for the parent stream.
+		uint32 prefetches; ///< Blocks filled in the background, ahead of the reader.
+		uint32 discards;   ///< Prefetched blocks which were dropped unused, e.g. after a seek.
+	};
+
+	/** Return the statistics collected so far. */
+	virtual Stats getStats() const = 0;
+
+	/** Reset all statistics counters to zero. */
+	virtual void resetStats() = 0;
+};
+
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a read-ahead stream.
+ *
+ * The wrapper caches @p numBlocks blocks of @p blockSize bytes each. If
+ * background prefetching is requested, the blocks following the current
+ * read position are filled from a timer callback, which runs on a separate
+ * thread on most backends. So as not to delay the other timer callbacks,
+ * a tick reads at least one block, but stops after 64 KB or 2 ms. Seeking
+ * discards the blocks outside the new read-ahead window.
+ *
+ * Since the parent stream is accessed from the timer thread, it must not
+ * be used by anybody else while the wrapper exists.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param parentStream        The SeekableReadStream to wrap.
+ * @param blockSize           Size of a single block.
+ * @param numBlocks           Number of blocks to keep, at least 2.
+ * @param disposeParentStream Flag indicating whether to dispose of the wrapped stream.
+ * @param background          Whether to prefetch blocks from a timer callback.
+ */
+ReadAheadStream *wrapReadAheadStream(SeekableReadStream *parentStream, uint32 blockSize, uint32 numBlocks, DisposeAfterUse::Flag disposeParentStream, bool background = true);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream that
  * transparently provides buffering.
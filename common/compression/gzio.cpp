@@ -208,7 +208,10 @@ static const ush mask_bits[] =
 };
 
 
-#define NEEDBITS(n) do {while(k<(n)){b|=((ulg)parentGetByte())<<k;k+=8;}} while (0)
+/* The input buffer is checked inline, so that only refills go through
+   parentGetByte(). */
+#define NEXTBYTE() (_inbufD < _inbufSize ? _inbuf[_inbufD++] : parentGetByte())
+#define NEEDBITS(n) do {while(k<(n)){b|=((ulg)NEXTBYTE())<<k;k+=8;}} while (0)
 #define DUMPBITS(n) do {b>>=(n);k-=(n);} while (0)
 
 /* The state stored in filesystem-specific data.  */
@@ -1062,8 +1065,20 @@ GzioReadStream::inflate_window ()
 
 	  while (_blockLen && w < WSIZE && !_err)
 	    {
-	      _slide[w++] = parentGetByte ();
-	      _blockLen--;
+	      /* Copy whatever is available in the input buffer at once,
+	         and only fall back to parentGetByte() to refill it. */
+	      int n = MIN<int> (MIN<int> (_blockLen, WSIZE - w), _inbufSize - _inbufD);
+	      if (n <= 0)
+		{
+		  _slide[w++] = parentGetByte ();
+		  _blockLen--;
+		  continue;
+		}
+
+	      memcpy (_slide + w, _inbuf + _inbufD, n);
+	      _inbufD += n;
+	      w += n;
+	      _blockLen -= n;
 	    }
 
 	  _wp = w;
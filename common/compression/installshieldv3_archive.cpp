@@ -26,7 +26,7 @@
 
 namespace Common {
 
-InstallShieldV3::InstallShieldV3() : Common::Archive() {
+InstallShieldV3::InstallShieldV3() : Common::MemcachingCaseInsensitiveArchive() {
 	_stream = nullptr;
 }
 
@@ -88,15 +88,23 @@ const Common::ArchiveMemberPtr InstallShieldV3::getMember(const Common::Path &pa
 	return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path, *this));
 }
 
-Common::SeekableReadStream *InstallShieldV3::createReadStreamForMember(const Common::Path &path) const {
+Common::SharedArchiveContents InstallShieldV3::readContentsForPath(const Common::Path &path) const {
 	if (!_stream || !_map.contains(path))
-		return nullptr;
+		return Common::SharedArchiveContents();
 
 	const FileEntry &entry = _map[path];
 
-	// Seek to our offset and then send it off to the decompressor
+	// Seek to our offset and then send it off to the decompressor. The
+	// result is cached, so opening the member again does not decompress
+	// it again as long as a stream of it is alive.
 	_stream->seek(entry.offset);
-	return Common::decompressDCL(_stream, entry.compressedSize, entry.uncompressedSize);
+	byte *data = new byte[entry.uncompressedSize];
+	if (!Common::decompressDCL(_stream, data, entry.compressedSize, entry.uncompressedSize)) {
+		delete[] data;
+		return Common::SharedArchiveContents();
+	}
+
+	return Common::SharedArchiveContents(data, entry.uncompressedSize);
 }
 
 char InstallShieldV3::getPathSeparator() const {
@@ -32,7 +32,7 @@
 
 namespace Common {
 
-class InstallShieldV3 : public Common::Archive {
+class InstallShieldV3 : public Common::MemcachingCaseInsensitiveArchive {
 public:
 	InstallShieldV3();
 	~InstallShieldV3() override;
@@ -47,7 +47,7 @@ public:
 	bool hasFile(const Common::Path &path) const override;
 	int listMembers(Common::ArchiveMemberList &list) const override;
 	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override;
-	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override;
+	Common::SharedArchiveContents readContentsForPath(const Common::Path &path) const override;
 	char getPathSeparator() const override;
 
 private:
@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/crc.h"
+#include "common/endian.h"
+
+namespace Common {
+
+bool CRC32::_slicingInitialized = false;
+uint32 CRC32::_slicingTable[8][256];
+
+CRC32::CRC32() : CRCReflected<uint32>(0xEDB88320, 0xFFFFFFFF, 0xFFFFFFFF) {
+	if (!_slicingInitialized)
+		initSlicingTables();
+}
+
+void CRC32::initSlicingTables() {
+	// Table 0 is the ordinary byte-wise table. Table n holds the CRC of
+	// a byte followed by n zero bytes, which allows folding eight input
+	// bytes into the remainder at once.
+	for (int i = 0; i < 256; ++i)
+		_slicingTable[0][i] = processByte(i, 0);
+
+	for (int i = 0; i < 256; ++i) {
+		uint32 remainder = _slicingTable[0][i];
+		for (int slice = 1; slice < 8; ++slice) {
+			remainder = _slicingTable[0][remainder & 0xFF] ^ (remainder >> 8);
+			_slicingTable[slice][i] = remainder;
+		}
+	}
+
+	_slicingInitialized = true;
+}
+
+uint32 CRC32::processBlock(byte const message[], int nBytes, uint32 remainder) const {
+	const uint32 (&t)[8][256] = _slicingTable;
+
+	while (nBytes >= 8) {
+		const uint32 one = READ_LE_UINT32(message) ^ remainder;
+		const uint32 two = READ_LE_UINT32(message + 4);
+
+		remainder = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+		            t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+		            t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+		            t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+
+		message += 8;
+		nBytes -= 8;
+	}
+
+	while (nBytes-- > 0)
+		remainder = t[0][(*message++ ^ remainder) & 0xFF] ^ (remainder >> 8);
+
+	return remainder;
+}
+
+} // End of namespace Common
@@ -228,9 +228,33 @@ public:
 	CRC16() : CRCReflected<uint16>(0xa001, 0x0000, 0x0000) {}
 };
 
+/**
+ * CRC-32 as used by zip, gzip and PNG.
+ *
+ * Besides the byte-wise interface of CRCReflected, this provides a
+ * slicing-by-8 implementation which processes eight bytes per step using
+ * a set of lookup tables shared by all instances.
+ */
 class CRC32 : public CRCReflected<uint32> {
 public:
-	CRC32() : CRCReflected<uint32>(0xEDB88320, 0xFFFFFFFF, 0xFFFFFFFF) {}
+	CRC32();
+
+	/** Compute the CRC of a message, using slicing-by-8. */
+	uint32 crcFast(byte const message[], int nBytes) const {
+		return finalize(processBlock(message, nBytes, getInitRemainder()));
+	}
+
+	/**
+	 * Continue a running CRC over a block of bytes, using slicing-by-8.
+	 * This is equivalent to calling processByte() for every byte.
+	 */
+	uint32 processBlock(byte const message[], int nBytes, uint32 remainder) const;
+
+private:
+	void initSlicingTables();
+
+	static bool _slicingInitialized;
+	static uint32 _slicingTable[8][256];
 };
 
 } // End of namespace Common
@@ -84,6 +84,18 @@ public:
 		_pos(0),
 		_eos(false) {}
 
+	/**
+	 * This constructor wraps @p dataSize bytes starting at @p offset inside
+	 * of a shared buffer. The stream holds a reference to the buffer, so that
+	 * any number of slices of it can be handed out without copying.
+	 */
+	MemoryReadStream(SharedPtr<byte> dataPtr, uint32 offset, uint32 dataSize) :
+		_ptrOrig(dataPtr),
+		_ptr(dataPtr.get() + offset),
+		_size(dataSize),
+		_pos(0),
+		_eos(false) {}
+
 	uint32 read(void *dataPtr, uint32 dataSize);
 
 	bool eos() const { return _eos; }
@@ -2,11 +2,13 @@ MODULE := common
 
 MODULE_OBJS := \
 	archive.o \
+	arena.o \
 	base64.o \
 	btea.o \
 	concatstream.o \
 	config-manager.o \
 	coroutines.o \
+	crc.o \
 	dbcs-str.o \
 	debug.o \
 	engine_data.o \
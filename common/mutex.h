@@ -43,6 +43,12 @@ public:
 
 	virtual bool lock() = 0;
 	virtual bool unlock() = 0;
+
+	/**
+	 * Lock the mutex if that is possible without waiting. Backends which
+	 * don't implement this always fail.
+	 */
+	virtual bool tryLock() { return false; }
 };
 
 /**
@@ -75,6 +81,7 @@ public:
 
 	bool lock();
 	bool unlock();
+	bool tryLock();
 };
 
 /** @} */
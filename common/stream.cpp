@@ -21,9 +21,19 @@
 
 #include "common/ptr.h"
 #include "common/stream.h"
+#include "common/bufferedstream.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
 #include "common/substream.h"
 #include "common/str.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(SCUMMVM_NEON) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace Common {
 
@@ -88,6 +98,123 @@ Common::String ReadStream::readString(char terminator, size_t len) {
 	return result;
 }
 
+namespace {
+
+// The SIMD paths are only used when the instruction set is guaranteed by the
+// compiler flags (e.g. SSE2 on amd64), so no runtime detection is needed.
+
+void swapArray16(uint16 *data, uint32 count) {
+	uint32 i = 0;
+#if defined(__SSE2__)
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+#elif defined(SCUMMVM_NEON) && defined(__ARM_NEON)
+	for (; i + 8 <= count; i += 8)
+		vst1q_u8((uint8 *)(data + i), vrev16q_u8(vld1q_u8((const uint8 *)(data + i))));
+#endif
+	for (; i < count; ++i)
+		data[i] = SWAP_BYTES_16(data[i]);
+}
+
+void swapArray32(uint32 *data, uint32 count) {
+	uint32 i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		// Swap the 16-bit halves of each word, then the bytes in each half
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+#elif defined(SCUMMVM_NEON) && defined(__ARM_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_u8((uint8 *)(data + i), vrev32q_u8(vld1q_u8((const uint8 *)(data + i))));
+#endif
+	for (; i < count; ++i)
+		data[i] = SWAP_BYTES_32(data[i]);
+}
+
+void swapArray64(uint64 *data, uint32 count) {
+	uint32 i = 0;
+#if defined(__SSE2__)
+	for (; i + 2 <= count; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+#elif defined(SCUMMVM_NEON) && defined(__ARM_NEON)
+	for (; i + 2 <= count; i += 2)
+		vst1q_u8((uint8 *)(data + i), vrev64q_u8(vld1q_u8((const uint8 *)(data + i))));
+#endif
+	for (; i < count; ++i)
+		data[i] = SWAP_BYTES_64(data[i]);
+}
+
+} // End of anonymous namespace
+
+#ifdef SCUMM_LITTLE_ENDIAN
+#define SWAP_IF_LE(swapFunc, data, count) swapFunc(data, count)
+#define SWAP_IF_BE(swapFunc, data, count)
+#else
+#define SWAP_IF_LE(swapFunc, data, count)
+#define SWAP_IF_BE(swapFunc, data, count) swapFunc(data, count)
+#endif
+
+uint32 ReadStream::readArrayUint16LE(uint16 *dst, uint32 count) {
+	count = read(dst, count * 2) / 2;
+	SWAP_IF_BE(swapArray16, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayUint16BE(uint16 *dst, uint32 count) {
+	count = read(dst, count * 2) / 2;
+	SWAP_IF_LE(swapArray16, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayUint32LE(uint32 *dst, uint32 count) {
+	count = read(dst, count * 4) / 4;
+	SWAP_IF_BE(swapArray32, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayUint32BE(uint32 *dst, uint32 count) {
+	count = read(dst, count * 4) / 4;
+	SWAP_IF_LE(swapArray32, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayUint64LE(uint64 *dst, uint32 count) {
+	count = read(dst, count * 8) / 8;
+	SWAP_IF_BE(swapArray64, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayUint64BE(uint64 *dst, uint32 count) {
+	count = read(dst, count * 8) / 8;
+	SWAP_IF_LE(swapArray64, dst, count);
+	return count;
+}
+
+uint32 ReadStream::readArrayFloatLE(float *dst, uint32 count) {
+	STATIC_ASSERT(sizeof(float) == sizeof(uint32), Unexpected_size_of_float);
+	return readArrayUint32LE((uint32 *)dst, count);
+}
+
+uint32 ReadStream::readArrayFloatBE(float *dst, uint32 count) {
+	return readArrayUint32BE((uint32 *)dst, count);
+}
+
+#undef SWAP_IF_LE
+#undef SWAP_IF_BE
+
 Common::String ReadStream::readPascalString(bool transformCR) {
 	Common::String s;
 	char *buf;
@@ -136,7 +263,9 @@ bool MemoryReadStream::seek(int64 offs, int whence) {
 	case SEEK_SET:
 		// Fall through
 	default:
-		_ptr = _ptrOrig.get() + offs;
+		// The stream may start at an offset inside of _ptrOrig, so
+		// seek relative to the current position.
+		_ptr += offs - (int64)_pos;
 		_pos = offs;
 		break;
 
@@ -499,6 +628,341 @@ SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStr
 
 namespace {
 
+class ReadAheadStreamImpl;
+
+/**
+ * Drives the background prefetching of all read-ahead streams. A timer
+ * callback can only be installed once, so a single callback serves all
+ * streams. It is installed with the first stream and removed with the last.
+ */
+class ReadAheadScheduler {
+public:
+	static void addStream(ReadAheadStreamImpl *stream);
+	static void removeStream(ReadAheadStreamImpl *stream);
+
+private:
+	enum {
+		kTimerInterval = 10000,			// microseconds
+		kMaxBytesPerTick = 64 * 1024,
+		kMaxTimePerTick = 2000			// microseconds
+	};
+
+	ReadAheadScheduler() : _firstStream(0) {}
+
+	static void timerProc(void *refCon);
+
+	Mutex _mutex;
+	Array<ReadAheadStreamImpl *> _streams;
+	uint _firstStream;
+};
+
+ReadAheadScheduler *g_readAheadScheduler = nullptr;
+
+/**
+ * Wrapper class which keeps the blocks following the read position of
+ * a SeekableReadStream filled.
+ * @see wrapReadAheadStream
+ */
+class ReadAheadStreamImpl : public ReadAheadStream {
+protected:
+	struct Block {
+		int64 index;
+		uint32 size;
+		bool used;
+		byte *data;
+	};
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _blockSize;
+	Array<Block> _blocks;
+	byte *_buf;
+
+	int64 _pos;
+	const int64 _size;
+	bool _eos;
+	bool _err;
+	const bool _background;
+
+	Stats _stats;
+	Mutex _mutex;
+
+	Block &blockFor(int64 index) { return _blocks[index % _blocks.size()]; }
+	bool isLoaded(int64 index) { return blockFor(index).index == index; }
+	void fillBlock(int64 index);
+	void discardBlock(Block &block);
+
+public:
+	ReadAheadStreamImpl(SeekableReadStream *parentStream, uint32 blockSize, uint32 numBlocks, DisposeAfterUse::Flag disposeParentStream, bool background);
+	~ReadAheadStreamImpl() override;
+
+	bool eos() const override { return _eos; }
+	bool err() const override { return _err; }
+	void clearErr() override;
+
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+	bool seek(int64 offset, int whence = SEEK_SET) override;
+
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	Stats getStats() const override;
+	void resetStats() override;
+
+	/**
+	 * Fill the first missing block of the read-ahead window.
+	 * Called from the timer thread.
+	 *
+	 * @return The number of bytes read, 0 if there was nothing to read.
+	 */
+	uint32 prefetchBlock();
+};
+
+void ReadAheadScheduler::addStream(ReadAheadStreamImpl *stream) {
+	if (!g_readAheadScheduler) {
+		g_readAheadScheduler = new ReadAheadScheduler();
+		g_system->getTimerManager()->installTimerProc(&timerProc, kTimerInterval, g_readAheadScheduler, "readAheadStream");
+	}
+
+	StackLock lock(g_readAheadScheduler->_mutex);
+	g_readAheadScheduler->_streams.push_back(stream);
+}
+
+void ReadAheadScheduler::removeStream(ReadAheadStreamImpl *stream) {
+	assert(g_readAheadScheduler);
+
+	bool empty;
+	{
+		// Once the stream has been removed while holding the lock, the
+		// timer callback can not be prefetching for it anymore.
+		StackLock lock(g_readAheadScheduler->_mutex);
+		Array<ReadAheadStreamImpl *> &streams = g_readAheadScheduler->_streams;
+		for (uint i = 0; i < streams.size(); ++i) {
+			if (streams[i] == stream) {
+				streams.remove_at(i);
+				break;
+			}
+		}
+		empty = streams.empty();
+	}
+
+	if (empty) {
+		g_system->getTimerManager()->removeTimerProc(&timerProc);
+		delete g_readAheadScheduler;
+		g_readAheadScheduler = nullptr;
+	}
+}
+
+void ReadAheadScheduler::timerProc(void *refCon) {
+	ReadAheadScheduler *scheduler = (ReadAheadScheduler *)refCon;
+
+	// The parent streams are read on the timer thread, which also runs
+	// the callbacks of other subsystems, e.g. the music players. To not
+	// delay those on slow media, stop once a tick has read
+	// kMaxBytesPerTick or has taken kMaxTimePerTick. The streams take
+	// turns one block at a time, starting with another one each tick,
+	// so that all of them make progress even with large blocks.
+	StackLock lock(scheduler->_mutex);
+	const uint count = scheduler->_streams.size();
+	if (!count)
+		return;
+
+	const uint64 startTime = g_system->getMicros();
+	const uint first = scheduler->_firstStream++ % count;
+	uint32 bytes = 0;
+	bool pending = true;
+	while (pending) {
+		pending = false;
+		for (uint i = 0; i < count; ++i) {
+			const uint32 size = scheduler->_streams[(first + i) % count]->prefetchBlock();
+			if (!size)
+				continue;
+
+			pending = true;
+			bytes += size;
+			if (bytes >= kMaxBytesPerTick || g_system->getMicros() - startTime >= kMaxTimePerTick)
+				return;
+		}
+	}
+}
+
+ReadAheadStreamImpl::ReadAheadStreamImpl(SeekableReadStream *parentStream, uint32 blockSize, uint32 numBlocks, DisposeAfterUse::Flag disposeParentStream, bool background)
+	: _parentStream(parentStream, disposeParentStream),
+	_blockSize(blockSize),
+	_pos(parentStream->pos()),
+	_size(parentStream->size()),
+	_eos(false),
+	_err(false),
+	_background(background) {
+
+	assert(blockSize > 0 && numBlocks >= 2);
+
+	_buf = new byte[blockSize * numBlocks];
+	_blocks.resize(numBlocks);
+	for (uint i = 0; i < numBlocks; ++i) {
+		_blocks[i].index = -1;
+		_blocks[i].size = 0;
+		_blocks[i].used = false;
+		_blocks[i].data = _buf + i * blockSize;
+	}
+
+	resetStats();
+
+	if (_background)
+		ReadAheadScheduler::addStream(this);
+}
+
+ReadAheadStreamImpl::~ReadAheadStreamImpl() {
+	if (_background)
+		ReadAheadScheduler::removeStream(this);
+
+	delete[] _buf;
+}
+
+void ReadAheadStreamImpl::discardBlock(Block &block) {
+	if (block.index >= 0 && !block.used)
+		_stats.discards++;
+	block.index = -1;
+	block.size = 0;
+}
+
+void ReadAheadStreamImpl::fillBlock(int64 index) {
+	Block &block = blockFor(index);
+	discardBlock(block);
+
+	const int64 start = index * _blockSize;
+	if (!_parentStream->seek(start)) {
+		_err = true;
+		return;
+	}
+
+	block.size = _parentStream->read(block.data, (uint32)MIN<int64>(_blockSize, _size - start));
+	if (_parentStream->err()) {
+		_err = true;
+		return;
+	}
+	block.index = index;
+	block.used = false;
+}
+
+uint32 ReadAheadStreamImpl::prefetchBlock() {
+	StackLock lock(_mutex);
+
+	if (_err)
+		return 0;
+
+	const int64 first = _pos / _blockSize;
+	for (int64 index = first; index < first + (int64)_blocks.size(); ++index) {
+		if (index * _blockSize >= _size)
+			break;
+
+		if (!isLoaded(index)) {
+			fillBlock(index);
+			_stats.prefetches++;
+			return _err ? 0 : blockFor(index).size;
+		}
+	}
+
+	return 0;
+}
+
+uint32 ReadAheadStreamImpl::read(void *dataPtr, uint32 dataSize) {
+	StackLock lock(_mutex);
+
+	uint32 alreadyRead = 0;
+	while (dataSize > 0) {
+		if (_pos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		const int64 index = _pos / _blockSize;
+		if (isLoaded(index)) {
+			_stats.hits++;
+		} else {
+			_stats.stalls++;
+			fillBlock(index);
+			if (_err)
+				break;
+		}
+
+		Block &block = blockFor(index);
+		const uint32 offset = (uint32)(_pos - index * _blockSize);
+		if (offset >= block.size) {
+			// The parent stream ended before its reported size
+			_eos = true;
+			break;
+		}
+
+		const uint32 n = MIN(dataSize, block.size - offset);
+		memcpy(dataPtr, block.data + offset, n);
+		block.used = true;
+
+		dataPtr = (byte *)dataPtr + n;
+		dataSize -= n;
+		alreadyRead += n;
+		_pos += n;
+	}
+
+	return alreadyRead;
+}
+
+bool ReadAheadStreamImpl::seek(int64 offset, int whence) {
+	StackLock lock(_mutex);
+
+	int64 newPos = offset;
+	if (whence == SEEK_CUR)
+		newPos = _pos + offset;
+	else if (whence == SEEK_END)
+		newPos = _size + offset;
+
+	if (newPos < 0 || newPos > _size)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+
+	// Drop all blocks outside of the new read-ahead window, so that the
+	// prefetcher starts over at the new position.
+	const int64 first = _pos / _blockSize;
+	for (uint i = 0; i < _blocks.size(); ++i) {
+		Block &block = _blocks[i];
+		if (block.index >= 0 && (block.index < first || block.index >= first + (int64)_blocks.size()))
+			discardBlock(block);
+	}
+
+	return true;
+}
+
+void ReadAheadStreamImpl::clearErr() {
+	StackLock lock(_mutex);
+
+	_eos = false;
+	_err = false;
+	_parentStream->clearErr();
+}
+
+ReadAheadStream::Stats ReadAheadStreamImpl::getStats() const {
+	StackLock lock(_mutex);
+	return _stats;
+}
+
+void ReadAheadStreamImpl::resetStats() {
+	StackLock lock(_mutex);
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+} // End of anonymous namespace
+
+ReadAheadStream *wrapReadAheadStream(SeekableReadStream *parentStream, uint32 blockSize, uint32 numBlocks, DisposeAfterUse::Flag disposeParentStream, bool background) {
+	if (parentStream)
+		return new ReadAheadStreamImpl(parentStream, blockSize, numBlocks, disposeParentStream, background);
+	return nullptr;
+}
+
+#pragma mark -
+
+namespace {
+
 /**
  * Wrapper class which adds buffering to any WriteStream.
  */
@@ -661,6 +661,96 @@ public:
 		return READ_BE_FLOAT64(val);
 	}
 
+	/**
+	 * Read an array of @p count unsigned 16-bit words stored in little
+	 * endian (LSB first) order from the stream and store them in native
+	 * endianness in @p dst.
+	 *
+	 * The whole array is read with a single read() call and byte-swapped
+	 * in place afterwards if necessary, which is much faster than reading
+	 * the values one by one.
+	 *
+	 * @return The number of values which could be read completely. If
+	 *         this is less than @p count, check err() and eos().
+	 */
+	uint32 readArrayUint16LE(uint16 *dst, uint32 count);
+
+	/**
+	 * Read an array of unsigned 16-bit words stored in big endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayUint16BE(uint16 *dst, uint32 count);
+
+	/**
+	 * Read an array of unsigned 32-bit words stored in little endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayUint32LE(uint32 *dst, uint32 count);
+
+	/**
+	 * Read an array of unsigned 32-bit words stored in big endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayUint32BE(uint32 *dst, uint32 count);
+
+	/**
+	 * Read an array of unsigned 64-bit words stored in little endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayUint64LE(uint64 *dst, uint32 count);
+
+	/**
+	 * Read an array of unsigned 64-bit words stored in big endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayUint64BE(uint64 *dst, uint32 count);
+
+	/**
+	 * Read an array of signed 16-bit words stored in little endian order.
+	 * @see readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint16LE(int16 *dst, uint32 count) {
+		return readArrayUint16LE((uint16 *)dst, count);
+	}
+
+	/**
+	 * Read an array of signed 16-bit words stored in big endian order.
+	 * @see readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint16BE(int16 *dst, uint32 count) {
+		return readArrayUint16BE((uint16 *)dst, count);
+	}
+
+	/**
+	 * Read an array of signed 32-bit words stored in little endian order.
+	 * @see readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint32LE(int32 *dst, uint32 count) {
+		return readArrayUint32LE((uint32 *)dst, count);
+	}
+
+	/**
+	 * Read an array of signed 32-bit words stored in big endian order.
+	 * @see readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint32BE(int32 *dst, uint32 count) {
+		return readArrayUint32BE((uint32 *)dst, count);
+	}
+
+	/**
+	 * Read an array of 32-bit floating point values stored in little
+	 * endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayFloatLE(float *dst, uint32 count);
+
+	/**
+	 * Read an array of 32-bit floating point values stored in big
+	 * endian order.
+	 * @see readArrayUint16LE
+	 */
+	uint32 readArrayFloatBE(float *dst, uint32 count);
+
 	/**
 	 * Read multiple values from the stream using a specified data format,
 	 * return true on success and false on failure.
@@ -935,6 +1025,51 @@ public:
 		read(val, 8);
 		return (_bigEndian) ? READ_BE_FLOAT64(val) : READ_LE_FLOAT64(val);
 	}
+
+	/**
+	 * Read an array of unsigned 16-bit words using the stream endianness
+	 * and store them in native endianness.
+	 * @see ReadStream::readArrayUint16LE
+	 */
+	uint32 readArrayUint16(uint16 *dst, uint32 count) {
+		return (_bigEndian) ? readArrayUint16BE(dst, count) : readArrayUint16LE(dst, count);
+	}
+
+	/**
+	 * Read an array of unsigned 32-bit words using the stream endianness
+	 * and store them in native endianness.
+	 * @see ReadStream::readArrayUint16LE
+	 */
+	uint32 readArrayUint32(uint32 *dst, uint32 count) {
+		return (_bigEndian) ? readArrayUint32BE(dst, count) : readArrayUint32LE(dst, count);
+	}
+
+	/**
+	 * Read an array of signed 16-bit words using the stream endianness
+	 * and store them in native endianness.
+	 * @see ReadStream::readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint16(int16 *dst, uint32 count) {
+		return readArrayUint16((uint16 *)dst, count);
+	}
+
+	/**
+	 * Read an array of signed 32-bit words using the stream endianness
+	 * and store them in native endianness.
+	 * @see ReadStream::readArrayUint16LE
+	 */
+	FORCEINLINE uint32 readArraySint32(int32 *dst, uint32 count) {
+		return readArrayUint32((uint32 *)dst, count);
+	}
+
+	/**
+	 * Read an array of 32-bit floating point values using the stream
+	 * endianness and store them in native endianness.
+	 * @see ReadStream::readArrayUint16LE
+	 */
+	uint32 readArrayFloat(float *dst, uint32 count) {
+		return (_bigEndian) ? readArrayFloatBE(dst, count) : readArrayFloatLE(dst, count);
+	}
 };
 
 /**
@@ -1510,6 +1510,16 @@ public:
 	 */
 	virtual uint32 getMillis(bool skipRecord = false) = 0;
 
+	/**
+	 * Get the number of microseconds since an arbitrary point in time.
+	 *
+	 * This is meant for measuring short durations, e.g. for profiling, and
+	 * is never recorded by the event recorder. The default implementation
+	 * only has the resolution of getMillis(), backends with a more precise
+	 * timer should override it.
+	 */
+	virtual uint64 getMicros() { return (uint64)getMillis(true) * 1000; }
+
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
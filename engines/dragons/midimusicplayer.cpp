@@ -19,10 +19,11 @@
  *
  */
 #include "common/debug.h"
-#include "common/memstream.h"
 #include "common/stream.h"
 #include "audio/midiparser.h"
 #include "audio/soundfont/rawfile.h"
+#include "audio/soundfont/sf2file.h"
+#include "audio/soundfont/sf2stream.h"
 #include "audio/soundfont/vab/vab.h"
 #include "audio/soundfont/vgmcoll.h"
 #include "midimusicplayer.h"
@@ -171,15 +172,17 @@ Common::SeekableReadStream *MidiMusicPlayer::loadSoundFont(BigfileArchive *bigFi
 	Vab *vab = new Vab(memFile, 0);
 	vab->LoadVGMFile();
 	VGMColl vabCollection;
-	SF2File *file = vabCollection.CreateSF2File(vab);
-	const byte *bytes = (const byte *)file->SaveToMem();
-	uint32 size = file->GetSize();
-
-	delete file;
-	delete vab;
-	delete memFile;
+	SF2File *file = vabCollection.CreateSF2File(vab, true);
+	if (!file) {
+		delete vab;
+		delete memFile;
+		return nullptr;
+	}
 
-	return new Common::MemoryReadStream(bytes, size, DisposeAfterUse::YES);
+	// The samples are decoded from the VAB when FluidSynth loads them
+	SF2SampleStream *stream = new SF2SampleStream(file);
+	stream->setSourceFiles(vab, memFile);
+	return stream;
 }
 
 } // End of namespace Dragons
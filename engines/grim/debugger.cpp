@@ -22,6 +22,9 @@
 #include "common/config-manager.h"
 
 #include "graphics/renderer.h"
+#if defined(USE_TINYGL)
+#include "graphics/tinygl/tinygl.h"
+#endif
 
 #include "engines/grim/debugger.h"
 #include "engines/grim/md5check.h"
@@ -39,6 +42,7 @@ Debugger::Debugger() :
 	registerCmd("renderer_get", WRAP_METHOD(Debugger, cmd_renderer_get));
 	registerCmd("save", WRAP_METHOD(Debugger, cmd_save));
 	registerCmd("load", WRAP_METHOD(Debugger, cmd_load));
+	registerCmd("tinygl_stats", WRAP_METHOD(Debugger, cmd_tinygl_stats));
 }
 
 Debugger::~Debugger() {
@@ -134,4 +138,37 @@ bool Debugger::cmd_load(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_tinygl_stats(int argc, const char **argv) {
+#if defined(USE_TINYGL)
+	if (g_grim->getRendererType() != Graphics::kRendererTypeTinyGL) {
+		debugPrintf("The statistics are only available with the software renderer\n");
+		return true;
+	}
+	if (argc < 2) {
+		debugPrintf("Usage: tinygl_stats <on|off|show|dump <file>>\n");
+		return true;
+	}
+
+	if (!strcmp(argv[1], "on")) {
+		TinyGL::enableProfiling(true);
+		debugPrintf("The statistics are gathered from the next frame\n");
+	} else if (!strcmp(argv[1], "off")) {
+		TinyGL::enableProfiling(false);
+	} else if (!strcmp(argv[1], "show")) {
+		debugPrintf("%s", TinyGL::formatFrameStats(10).c_str());
+	} else if (!strcmp(argv[1], "dump") && argc >= 3) {
+		if (TinyGL::dumpFrameStats(argv[2])) {
+			debugPrintf("The statistics of the last frame were written to '%s'\n", argv[2]);
+		} else {
+			debugPrintf("Unable to write to '%s'\n", argv[2]);
+		}
+	} else {
+		debugPrintf("Usage: tinygl_stats <on|off|show|dump <file>>\n");
+	}
+#else
+	debugPrintf("TinyGL is not available in this build\n");
+#endif
+	return true;
+}
+
 }
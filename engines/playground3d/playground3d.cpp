@@ -59,7 +59,7 @@ Playground3dEngine::Playground3dEngine(OSystem *syst)
 		_clearColor(0.0f, 0.0f, 0.0f, 1.0f), _fogColor(0.0f, 0.0f, 0.0f, 1.0f),
         _fade(1.0f), _fadeIn(false),
 		_rgbaTexture(nullptr), _rgbTexture(nullptr), _rgb565Texture(nullptr),
-		_rgba5551Texture(nullptr), _rgba4444Texture(nullptr) {
+		_rgba5551Texture(nullptr), _rgba4444Texture(nullptr), _benchmark(false) {
 }
 
 Playground3dEngine::~Playground3dEngine() {
@@ -75,13 +75,36 @@ Common::Error Playground3dEngine::run() {
 
 	_system->showMouse(true);
 
-	// 1 - rotated colorfull cube
-	// 2 - rotated two triangles with depth offset
-	// 3 - fade in/out
-	// 4 - moving filled rectangle in viewport
-	// 5 - drawing RGBA pattern texture to check endian correctness
-	int testId = 1;
-	_fogEnable = false;
+	const int benchmarkFrames = ConfMan.getInt("benchmark");
+	if (benchmarkFrames > 0) {
+		runBenchmark(benchmarkFrames);
+	} else {
+		// 1 - rotated colorfull cube
+		// 2 - rotated two triangles with depth offset
+		// 3 - fade in/out
+		// 4 - moving filled rectangle in viewport
+		// 5 - drawing RGBA pattern texture to check endian correctness
+		int testId = 1;
+		_fogEnable = false;
+		setupTest(testId);
+
+		while (!shouldQuit()) {
+			processInput();
+			drawFrame(testId);
+		}
+	}
+
+	freeTextures();
+	_gfx->deinit();
+	_system->showMouse(false);
+
+	return Common::kNoError;
+}
+
+void Playground3dEngine::setupTest(int testId) {
+	_rotateAngleX = 0, _rotateAngleY = 0, _rotateAngleZ = 0;
+	_fade = 1.0f;
+	_fadeIn = false;
 
 	if (_fogEnable) {
 		_fogColor = Math::Vector4d(1.0f, 1.0f, 1.0f, 1.0f);
@@ -123,21 +146,60 @@ Common::Error Playground3dEngine::run() {
 		default:
 			assert(false);
 	}
+}
 
-	while (!shouldQuit()) {
-		processInput();
-		drawFrame(testId);
-	}
-
+void Playground3dEngine::freeTextures() {
 	delete _rgbaTexture;
 	delete _rgbTexture;
 	delete _rgb565Texture;
 	delete _rgba5551Texture;
 	delete _rgba4444Texture;
-	_gfx->deinit();
-	_system->showMouse(false);
+	_rgbaTexture = nullptr;
+	_rgbTexture = nullptr;
+	_rgb565Texture = nullptr;
+	_rgba5551Texture = nullptr;
+	_rgba4444Texture = nullptr;
+}
 
-	return Common::kNoError;
+void Playground3dEngine::runBenchmark(int frames) {
+	// The renderers never disable the fog, so the fog scene comes last
+	static const struct {
+		int testId;
+		bool fog;
+		const char *name;
+	} scenes[] = {
+		{ 1, false, "rotated cube" },
+		{ 2, false, "polygon offset" },
+		{ 3, false, "fade in/out" },
+		{ 4, false, "viewport" },
+		{ 5, false, "textures" },
+		{ 1, true, "rotated cube with fog" }
+	};
+
+	_benchmark = true;
+	uint32 totalTime = 0;
+	int totalFrames = 0;
+	for (int i = 0; i < ARRAYSIZE(scenes) && !shouldQuit(); i++) {
+		_fogEnable = scenes[i].fog;
+		setupTest(scenes[i].testId);
+
+		const uint32 startTime = _system->getMillis();
+		int frame = 0;
+		for (; frame < frames && !shouldQuit(); frame++) {
+			processInput();
+			drawFrame(scenes[i].testId);
+		}
+		const uint32 time = _system->getMillis() - startTime;
+		freeTextures();
+
+		totalTime += time;
+		totalFrames += frame;
+		_system->logMessage(LogMessageType::kInfo, Common::String::format("Playground3d benchmark: %s: %d frames in %u ms, %.1f frames/s\n",
+		                                                                  scenes[i].name, frame, time, frame * 1000.0f / MAX<uint32>(time, 1)).c_str());
+	}
+	_system->logMessage(LogMessageType::kInfo, Common::String::format("Playground3d benchmark: total: %d frames in %u ms, %.1f frames/s\n",
+	                                                                  totalFrames, totalTime, totalFrames * 1000.0f / MAX<uint32>(totalTime, 1)).c_str());
+	_benchmark = false;
 }
 
 void Playground3dEngine::processInput() {
@@ -259,9 +321,12 @@ void Playground3dEngine::drawFrame(int testId) {
 
 	_gfx->flipBuffer();
 
-	_frameLimiter->delayBeforeSwap();
+	// The benchmark draws as fast as possible
+	if (!_benchmark)
+		_frameLimiter->delayBeforeSwap();
 	_system->updateScreen();
-	_frameLimiter->startFrame();
+	if (!_benchmark)
+		_frameLimiter->startFrame();
 }
 
 } // End of namespace Playground3d
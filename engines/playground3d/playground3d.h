@@ -59,9 +59,13 @@ private:
 	Graphics::Surface *_rgb565Texture;
 	Graphics::Surface *_rgba5551Texture;
 	Graphics::Surface *_rgba4444Texture;
+	bool _benchmark;
 
 	float _rotateAngleX, _rotateAngleY, _rotateAngleZ;
 
+	void setupTest(int testId);
+	void freeTextures();
+	void runBenchmark(int frames);
 	Graphics::Surface *generateRgbaTexture(int width, int height, Graphics::PixelFormat format);
 	void drawAndRotateCube();
 	void drawPolyOffsetTest();
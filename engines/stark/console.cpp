@@ -22,6 +22,9 @@
 #include "engines/stark/console.h"
 
 #include "engines/stark/formats/xarc.h"
+#if defined(USE_TINYGL)
+#include "engines/stark/gfx/tinygl.h"
+#endif
 #include "engines/stark/resources/object.h"
 #include "engines/stark/resources/anim.h"
 #include "engines/stark/resources/level.h"
@@ -70,6 +73,7 @@ Console::Console() :
 	registerCmd("changeKnowledge",      WRAP_METHOD(Console, Cmd_ChangeKnowledge));
 	registerCmd("enableInventoryItem",  WRAP_METHOD(Console, Cmd_EnableInventoryItem));
 	registerCmd("extractAllTextures",   WRAP_METHOD(Console, Cmd_ExtractAllTextures));
+	registerCmd("tinygl_stats",         WRAP_METHOD(Console, Cmd_TinyGLStats));
 }
 
 Console::~Console() {
@@ -507,6 +511,37 @@ bool Console::Cmd_ExtractAllTextures(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_TinyGLStats(int argc, const char **argv) {
+#if defined(USE_TINYGL)
+	if (!dynamic_cast<Gfx::TinyGLDriver *>(StarkGfx)) {
+		debugPrintf("The statistics are only available with the software renderer\n");
+		return true;
+	}
+
+	if (argc >= 2 && !strcmp(argv[1], "on")) {
+		TinyGL::enableProfiling(true);
+		debugPrintf("The statistics are gathered from the next frame\n");
+	} else if (argc >= 2 && !strcmp(argv[1], "off")) {
+		TinyGL::enableProfiling(false);
+	} else if (argc >= 2 && !strcmp(argv[1], "show")) {
+		debugPrintf("%s", TinyGL::formatFrameStats(10).c_str());
+	} else if (argc >= 3 && !strcmp(argv[1], "dump")) {
+		if (TinyGL::dumpFrameStats(argv[2])) {
+			debugPrintf("The statistics of the last frame were written to '%s'\n", argv[2]);
+		} else {
+			debugPrintf("Unable to write to '%s'\n", argv[2]);
+		}
+	} else {
+		debugPrintf("Show the rendering statistics of the software renderer\n");
+		debugPrintf("Usage :\n");
+		debugPrintf("tinygl_stats [on|off|show|dump <file>]\n");
+	}
+#else
+	debugPrintf("TinyGL is not available in this build\n");
+#endif
+	return true;
+}
+
 Common::Array<Resources::Anim *> Console::listAllLocationAnimations() const {
 	Common::Array<Resources::Anim *> animations;
 
@@ -95,6 +95,19 @@ MODULE_OBJS += \
 	tinygl/ztriangle.o \
 	tinygl/zblit.o \
 	tinygl/zdirtyrect.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	tinygl/zblitrow-sse2.o \
+	tinygl/zspan-sse2.o \
+	tinygl/ztransform-sse2.o
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	tinygl/zblitrow-avx2.o \
+	tinygl/zspan-avx2.o \
+	tinygl/ztransform-avx2.o
+endif
 endif
 
 ifdef USE_ASPECT
@@ -38,10 +38,11 @@
 
 namespace TinyGL {
 
-void GLContext::glopArrayElement(GLParam *param) {
+// Set the current color, normal and texture coordinates from the arrays,
+// and return whether the vertex array gives a vertex
+bool GLContext::gl_fetch_array_element(int idx, GLParam *vertex_param) {
 	int offset;
 	int states = client_states;
-	int idx = param[1].i;
 
 	if (states & COLOR_ARRAY) {
 		GLParam p[5];
@@ -194,64 +195,86 @@ void GLContext::glopArrayElement(GLParam *param) {
 		}
 	}
 	if (states & VERTEX_ARRAY) {
-		GLParam p[5];
 		int size = vertex_array_size;
 		offset = idx * vertex_array_stride;
 		switch (vertex_array_type) {
 		case TGL_FLOAT: {
 				TGLfloat *array = (TGLfloat *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				vertex_param[1].f = array[0];
+				vertex_param[2].f = array[1];
+				vertex_param[3].f = size > 2 ? array[2] : 0.0f;
+				vertex_param[4].f = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_DOUBLE: {
 				TGLdouble *array = (TGLdouble *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				vertex_param[1].f = array[0];
+				vertex_param[2].f = array[1];
+				vertex_param[3].f = size > 2 ? array[2] : 0.0f;
+				vertex_param[4].f = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_INT: {
 				TGLint *array = (TGLint *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				vertex_param[1].f = array[0];
+				vertex_param[2].f = array[1];
+				vertex_param[3].f = size > 2 ? array[2] : 0.0f;
+				vertex_param[4].f = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_SHORT: {
 				TGLshort *array = (TGLshort *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				vertex_param[1].f = array[0];
+				vertex_param[2].f = array[1];
+				vertex_param[3].f = size > 2 ? array[2] : 0.0f;
+				vertex_param[4].f = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		default:
 			assert(0);
 		}
-		glopVertex(p);
+		return true;
+	}
+	return false;
+}
+
+void GLContext::gl_draw_array_element(int idx, bool batched) {
+	GLParam p[5];
+
+	if (gl_fetch_array_element(idx, p)) {
+		if (batched)
+			gl_add_vertex(p);
+		else
+			glopVertex(p);
 	}
 }
 
+// The vertices of the arrays are transformed together, unless each of them
+// changes the lighting through the color material.
+bool GLContext::gl_can_batch_array_elements() const {
+	return !(lighting_enabled && color_material_enabled && (client_states & COLOR_ARRAY));
+}
+
+void GLContext::glopArrayElement(GLParam *param) {
+	gl_draw_array_element(param[1].i, false);
+}
+
 void GLContext::glopDrawArrays(GLParam *p) {
-	GLParam array_element[2];
 	GLParam begin[2];
 
 	begin[1].i = p[1].i;
 	glopBegin(begin);
+	bool batched = gl_can_batch_array_elements();
 	for (int i = 0; i < p[3].i; i++) {
-		array_element[1].i = p[2].i + i;
-		glopArrayElement(array_element);
+		gl_draw_array_element(p[2].i + i, batched);
 	}
+	if (batched)
+		gl_transform_vertices(vertex, vertex_n);
 	glopEnd(nullptr);
 }
 
 void GLContext::glopDrawElements(GLParam *p) {
-	GLParam array_element[2];
+	int idx;
 	void *indices;
 	GLParam begin[2];
 
@@ -259,23 +282,27 @@ void GLContext::glopDrawElements(GLParam *p) {
 	begin[1].i = p[1].i;
 
 	glopBegin(begin);
+	bool batched = gl_can_batch_array_elements();
 	for (int i = 0; i < p[2].i; i++) {
 		switch (p[3].i) {
 		case TGL_UNSIGNED_BYTE:
-			array_element[1].i = ((TGLbyte *)indices)[i];
+			idx = ((TGLbyte *)indices)[i];
 			break;
 		case TGL_UNSIGNED_SHORT:
-			array_element[1].i = ((TGLshort *)indices)[i];
+			idx = ((TGLshort *)indices)[i];
 			break;
 		case TGL_UNSIGNED_INT:
-			array_element[1].i = ((TGLint *)indices)[i];
+			idx = ((TGLint *)indices)[i];
 			break;
 		default:
 			assert(0);
+			idx = 0;
 			break;
 		}
-		glopArrayElement(array_element);
+		gl_draw_array_element(idx, batched);
 	}
+	if (batched)
+		gl_transform_vertices(vertex, vertex_n);
 	glopEnd(nullptr);
 }
 
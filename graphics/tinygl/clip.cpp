@@ -45,6 +45,10 @@ void GLContext::gl_transform_to_viewport(GLVertex *v) {
 	v->zp.y = (int)(v->pc.Y * winv * viewport.scale.Y + viewport.trans.Y);
 	v->zp.z = (int)(v->pc.Z * winv * viewport.scale.Z + viewport.trans.Z);
 
+	gl_transform_attributes_to_viewport(v);
+}
+
+void GLContext::gl_transform_attributes_to_viewport(GLVertex *v) {
 	// color
 	v->zp.r = (int)(v->color.X * ZB_POINT_RED_MAX);
 	v->zp.g = (int)(v->color.Y * ZB_POINT_GREEN_MAX);
@@ -231,6 +235,9 @@ static inline void updateTmp(GLContext *c, GLVertex *q, GLVertex *p0, GLVertex *
 		q->tex_coord.Y = (p0->tex_coord.Y + (p1->tex_coord.Y - p0->tex_coord.Y) * t);
 	}
 
+	if (c->fog_enabled)
+		q->fog_factor = p0->fog_factor + (p1->fog_factor - p0->fog_factor) * t;
+
 	q->clip_code = gl_clipcode(q->pc.X, q->pc.Y, q->pc.Z, q->pc.W);
 	if (q->clip_code == 0)
 		c->gl_transform_to_viewport(q);
@@ -240,6 +247,9 @@ void GLContext::gl_draw_triangle(GLVertex *p0, GLVertex *p1, GLVertex *p2) {
 	int co, c_and, cc[3], front;
 	float norm;
 
+	if (_profilingEnabled)
+		_frameStats.trianglesIn++;
+
 	cc[0] = p0->clip_code;
 	cc[1] = p1->clip_code;
 	cc[2] = p2->clip_code;
@@ -297,6 +307,9 @@ void GLContext::gl_draw_triangle_clip(GLVertex *p0, GLVertex *p1, GLVertex *p2,
 
 	co = cc[0] | cc[1] | cc[2];
 	if (co == 0) {
+		// The pieces of a clipped triangle are not counted as submitted
+		if (_profilingEnabled)
+			_frameStats.trianglesIn--;
 		gl_draw_triangle(p0, p1, p2);
 	} else {
 		c_and = cc[0] & cc[1] & cc[2];
@@ -375,11 +388,46 @@ void GLContext::gl_draw_triangle_select(GLContext *c, GLVertex *p0, GLVertex *p1
 	c->gl_add_select1(p0->zp.z, p1->zp.z, p2->zp.z);
 }
 
-int count_triangles, count_triangles_textured, count_pixels;
+// Pick the mipmap levels from the ratio between the areas the triangle
+// covers in level 0 texels and in pixels: one level per halving of each
+// direction.
+static void setTriangleTexture(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2) {
+	const GLTexture *texture = c->current_texture;
+	const TexelBuffer *level0 = texture->images[0].pixmap;
+	const int filter = c->texture_min_filter;
+	if (!texture->images[1].pixmap || filter == TGL_NEAREST || filter == TGL_LINEAR) {
+		c->fb->setTexture(level0, c->texture_wrap_s, c->texture_wrap_t);
+		return;
+	}
+
+	const float pixelArea = fabsf((float)(p1->zp.x - p0->zp.x) * (p2->zp.y - p0->zp.y) -
+	                              (float)(p2->zp.x - p0->zp.x) * (p1->zp.y - p0->zp.y));
+	const float texelArea = fabsf((p1->tex_coord.X - p0->tex_coord.X) * (p2->tex_coord.Y - p0->tex_coord.Y) -
+	                              (p2->tex_coord.X - p0->tex_coord.X) * (p1->tex_coord.Y - p0->tex_coord.Y)) *
+	                        level0->getWidth() * level0->getHeight();
+	float lod = 0.0f;
+	if (pixelArea > 0.0f && texelArea > pixelArea)
+		lod = logf(texelArea / pixelArea) * (float)(0.5 * M_LOG2E);
+
+	int maxLevel = 1;
+	while (maxLevel + 1 < MAX_TEXTURE_LEVELS && texture->images[maxLevel + 1].pixmap)
+		maxLevel++;
+
+	int level;
+	uint lodFraction = 0;
+	if (filter == TGL_NEAREST_MIPMAP_NEAREST || filter == TGL_LINEAR_MIPMAP_NEAREST) {
+		level = MIN((int)(lod + 0.5f), maxLevel);
+	} else {
+		level = MIN((int)lod, maxLevel);
+		if (level < maxLevel)
+			lodFraction = (uint)((lod - level) * 256.0f);
+	}
+	c->fb->setTexture(texture->images[level].pixmap, c->texture_wrap_s, c->texture_wrap_t,
+	                  lodFraction ? texture->images[level + 1].pixmap : nullptr, lodFraction);
+}
 
 void GLContext::gl_draw_triangle_fill(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2) {
 	if (c->_profilingEnabled) {
-		int norm;
 		assert(p0->zp.x >= 0 && p0->zp.x < c->fb->getPixelBufferWidth());
 		assert(p0->zp.y >= 0 && p0->zp.y < c->fb->getPixelBufferHeight());
 		assert(p1->zp.x >= 0 && p1->zp.x < c->fb->getPixelBufferWidth());
@@ -387,19 +435,16 @@ void GLContext::gl_draw_triangle_fill(GLContext *c, GLVertex *p0, GLVertex *p1,
 		assert(p2->zp.x >= 0 && p2->zp.x < c->fb->getPixelBufferWidth());
 		assert(p2->zp.y >= 0 && p2->zp.y < c->fb->getPixelBufferHeight());
 
-		norm = (p1->zp.x - p0->zp.x) * (p2->zp.y - p0->zp.y) -
-				(p2->zp.x - p0->zp.x) * (p1->zp.y - p0->zp.y);
-		count_pixels += abs(norm) / 2;
-		count_triangles++;
+		c->_frameStats.trianglesOut++;
 	}
 
 	if (!c->color_mask_red && !c->color_mask_green && !c->color_mask_blue && !c->color_mask_alpha) {
 		c->fb->fillTriangleDepthOnly(&p0->zp, &p1->zp, &p2->zp);
 	} else if (c->texture_2d_enabled && c->current_texture->images[0].pixmap) {
 		if (c->_profilingEnabled) {
-			count_triangles_textured++;
+			c->_frameStats.texturedTriangles++;
 		}
-		c->fb->setTexture(c->current_texture->images[0].pixmap, c->texture_wrap_s, c->texture_wrap_t);
+		setTriangleTexture(c, p0, p1, p2);
 		if (c->current_shade_model == TGL_SMOOTH) {
 			c->fb->fillTriangleTextureMappingPerspectiveSmooth(&p0->zp, &p1->zp, &p2->zp);
 		} else {
@@ -415,6 +460,9 @@ void GLContext::gl_draw_triangle_fill(GLContext *c, GLVertex *p0, GLVertex *p1,
 // Render a clipped triangle in line mode
 
 void GLContext::gl_draw_triangle_line(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2) {
+	if (c->_profilingEnabled)
+		c->_frameStats.trianglesOut++;
+
 	if (c->depth_test_enabled) {
 		if (p0->edge_flag)
 			c->fb->fillLineZ(&p0->zp, &p1->zp);
@@ -434,6 +482,9 @@ void GLContext::gl_draw_triangle_line(GLContext *c, GLVertex *p0, GLVertex *p1,
 
 // Render a clipped triangle in point mode
 void GLContext::gl_draw_triangle_point(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2) {
+	if (c->_profilingEnabled)
+		c->_frameStats.trianglesOut++;
+
 	if (p0->edge_flag)
 		c->fb->plot(&p0->zp);
 	if (p1->edge_flag)
@@ -138,7 +138,8 @@ void GLContext::endSharedState() {
 	GLSharedState *s = &shared_state;
 
 	for (int i = 0; i < MAX_DISPLAY_LISTS; i++) {
-		// TODO
+		if (s->lists[i])
+			delete_list(i);
 	}
 	gl_free(s->lists);
 
@@ -181,6 +182,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	exec_flag = 1;
 	compile_flag = 0;
 	print_flag = 0;
+	current_list = nullptr;
 
 	in_begin = 0;
 
@@ -237,6 +239,8 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	maxTextureName = 0;
 	texture_mag_filter = TGL_LINEAR;
 	texture_min_filter = TGL_NEAREST_MIPMAP_LINEAR;
+	texture_wrap_s = TGL_REPEAT;
+	texture_wrap_t = TGL_REPEAT;
 #if defined(SCUMM_LITTLE_ENDIAN)
 	colorAssociationList.push_back({Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), TGL_RGBA, TGL_UNSIGNED_BYTE});
 	colorAssociationList.push_back({Graphics::PixelFormat(3, 8, 8, 8, 0, 0, 8, 16, 0),  TGL_RGB,  TGL_UNSIGNED_BYTE});
@@ -353,6 +357,8 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[1].initialize(drawCallMemorySize);
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
+	memset(&_frameStats, 0, sizeof(_frameStats));
+	_tileSize = 0;
 
 	TinyGL::Internal::tglBlitResetScissorRect();
 }
@@ -25,6 +25,7 @@
  * It also has modifications by the ResidualVM-team, which are covered under the GPLv2 (or later).
  */
 
+#include "common/hashmap.h"
 #include "common/streamdebug.h"
 
 #include "graphics/tinygl/zgl.h"
@@ -68,6 +69,14 @@ void GLContext::delete_list(int list) {
 		pb = pb1;
 	}
 
+	GLListPrimitive *prim = l->first_primitive;
+	while (prim) {
+		GLListPrimitive *prim1 = prim->next;
+		gl_free(prim->vertices);
+		gl_free(prim);
+		prim = prim1;
+	}
+
 	gl_free(l);
 	shared_state.lists[list] = nullptr;
 }
@@ -78,6 +87,7 @@ GLList *GLContext::alloc_list(int list) {
 
 	ob->next = nullptr;
 	l->first_op_buffer = ob;
+	l->first_primitive = nullptr;
 
 	ob->ops[0].op = OP_EndList;
 
@@ -164,6 +174,66 @@ void GLContext::glopNextBuffer(GLParam *) {
 	assert(0);
 }
 
+void GLContext::glopListPrimitive(GLParam *p) {
+	const GLListPrimitive *prim = (const GLListPrimitive *)p[1].p;
+	GLParam q[5];
+
+	q[1].i = prim->type;
+	glopBegin(q);
+
+	// With the color material, each color also sets the material
+	bool batched = !(prim->has_color && color_material_enabled);
+	for (int i = 0; i < prim->vertex_count; i++) {
+		const GLListVertex *v = &prim->vertices[i];
+
+		if (prim->has_color) {
+			if (batched) {
+				current_color = v->color;
+			} else {
+				q[1].f = v->color.X;
+				q[2].f = v->color.Y;
+				q[3].f = v->color.Z;
+				q[4].f = v->color.W;
+				glopColor(q);
+			}
+		}
+		if (prim->has_normal)
+			current_normal = v->normal;
+		if (prim->has_tex_coord)
+			current_tex_coord = v->tex_coord;
+		if (prim->has_edge_flag)
+			current_edge_flag = v->edge_flag;
+
+		q[1].f = v->coord.X;
+		q[2].f = v->coord.Y;
+		q[3].f = v->coord.Z;
+		q[4].f = v->coord.W;
+		if (batched)
+			gl_add_vertex(q);
+		else
+			glopVertex(q);
+	}
+	if (batched)
+		gl_transform_vertices(vertex, vertex_n);
+
+	glopEnd(nullptr);
+
+	// The attributes may change after the last vertex
+	if (prim->has_color) {
+		q[1].f = prim->last.color.X;
+		q[2].f = prim->last.color.Y;
+		q[3].f = prim->last.color.Z;
+		q[4].f = prim->last.color.W;
+		glopColor(q);
+	}
+	if (prim->has_normal)
+		current_normal = prim->last.normal;
+	if (prim->has_tex_coord)
+		current_tex_coord = prim->last.tex_coord;
+	if (prim->has_edge_flag)
+		current_edge_flag = prim->last.edge_flag;
+}
+
 void GLContext::glopCallList(GLParam *p) {
 	uint list = p[1].ui;
 	GLList *l = find_list(list);
@@ -185,6 +255,273 @@ void GLContext::glopCallList(GLParam *p) {
 	}
 }
 
+// Display list optimization
+
+// Ops which only set a state, so that they have no effect when repeated
+// with the same parameters
+static bool isStateOp(int op) {
+	switch (op) {
+	case OP_Color:
+	case OP_Normal:
+	case OP_TexCoord:
+	case OP_EdgeFlag:
+	case OP_ShadeModel:
+	case OP_CullFace:
+	case OP_FrontFace:
+	case OP_PolygonMode:
+	case OP_DepthMask:
+	case OP_DepthFunc:
+	case OP_BlendFunc:
+	case OP_AlphaFunc:
+	case OP_StencilMask:
+	case OP_BindTexture:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Ops which do not change the states of isStateOp() and glEnable()
+static bool isNeutralOp(int op) {
+	switch (op) {
+	case OP_Begin:
+	case OP_Vertex:
+	case OP_End:
+	case OP_MatrixMode:
+	case OP_LoadMatrix:
+	case OP_LoadIdentity:
+	case OP_MultMatrix:
+	case OP_PushMatrix:
+	case OP_PopMatrix:
+	case OP_Rotate:
+	case OP_Translate:
+	case OP_Scale:
+	case OP_Ortho:
+	case OP_Viewport:
+	case OP_Frustum:
+	case OP_Light:
+	case OP_LightModel:
+	case OP_Clear:
+	case OP_ClearColor:
+	case OP_ClearDepth:
+	case OP_ClearStencil:
+	case OP_InitNames:
+	case OP_PushName:
+	case OP_PopName:
+	case OP_LoadName:
+	case OP_TexImage2D:
+	case OP_TexEnv:
+	case OP_TexParameter:
+	case OP_ColorMask:
+	case OP_StencilFunc:
+	case OP_StencilOp:
+	case OP_Fog:
+	case OP_Hint:
+	case OP_PolygonOffset:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool isAttributeOp(int op) {
+	return op == OP_Color || op == OP_Normal || op == OP_TexCoord || op == OP_EdgeFlag;
+}
+
+static bool sameParams(const GLParam *p1, const GLParam *p2) {
+	if (p1[0].op != p2[0].op)
+		return false;
+	for (int i = 1; i < op_table_size[p1[0].op]; i++) {
+		if (p1[i].i != p2[i].i)
+			return false;
+	}
+	return true;
+}
+
+static GLParam *nextOp(GLParam *p) {
+	p += op_table_size[p[0].op];
+	if (p[0].op == OP_NextBuffer)
+		p = (GLParam *)p[1].p;
+	return p;
+}
+
+// The number of vertices of each primitive, for the types of which
+// consecutive blocks can be joined
+static int getPrimitiveSize(int type) {
+	switch (type) {
+	case TGL_POINTS:
+		return 1;
+	case TGL_LINES:
+		return 2;
+	case TGL_TRIANGLES:
+		return 3;
+	case TGL_QUADS:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+// Unpack the vertices of the glBegin/glEnd block starting at ops[index],
+// joined with the following blocks of the same type if they only contain
+// whole primitives. Return the index of the first op after them, or index
+// if the block contains other ops or sets attributes after its first
+// vertex which it doesn't set before.
+static uint unpackPrimitive(const Common::Array<GLParam> &ops, uint index, GLListPrimitive &prim, Common::Array<GLListVertex> &vertices) {
+	const int primitiveSize = getPrimitiveSize(ops[index + 1].i);
+	uint end = index;
+
+	prim.type = ops[index + 1].i;
+	prim.has_color = prim.has_normal = prim.has_tex_coord = prim.has_edge_flag = false;
+	prim.last.coord = prim.last.color = prim.last.normal = prim.last.tex_coord = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+	prim.last.edge_flag = 0;
+
+	while (end < ops.size() && ops[end].op == OP_Begin && ops[end + 1].i == prim.type) {
+		GLListPrimitive block = prim;
+		uint numVertices = vertices.size();
+		uint i = end + op_table_size[OP_Begin];
+		bool valid = true;
+
+		while (valid && i < ops.size() && ops[i].op != OP_End) {
+			const GLParam *p = &ops[i];
+			switch (p[0].op) {
+			case OP_Color:
+				valid = block.has_color || vertices.empty();
+				block.has_color = true;
+				block.last.color = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				break;
+			case OP_Normal:
+				valid = block.has_normal || vertices.empty();
+				block.has_normal = true;
+				block.last.normal = Vector4(p[1].f, p[2].f, p[3].f, 0.0f);
+				break;
+			case OP_TexCoord:
+				valid = block.has_tex_coord || vertices.empty();
+				block.has_tex_coord = true;
+				block.last.tex_coord = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				break;
+			case OP_EdgeFlag:
+				valid = block.has_edge_flag || vertices.empty();
+				block.has_edge_flag = true;
+				block.last.edge_flag = p[1].i;
+				break;
+			case OP_Vertex:
+				block.last.coord = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				vertices.push_back(block.last);
+				break;
+			default:
+				valid = false;
+				break;
+			}
+			i += op_table_size[p[0].op];
+		}
+
+		if (!valid || i >= ops.size() || (end != index && (vertices.size() - numVertices) % primitiveSize)) {
+			vertices.resize(numVertices);
+			break;
+		}
+
+		prim = block;
+		end = i + op_table_size[OP_End];
+		if (primitiveSize == 0 || vertices.size() % primitiveSize)
+			break;
+	}
+
+	if (vertices.empty())
+		return index;
+	return end;
+}
+
+// Drop the state changes which have no effect, and unpack the vertices of
+// the glBegin/glEnd blocks.
+void GLContext::gl_optimize_list(GLList *l) {
+	Common::Array<GLParam> ops;
+	const GLParam *state_ops[ARRAYSIZE(op_table_size)] = {};
+	Common::HashMap<int, int> enabled;
+
+	for (GLParam *p = l->first_op_buffer->ops; p[0].op != OP_EndList; p = nextOp(p)) {
+		const int op = p[0].op;
+
+		// Attributes set again by the next op
+		if (isAttributeOp(op) && nextOp(p)[0].op == op)
+			continue;
+
+		if (isStateOp(op)) {
+			if (state_ops[op] && sameParams(state_ops[op], p))
+				continue;
+			state_ops[op] = p;
+		} else if (op == OP_EnableDisable) {
+			if (enabled.contains(p[1].i) && enabled[p[1].i] == p[2].i)
+				continue;
+			enabled[p[1].i] = p[2].i;
+			if (p[1].i == TGL_COLOR_MATERIAL)
+				state_ops[OP_Color] = nullptr;
+		} else if (op == OP_Material || op == OP_ColorMaterial) {
+			// The color may set the material
+			state_ops[OP_Color] = nullptr;
+		} else if (op == OP_ArrayElement || op == OP_DrawArrays || op == OP_DrawElements) {
+			state_ops[OP_Color] = nullptr;
+			state_ops[OP_Normal] = nullptr;
+			state_ops[OP_TexCoord] = nullptr;
+		} else if (!isNeutralOp(op)) {
+			memset(state_ops, 0, sizeof(state_ops));
+			enabled.clear();
+		}
+
+		for (int i = 0; i < op_table_size[op]; i++)
+			ops.push_back(p[i]);
+	}
+
+	// Write the list again, the old ops stay valid until it is done
+	GLParamBuffer *old_op_buffer = l->first_op_buffer;
+	l->first_op_buffer = (GLParamBuffer *)gl_zalloc(sizeof(GLParamBuffer));
+	l->first_op_buffer->next = nullptr;
+	current_op_buffer = l->first_op_buffer;
+	current_op_buffer_index = 0;
+
+	Common::Array<GLListVertex> vertices;
+	GLListPrimitive **last_primitive = &l->first_primitive;
+	uint i = 0;
+	while (i < ops.size()) {
+		if (ops[i].op == OP_Begin) {
+			GLListPrimitive prim;
+			vertices.clear();
+			uint end = unpackPrimitive(ops, i, prim, vertices);
+			if (end != i) {
+				prim.vertex_count = vertices.size();
+				prim.vertices = (GLListVertex *)gl_malloc(vertices.size() * sizeof(GLListVertex));
+				memcpy(prim.vertices, vertices.data(), vertices.size() * sizeof(GLListVertex));
+				prim.next = nullptr;
+
+				GLListPrimitive *new_prim = (GLListPrimitive *)gl_malloc(sizeof(GLListPrimitive));
+				*new_prim = prim;
+				*last_primitive = new_prim;
+				last_primitive = &new_prim->next;
+
+				GLParam p[2];
+				p[0].op = OP_ListPrimitive;
+				p[1].p = new_prim;
+				gl_compile_op(p);
+				i = end;
+				continue;
+			}
+		}
+
+		gl_compile_op(&ops[i]);
+		i += op_table_size[ops[i].op];
+	}
+
+	GLParam p[1];
+	p[0].op = OP_EndList;
+	gl_compile_op(p);
+
+	while (old_op_buffer) {
+		GLParamBuffer *next = old_op_buffer->next;
+		gl_free(old_op_buffer);
+		old_op_buffer = next;
+	}
+}
+
 void GLContext::gl_NewList(TGLuint list, TGLenum mode) {
 	assert(mode == TGL_COMPILE || mode == TGL_COMPILE_AND_EXECUTE);
 	assert(compile_flag == 0);
@@ -194,6 +531,7 @@ void GLContext::gl_NewList(TGLuint list, TGLenum mode) {
 		delete_list(list);
 	l = alloc_list(list);
 
+	current_list = l;
 	current_op_buffer = l->first_op_buffer;
 	current_op_buffer_index = 0;
 
@@ -210,6 +548,8 @@ void GLContext::gl_EndList() {
 	p[0].op = OP_EndList;
 	gl_compile_op(p);
 
+	gl_optimize_list(current_list);
+
 	compile_flag = 0;
 	exec_flag = 1;
 }
@@ -92,6 +92,7 @@ ADD_OP(Hint, 2, "%C %C")
 // special opcodes
 ADD_OP(EndList, 0, "")
 ADD_OP(NextBuffer, 1, "%p")
+ADD_OP(ListPrimitive, 1, "%p")
 
 // opengl 1.1 arrays
 ADD_OP(ArrayElement, 1, "%d")
@@ -31,6 +31,11 @@ namespace TinyGL {
 #define ZB_POINT_ST_UNIT (1 << ZB_POINT_ST_FRAC_BITS)
 #define ZB_POINT_ST_FRAC_MASK (ZB_POINT_ST_UNIT - 1)
 
+// 4x4 texels tiles, 64 bytes for 32 bits formats
+#define TEXEL_TILE_SHIFT 2
+#define TEXEL_TILE_SIZE (1 << TEXEL_TILE_SHIFT)
+#define TEXEL_TILE_MASK (TEXEL_TILE_SIZE - 1)
+
 TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize) {
 	assert(width);
 	assert(height);
@@ -42,6 +47,13 @@ TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize) {
 	_fracTextureMask = _fracTextureUnit - 1;
 	_widthRatio = (float) width / textureSize;
 	_heightRatio = (float) height / textureSize;
+	_tilesPerRow = (width + TEXEL_TILE_MASK) >> TEXEL_TILE_SHIFT;
+	_texelCount = (_tilesPerRow * ((height + TEXEL_TILE_MASK) >> TEXEL_TILE_SHIFT)) << (2 * TEXEL_TILE_SHIFT);
+}
+
+inline uint TexelBuffer::getTexelOffset(uint x, uint y) const {
+	const uint tile = (y >> TEXEL_TILE_SHIFT) * _tilesPerRow + (x >> TEXEL_TILE_SHIFT);
+	return (tile << (2 * TEXEL_TILE_SHIFT)) + ((y & TEXEL_TILE_MASK) << TEXEL_TILE_SHIFT) + (x & TEXEL_TILE_MASK);
 }
 
 static inline uint wrap(uint wrap_mode, int coord, uint _fracTextureUnit, uint _fracTextureMask) {
@@ -72,27 +84,54 @@ void TexelBuffer::getARGBAt(
 	x = wrap(wrap_s, s, _fracTextureUnit, _fracTextureMask) * _widthRatio;
 	y = wrap(wrap_t, t, _fracTextureUnit, _fracTextureMask) * _heightRatio;
 	getARGBAt(
-		(x >> ZB_POINT_ST_FRAC_BITS) + (y >> ZB_POINT_ST_FRAC_BITS) * _width,
+		getTexelOffset(x >> ZB_POINT_ST_FRAC_BITS, y >> ZB_POINT_ST_FRAC_BITS),
 		x & ZB_POINT_ST_FRAC_MASK, y & ZB_POINT_ST_FRAC_MASK,
 		a, r, g, b
 	);
 }
 
+void TexelBuffer::blendARGBAt(
+	uint lodFraction,
+	uint wrap_s, uint wrap_t,
+	int s, int t,
+	uint8 &a, uint8 &r, uint8 &g, uint8 &b
+) const {
+	uint8 c_a, c_r, c_g, c_b;
+	getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+	a += ((c_a - a) * (int)lodFraction) >> 8;
+	r += ((c_r - r) * (int)lodFraction) >> 8;
+	g += ((c_g - g) * (int)lodFraction) >> 8;
+	b += ((c_b - b) * (int)lodFraction) >> 8;
+}
+
+void TexelBuffer::getTexelAt(uint x, uint y, uint8 &a, uint8 &r, uint8 &g, uint8 &b) const {
+	assert(x < _width && y < _height);
+	getARGBAt(getTexelOffset(x, y), 0, 0, a, r, g, b);
+}
+
 // Nearest: store texture in original size.
 class BaseNearestTexelBuffer : public TexelBuffer {
 public:
 	BaseNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize);
 	~BaseNearestTexelBuffer();
 
+	uint getMemorySize() const override { return _texelCount * _format.bytesPerPixel; }
+
 protected:
 	byte *_buf;
 	Graphics::PixelFormat _format;
 };
 
 BaseNearestTexelBuffer::BaseNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize), _format(format) {
-	uint count = _width * _height * _format.bytesPerPixel;
-	_buf = (byte *)gl_malloc(count);
-	memcpy(_buf, buf, count);
+	const uint bpp = _format.bytesPerPixel;
+	_buf = (byte *)gl_zalloc(_texelCount * bpp);
+	// Each tile row is a run of contiguous texels
+	for (uint y = 0; y < _height; y++) {
+		for (uint x = 0; x < _width; x += TEXEL_TILE_SIZE) {
+			const uint count = MIN<uint>(TEXEL_TILE_SIZE, _width - x);
+			memcpy(_buf + getTexelOffset(x, y) * bpp, buf + (y * _width + x) * bpp, count * bpp);
+		}
+	}
 }
 
 BaseNearestTexelBuffer::~BaseNearestTexelBuffer() {
@@ -181,11 +220,15 @@ TexelBuffer *createNearestTexelBuffer(const byte *buf, const Graphics::PixelForm
 // allows applying linear filtering at render time at a very low performance
 // cost. As we expect to work on small-ish textures (512*512 ?) the 4x memory
 // usage increase should be negligible.
+#define PIXEL_PER_TEXEL_SHIFT 2
+
 class BilinearTexelBuffer : public TexelBuffer {
 public:
 	BilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize);
 	~BilinearTexelBuffer();
 
+	uint getMemorySize() const override { return (_texelCount << PIXEL_PER_TEXEL_SHIFT) * sizeof(uint32); }
+
 protected:
 	void getARGBAt(
 		uint pixel,
@@ -205,19 +248,17 @@ private:
 #define P01_OFFSET 1
 #define P10_OFFSET 2
 #define P11_OFFSET 3
-#define PIXEL_PER_TEXEL_SHIFT 2
 
 BilinearTexelBuffer::BilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize) {
 	const Graphics::PixelBuffer src(format, buf);
 
 	uint pixel00_offset = 0, pixel11_offset, pixel01_offset, pixel10_offset;
 	uint8 *texel8;
-	uint32 *texel32;
 
-	texel32 = _texels = (uint32 *)gl_malloc((_width * _height << PIXEL_PER_TEXEL_SHIFT) * sizeof(uint32));
+	_texels = (uint32 *)gl_zalloc((_texelCount << PIXEL_PER_TEXEL_SHIFT) * sizeof(uint32));
 	for (uint y = 0; y < _height; y++) {
 		for (uint x = 0; x < _width; x++) {
-			texel8 = (uint8 *)texel32;
+			texel8 = (uint8 *)(_texels + (getTexelOffset(x, y) << PIXEL_PER_TEXEL_SHIFT));
 			pixel11_offset = pixel00_offset + _width + 1;
 			src.getARGBAt(
 				pixel00_offset,
@@ -257,7 +298,6 @@ BilinearTexelBuffer::BilinearTexelBuffer(byte *buf, const Graphics::PixelFormat
 				*(texel8 + P11_OFFSET + G_OFFSET),
 				*(texel8 + P11_OFFSET + B_OFFSET)
 			);
-			texel32 += 1 << PIXEL_PER_TEXEL_SHIFT;
 			pixel00_offset++;
 		}
 	}
@@ -327,4 +367,40 @@ TexelBuffer *createBilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &p
 	);
 }
 
+TexelBuffer *createMipmapTexelBuffer(const TexelBuffer *level, bool bilinear, uint textureSize) {
+	typedef ColorMasks<TGL_RGBA, TGL_UNSIGNED_BYTE> ColorMask;
+	const Graphics::PixelFormat pf(ColorMask::kBytesPerPixel, 8, 8, 8, 8,
+	                               ColorMask::kRedShift, ColorMask::kGreenShift, ColorMask::kBlueShift, ColorMask::kAlphaShift);
+	const uint srcWidth = level->getWidth(), srcHeight = level->getHeight();
+	const uint width = MAX<uint>(srcWidth >> 1, 1), height = MAX<uint>(srcHeight >> 1, 1);
+
+	uint32 *pixels = (uint32 *)gl_malloc(width * height * sizeof(uint32));
+	for (uint y = 0; y < height; y++) {
+		const uint y0 = MIN(y * 2, srcHeight - 1), y1 = MIN(y * 2 + 1, srcHeight - 1);
+		for (uint x = 0; x < width; x++) {
+			const uint x0 = MIN(x * 2, srcWidth - 1), x1 = MIN(x * 2 + 1, srcWidth - 1);
+			const uint xs[4] = { x0, x1, x0, x1 }, ys[4] = { y0, y0, y1, y1 };
+			// Rounded to the nearest
+			uint sumA = 2, sumR = 2, sumG = 2, sumB = 2;
+			for (int i = 0; i < 4; i++) {
+				uint8 a, r, g, b;
+				level->getTexelAt(xs[i], ys[i], a, r, g, b);
+				sumA += a;
+				sumR += r;
+				sumG += g;
+				sumB += b;
+			}
+			pixels[y * width + x] = pf.ARGBToColor(sumA >> 2, sumR >> 2, sumG >> 2, sumB >> 2);
+		}
+	}
+
+	TexelBuffer *buffer;
+	if (bilinear)
+		buffer = createBilinearTexelBuffer((byte *)pixels, pf, TGL_RGBA, TGL_UNSIGNED_BYTE, width, height, textureSize);
+	else
+		buffer = createNearestTexelBuffer((byte *)pixels, pf, TGL_RGBA, TGL_UNSIGNED_BYTE, width, height, textureSize);
+	gl_free(pixels);
+	return buffer;
+}
+
 } // end of namespace TinyGL
@@ -37,18 +37,43 @@ public:
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const;
 
+	// Samples the texture like getARGBAt, and moves the given color towards
+	// the sample by lodFraction / 256. Used to blend two mipmap levels.
+	void blendARGBAt(
+		uint lodFraction,
+		uint wrap_s, uint wrap_t,
+		int s, int t,
+		uint8 &a, uint8 &r, uint8 &g, uint8 &b
+	) const;
+
+	// The unfiltered color of the texel at the given position
+	void getTexelAt(uint x, uint y, uint8 &a, uint8 &r, uint8 &g, uint8 &b) const;
+
+	uint getWidth() const { return _width; }
+	uint getHeight() const { return _height; }
+	virtual uint getMemorySize() const = 0;
+
 protected:
 	virtual void getARGBAt(
 		uint pixel,
 		uint ds, uint dt,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const = 0;
+
+	// Texels are stored in small square tiles rather than in rows, so that
+	// the texels sampled for neighbour pixels are likely to share a cache
+	// line whatever the direction the texture is walked in.
+	uint getTexelOffset(uint x, uint y) const;
+
 	uint _width, _height, _fracTextureUnit, _fracTextureMask;
+	uint _tilesPerRow, _texelCount;
 	float _widthRatio, _heightRatio;
 };
 
 TexelBuffer *createNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize);
 TexelBuffer *createBilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize);
+// Box filter a texture down to half its size, for the next mipmap level
+TexelBuffer *createMipmapTexelBuffer(const TexelBuffer *level, bool bilinear, uint textureSize);
 
 } // end of namespace TinyGL
 
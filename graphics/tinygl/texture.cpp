@@ -71,6 +71,41 @@ void GLContext::free_texture(GLTexture *t) {
 	gl_free(t);
 }
 
+static bool isMipmapFilter(uint filter) {
+	return filter == TGL_NEAREST_MIPMAP_NEAREST || filter == TGL_NEAREST_MIPMAP_LINEAR ||
+	       filter == TGL_LINEAR_MIPMAP_NEAREST || filter == TGL_LINEAR_MIPMAP_LINEAR;
+}
+
+void GLContext::free_mipmaps(GLTexture *t) {
+	for (int i = 1; i < MAX_TEXTURE_LEVELS; i++) {
+		GLImage *im = &t->images[i];
+		if (im->pixmap) {
+			delete im->pixmap;
+			im->pixmap = nullptr;
+		}
+	}
+	t->generatedMipmaps = false;
+}
+
+// Build the whole chain down to a single texel, each level filtered
+// within itself the same way as level 0
+void GLContext::generate_mipmaps(GLTexture *t) {
+	const bool bilinear = texture_min_filter == TGL_LINEAR_MIPMAP_NEAREST || texture_min_filter == TGL_LINEAR_MIPMAP_LINEAR;
+
+	free_mipmaps(t);
+	for (int i = 1; i < MAX_TEXTURE_LEVELS; i++) {
+		const TexelBuffer *previous = t->images[i - 1].pixmap;
+		if (previous->getWidth() == 1 && previous->getHeight() == 1)
+			break;
+		GLImage *im = &t->images[i];
+		im->xsize = _textureSize;
+		im->ysize = _textureSize;
+		im->pixmap = createMipmapTexelBuffer(previous, bilinear, _textureSize);
+	}
+	t->generatedMipmaps = true;
+	t->versionNumber++;
+}
+
 GLTexture *GLContext::alloc_texture(uint h) {
 	GLTexture *t, **ht;
 
@@ -128,6 +163,11 @@ void GLContext::glopTexImage2D(GLParam *p) {
 
 	assert (current_texture);
 
+	// Mipmaps built from the previous image are out of date, and get in the
+	// way of the ones the application uploads
+	if (current_texture->generatedMipmaps)
+		free_mipmaps(current_texture);
+
 	current_texture->versionNumber++;
 	im = &current_texture->images[level];
 	im->xsize = _textureSize;
@@ -176,6 +216,9 @@ void GLContext::glopTexImage2D(GLParam *p) {
 			);
 			break;
 		}
+
+		if (level == 0 && isMipmapFilter(texture_min_filter))
+			generate_mipmaps(current_texture);
 	}
 }
 
@@ -238,6 +281,10 @@ error:
 		default:
 			goto error;
 		}
+		// Applications may choose the filter after uploading the texture
+		if (isMipmapFilter(param) && current_texture && current_texture->images[0].pixmap &&
+		    !current_texture->images[1].pixmap)
+			generate_mipmaps(current_texture);
 		break;
 	default:
 		;
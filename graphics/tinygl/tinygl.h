@@ -22,6 +22,11 @@
 #ifndef GRAPHICS_TINYGL_H
 #define GRAPHICS_TINYGL_H
 
+#include "common/array.h"
+#include "common/path.h"
+#include "common/rect.h"
+#include "common/str.h"
+
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 #include "graphics/tinygl/gl.h"
@@ -39,6 +44,95 @@ void destroyContext(ContextHandle *handle);
 void setContext(ContextHandle *handle);
 void presentBuffer();
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas);
+
+/**
+ * Execute the draw calls of a frame tile by tile instead of one after the
+ * other, which keeps the parts of the color and z buffers being drawn to in
+ * the cache. The output is the same as without tiles. Frames with draw calls
+ * that cannot be clipped exactly, like scaled or rotated blits, are still
+ * drawn in one go.
+ *
+ * @param tileSize  The width and height of the tiles in pixels, or 0 to
+ *                  disable tiled rendering, which is the default.
+ */
+void setTileSize(int tileSize);
+
+/**
+ * Counters of the hierarchical z buffer, which keeps the range of the depth
+ * values of every 8x8 pixels tile to skip the triangles and the spans hidden
+ * behind them.
+ */
+struct DepthStats {
+	uint32 testedTriangles;   ///< Triangles tested against the tiles
+	uint32 rejectedTriangles; ///< Triangles skipped as a whole
+	uint32 rejectedSpans;     ///< Spans skipped in the other triangles
+	uint32 rejectedTiles;     ///< Tiles which hid a skipped triangle or span
+	uint32 updatedTiles;      ///< Tiles whose range was computed again after being drawn to
+};
+
+/**
+ * Enable or disable the hierarchical z buffer, which is enabled by default.
+ * The output is the same either way.
+ */
+void enableHierarchicalDepth(bool enable);
+void getDepthStats(DepthStats &stats);
+void resetDepthStats();
+
+/**
+ * Counters and timings of a frame, gathered while profiling is enabled.
+ */
+struct FrameStats {
+	uint32 drawCalls;           ///< Draw calls queued during the frame
+	uint32 changedDrawCalls;    ///< Queued draw calls not found in the previous frame, with dirty rectangles
+	uint32 executedDrawCalls;   ///< Draw calls executed, once for each dirty rectangle or tile they cover
+	uint32 blitCalls;           ///< Blitting draw calls queued during the frame
+	uint32 trianglesIn;         ///< Triangles sent to clipping and culling
+	uint32 trianglesOut;        ///< Triangles rasterized after clipping and culling
+	uint32 texturedTriangles;   ///< Rasterized triangles with a texture
+	uint32 pixelsShaded;        ///< Pixels of the rasterized triangles which were depth tested and shaded
+	uint32 pixelsDepthRejected; ///< Pixels skipped by the hierarchical z buffer without being shaded
+	uint32 dirtyArea;           ///< Pixels in the regions of the screen which were drawn again
+	uint32 executeTime;         ///< Microseconds spent executing the draw calls
+};
+
+/**
+ * Counters and timings of a draw call of the frame, gathered while profiling
+ * is enabled.
+ */
+struct DrawCallStats {
+	Common::String description; ///< What the draw call does, like "triangles, 24 vertices, textured"
+	Common::Rect region;        ///< The screen region the draw call covers
+	uint32 executions;          ///< How many times it was executed, once for each dirty rectangle or tile
+	uint32 triangles;           ///< Triangles rasterized after clipping and culling
+	uint32 pixelsShaded;        ///< Pixels which were depth tested and shaded
+	uint32 executeTime;         ///< Microseconds spent executing the draw call
+};
+
+/**
+ * Enable or disable gathering statistics about the frames, which is disabled
+ * by default. The statistics of a frame are available once presentBuffer()
+ * returned, until the next frame is presented.
+ */
+void enableProfiling(bool enable);
+void getFrameStats(FrameStats &stats);
+void getDrawCallStats(Common::Array<DrawCallStats> &stats);
+
+/**
+ * Format the statistics of the last presented frame as text, followed by a
+ * table of its slowest draw calls.
+ *
+ * @param maxDrawCalls  How many of the draw calls to list, 0 for none.
+ */
+Common::String formatFrameStats(uint maxDrawCalls);
+
+/**
+ * Write the statistics of the last presented frame and of all its draw calls
+ * to a text file, as formatted by formatFrameStats().
+ *
+ * @return  Whether the file could be written.
+ */
+bool dumpFrameStats(const Common::Path &fileName);
+
 void getSurfaceRef(Graphics::Surface &surface);
 Graphics::Surface *copyFromFrameBuffer(const Graphics::PixelFormat &dstFormat);
 
@@ -27,6 +27,9 @@
 
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/ztransform.h"
+
+#include "common/system.h"
 
 namespace TinyGL {
 
@@ -194,19 +197,66 @@ void GLContext::gl_vertex_transform(GLVertex *v) {
 	v->clip_code = gl_clipcode(v->pc.X, v->pc.Y, v->pc.Z, v->pc.W);
 }
 
-void GLContext::glopVertex(GLParam *p) {
-	GLVertex *v;
-	int n, cnt;
+void transformVertices(const TransformState &state, GLVertex *vertices, int count) {
+	for (int i = 0; i < count; i++) {
+		GLVertex *v = &vertices[i];
 
-	assert(in_begin != 0);
+		if (state.eyeCoords) {
+			state.modelView->transform3x4(v->coord, v->ec);
+		}
+
+		if (state.lighting) {
+			state.projection->transform(v->ec, v->pc);
+
+			Vector3 normal = v->normal;
+			state.normalMatrix->transform3x3(normal, v->normal);
+			if (state.normalize) {
+				v->normal.normalize();
+			}
+		} else {
+			state.modelViewProjection->transform3x4(v->coord, v->pc);
+			if (state.noWTransform) {
+				v->pc.W = state.modelViewProjection->_m[3][3];
+			}
+		}
+
+		v->clip_code = gl_clipcode(v->pc.X, v->pc.Y, v->pc.Z, v->pc.W);
+
+		if (v->clip_code == 0) {
+			float winv = (float)(1.0 / v->pc.W);
+			v->zp.x = (int)(v->pc.X * winv * state.viewportScale[0] + state.viewportTrans[0]);
+			v->zp.y = (int)(v->pc.Y * winv * state.viewportScale[1] + state.viewportTrans[1]);
+			v->zp.z = (int)(v->pc.Z * winv * state.viewportScale[2] + state.viewportTrans[2]);
+		}
+	}
+}
+
+namespace Internal {
 
-	n = vertex_n;
-	cnt = vertex_cnt;
-	cnt++;
-	vertex_cnt = cnt;
+static TransformFunc g_transformFunc = nullptr;
 
+TransformFunc getTransformFunc() {
+	if (!g_transformFunc) {
+		g_transformFunc = transformVertices;
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) g_transformFunc = transformVerticesSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) g_transformFunc = transformVerticesAVX2;
+#endif
+	}
+	return g_transformFunc;
+}
+
+void setTransformFunc(TransformFunc func) {
+	g_transformFunc = func ? func : transformVertices;
+}
+
+} // end of namespace Internal
+
+GLVertex *GLContext::gl_new_vertex() {
 	// quick fix to avoid crashes on large polygons
-	if (n >= vertex_max) {
+	if (vertex_n >= vertex_max) {
 		GLVertex *newarray;
 		vertex_max <<= 1;    // just double size
 		newarray = (GLVertex *)gl_realloc(vertex, sizeof(GLVertex) * vertex_max);
@@ -215,9 +265,18 @@ void GLContext::glopVertex(GLParam *p) {
 		}
 		vertex = newarray;
 	}
+
+	vertex_cnt++;
+	return &vertex[vertex_n++];
+}
+
+void GLContext::glopVertex(GLParam *p) {
+	GLVertex *v;
+
+	assert(in_begin != 0);
+
 	// new vertex entry
-	v = &vertex[n];
-	n++;
+	v = gl_new_vertex();
 
 	v->coord.X = p[1].f;
 	v->coord.Y = p[2].f;
@@ -228,20 +287,18 @@ void GLContext::glopVertex(GLParam *p) {
 
 	// color
 
+	v->color = current_color;
 	if (lighting_enabled) {
 		gl_shade_vertex(v);
-	} else {
-		v->color = current_color;
 	}
 
-	// tex coords
+	// tex coords, also without texture so that the vertex compares equal
+	// to the same one in the next frame with dirty rectangles
 
-	if (texture_2d_enabled) {
-		if (apply_texture_matrix) {
-			matrix_stack_ptr[2]->transform(current_tex_coord, v->tex_coord);
-		} else {
-			v->tex_coord = current_tex_coord;
-		}
+	if (texture_2d_enabled && apply_texture_matrix) {
+		matrix_stack_ptr[2]->transform(current_tex_coord, v->tex_coord);
+	} else {
+		v->tex_coord = current_tex_coord;
 	}
 	// precompute the mapping to the viewport
 	if (v->clip_code == 0)
@@ -250,8 +307,71 @@ void GLContext::glopVertex(GLParam *p) {
 	// edge flag
 
 	v->edge_flag = current_edge_flag;
+}
+
+// Add a vertex with the current state, which gl_transform_vertices() has
+// to transform afterwards
+void GLContext::gl_add_vertex(GLParam *p) {
+	GLVertex *v;
+
+	assert(in_begin != 0);
 
-	vertex_n = n;
+	v = gl_new_vertex();
+
+	v->coord.X = p[1].f;
+	v->coord.Y = p[2].f;
+	v->coord.Z = p[3].f;
+	v->coord.W = p[4].f;
+	v->normal.X = current_normal.X;
+	v->normal.Y = current_normal.Y;
+	v->normal.Z = current_normal.Z;
+	v->color = current_color;
+	v->tex_coord = current_tex_coord;
+	v->edge_flag = current_edge_flag;
+}
+
+// Transform the vertices added by gl_add_vertex() in one go, giving the
+// same results as glopVertex()
+void GLContext::gl_transform_vertices(GLVertex *vertices, int count) {
+	TransformState state;
+
+	state.modelView = matrix_stack_ptr[0];
+	state.projection = matrix_stack_ptr[1];
+	state.modelViewProjection = &matrix_model_projection;
+	state.noWTransform = matrix_model_projection_no_w_transform;
+	state.normalMatrix = &matrix_model_view_inv;
+	state.normalize = normalize_enabled;
+	state.lighting = lighting_enabled;
+	state.eyeCoords = lighting_enabled || fog_enabled;
+	for (int i = 0; i < 3; i++) {
+		state.viewportScale[i] = viewport.scale._v[i];
+		state.viewportTrans[i] = viewport.trans._v[i];
+	}
+
+	Internal::getTransformFunc()(state, vertices, count);
+
+	for (int i = 0; i < count; i++) {
+		GLVertex *v = &vertices[i];
+
+		if (fog_enabled) {
+			gl_calc_fog_factor(v);
+		}
+
+		if (lighting_enabled) {
+			gl_shade_vertex(v);
+		} else {
+			v->normal.X = v->normal.Y = v->normal.Z = 0;
+			v->ec.X = v->ec.Y = v->ec.Z = v->ec.W = 0;
+		}
+
+		if (texture_2d_enabled && apply_texture_matrix) {
+			Vector4 tex_coord = v->tex_coord;
+			matrix_stack_ptr[2]->transform(tex_coord, v->tex_coord);
+		}
+
+		if (v->clip_code == 0)
+			gl_transform_attributes_to_viewport(v);
+	}
 }
 
 void GLContext::glopEnd(GLParam *) {
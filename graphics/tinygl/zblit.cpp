@@ -20,8 +20,11 @@
  */
 
 #include "common/array.h"
+#include "common/system.h"
 
 #include "graphics/tinygl/zblit.h"
+#include "graphics/tinygl/zblitrow.h"
+#include "graphics/tinygl/zspan.h"
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/pixelbuffer.h"
 #include "graphics/tinygl/zdirtyrect.h"
@@ -238,6 +241,7 @@ public:
 			dstBuf.shiftBy(fbWidth);
 			srcBuf.shiftBy(_surface.w);
 		}
+		c->fb->invalidateDepthTiles(dstX, dstY, dstX + clampWidth - 1, dstY + clampHeight - 1);
 	}
 
 	void tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight);
@@ -305,6 +309,9 @@ private:
 	bool _zBuffer;
 	Common::Array<Line> _lines;
 	Graphics::Surface _surface;
+	// Gathered source pixels and source columns of the row functions
+	Common::Array<uint32> _row;
+	Common::Array<int> _columns;
 	int _version;
 	int _refcount;
 };
@@ -346,6 +353,108 @@ void tglDeleteBlitImage(TinyGL::BlitImage *blitImage) {
 
 namespace TinyGL {
 
+void blitRow(const BlitRowState &state, uint32 *dst, const uint32 *src, int count) {
+	const uint32 alphaFull = (0xFF >> state.aLoss) << state.aShift;
+	for (int i = 0; i < count; i++) {
+		const uint32 pixel = src[i];
+		const uint a = ((((pixel >> state.srcAShift) & 0xFF) | state.srcAlphaMask) * state.aTint) >> 16;
+		uint r = (((pixel >> state.srcRShift) & 0xFF) * state.rTint) >> 16;
+		uint g = (((pixel >> state.srcGShift) & 0xFF) * state.gTint) >> 16;
+		uint b = (((pixel >> state.srcBShift) & 0xFF) * state.bTint) >> 16;
+
+		if (!state.blending || (state.storeOpaque && a == 0xFF)) {
+			dst[i] = ((a >> state.aLoss) << state.aShift) | (r << state.rShift) | (g << state.gShift) | (b << state.bShift);
+			continue;
+		}
+
+		const uint32 color = dst[i];
+		const uint srcFactor = state.srcFactorBase + state.srcFactorSign * (int)a;
+		const uint dstFactor = state.dstFactorBase + state.dstFactorSign * (int)a;
+		r = MIN<uint>(((r * srcFactor) >> 8) + ((((color >> state.rShift) & 0xFF) * dstFactor) >> 8), 255);
+		g = MIN<uint>(((g * srcFactor) >> 8) + ((((color >> state.gShift) & 0xFF) * dstFactor) >> 8), 255);
+		b = MIN<uint>(((b * srcFactor) >> 8) + ((((color >> state.bShift) & 0xFF) * dstFactor) >> 8), 255);
+		dst[i] = alphaFull | (r << state.rShift) | (g << state.gShift) | (b << state.bShift);
+	}
+}
+
+bool FrameBuffer::getBlitRowState(BlitRowState &state, const Graphics::PixelFormat &srcFormat) const {
+	if (_pbufBpp != 4 || _pbufFormat.rLoss || _pbufFormat.gLoss || _pbufFormat.bLoss ||
+	    (_pbufFormat.aLoss != 0 && _pbufFormat.aLoss != 8)) {
+		return false;
+	}
+	if (srcFormat.bytesPerPixel != 4 || srcFormat.rLoss || srcFormat.gLoss || srcFormat.bLoss ||
+	    (srcFormat.aLoss != 0 && srcFormat.aLoss != 8)) {
+		return false;
+	}
+	// Alpha testing is left to the per pixel code
+	if (_alphaTestEnabled) {
+		return false;
+	}
+
+	state.blending = _blendingEnabled;
+	if (_blendingEnabled) {
+		if (!getSpanBlendingFactor(_sourceBlendingFactor, state.srcFactorBase, state.srcFactorSign) ||
+		    !getSpanBlendingFactor(_destinationBlendingFactor, state.dstFactorBase, state.dstFactorSign)) {
+			return false;
+		}
+	}
+	state.storeOpaque = false;
+
+	state.srcAShift = srcFormat.aShift;
+	state.srcRShift = srcFormat.rShift;
+	state.srcGShift = srcFormat.gShift;
+	state.srcBShift = srcFormat.bShift;
+	state.srcAlphaMask = srcFormat.aLoss ? 0xFF : 0;
+	state.aTint = state.rTint = state.gTint = state.bTint = 1 << 16;
+
+	state.aShift = _pbufFormat.aShift;
+	state.rShift = _pbufFormat.rShift;
+	state.gShift = _pbufFormat.gShift;
+	state.bShift = _pbufFormat.bShift;
+	state.aLoss = _pbufFormat.aLoss;
+	return true;
+}
+
+// The per pixel code multiplies the components by the float tint and
+// truncates them. Find the fixed point tint giving the same components
+// for all of them, which exists for nearly all tints.
+static bool getRowTint(float tint, uint &rowTint) {
+	if (tint == 1.0f) {
+		rowTint = 1 << 16;
+		return true;
+	}
+	if (!(tint >= 0.0f && tint < 1.0f)) {
+		return false;
+	}
+	const uint base = (uint)(tint * 65536.0f);
+	for (uint t = base; t <= base + 1; t++) {
+		int c = 0;
+		while (c < 256 && (byte)(c * tint) == ((c * t) >> 16)) {
+			c++;
+		}
+		if (c == 256) {
+			rowTint = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Set up the row function for blitting an image in the given format, or
+// return nullptr if the per pixel code has to be used.
+static BlitRowFunc setupBlitRow(GLContext *c, const Graphics::PixelFormat &format, BlitRowState &state,
+                                float aTint, float rTint, float gTint, float bTint) {
+	BlitRowFunc func = Internal::getBlitRowFunc();
+	if (!func || !c->fb->getBlitRowState(state, format)) {
+		return nullptr;
+	}
+	if (!getRowTint(aTint, state.aTint) || !getRowTint(rTint, state.rTint) ||
+	    !getRowTint(gTint, state.gTint) || !getRowTint(bTint, state.bTint)) {
+		return nullptr;
+	}
+	return func;
+}
+
 void BlitImage::tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight) {
 	GLContext *c = gl_get_context();
 
@@ -388,6 +497,9 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 
 	int kBytesPerPixel = c->fb->getPixelFormat().bytesPerPixel;
 
+	BlitRowState rowState;
+	BlitRowFunc writeRow = setupBlitRow(c, _surface.format, rowState, aTint, rTint, gTint, bTint);
+
 	uint32 lineIndex = 0;
 	int maxY = srcY + clampHeight;
 	int maxX = srcX + clampWidth;
@@ -408,6 +520,9 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 				if (kDisableColoring) {
 					memcpy(dstBuf.getRawBuffer((l._y - srcY) * fbWidth + xStart),
 						l._pixels + skipStart * kBytesPerPixel, length * kBytesPerPixel);
+				} else if (writeRow) {
+					writeRow(rowState, (uint32 *)dstBuf.getRawBuffer((l._y - srcY) * fbWidth + xStart),
+					         (const uint32 *)srcBuf.getRawBuffer((l._y - srcY) * _surface.w + xStart), length);
 				} else {
 					for(int x = xStart; x < xStart + length; x++) {
 						byte aDst, rDst, gDst, bDst;
@@ -419,6 +534,7 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 			lineIndex++;
 		}
 	} else { // Otherwise can use setPixel in some cases which speeds up things quite a bit
+		rowState.storeOpaque = kDisableColoring;
 		while (lineIndex < _lines.size() && _lines[lineIndex]._y < maxY) {
 			const BlitImage::Line &l = _lines[lineIndex];
 			if (l._x < maxX && l._x + l._length > srcX) {
@@ -431,6 +547,9 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 				if (kDisableColoring && (kEnableAlphaBlending == false || kDisableBlending)) {
 					memcpy(dstBuf.getRawBuffer((l._y - srcY) * fbWidth + xStart),
 						l._pixels + skipStart * kBytesPerPixel, length * kBytesPerPixel);
+				} else if (writeRow) {
+					writeRow(rowState, (uint32 *)dstBuf.getRawBuffer((l._y - srcY) * fbWidth + xStart),
+					         (const uint32 *)srcBuf.getRawBuffer((l._y - srcY) * _surface.w + xStart), length);
 				} else {
 					for(int x = xStart; x < xStart + length; x++) {
 						byte aDst, rDst, gDst, bDst;
@@ -473,6 +592,32 @@ void BlitImage::tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWid
 	Graphics::PixelBuffer dstBuf(c->fb->getPixelFormat(), c->fb->getPixelBuffer());
 	int fbWidth = c->fb->getPixelBufferWidth();
 
+	BlitRowState rowState;
+	BlitRowFunc writeRow = setupBlitRow(c, _surface.format, rowState, aTint, rTint, gTint, bTint);
+	if (writeRow) {
+		uint32 *dstRow = (uint32 *)dstBuf.getRawBuffer(dstX + dstY * fbWidth);
+		if (kFlipHorizontal) {
+			_row.resize(clampWidth);
+		}
+		for (int y = 0; y < clampHeight; y++) {
+			const uint32 *srcRow = (const uint32 *)srcBuf.getRawBuffer(srcX);
+			if (kFlipHorizontal) {
+				for (int x = 0; x < clampWidth; x++) {
+					_row[x] = srcRow[clampWidth - x];
+				}
+				srcRow = _row.data();
+			}
+			writeRow(rowState, dstRow, srcRow, clampWidth);
+			dstRow += fbWidth;
+			if (kFlipVertical) {
+				srcBuf.shiftBy(-_surface.w);
+			} else {
+				srcBuf.shiftBy(_surface.w);
+			}
+		}
+		return;
+	}
+
 	for (int y = 0; y < clampHeight; y++) {
 		for (int x = 0; x < clampWidth; ++x) {
 			byte aDst, rDst, gDst, bDst;
@@ -522,6 +667,38 @@ void BlitImage::tglBlitScale(int dstX, int dstY, int width, int height, int srcX
 	Graphics::PixelBuffer dstBuf(c->fb->getPixelFormat(), c->fb->getPixelBuffer());
 	int fbWidth = c->fb->getPixelBufferWidth();
 
+	BlitRowState rowState;
+	BlitRowFunc writeRow = setupBlitRow(c, _surface.format, rowState, aTint, rTint, gTint, bTint);
+	if (writeRow && clampWidth > 0) {
+		_columns.resize(clampWidth);
+		for (int x = 0; x < clampWidth; x++) {
+			const int xSource = kFlipHorizontal ? clampWidth - x - 1 : x;
+			_columns[x] = (xSource * srcWidth) / width;
+		}
+		_row.resize(clampWidth);
+
+		uint32 *dstRow = (uint32 *)dstBuf.getRawBuffer(dstX + dstY * fbWidth);
+		int lastRow = -1;
+		for (int y = 0; y < clampHeight; y++) {
+			const int ySource = kFlipVertical ? clampHeight - y - 1 : y;
+			const int row = (ySource * srcHeight) / height;
+			if (row == lastRow && !rowState.blending) {
+				// Without blending the pixels only depend on the source row,
+				// so the rows repeated by scaling up are copied.
+				memcpy(dstRow, dstRow - fbWidth, clampWidth * sizeof(uint32));
+			} else {
+				const uint32 *srcRow = (const uint32 *)srcBuf.getRawBuffer(row * _surface.w);
+				for (int x = 0; x < clampWidth; x++) {
+					_row[x] = srcRow[_columns[x]];
+				}
+				writeRow(rowState, dstRow, _row.data(), clampWidth);
+				lastRow = row;
+			}
+			dstRow += fbWidth;
+		}
+		return;
+	}
+
 	for (int y = 0; y < clampHeight; y++) {
 		for (int x = 0; x < clampWidth; ++x) {
 			byte aDst, rDst, gDst, bDst;
@@ -643,6 +820,88 @@ void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int height, int
 	int sw = width - 1;
 	int sh = height - 1;
 
+	BlitRowState rowState;
+	BlitRowFunc writeRow = setupBlitRow(c, _surface.format, rowState, aTint, rTint, gTint, bTint);
+	if (writeRow && clampWidth > 0) {
+		_row.resize(clampWidth);
+		const uint32 *src = (const uint32 *)srcBuf.getRawBuffer();
+		uint32 *dstRow = (uint32 *)dstBuf.getRawBuffer(dstX + dstY * fbWidth);
+
+		// Without rotation (or turned upside down) the source row is the same
+		// along the whole row, and the source columns are the same in every row.
+		const bool axisAligned = isinx == 0 && isiny == 0;
+		int lastRow = -1, lastStart = 0, lastCount = 0;
+
+		for (int y = 0; y < clampHeight; y++, dstRow += fbWidth) {
+			int t = cy - y;
+			int sdx = ax + (isinx * t) + xd;
+			int sdy = ay - (icosy * t) + yd;
+
+			int row = -1;
+			if (axisAligned) {
+				row = sdy >> 16;
+				if (kFlipVertical) {
+					row = sh - row;
+				}
+				if (row < 0 || row >= srcHeight) {
+					lastRow = -1;
+					continue;
+				}
+				if (row == lastRow && !rowState.blending) {
+					memcpy(dstRow + lastStart, dstRow - fbWidth + lastStart, lastCount * sizeof(uint32));
+					continue;
+				}
+			}
+
+			// Write the runs of pixels inside of the source rectangle
+			int start = 0, count = 0, runs = 0;
+			int runStart = 0, runCount = 0;
+			for (int x = 0; x < clampWidth; ++x) {
+				int dx = (sdx >> 16);
+				int dy = (sdy >> 16);
+
+				if (kFlipHorizontal) {
+					dx = sw - dx;
+				}
+
+				if (kFlipVertical) {
+					dy = sh - dy;
+				}
+
+				if ((dx >= 0) && (dy >= 0) && (dx < srcWidth) && (dy < srcHeight)) {
+					if (count == 0) {
+						start = x;
+					}
+					_row[count++] = src[dy * _surface.w + dx];
+				} else if (count) {
+					writeRow(rowState, dstRow + start, _row.data(), count);
+					runStart = start;
+					runCount = count;
+					count = 0;
+					runs++;
+				}
+				sdx += icosx;
+				sdy += isiny;
+			}
+			if (count) {
+				writeRow(rowState, dstRow + start, _row.data(), count);
+				runStart = start;
+				runCount = count;
+				runs++;
+			}
+
+			// Without rotation, there is a single run
+			if (axisAligned && runs == 1) {
+				lastRow = row;
+				lastStart = runStart;
+				lastCount = runCount;
+			} else {
+				lastRow = -1;
+			}
+		}
+		return;
+	}
+
 	for (int y = 0; y < clampHeight; y++) {
 		int t = cy - y;
 		int sdx = ax + (isinx * t) + xd;
@@ -815,6 +1074,28 @@ void tglBlitResetScissorRect() {
 	c->_scissorRect = c->renderRect;
 }
 
+static BlitRowFunc g_blitRowFunc = nullptr;
+static bool g_blitRowFuncDetected = false;
+
+BlitRowFunc getBlitRowFunc() {
+	if (!g_blitRowFuncDetected) {
+		g_blitRowFunc = blitRow;
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) g_blitRowFunc = blitRowSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) g_blitRowFunc = blitRowAVX2;
+#endif
+		g_blitRowFuncDetected = true;
+	}
+	return g_blitRowFunc;
+}
+
+void setBlitRowFunc(BlitRowFunc func) {
+	g_blitRowFunc = func;
+	g_blitRowFuncDetected = true;
+}
+
 } // end of namespace Internal
 
 Common::Point transformPoint(float x, float y, int rotation) {
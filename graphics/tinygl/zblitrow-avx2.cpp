@@ -0,0 +1,152 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zblitrow.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The row state, expanded to vectors
+struct Context {
+	__m128i srcAShift, srcRShift, srcGShift, srcBShift;
+	__m256i srcAlphaMask;
+	__m256i aTint, rTint, gTint, bTint;
+	__m256i aTintFull, rTintFull, gTintFull, bTintFull;
+	__m256i srcFactorBase, srcFactorPlus, srcFactorMinus;
+	__m256i dstFactorBase, dstFactorPlus, dstFactorMinus;
+	__m256i storeOpaque;
+	__m128i aShift, rShift, gShift, bShift, aLoss;
+	__m256i alphaFull;
+
+	Context(const BlitRowState &state) {
+		srcAShift = _mm_cvtsi32_si128(state.srcAShift);
+		srcRShift = _mm_cvtsi32_si128(state.srcRShift);
+		srcGShift = _mm_cvtsi32_si128(state.srcGShift);
+		srcBShift = _mm_cvtsi32_si128(state.srcBShift);
+		srcAlphaMask = _mm256_set1_epi32(state.srcAlphaMask);
+		// A full tint of 65536 does not fit in 16 bits, and keeps the component
+		aTint = _mm256_set1_epi32(state.aTint & 0xffff);
+		rTint = _mm256_set1_epi32(state.rTint & 0xffff);
+		gTint = _mm256_set1_epi32(state.gTint & 0xffff);
+		bTint = _mm256_set1_epi32(state.bTint & 0xffff);
+		aTintFull = _mm256_set1_epi32(state.aTint > 0xffff ? -1 : 0);
+		rTintFull = _mm256_set1_epi32(state.rTint > 0xffff ? -1 : 0);
+		gTintFull = _mm256_set1_epi32(state.gTint > 0xffff ? -1 : 0);
+		bTintFull = _mm256_set1_epi32(state.bTint > 0xffff ? -1 : 0);
+		srcFactorBase = _mm256_set1_epi32(state.srcFactorBase);
+		srcFactorPlus = _mm256_set1_epi32(state.srcFactorSign > 0 ? -1 : 0);
+		srcFactorMinus = _mm256_set1_epi32(state.srcFactorSign < 0 ? -1 : 0);
+		dstFactorBase = _mm256_set1_epi32(state.dstFactorBase);
+		dstFactorPlus = _mm256_set1_epi32(state.dstFactorSign > 0 ? -1 : 0);
+		dstFactorMinus = _mm256_set1_epi32(state.dstFactorSign < 0 ? -1 : 0);
+		storeOpaque = _mm256_set1_epi32(state.storeOpaque ? -1 : 0);
+		aShift = _mm_cvtsi32_si128(state.aShift);
+		rShift = _mm_cvtsi32_si128(state.rShift);
+		gShift = _mm_cvtsi32_si128(state.gShift);
+		bShift = _mm_cvtsi32_si128(state.bShift);
+		aLoss = _mm_cvtsi32_si128(state.aLoss);
+		alphaFull = _mm256_set1_epi32((0xFF >> state.aLoss) << state.aShift);
+	}
+};
+
+FORCEINLINE __m256i select(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b));
+}
+
+FORCEINLINE __m256i channel(__m256i color, __m128i shift) {
+	return _mm256_and_si256(_mm256_srl_epi32(color, shift), _mm256_set1_epi32(0xff));
+}
+
+// (c * tint) >> 16 for c up to 255 and tints up to 65536
+FORCEINLINE __m256i tint(__m256i c, __m256i tint, __m256i tintFull) {
+	return _mm256_add_epi32(_mm256_mulhi_epu16(c, tint), _mm256_and_si256(c, tintFull));
+}
+
+// (c * factor) >> 8 for c up to 255 and factor up to 256
+FORCEINLINE __m256i scale(__m256i c, __m256i factor) {
+	return _mm256_srli_epi32(_mm256_mullo_epi16(c, factor), 8);
+}
+
+// Tint, blend and pack eight pixels, as in blitRow()
+FORCEINLINE __m256i blitPixels(const Context &ctx, const BlitRowState &state, __m256i src, __m256i dst) {
+	const __m256i a = tint(_mm256_or_si256(channel(src, ctx.srcAShift), ctx.srcAlphaMask), ctx.aTint, ctx.aTintFull);
+	__m256i r = tint(channel(src, ctx.srcRShift), ctx.rTint, ctx.rTintFull);
+	__m256i g = tint(channel(src, ctx.srcGShift), ctx.gTint, ctx.gTintFull);
+	__m256i b = tint(channel(src, ctx.srcBShift), ctx.bTint, ctx.bTintFull);
+
+	const __m256i color = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(a, ctx.aLoss), ctx.aShift), _mm256_sll_epi32(r, ctx.rShift)),
+	                                   _mm256_or_si256(_mm256_sll_epi32(g, ctx.gShift), _mm256_sll_epi32(b, ctx.bShift)));
+	if (!state.blending) {
+		return color;
+	}
+
+	const __m256i srcFactor = _mm256_sub_epi32(_mm256_add_epi32(ctx.srcFactorBase, _mm256_and_si256(a, ctx.srcFactorPlus)), _mm256_and_si256(a, ctx.srcFactorMinus));
+	const __m256i dstFactor = _mm256_sub_epi32(_mm256_add_epi32(ctx.dstFactorBase, _mm256_and_si256(a, ctx.dstFactorPlus)), _mm256_and_si256(a, ctx.dstFactorMinus));
+	const __m256i max = _mm256_set1_epi32(255);
+	r = _mm256_min_epi16(_mm256_add_epi32(scale(r, srcFactor), scale(channel(dst, ctx.rShift), dstFactor)), max);
+	g = _mm256_min_epi16(_mm256_add_epi32(scale(g, srcFactor), scale(channel(dst, ctx.gShift), dstFactor)), max);
+	b = _mm256_min_epi16(_mm256_add_epi32(scale(b, srcFactor), scale(channel(dst, ctx.bShift), dstFactor)), max);
+	const __m256i blended = _mm256_or_si256(_mm256_or_si256(ctx.alphaFull, _mm256_sll_epi32(r, ctx.rShift)),
+	                                     _mm256_or_si256(_mm256_sll_epi32(g, ctx.gShift), _mm256_sll_epi32(b, ctx.bShift)));
+	return select(_mm256_and_si256(_mm256_cmpeq_epi32(a, max), ctx.storeOpaque), color, blended);
+}
+
+} // end of anonymous namespace
+
+void blitRowAVX2(const BlitRowState &state, uint32 *dst, const uint32 *src, int count) {
+	const Context ctx(state);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i dstPixels = _mm256_loadu_si256((const __m256i *)(dst + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), blitPixels(ctx, state, pixels, dstPixels));
+	}
+
+	// The last pixels go through temporary buffers, so that the pixels
+	// after the row are not touched
+	if (i < count) {
+		uint32 srcRest[8] = { 0 }, dstRest[8] = { 0 };
+		memcpy(srcRest, src + i, (count - i) * sizeof(uint32));
+		memcpy(dstRest, dst + i, (count - i) * sizeof(uint32));
+		const __m256i pixels = _mm256_loadu_si256((const __m256i *)srcRest);
+		const __m256i dstPixels = _mm256_loadu_si256((const __m256i *)dstRest);
+		_mm256_storeu_si256((__m256i *)dstRest, blitPixels(ctx, state, pixels, dstPixels));
+		memcpy(dst + i, dstRest, (count - i) * sizeof(uint32));
+	}
+}
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
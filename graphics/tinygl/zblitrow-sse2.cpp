@@ -0,0 +1,155 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zblitrow.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The row state, expanded to vectors
+struct Context {
+	__m128i srcAShift, srcRShift, srcGShift, srcBShift, srcAlphaMask;
+	__m128i aTint, rTint, gTint, bTint;
+	__m128i aTintFull, rTintFull, gTintFull, bTintFull;
+	__m128i srcFactorBase, srcFactorPlus, srcFactorMinus;
+	__m128i dstFactorBase, dstFactorPlus, dstFactorMinus;
+	__m128i storeOpaque;
+	__m128i aShift, rShift, gShift, bShift, aLoss;
+	__m128i alphaFull;
+
+	Context(const BlitRowState &state) {
+		srcAShift = _mm_cvtsi32_si128(state.srcAShift);
+		srcRShift = _mm_cvtsi32_si128(state.srcRShift);
+		srcGShift = _mm_cvtsi32_si128(state.srcGShift);
+		srcBShift = _mm_cvtsi32_si128(state.srcBShift);
+		srcAlphaMask = _mm_set1_epi32(state.srcAlphaMask);
+		// A full tint of 65536 does not fit in 16 bits, and keeps the component
+		aTint = _mm_set1_epi32(state.aTint & 0xffff);
+		rTint = _mm_set1_epi32(state.rTint & 0xffff);
+		gTint = _mm_set1_epi32(state.gTint & 0xffff);
+		bTint = _mm_set1_epi32(state.bTint & 0xffff);
+		aTintFull = _mm_set1_epi32(state.aTint > 0xffff ? -1 : 0);
+		rTintFull = _mm_set1_epi32(state.rTint > 0xffff ? -1 : 0);
+		gTintFull = _mm_set1_epi32(state.gTint > 0xffff ? -1 : 0);
+		bTintFull = _mm_set1_epi32(state.bTint > 0xffff ? -1 : 0);
+		srcFactorBase = _mm_set1_epi32(state.srcFactorBase);
+		srcFactorPlus = _mm_set1_epi32(state.srcFactorSign > 0 ? -1 : 0);
+		srcFactorMinus = _mm_set1_epi32(state.srcFactorSign < 0 ? -1 : 0);
+		dstFactorBase = _mm_set1_epi32(state.dstFactorBase);
+		dstFactorPlus = _mm_set1_epi32(state.dstFactorSign > 0 ? -1 : 0);
+		dstFactorMinus = _mm_set1_epi32(state.dstFactorSign < 0 ? -1 : 0);
+		storeOpaque = _mm_set1_epi32(state.storeOpaque ? -1 : 0);
+		aShift = _mm_cvtsi32_si128(state.aShift);
+		rShift = _mm_cvtsi32_si128(state.rShift);
+		gShift = _mm_cvtsi32_si128(state.gShift);
+		bShift = _mm_cvtsi32_si128(state.bShift);
+		aLoss = _mm_cvtsi32_si128(state.aLoss);
+		alphaFull = _mm_set1_epi32((0xFF >> state.aLoss) << state.aShift);
+	}
+};
+
+FORCEINLINE __m128i select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+FORCEINLINE __m128i channel(__m128i color, __m128i shift) {
+	return _mm_and_si128(_mm_srl_epi32(color, shift), _mm_set1_epi32(0xff));
+}
+
+// (c * tint) >> 16 for c up to 255 and tints up to 65536
+FORCEINLINE __m128i tint(__m128i c, __m128i tint, __m128i tintFull) {
+	return _mm_add_epi32(_mm_mulhi_epu16(c, tint), _mm_and_si128(c, tintFull));
+}
+
+// (c * factor) >> 8 for c up to 255 and factor up to 256
+FORCEINLINE __m128i scale(__m128i c, __m128i factor) {
+	return _mm_srli_epi32(_mm_mullo_epi16(c, factor), 8);
+}
+
+// Tint, blend and pack four pixels, as in blitRow()
+FORCEINLINE __m128i blitPixels(const Context &ctx, const BlitRowState &state, __m128i src, __m128i dst) {
+	const __m128i a = tint(_mm_or_si128(channel(src, ctx.srcAShift), ctx.srcAlphaMask), ctx.aTint, ctx.aTintFull);
+	__m128i r = tint(channel(src, ctx.srcRShift), ctx.rTint, ctx.rTintFull);
+	__m128i g = tint(channel(src, ctx.srcGShift), ctx.gTint, ctx.gTintFull);
+	__m128i b = tint(channel(src, ctx.srcBShift), ctx.bTint, ctx.bTintFull);
+
+	const __m128i color = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(a, ctx.aLoss), ctx.aShift), _mm_sll_epi32(r, ctx.rShift)),
+	                                   _mm_or_si128(_mm_sll_epi32(g, ctx.gShift), _mm_sll_epi32(b, ctx.bShift)));
+	if (!state.blending) {
+		return color;
+	}
+
+	const __m128i srcFactor = _mm_sub_epi32(_mm_add_epi32(ctx.srcFactorBase, _mm_and_si128(a, ctx.srcFactorPlus)), _mm_and_si128(a, ctx.srcFactorMinus));
+	const __m128i dstFactor = _mm_sub_epi32(_mm_add_epi32(ctx.dstFactorBase, _mm_and_si128(a, ctx.dstFactorPlus)), _mm_and_si128(a, ctx.dstFactorMinus));
+	const __m128i max = _mm_set1_epi32(255);
+	r = _mm_min_epi16(_mm_add_epi32(scale(r, srcFactor), scale(channel(dst, ctx.rShift), dstFactor)), max);
+	g = _mm_min_epi16(_mm_add_epi32(scale(g, srcFactor), scale(channel(dst, ctx.gShift), dstFactor)), max);
+	b = _mm_min_epi16(_mm_add_epi32(scale(b, srcFactor), scale(channel(dst, ctx.bShift), dstFactor)), max);
+	const __m128i blended = _mm_or_si128(_mm_or_si128(ctx.alphaFull, _mm_sll_epi32(r, ctx.rShift)),
+	                                     _mm_or_si128(_mm_sll_epi32(g, ctx.gShift), _mm_sll_epi32(b, ctx.bShift)));
+	return select(_mm_and_si128(_mm_cmpeq_epi32(a, max), ctx.storeOpaque), color, blended);
+}
+
+} // end of anonymous namespace
+
+void blitRowSSE2(const BlitRowState &state, uint32 *dst, const uint32 *src, int count) {
+	const Context ctx(state);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i dstPixels = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), blitPixels(ctx, state, pixels, dstPixels));
+	}
+
+	// The last pixels go through temporary buffers, so that the pixels
+	// after the row are not touched
+	if (i < count) {
+		uint32 srcRest[4] = { 0 }, dstRest[4] = { 0 };
+		memcpy(srcRest, src + i, (count - i) * sizeof(uint32));
+		memcpy(dstRest, dst + i, (count - i) * sizeof(uint32));
+		const __m128i pixels = _mm_loadu_si128((const __m128i *)srcRest);
+		const __m128i dstPixels = _mm_loadu_si128((const __m128i *)dstRest);
+		_mm_storeu_si128((__m128i *)dstRest, blitPixels(ctx, state, pixels, dstPixels));
+		memcpy(dst + i, dstRest, (count - i) * sizeof(uint32));
+	}
+}
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef GRAPHICS_TINYGL_ZBLITROW_H
+#define GRAPHICS_TINYGL_ZBLITROW_H
+
+#include "common/scummsys.h"
+
+namespace TinyGL {
+
+/**
+ * The state of the frame buffer and the tint used to write rows of blit
+ * image pixels, set up once per blit.
+ */
+struct BlitRowState {
+	// The source pixels have 32 bits, with 8 bits per component. Sources
+	// without alpha set the alpha mask to 0xff.
+	byte srcAShift, srcRShift, srcGShift, srcBShift;
+	uint32 srcAlphaMask;
+
+	// The tinted components are (c * tint) >> 16, with tints up to 65536.
+	uint aTint, rTint, gTint, bTint;
+
+	// The blending factors are base + sign * source alpha.
+	bool blending;
+	int srcFactorBase, srcFactorSign;
+	int dstFactorBase, dstFactorSign;
+	// Pixels with full alpha are stored without blending.
+	bool storeOpaque;
+
+	// The color buffer has 32 bits per pixel, with 8 bits per component.
+	byte aShift, rShift, gShift, bShift;
+	byte aLoss;
+};
+
+/**
+ * Tint count source pixels and write them to the color buffer as
+ * FrameBuffer::writePixel() does without alpha testing, giving the same
+ * results as the per pixel code of the blits.
+ */
+typedef void (*BlitRowFunc)(const BlitRowState &state, uint32 *dst, const uint32 *src, int count);
+
+void blitRow(const BlitRowState &state, uint32 *dst, const uint32 *src, int count);
+#ifdef SCUMMVM_SSE2
+void blitRowSSE2(const BlitRowState &state, uint32 *dst, const uint32 *src, int count);
+#endif
+#ifdef SCUMMVM_AVX2
+void blitRowAVX2(const BlitRowState &state, uint32 *dst, const uint32 *src, int count);
+#endif
+
+namespace Internal {
+/**
+ * Return the row function for the CPU.
+ */
+BlitRowFunc getBlitRowFunc();
+
+/**
+ * Override the row function, for testing. nullptr selects the per pixel
+ * code of the blits.
+ */
+void setBlitRowFunc(BlitRowFunc func);
+} // end of namespace Internal
+
+} // end of namespace TinyGL
+
+#endif // GRAPHICS_TINYGL_ZBLITROW_H
@@ -54,11 +54,23 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_offscreenBuffer.zbuf = _zbuf;
 
 	_currentTexture = nullptr;
+	_nextTexture = nullptr;
+	_lodFraction = 0;
 
 	_enableScissor = false;
+
+	_depthTilesPerRow = (_pbufWidth + ZB_DEPTH_TILE_SIZE - 1) >> ZB_DEPTH_TILE_SHIFT;
+	_depthTileRows = (_pbufHeight + ZB_DEPTH_TILE_SIZE - 1) >> ZB_DEPTH_TILE_SHIFT;
+	_depthTiles = (DepthTile *)gl_malloc(_depthTilesPerRow * _depthTileRows * sizeof(DepthTile));
+	setDepthTiles(0);
+	_depthTilesEnabled = true;
+	resetDepthStats();
+	_shadedPixels = 0;
+	_rejectedPixels = 0;
 }
 
 FrameBuffer::~FrameBuffer() {
+	gl_free(_depthTiles);
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
@@ -91,6 +103,7 @@ void FrameBuffer::clear(int clearZ, int z, int clearColor, int r, int g, int b,
 			// Cannot use memset, use a variant working on integers (possibly slower)
 			Common::memset32((uint32 *)_zbuf, z, _pbufWidth * _pbufHeight);
 		}
+		setDepthTiles(z);
 	}
 	if (clearColor) {
 		byte *pp = _pbuf;
@@ -141,6 +154,7 @@ void FrameBuffer::clearRegion(int x, int y, int w, int h, bool clearZ, int z,
 				zbuf += _pbufWidth;
 			}
 		}
+		invalidateDepthTiles(x, y, x + w - 1, y + h - 1);
 	}
 	if (clearColor) {
 		int height = h;
@@ -193,6 +207,7 @@ void FrameBuffer::blitOffscreenBuffer(Buffer *buf) {
 	// TODO: could be faster, probably.
 #define UNROLL_COUNT 16
 	if (buf->used) {
+		invalidateDepthTiles(0, 0, _pbufWidth - 1, _pbufHeight - 1);
 		const int pixel_bytes = _pbufBpp;
 		const int unrolled_pixel_bytes = pixel_bytes * UNROLL_COUNT;
 		byte *to = _pbuf;
@@ -253,12 +268,121 @@ void FrameBuffer::selectOffscreenBuffer(Buffer *buf) {
 		_pbuf = _offscreenBuffer.pbuf;
 		_zbuf = _offscreenBuffer.zbuf;
 	}
+	// The tiles only follow one z buffer
+	invalidateDepthTiles(0, 0, _pbufWidth - 1, _pbufHeight - 1);
 }
 
 void FrameBuffer::clearOffscreenBuffer(Buffer *buf) {
 	memset(buf->pbuf, 0, _pbufHeight * _pbufPitch);
 	memset(buf->zbuf, 0, _pbufHeight * _pbufWidth * sizeof(uint));
 	buf->used = false;
+	if (buf->zbuf == _zbuf)
+		setDepthTiles(0);
+}
+
+void FrameBuffer::setDepthTiles(uint z) {
+	const DepthTile tile = { z, z, false };
+	for (int i = 0; i < _depthTilesPerRow * _depthTileRows; i++)
+		_depthTiles[i] = tile;
+}
+
+void FrameBuffer::invalidateDepthTiles(int left, int top, int right, int bottom) {
+	left = MAX(left, 0) >> ZB_DEPTH_TILE_SHIFT;
+	top = MAX(top, 0) >> ZB_DEPTH_TILE_SHIFT;
+	right = MIN(right, _pbufWidth - 1) >> ZB_DEPTH_TILE_SHIFT;
+	bottom = MIN(bottom, _pbufHeight - 1) >> ZB_DEPTH_TILE_SHIFT;
+	for (int y = top; y <= bottom; y++) {
+		DepthTile *tile = _depthTiles + y * _depthTilesPerRow;
+		for (int x = left; x <= right; x++)
+			tile[x].dirty = true;
+	}
+}
+
+const FrameBuffer::DepthTile &FrameBuffer::getDepthTile(int x, int y) {
+	DepthTile &tile = _depthTiles[y * _depthTilesPerRow + x];
+	if (tile.dirty) {
+		const int width = MIN(ZB_DEPTH_TILE_SIZE, _pbufWidth - (x << ZB_DEPTH_TILE_SHIFT));
+		const int height = MIN(ZB_DEPTH_TILE_SIZE, _pbufHeight - (y << ZB_DEPTH_TILE_SHIFT));
+		const uint *zbuf = _zbuf + (y << ZB_DEPTH_TILE_SHIFT) * _pbufWidth + (x << ZB_DEPTH_TILE_SHIFT);
+		uint zMin = zbuf[0], zMax = zbuf[0];
+		for (int j = 0; j < height; j++) {
+			for (int i = 0; i < width; i++) {
+				zMin = MIN(zMin, zbuf[i]);
+				zMax = MAX(zMax, zbuf[i]);
+			}
+			zbuf += _pbufWidth;
+		}
+		tile.zMin = zMin;
+		tile.zMax = zMax;
+		tile.dirty = false;
+		_depthStats.updatedTiles++;
+	}
+	return tile;
+}
+
+// Whether the depth test fails for every pixel of the rectangle, inclusive,
+// with depth values between zMin and zMax. Remember that the depth values
+// grow towards the viewer.
+bool FrameBuffer::isDepthHidden(int left, int top, int right, int bottom, uint zMin, uint zMax) {
+	left = MAX(left, 0);
+	top = MAX(top, 0);
+	right = MIN(right, _pbufWidth - 1);
+	bottom = MIN(bottom, _pbufHeight - 1);
+	if (left > right || top > bottom)
+		return false;
+
+	left >>= ZB_DEPTH_TILE_SHIFT;
+	top >>= ZB_DEPTH_TILE_SHIFT;
+	right >>= ZB_DEPTH_TILE_SHIFT;
+	bottom >>= ZB_DEPTH_TILE_SHIFT;
+	for (int y = top; y <= bottom; y++) {
+		for (int x = left; x <= right; x++) {
+			const DepthTile &tile = getDepthTile(x, y);
+			bool hidden;
+			switch (_depthFunc) {
+			case TGL_NEVER:
+				hidden = true;
+				break;
+			case TGL_LESS:
+				hidden = zMax <= tile.zMin;
+				break;
+			case TGL_LEQUAL:
+				hidden = zMax < tile.zMin;
+				break;
+			case TGL_GREATER:
+				hidden = zMin >= tile.zMax;
+				break;
+			case TGL_GEQUAL:
+				hidden = zMin > tile.zMax;
+				break;
+			default:
+				hidden = false;
+				break;
+			}
+			if (!hidden)
+				return false;
+		}
+	}
+	_depthStats.rejectedTiles += (right - left + 1) * (bottom - top + 1);
+	return true;
+}
+
+void enableHierarchicalDepth(bool enable) {
+	GLContext *c = gl_get_context();
+	assert(c->fb);
+	c->fb->enableDepthTiles(enable);
+}
+
+void getDepthStats(DepthStats &stats) {
+	GLContext *c = gl_get_context();
+	assert(c->fb);
+	stats = c->fb->getDepthStats();
+}
+
+void resetDepthStats() {
+	GLContext *c = gl_get_context();
+	assert(c->fb);
+	c->fb->resetDepthStats();
 }
 
 void getSurfaceRef(Graphics::Surface &surface) {
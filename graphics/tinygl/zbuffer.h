@@ -31,11 +31,15 @@
 #include "graphics/surface.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/tinygl.h"
 
 #include "common/rect.h"
 
 namespace TinyGL {
 
+struct SpanState;
+struct BlitRowState;
+
 // Z buffer
 
 #define ZB_Z_BITS 16
@@ -45,6 +49,10 @@ namespace TinyGL {
 
 #define ZB_POINT_Z_FRAC_BITS 14
 
+// Hierarchical z buffer tiles, 8x8 pixels
+#define ZB_DEPTH_TILE_SHIFT 3
+#define ZB_DEPTH_TILE_SIZE (1 << ZB_DEPTH_TILE_SHIFT)
+
 #define ZB_POINT_ST_FRAC_BITS 14
 #define ZB_POINT_ST_FRAC_SHIFT     (ZB_POINT_ST_FRAC_BITS - 1)
 #define ZB_POINT_ST_MAX            ( (_textureSize << ZB_POINT_ST_FRAC_BITS) - 1 )
@@ -144,6 +152,12 @@ struct FrameBuffer {
 		surface.init(_pbufWidth, _pbufHeight, _pbufPitch, _pbuf, _pbufFormat);
 	}
 
+	/**
+	 * Set up the state for writing rows of blit image pixels in the given
+	 * format, if the row functions support the formats and the state.
+	 */
+	bool getBlitRowState(BlitRowState &state, const Graphics::PixelFormat &srcFormat) const;
+
 private:
 
 	FORCEINLINE void setPixelAt(int pixel, uint32 value) {
@@ -621,6 +635,31 @@ public:
 		_stencilMask = stencilMask;
 	}
 
+	void enableDepthTiles(bool enable) {
+		_depthTilesEnabled = enable;
+	}
+
+	const DepthStats &getDepthStats() const {
+		return _depthStats;
+	}
+
+	void resetDepthStats() {
+		memset(&_depthStats, 0, sizeof(_depthStats));
+	}
+
+	// Running totals of the pixels of the triangles which were shaded, and
+	// of the ones skipped by the hierarchical z buffer, for the profiling
+	uint32 getShadedPixels() const {
+		return _shadedPixels;
+	}
+
+	uint32 getRejectedPixels() const {
+		return _rejectedPixels;
+	}
+
+	// Mark the tiles of the pixels in the rectangle, inclusive, as changed
+	void invalidateDepthTiles(int left, int top, int right, int bottom);
+
 	void setStencilOp(int stencilSfail, int stencilDpfail, int stencilDppass) {
 		_stencilSfail = stencilSfail;
 		_stencilDpfail = stencilDpfail;
@@ -639,10 +678,15 @@ public:
 		_offsetUnits = offsetUnits;
 	}
 
-	void setTexture(const TexelBuffer *texture, uint wraps, uint wrapt) {
+	// With a next level, the samples of both mipmap levels are blended by
+	// lodFraction / 256
+	void setTexture(const TexelBuffer *texture, uint wraps, uint wrapt,
+	                const TexelBuffer *nextLevel = nullptr, uint lodFraction = 0) {
 		_currentTexture = texture;
 		_wrapS = wraps;
 		_wrapT = wrapt;
+		_nextTexture = nextLevel;
+		_lodFraction = lodFraction;
 	}
 
 	void setTextureSizeAndMask(int textureSize, int textureSizeMask) {
@@ -673,6 +717,9 @@ private:
 	void selectOffscreenBuffer(Buffer *buffer);
 	void clearOffscreenBuffer(Buffer *buffer);
 
+	template <bool kDepthWrite, bool kBlendingEnabled, bool kDepthTestEnabled>
+	bool getSpanState(SpanState &state) const;
+
 	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, bool kSmoothMode,
 	          bool kDepthWrite, bool kFogMode, bool kAlphaTestEnabled, bool kEnableScissor,
 	          bool kBlendingEnabled, bool kStencilEnabled, bool kDepthTestEnabled>
@@ -740,6 +787,33 @@ private:
 	template <bool kInterpRGB, bool kInterpZ, bool kDepthWrite, bool kEnableScissor>
 	void drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2);
 
+	/**
+	 * The hierarchical z buffer keeps the range of the depth values of every
+	 * tile, so that the triangles and spans whose depth test would fail for
+	 * every pixel are skipped without testing the pixels one by one. A dirty
+	 * tile was drawn to since its range was computed.
+	 */
+	struct DepthTile {
+		uint zMin, zMax;
+		bool dirty;
+	};
+
+	const DepthTile &getDepthTile(int x, int y);
+	void setDepthTiles(uint z);
+	bool isDepthHidden(int left, int top, int right, int bottom, uint zMin, uint zMax);
+
+	// The span starts at x1 with the depth z1, but may be drawn from left
+	FORCEINLINE bool isSpanHidden(int x1, int left, int right, int y, uint z1, int dzdx) {
+		const uint zLeft = z1 + dzdx * (uint)(left - x1);
+		const uint zRight = z1 + dzdx * (uint)(right - x1);
+		if (isDepthHidden(left, y, right, y, MIN(zLeft, zRight), MAX(zLeft, zRight))) {
+			_depthStats.rejectedSpans++;
+			_rejectedPixels += right - left + 1;
+			return true;
+		}
+		return false;
+	}
+
 	Buffer _offscreenBuffer;
 	byte *_pbuf;
 	int _pbufWidth;
@@ -759,6 +833,8 @@ private:
 	bool _enableScissor;
 
 	const TexelBuffer *_currentTexture;
+	const TexelBuffer *_nextTexture;
+	uint _lodFraction;
 	uint _wrapS, _wrapT;
 	bool _blendingEnabled;
 	int _sourceBlendingFactor;
@@ -784,6 +860,14 @@ private:
 	float _fogColorR;
 	float _fogColorG;
 	float _fogColorB;
+
+	DepthTile *_depthTiles;
+	int _depthTilesPerRow;
+	int _depthTileRows;
+	bool _depthTilesEnabled;
+	DepthStats _depthStats;
+	uint32 _shadedPixels;
+	uint32 _rejectedPixels;
 };
 
 // memory.c
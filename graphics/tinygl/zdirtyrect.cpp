@@ -23,8 +23,11 @@
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/gl.h"
 
+#include "common/algorithm.h"
 #include "common/debug.h"
+#include "common/file.h"
 #include "common/math.h"
+#include "common/system.h"
 
 namespace TinyGL {
 
@@ -73,6 +76,33 @@ struct DirtyRectangle {
 	}
 };
 
+// Past these numbers of dirty rectangles, before and after merging them,
+// the whole screen is drawn again instead
+static const uint kMaxDirtyRectangles = 64;
+static const uint kMaxMergedDirtyRectangles = 16;
+
+// Signatures are FNV-1a hashes of the words describing the draw calls
+static const uint32 kSignatureBasis = 2166136261u;
+
+static inline uint32 hashWord(uint32 hash, uint32 value) {
+	return (hash ^ value) * 16777619u;
+}
+
+static inline uint32 hashFloat(uint32 hash, float value) {
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return hashWord(hash, bits);
+}
+
+static inline uint32 hashPointer(uint32 hash, const void *pointer) {
+	return hashWord(hash, (uint32)(uintptr)pointer);
+}
+
+static inline uint32 hashRect(uint32 hash, const Common::Rect &rect) {
+	hash = hashWord(hash, (uint32)rect.left | ((uint32)rect.top << 16));
+	return hashWord(hash, (uint32)rect.right | ((uint32)rect.bottom << 16));
+}
+
 void GLContext::disposeResources() {
 	// Dispose textures and resources.
 	bool allDisposed = true;
@@ -119,35 +149,80 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 
 	Common::List<DirtyRectangle> rectangles;
 
-	DrawCallIterator itFrame = _drawCallsQueue.begin();
-	DrawCallIterator endFrame = _drawCallsQueue.end();
-	DrawCallIterator itPrevFrame = _previousFrameDrawCallsQueue.begin();
-	DrawCallIterator endPrevFrame = _previousFrameDrawCallsQueue.end();
-
-	// Compare draw calls.
-	for ( ; itPrevFrame != endPrevFrame && itFrame != endFrame;
-		++itPrevFrame, ++itFrame) {
-			const DrawCall &currentCall = **itFrame;
-			const DrawCall &previousCall = **itPrevFrame;
+	// Index the calls of the previous frame by their signatures. The calls
+	// with the same signature are chained in the order they were drawn.
+	Common::Array<DrawCall *> previousCalls;
+	Common::Array<int> nextPreviousCall;
+	Common::Array<bool> matchedPreviousCall;
+	previousCalls.reserve(_previousFrameDrawCallsQueue.size());
+	for (DrawCallIterator it = _previousFrameDrawCallsQueue.begin(); it != _previousFrameDrawCallsQueue.end(); ++it) {
+		previousCalls.push_back(*it);
+	}
+	nextPreviousCall.resize(previousCalls.size());
+	matchedPreviousCall.resize(previousCalls.size());
+	_previousCallsBySignature.clear();
+	for (int i = (int)previousCalls.size() - 1; i >= 0; i--) {
+		const uint32 signature = previousCalls[i]->getSignature();
+		nextPreviousCall[i] = _previousCallsBySignature.getValOrDefault(signature, -1);
+		_previousCallsBySignature[signature] = i;
+		matchedPreviousCall[i] = false;
+	}
 
-			if (previousCall != currentCall) {
-				_appendDirtyRectangle(previousCall, rectangles, 255, 255, 255);
-				_appendDirtyRectangle(currentCall, rectangles, 255, 0, 0);
+	// Look for every call in the previous frame. The matched calls have to
+	// be in the same order in both frames, so that the calls covering a
+	// pixel outside of the dirty rectangles are the same. Inserting or
+	// removing calls only makes their own regions dirty.
+	int lastMatch = -1;
+	uint changedCalls = 0, numRectangles = 0;
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		const DrawCall &currentCall = **it;
+		bool matched = false;
+		Common::HashMap<uint32, int>::iterator chain = _previousCallsBySignature.find(currentCall.getSignature());
+		if (chain != _previousCallsBySignature.end()) {
+			// The calls before the last match can no longer be matched
+			int i = chain->_value;
+			while (i != -1 && i <= lastMatch) {
+				i = nextPreviousCall[i];
+			}
+			chain->_value = i;
+			for ( ; i != -1; i = nextPreviousCall[i]) {
+				if (*previousCalls[i] == currentCall) {
+					matchedPreviousCall[i] = true;
+					lastMatch = i;
+					matched = true;
+					break;
+				}
 			}
+		}
+		if (!matched) {
+			_appendDirtyRectangle(currentCall, rectangles, 255, 0, 0);
+			changedCalls++;
+		}
 	}
 
-	for ( ; itPrevFrame != endPrevFrame; ++itPrevFrame) {
-		_appendDirtyRectangle(**itPrevFrame, rectangles, 255, 255, 255);
+	for (uint i = 0; i < previousCalls.size(); i++) {
+		if (!matchedPreviousCall[i]) {
+			_appendDirtyRectangle(*previousCalls[i], rectangles, 255, 255, 255);
+		}
 	}
 
-	for ( ; itFrame != endFrame; ++itFrame) {
-		_appendDirtyRectangle(**itFrame, rectangles, 255, 0, 0);
+	if (_profilingEnabled) {
+		_frameStats.changedDrawCalls = changedCalls;
 	}
 
 	// This loop increases outer rectangle coordinates to favor merging of adjacent rectangles.
 	for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
 		(*it).rectangle.right++;
 		(*it).rectangle.bottom++;
+		numRectangles++;
+	}
+
+	// Merging the rectangles takes quadratic time, and the draw calls are
+	// executed once for each rectangle they cross: past some number of
+	// rectangles, drawing the whole screen once is cheaper.
+	if (numRectangles > kMaxDirtyRectangles) {
+		rectangles.clear();
+		rectangles.push_back(DirtyRectangle(renderRect, 0, 0, 255));
 	}
 
 	// Merge coalesce dirty rects.
@@ -183,8 +258,19 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 	}
 
+	int dirtyArea = 0;
+	numRectangles = 0;
 	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
 		(*it1).rectangle.clip(renderRect);
+		dirtyArea += (*it1).rectangle.width() * (*it1).rectangle.height();
+		numRectangles++;
+	}
+
+	// The same goes for merged rectangles covering most of the screen
+	if (numRectangles > 1 && (numRectangles > kMaxMergedDirtyRectangles ||
+	                          dirtyArea * 4 > renderRect.width() * renderRect.height() * 3)) {
+		rectangles.clear();
+		rectangles.push_back(DirtyRectangle(renderRect, 0, 0, 255));
 	}
 
 	if (!rectangles.empty()) {
@@ -193,12 +279,18 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (canExecuteTiled()) {
 			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+				executeDrawCallsTiled((*itRect).rectangle);
+			}
+		} else {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						executeDrawCall(*it, &dirtyRegion);
+					}
 				}
 			}
 		}
@@ -240,9 +332,16 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 
 	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
 
-	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
-		delete *it;
+	if (canExecuteTiled()) {
+		executeDrawCallsTiled(renderRect);
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			delete *it;
+		}
+	} else {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			executeDrawCall(*it, nullptr);
+			delete *it;
+		}
 	}
 
 	_drawCallsQueue.clear();
@@ -252,13 +351,158 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+bool GLContext::canExecuteTiled() const {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	if (_tileSize <= 0)
+		return false;
+
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		if (!(*it)->isSplittable())
+			return false;
+	}
+	return true;
+}
+
+void GLContext::executeDrawCallsTiled(const Common::Rect &region) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	if (region.isEmpty())
+		return;
+
+	const int tilesX = (region.width() + _tileSize - 1) / _tileSize;
+	const int tilesY = (region.height() + _tileSize - 1) / _tileSize;
+
+	// The bins keep their storage from one frame to the next
+	_tileBins.resize(tilesX * tilesY);
+	for (uint i = 0; i < _tileBins.size(); i++) {
+		_tileBins[i].resize(0);
+	}
+
+	// Sort the draw calls into the tiles they cover, keeping their order.
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (!drawCallRegion.intersects(region))
+			continue;
+		drawCallRegion.clip(region);
+
+		const int left = (drawCallRegion.left - region.left) / _tileSize;
+		const int right = (drawCallRegion.right - 1 - region.left) / _tileSize;
+		const int top = (drawCallRegion.top - region.top) / _tileSize;
+		const int bottom = (drawCallRegion.bottom - 1 - region.top) / _tileSize;
+		for (int y = top; y <= bottom; y++) {
+			for (int x = left; x <= right; x++) {
+				_tileBins[y * tilesX + x].push_back(*it);
+			}
+		}
+	}
+
+	// Each tile only depends on the draw calls in its bin, so the tiles
+	// could be drawn in any order.
+	for (int y = 0; y < tilesY; y++) {
+		for (int x = 0; x < tilesX; x++) {
+			const Common::Array<DrawCall *> &bin = _tileBins[y * tilesX + x];
+			Common::Rect tile(region.left + x * _tileSize, region.top + y * _tileSize,
+			                  region.left + (x + 1) * _tileSize, region.top + (y + 1) * _tileSize);
+			tile.clip(region);
+			for (uint i = 0; i < bin.size(); i++) {
+				executeDrawCall(bin[i], &tile);
+			}
+		}
+	}
+}
+
+void GLContext::executeDrawCall(DrawCall *drawCall, const Common::Rect *clippingRectangle) {
+	if (!_profilingEnabled) {
+		if (clippingRectangle) {
+			drawCall->execute(*clippingRectangle, true);
+		} else {
+			drawCall->execute(true);
+		}
+		return;
+	}
+
+	DrawCallStats &stats = _drawCallStats[drawCall->getStatsIndex()];
+	const uint32 triangles = _frameStats.trianglesOut;
+	const uint32 pixels = fb->getShadedPixels();
+	const uint64 startTime = g_system->getMicros();
+
+	if (clippingRectangle) {
+		drawCall->execute(*clippingRectangle, true);
+	} else {
+		drawCall->execute(true);
+	}
+
+	const uint32 time = (uint32)(g_system->getMicros() - startTime);
+	stats.executions++;
+	stats.triangles += _frameStats.trianglesOut - triangles;
+	stats.pixelsShaded += fb->getShadedPixels() - pixels;
+	stats.executeTime += time;
+	_frameStats.executedDrawCalls++;
+	_frameStats.executeTime += time;
+}
+
+void GLContext::beginFrameStats() {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	memset(&_frameStats, 0, sizeof(_frameStats));
+	_drawCallStats.clear();
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		DrawCallStats stats;
+		stats.description = (*it)->getDescription();
+		stats.region = (*it)->getDirtyRegion();
+		stats.executions = 0;
+		stats.triangles = 0;
+		stats.pixelsShaded = 0;
+		stats.executeTime = 0;
+		(*it)->setStatsIndex(_drawCallStats.size());
+		_drawCallStats.push_back(stats);
+
+		_frameStats.drawCalls++;
+		if ((*it)->getType() == DrawCall::DrawCall_Blitting)
+			_frameStats.blitCalls++;
+	}
+
+	// The pixel counters of the frame buffer keep running, so the frame
+	// statistics start with their values and take the difference at the end
+	_frameStats.pixelsShaded = fb->getShadedPixels();
+	_frameStats.pixelsDepthRejected = fb->getRejectedPixels();
+}
+
+void GLContext::endFrameStats(const Common::List<Common::Rect> &dirtyAreas, uint firstDirtyArea) {
+	typedef Common::List<Common::Rect>::const_iterator RectangleIterator;
+
+	_frameStats.pixelsShaded = fb->getShadedPixels() - _frameStats.pixelsShaded;
+	_frameStats.pixelsDepthRejected = fb->getRejectedPixels() - _frameStats.pixelsDepthRejected;
+
+	uint index = 0;
+	for (RectangleIterator it = dirtyAreas.begin(); it != dirtyAreas.end(); ++it, ++index) {
+		if (index >= firstDirtyArea)
+			_frameStats.dirtyArea += (*it).width() * (*it).height();
+	}
+}
+
+void setTileSize(int tileSize) {
+	gl_get_context()->_tileSize = MAX(tileSize, 0);
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
+	const bool profiling = c->_profilingEnabled;
+	const uint firstDirtyArea = profiling ? dirtyAreas.size() : 0;
+	if (profiling) {
+		c->beginFrameStats();
+	}
+
 	if (c->_enableDirtyRectangles) {
 		c->presentBufferDirtyRects(dirtyAreas);
 	} else {
 		c->presentBufferSimple(dirtyAreas);
 	}
+
+	if (profiling) {
+		c->endFrameStats(dirtyAreas, firstDirtyArea);
+	}
 }
 
 void presentBuffer() {
@@ -266,6 +510,68 @@ void presentBuffer() {
 	presentBuffer(dirtyAreas);
 }
 
+void enableProfiling(bool enable) {
+	gl_get_context()->_profilingEnabled = enable;
+}
+
+void getFrameStats(FrameStats &stats) {
+	stats = gl_get_context()->_frameStats;
+}
+
+void getDrawCallStats(Common::Array<DrawCallStats> &stats) {
+	stats = gl_get_context()->_drawCallStats;
+}
+
+Common::String formatFrameStats(uint maxDrawCalls) {
+	GLContext *c = gl_get_context();
+	const FrameStats &frame = c->_frameStats;
+
+	Common::String text;
+	text += Common::String::format("Draw calls: %u queued, %u changed, %u executed, %u blits\n",
+	                               frame.drawCalls, frame.changedDrawCalls, frame.executedDrawCalls, frame.blitCalls);
+	text += Common::String::format("Triangles: %u in, %u out, %u textured\n",
+	                               frame.trianglesIn, frame.trianglesOut, frame.texturedTriangles);
+	text += Common::String::format("Pixels: %u shaded, %u depth rejected, %u dirty\n",
+	                               frame.pixelsShaded, frame.pixelsDepthRejected, frame.dirtyArea);
+	text += Common::String::format("Execution time: %u us\n", frame.executeTime);
+	if (maxDrawCalls == 0 || c->_drawCallStats.empty())
+		return text;
+
+	// The slowest draw calls first, numbered by their position in the frame
+	Common::Array<uint> order;
+	order.resize(c->_drawCallStats.size());
+	for (uint i = 0; i < order.size(); i++)
+		order[i] = i;
+	Common::sort(order.begin(), order.end(), [c](uint a, uint b) {
+		const uint32 timeA = c->_drawCallStats[a].executeTime, timeB = c->_drawCallStats[b].executeTime;
+		return timeA != timeB ? timeA > timeB : a < b;
+	});
+
+	text += "\n#   time (us)  runs  triangles  pixels  region  description\n";
+	for (uint i = 0; i < order.size() && i < maxDrawCalls; i++) {
+		const DrawCallStats &stats = c->_drawCallStats[order[i]];
+		text += Common::String::format("%-3u %9u  %4u  %9u  %6u  (%d, %d) %dx%d  %s\n",
+		                               order[i], stats.executeTime, stats.executions, stats.triangles, stats.pixelsShaded,
+		                               stats.region.left, stats.region.top, stats.region.width(), stats.region.height(),
+		                               stats.description.c_str());
+	}
+	return text;
+}
+
+bool dumpFrameStats(const Common::Path &fileName) {
+	GLContext *c = gl_get_context();
+
+	Common::DumpFile file;
+	if (!file.open(fileName, true)) {
+		warning("TinyGL: Unable to write the frame statistics to '%s'", fileName.toString().c_str());
+		return false;
+	}
+
+	file.writeString(formatFrameStats(c->_drawCallStats.size()));
+	file.finalize();
+	return !file.err();
+}
+
 bool DrawCall::operator==(const DrawCall &other) const {
 	if (_type == other._type) {
 		switch (_type) {
@@ -295,9 +601,12 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
 	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_tileSize > 0) {
 		computeDirtyRegion();
 	}
+	if (c->_enableDirtyRectangles) {
+		computeSignature();
+	}
 }
 
 void RasterizationDrawCall::computeDirtyRegion() {
@@ -333,6 +642,30 @@ void RasterizationDrawCall::computeDirtyRegion() {
 	}
 }
 
+// Only a part of the vertices and of the state is hashed: the calls with the
+// same signature are still compared.
+void RasterizationDrawCall::computeSignature() {
+	uint32 hash = hashWord(kSignatureBasis, DrawCall_Rasterization);
+	hash = hashRect(hash, _dirtyRegion);
+	hash = hashWord(hash, _vertexCount);
+	hash = hashWord(hash, _state.beginType);
+	hash = hashPointer(hash, _state.texture);
+	hash = hashWord(hash, _state.textureVersion);
+	hash = hashWord(hash, _state.texture2DEnabled | (_state.enableBlending << 1) | (_state.depthTestEnabled << 2));
+	for (int i = 0; i < _vertexCount; i++) {
+		const GLVertex &v = _vertex[i];
+		hash = hashWord(hash, (uint32)v.zp.x | ((uint32)v.zp.y << 16));
+		hash = hashWord(hash, v.zp.z);
+		hash = hashFloat(hash, v.color.X);
+		hash = hashFloat(hash, v.color.Y);
+		hash = hashFloat(hash, v.color.Z);
+		hash = hashFloat(hash, v.color.W);
+		hash = hashFloat(hash, v.tex_coord.X);
+		hash = hashFloat(hash, v.tex_coord.Y);
+	}
+	_signature = hash;
+}
+
 void RasterizationDrawCall::execute(bool restoreState) const {
 	GLContext *c = gl_get_context();
 
@@ -404,6 +737,7 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 			c->vertex[i + 2].edge_flag = 1;
 			c->vertex[i + 0].edge_flag = 0;
 			c->gl_draw_triangle(&c->vertex[i], &c->vertex[i + 2], &c->vertex[i + 3]);
+			c->vertex[i + 0].edge_flag = 1;
 		}
 		break;
 	case TGL_QUAD_STRIP:
@@ -471,6 +805,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	state.texture = c->current_texture;
 	state.wrapS = c->texture_wrap_s;
 	state.wrapT = c->texture_wrap_t;
+	state.minFilter = c->texture_min_filter;
 	state.lightingEnabled = c->lighting_enabled;
 	state.textureVersion = c->current_texture->versionNumber;
 	state.fogEnabled = c->fog_enabled;
@@ -539,6 +874,7 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	c->current_texture = state.texture;
 	c->texture_wrap_s = state.wrapS;
 	c->texture_wrap_t = state.wrapT;
+	c->texture_min_filter = state.minFilter;
 	c->fog_enabled = state.fogEnabled;
 	c->fog_color = Vector4(state.fogColorR, state.fogColorG, state.fogColorB, 1.0f);
 
@@ -553,6 +889,59 @@ void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool
 	c->fb->resetScissorRectangle();
 }
 
+bool RasterizationDrawCall::isSplittable() const {
+	// Quad strips are drawn by shifting the recorded vertices
+	return _state.beginType != TGL_QUAD_STRIP;
+}
+
+Common::String RasterizationDrawCall::getDescription() const {
+	const char *primitive;
+	switch (_state.beginType) {
+	case TGL_POINTS:
+		primitive = "points";
+		break;
+	case TGL_LINES:
+		primitive = "lines";
+		break;
+	case TGL_LINE_LOOP:
+		primitive = "line loop";
+		break;
+	case TGL_LINE_STRIP:
+		primitive = "line strip";
+		break;
+	case TGL_TRIANGLES:
+		primitive = "triangles";
+		break;
+	case TGL_TRIANGLE_STRIP:
+		primitive = "triangle strip";
+		break;
+	case TGL_TRIANGLE_FAN:
+		primitive = "triangle fan";
+		break;
+	case TGL_QUADS:
+		primitive = "quads";
+		break;
+	case TGL_QUAD_STRIP:
+		primitive = "quad strip";
+		break;
+	case TGL_POLYGON:
+		primitive = "polygon";
+		break;
+	default:
+		primitive = "unknown";
+		break;
+	}
+
+	Common::String description = Common::String::format("%s, %d vertices", primitive, _vertexCount);
+	if (_state.texture2DEnabled)
+		description += ", textured";
+	if (_state.enableBlending)
+		description += ", blended";
+	if (!_state.colorMaskRed && !_state.colorMaskGreen && !_state.colorMaskBlue && !_state.colorMaskAlpha)
+		description += ", depth only";
+	return description;
+}
+
 bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const {
 	if (_vertexCount == other._vertexCount &&
 		_drawTriangleFront == other._drawTriangleFront &&
@@ -573,15 +962,35 @@ BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transf
 	tglIncBlitImageRef(image);
 	_blitState = captureState();
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	GLContext *c = gl_get_context();
+	if (c->_enableDirtyRectangles || c->_tileSize > 0) {
 		computeDirtyRegion();
 	}
+	if (c->_enableDirtyRectangles) {
+		computeSignature();
+	}
 }
 
 BlittingDrawCall::~BlittingDrawCall() {
 	tglDeleteBlitImage(_image);
 }
 
+void BlittingDrawCall::computeSignature() {
+	uint32 hash = hashWord(kSignatureBasis, DrawCall_Blitting);
+	hash = hashWord(hash, _mode);
+	hash = hashPointer(hash, _image);
+	hash = hashWord(hash, _imageVersion);
+	hash = hashRect(hash, _transform._destinationRectangle);
+	hash = hashRect(hash, _transform._sourceRectangle);
+	hash = hashWord(hash, _transform._rotation);
+	hash = hashFloat(hash, _transform._aTint);
+	hash = hashFloat(hash, _transform._rTint);
+	hash = hashFloat(hash, _transform._gTint);
+	hash = hashFloat(hash, _transform._bTint);
+	hash = hashWord(hash, _transform._flipHorizontally | (_transform._flipVertically << 1) | (_blitState.enableBlending << 2));
+	_signature = hash;
+}
+
 void BlittingDrawCall::execute(bool restoreState) const {
 	BlittingState backupState;
 	if (restoreState) {
@@ -613,6 +1022,38 @@ void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool resto
 	Internal::tglBlitResetScissorRect();
 }
 
+bool BlittingDrawCall::isSplittable() const {
+	// Clipping a scaled, rotated or flipped image moves its source pixels
+	if (_mode != BlitMode_Regular)
+		return true;
+	return _transform._destinationRectangle.width() == 0 && _transform._destinationRectangle.height() == 0 &&
+	       _transform._rotation == 0 && !_transform._flipHorizontally && !_transform._flipVertically;
+}
+
+Common::String BlittingDrawCall::getDescription() const {
+	Common::String description;
+	switch (_mode) {
+	case BlitMode_Regular:
+		description = "blit";
+		break;
+	case BlitMode_Fast:
+		description = "fast blit";
+		break;
+	case BlitMode_ZBuffer:
+		description = "z buffer blit";
+		break;
+	}
+	if (!_transform._sourceRectangle.isEmpty())
+		description += Common::String::format(", %dx%d source", _transform._sourceRectangle.width(), _transform._sourceRectangle.height());
+	if (_transform._rotation != 0)
+		description += ", rotated";
+	if (_transform._aTint != 1.0f || _transform._rTint != 1.0f || _transform._gTint != 1.0f || _transform._bTint != 1.0f)
+		description += ", tinted";
+	if (_blitState.enableBlending)
+		description += ", blended";
+	return description;
+}
+
 BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	BlittingState state;
 	TinyGL::GLContext *c = gl_get_context();
@@ -690,9 +1131,16 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_tileSize > 0) {
 		_dirtyRegion = c->renderRect;
 	}
+	if (c->_enableDirtyRectangles) {
+		uint32 hash = hashWord(kSignatureBasis, DrawCall_Clear);
+		hash = hashWord(hash, _clearZBuffer | (_clearColorBuffer << 1) | (_clearStencilBuffer << 2));
+		hash = hashWord(hash, _zValue);
+		hash = hashWord(hash, _rValue | (_gValue << 8) | (_bValue << 16));
+		_signature = hashWord(hash, _stencilValue);
+	}
 }
 
 void ClearBufferDrawCall::execute(bool restoreState) const {
@@ -708,6 +1156,17 @@ void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool re
 	                   _clearStencilBuffer, _stencilValue);
 }
 
+Common::String ClearBufferDrawCall::getDescription() const {
+	Common::String description = "clear";
+	if (_clearColorBuffer)
+		description += " color";
+	if (_clearZBuffer)
+		description += " depth";
+	if (_clearStencilBuffer)
+		description += " stencil";
+	return description;
+}
+
 bool ClearBufferDrawCall::operator==(const ClearBufferDrawCall &other) const {
 	return
 		_clearZBuffer == other._clearZBuffer &&
@@ -757,6 +1216,7 @@ bool RasterizationDrawCall::RasterizationState::operator==(const RasterizationSt
 		texture2DEnabled == other.texture2DEnabled &&
 		texture == other.texture &&
 		textureVersion == texture->versionNumber &&
+		minFilter == other.minFilter &&
 		fogEnabled == other.fogEnabled &&
 		fogColorR == other.fogColorR &&
 		fogColorG == other.fogColorG &&
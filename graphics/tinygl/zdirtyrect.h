@@ -25,6 +25,7 @@
 #include "common/types.h"
 #include "common/rect.h"
 #include "common/array.h"
+#include "common/str.h"
 
 #include "graphics/tinygl/zblit.h"
 
@@ -47,7 +48,7 @@ public:
 		DrawCall_Clear
 	};
 
-	DrawCall(DrawCallType type) : _type(type) { }
+	DrawCall(DrawCallType type) : _type(type), _signature(0), _statsIndex(0) { }
 	virtual ~DrawCall() { }
 	bool operator==(const DrawCall &other) const;
 	bool operator!=(const DrawCall &other) const {
@@ -57,10 +58,22 @@ public:
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
+	// A hash of the call, computed with dirty rectangles: equal calls have
+	// equal signatures, so the calls of the previous frame are looked up by it.
+	uint32 getSignature() const { return _signature; }
+	// Whether executing the call clipped to several rectangles, one after the other,
+	// gives the same pixels as executing it once.
+	virtual bool isSplittable() const { return true; }
+	// A short summary of what the call draws, for the profiling statistics.
+	virtual Common::String getDescription() const = 0;
+	uint getStatsIndex() const { return _statsIndex; }
+	void setStatsIndex(uint index) { _statsIndex = index; }
 protected:
 	Common::Rect _dirtyRegion;
+	uint32 _signature;
 private:
 	DrawCallType _type;
+	uint _statsIndex;
 };
 
 class ClearBufferDrawCall : public DrawCall {
@@ -70,6 +83,7 @@ public:
 	bool operator==(const ClearBufferDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual Common::String getDescription() const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -89,6 +103,8 @@ public:
 	bool operator==(const RasterizationDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual Common::String getDescription() const;
+	virtual bool isSplittable() const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -97,6 +113,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void computeSignature();
 	typedef void (*gl_draw_triangle_func_ptr)(GLContext *c, TinyGL::GLVertex *p0, TinyGL::GLVertex *p1, TinyGL::GLVertex *p2);
 	int _vertexCount;
 	GLVertex *_vertex;
@@ -140,6 +157,7 @@ private:
 		int stencilDppass;
 		GLTexture *texture;
 		uint wrapS, wrapT;
+		int minFilter;
 		bool fogEnabled;
 		float fogColorR;
 		float fogColorG;
@@ -168,6 +186,8 @@ public:
 	bool operator==(const BlittingDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual Common::String getDescription() const;
+	virtual bool isSplittable() const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -178,6 +198,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void computeSignature();
 	BlitImage *_image;
 	BlitTransform _transform;
 	BlittingMode _mode;
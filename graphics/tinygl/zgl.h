@@ -32,6 +32,7 @@
 #include "common/textconsole.h"
 #include "common/array.h"
 #include "common/list.h"
+#include "common/hashmap.h"
 #include "common/scummsys.h"
 
 #include "graphics/pixelformat.h"
@@ -157,8 +158,32 @@ struct GLParamBuffer {
 	struct GLParamBuffer *next;
 };
 
+// A vertex of a glBegin/glEnd block in a display list, with the attributes
+// set before it
+struct GLListVertex {
+	Vector4 coord;
+	Vector4 color;
+	Vector4 normal;
+	Vector4 tex_coord;
+	int edge_flag;
+};
+
+// The glBegin/glEnd blocks of a display list are unpacked when it is
+// compiled, so that calling the list adds the vertices directly.
+struct GLListPrimitive {
+	int type;
+	int vertex_count;
+	GLListVertex *vertices;
+	// Which attributes the block sets, the others come from the current state
+	bool has_color, has_normal, has_tex_coord, has_edge_flag;
+	// The attributes at the end of the block
+	GLListVertex last;
+	GLListPrimitive *next;
+};
+
 struct GLList {
 	GLParamBuffer *first_op_buffer;
+	GLListPrimitive *first_primitive;
 	// TODO: extensions for a hash table or a better allocating scheme
 };
 
@@ -207,6 +232,8 @@ struct GLTexture {
 	GLImage images[MAX_TEXTURE_LEVELS];
 	uint handle;
 	int versionNumber;
+	// Levels 1 and up were built from level 0, not uploaded
+	bool generatedMipmaps;
 	struct GLTexture *next, *prev;
 	bool disposed;
 };
@@ -326,6 +353,7 @@ struct GLContext {
 	GLSharedState shared_state;
 
 	// current list
+	GLList *current_list;
 	GLParamBuffer *current_op_buffer;
 	int current_op_buffer_index;
 	int exec_flag, compile_flag, print_flag;
@@ -458,13 +486,29 @@ struct GLContext {
 	// Draw call queue
 	Common::List<DrawCall *> _drawCallsQueue;
 	Common::List<DrawCall *> _previousFrameDrawCallsQueue;
+	Common::HashMap<uint32, int> _previousCallsBySignature;
 	int _currentAllocatorIndex;
 	LinearAllocator _drawCallAllocator[2];
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Statistics of the frame being presented, or of the last presented one
+	FrameStats _frameStats;
+	Common::Array<DrawCallStats> _drawCallStats;
+
+	// Tiled rendering
+	int _tileSize;
+	Common::Array<Common::Array<DrawCall *> > _tileBins;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
+	GLVertex *gl_new_vertex();
+	void gl_add_vertex(GLParam *p);
+	void gl_transform_vertices(GLVertex *vertices, int count);
+
+	bool gl_fetch_array_element(int idx, GLParam *vertex_param);
+	void gl_draw_array_element(int idx, bool batched);
+	bool gl_can_batch_array_elements() const;
 
 	void gl_get_pname(TGLenum pname, union uglValue *data, eDataType &dataType);
 
@@ -479,6 +523,7 @@ public:
 
 	void gl_eval_viewport();
 	void gl_transform_to_viewport(GLVertex *v);
+	void gl_transform_attributes_to_viewport(GLVertex *v);
 	void gl_draw_triangle(GLVertex *p0, GLVertex *p1, GLVertex *p2);
 	void gl_draw_line(GLVertex *p0, GLVertex *p1);
 	void gl_draw_point(GLVertex *p0);
@@ -509,6 +554,8 @@ public:
 	GLTexture *alloc_texture(uint h);
 	GLTexture *find_texture(uint h);
 	void free_texture(GLTexture *t);
+	void free_mipmaps(GLTexture *t);
+	void generate_mipmaps(GLTexture *t);
 	void gl_GenTextures(TGLsizei n, TGLuint *textures);
 	void gl_DeleteTextures(TGLsizei n, const TGLuint *textures);
 	void gl_PixelStore(TGLenum pname, TGLint param);
@@ -519,6 +566,11 @@ public:
 
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
+	bool canExecuteTiled() const;
+	void executeDrawCallsTiled(const Common::Rect &region);
+	void executeDrawCall(DrawCall *drawCall, const Common::Rect *clippingRectangle);
+	void beginFrameStats();
+	void endFrameStats(const Common::List<Common::Rect> &dirtyAreas, uint firstDirtyArea);
 
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
@@ -531,6 +583,7 @@ public:
 	GLList *alloc_list(int list);
 	GLList *find_list(uint list);
 	void delete_list(int list);
+	void gl_optimize_list(GLList *l);
 	void gl_NewList(TGLuint list, TGLenum mode);
 	void gl_EndList();
 	TGLboolean gl_IsList(TGLuint list);
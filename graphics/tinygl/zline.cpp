@@ -62,6 +62,8 @@ void FrameBuffer::drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2) {
 		drawLine<kInterpRGB, kInterpZ, kDepthWrite, true>(p1, p2);
 	else
 		drawLine<kInterpRGB, kInterpZ, kDepthWrite, false>(p1, p2);
+	if (kDepthWrite)
+		invalidateDepthTiles(MIN(p1->x, p2->x), MIN(p1->y, p2->y), MAX(p1->x, p2->x), MAX(p1->y, p2->y));
 }
 
 template <bool kInterpRGB, bool kInterpZ, bool kDepthWrite, bool kEnableScissor>
@@ -146,9 +148,10 @@ void FrameBuffer::plot(ZBufferPoint *p) {
 	const uint pixelOffset = p->y * _pbufWidth + p->x;
 	const int col = RGB_TO_PIXEL(p->r, p->g, p->b);
 	const uint z = p->z;
-	if (_depthWrite && _depthTestEnabled)
+	if (_depthWrite && _depthTestEnabled) {
 		putPixel<true>(pixelOffset, col, p->x, p->y, z);
-	else
+		invalidateDepthTiles(p->x, p->y, p->x, p->y);
+	} else
 		putPixel<false>(pixelOffset, col, p->x, p->y, z);
 }
 
@@ -0,0 +1,278 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zspan.h"
+#include "graphics/tinygl/texelbuffer.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The span state, expanded to vectors
+struct Context {
+	__m256i depthLess, depthEqual, depthGreater;
+	__m256i srcFactorBase, srcFactorPlus, srcFactorMinus;
+	__m256i dstFactorBase, dstFactorPlus, dstFactorMinus;
+	__m128i aShift, rShift, gShift, bShift, aLoss;
+	__m256i alphaFull;
+
+	Context(const SpanState &state) {
+		depthLess = _mm256_set1_epi32(state.depthLess);
+		depthEqual = _mm256_set1_epi32(state.depthEqual);
+		depthGreater = _mm256_set1_epi32(state.depthGreater);
+		srcFactorBase = _mm256_set1_epi32(state.srcFactorBase);
+		srcFactorPlus = _mm256_set1_epi32(state.srcFactorSign > 0 ? -1 : 0);
+		srcFactorMinus = _mm256_set1_epi32(state.srcFactorSign < 0 ? -1 : 0);
+		dstFactorBase = _mm256_set1_epi32(state.dstFactorBase);
+		dstFactorPlus = _mm256_set1_epi32(state.dstFactorSign > 0 ? -1 : 0);
+		dstFactorMinus = _mm256_set1_epi32(state.dstFactorSign < 0 ? -1 : 0);
+		aShift = _mm_cvtsi32_si128(state.aShift);
+		rShift = _mm_cvtsi32_si128(state.rShift);
+		gShift = _mm_cvtsi32_si128(state.gShift);
+		bShift = _mm_cvtsi32_si128(state.bShift);
+		aLoss = _mm_cvtsi32_si128(state.aLoss);
+		alphaFull = _mm256_set1_epi32((0xFF >> state.aLoss) << state.aShift);
+	}
+};
+
+FORCEINLINE __m256i select(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+FORCEINLINE __m256i ramp(uint value, int delta) {
+	return _mm256_add_epi32(_mm256_set1_epi32(value), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(delta)));
+}
+
+// Lanes from first up to, but not including, last
+FORCEINLINE __m256i laneMask(int first, int last) {
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	return _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(first), lanes), _mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes));
+}
+
+FORCEINLINE __m256i depthTest(const Context &ctx, __m256i z, __m256i zDst) {
+	const __m256i sign = _mm256_set1_epi32((int)0x80000000);
+	const __m256i less = _mm256_cmpgt_epi32(_mm256_xor_si256(z, sign), _mm256_xor_si256(zDst, sign));
+	const __m256i equal = _mm256_cmpeq_epi32(zDst, z);
+	const __m256i greater = _mm256_andnot_si256(_mm256_or_si256(less, equal), _mm256_set1_epi32(-1));
+	return _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(less, ctx.depthLess), _mm256_and_si256(equal, ctx.depthEqual)),
+	                       _mm256_and_si256(greater, ctx.depthGreater));
+}
+
+// The color paths store the depth through a float, which drops the low
+// bits of large values.
+FORCEINLINE __m256i roundDepth(__m256i z) {
+	const __m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(z, 16)), _mm256_set1_ps(65536.0f));
+	const __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(z, _mm256_set1_epi32(0xffff)));
+	__m256 f = _mm256_add_ps(hi, lo);
+	const __m256 big = _mm256_cmp_ps(f, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ);
+	f = _mm256_sub_ps(f, _mm256_and_ps(big, _mm256_set1_ps(2147483648.0f)));
+	return _mm256_xor_si256(_mm256_cvttps_epi32(f), _mm256_and_si256(_mm256_castps_si256(big), _mm256_set1_epi32((int)0x80000000)));
+}
+
+FORCEINLINE __m256i channel(__m256i color, __m128i shift) {
+	return _mm256_and_si256(_mm256_srl_epi32(color, shift), _mm256_set1_epi32(0xff));
+}
+
+// (c * factor) >> 8 for c up to 255 and factor up to 256
+FORCEINLINE __m256i scale(__m256i c, __m256i factor) {
+	return _mm256_srli_epi32(_mm256_mullo_epi16(c, factor), 8);
+}
+
+// Shade, blend and store the pixels, as in FrameBuffer::writePixel()
+FORCEINLINE void writePixels(const Context &ctx, const SpanState &state, uint32 *pbuf, uint *zbuf,
+                             __m256i pass, __m256i z, __m256i zDst,
+                             __m256i a, __m256i r, __m256i g, __m256i b) {
+	const __m256i dst = _mm256_loadu_si256((const __m256i *)pbuf);
+	__m256i color;
+	if (!state.blending) {
+		color = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(a, ctx.aLoss), ctx.aShift), _mm256_sll_epi32(r, ctx.rShift)),
+		                        _mm256_or_si256(_mm256_sll_epi32(g, ctx.gShift), _mm256_sll_epi32(b, ctx.bShift)));
+	} else {
+		const __m256i srcFactor = _mm256_sub_epi32(_mm256_add_epi32(ctx.srcFactorBase, _mm256_and_si256(a, ctx.srcFactorPlus)), _mm256_and_si256(a, ctx.srcFactorMinus));
+		const __m256i dstFactor = _mm256_sub_epi32(_mm256_add_epi32(ctx.dstFactorBase, _mm256_and_si256(a, ctx.dstFactorPlus)), _mm256_and_si256(a, ctx.dstFactorMinus));
+		const __m256i max = _mm256_set1_epi32(255);
+		r = _mm256_min_epi32(_mm256_add_epi32(scale(r, srcFactor), scale(channel(dst, ctx.rShift), dstFactor)), max);
+		g = _mm256_min_epi32(_mm256_add_epi32(scale(g, srcFactor), scale(channel(dst, ctx.gShift), dstFactor)), max);
+		b = _mm256_min_epi32(_mm256_add_epi32(scale(b, srcFactor), scale(channel(dst, ctx.bShift), dstFactor)), max);
+		color = _mm256_or_si256(_mm256_or_si256(ctx.alphaFull, _mm256_sll_epi32(r, ctx.rShift)),
+		                        _mm256_or_si256(_mm256_sll_epi32(g, ctx.gShift), _mm256_sll_epi32(b, ctx.bShift)));
+	}
+	_mm256_storeu_si256((__m256i *)pbuf, select(pass, color, dst));
+	if (state.depthWrite) {
+		_mm256_storeu_si256((__m256i *)zbuf, select(pass, roundDepth(z), zDst));
+	}
+}
+
+// A group of eight pixels of a span. The last group of a span goes through
+// temporary buffers, so that the pixels after the span are not touched.
+class Group {
+public:
+	Group(uint32 *pbuf, uint *zbuf, int count) : _pbuf(pbuf), _zbuf(zbuf), _count(count) {
+		if (_count < 8) {
+			if (_pbuf) {
+				memcpy(_pbufRest, _pbuf, _count * sizeof(uint32));
+			}
+			memcpy(_zbufRest, _zbuf, _count * sizeof(uint));
+		}
+	}
+
+	~Group() {
+		if (_count < 8) {
+			if (_pbuf) {
+				memcpy(_pbuf, _pbufRest, _count * sizeof(uint32));
+			}
+			memcpy(_zbuf, _zbufRest, _count * sizeof(uint));
+		}
+	}
+
+	uint32 *pbuf() { return _count < 8 ? _pbufRest : _pbuf; }
+	uint *zbuf() { return _count < 8 ? _zbufRest : _zbuf; }
+	__m256i lanes() const { return laneMask(0, _count); }
+
+private:
+	uint32 *_pbuf;
+	uint *_zbuf;
+	int _count;
+	uint32 _pbufRest[8];
+	uint _zbufRest[8];
+};
+
+void fillDepth(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m256i z = ramp(span.z, span.dzdx);
+	const __m256i dz = _mm256_set1_epi32(8 * (uint)span.dzdx);
+
+	for (int i = 0; i < span.count; i += 8) {
+		Group group(nullptr, span.zbuf + i, span.count - i);
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)group.zbuf());
+		const __m256i pass = _mm256_and_si256(depthTest(ctx, z, zDst), group.lanes());
+		if (state.depthWrite) {
+			_mm256_storeu_si256((__m256i *)group.zbuf(), select(pass, z, zDst));
+		}
+		z = _mm256_add_epi32(z, dz);
+	}
+}
+
+void fillColor(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m256i z = ramp(span.z, span.dzdx);
+	__m256i r = ramp(span.r, span.drdx);
+	__m256i g = ramp(span.g, span.dgdx);
+	__m256i b = ramp(span.b, span.dbdx);
+	__m256i a = ramp(span.a, span.dadx);
+	const __m256i dz = _mm256_set1_epi32(8 * (uint)span.dzdx);
+	const __m256i dr = _mm256_set1_epi32(8 * (uint)span.drdx);
+	const __m256i dg = _mm256_set1_epi32(8 * (uint)span.dgdx);
+	const __m256i db = _mm256_set1_epi32(8 * (uint)span.dbdx);
+	const __m256i da = _mm256_set1_epi32(8 * (uint)span.dadx);
+	const __m256i mask = _mm256_set1_epi32(0xff);
+
+	for (int i = 0; i < span.count; i += 8) {
+		Group group(span.pbuf + i, span.zbuf + i, span.count - i);
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)group.zbuf());
+		const __m256i pass = _mm256_and_si256(depthTest(ctx, z, zDst), group.lanes());
+		if (_mm256_movemask_epi8(pass)) {
+			writePixels(ctx, state, group.pbuf(), group.zbuf(), pass, z, zDst,
+			            _mm256_and_si256(_mm256_srli_epi32(a, 8), mask), _mm256_and_si256(_mm256_srli_epi32(r, 8), mask),
+			            _mm256_and_si256(_mm256_srli_epi32(g, 8), mask), _mm256_and_si256(_mm256_srli_epi32(b, 8), mask));
+		}
+		z = _mm256_add_epi32(z, dz);
+		r = _mm256_add_epi32(r, dr);
+		g = _mm256_add_epi32(g, dg);
+		b = _mm256_add_epi32(b, db);
+		a = _mm256_add_epi32(a, da);
+	}
+}
+
+// (c * l) >> 8 with l being the color component in 16.8 fixed point, as in
+// FrameBuffer::putPixelTexture()
+FORCEINLINE __m256i modulate(__m256i c, __m256i l) {
+	return _mm256_and_si256(_mm256_srli_epi32(_mm256_mullo_epi32(c, _mm256_srli_epi32(l, 8)), 8), _mm256_set1_epi32(0xff));
+}
+
+void fillTexture(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m256i z = ramp(span.z, span.dzdx);
+	__m256i r = ramp(span.r, span.drdx);
+	__m256i g = ramp(span.g, span.dgdx);
+	__m256i b = ramp(span.b, span.dbdx);
+	__m256i a = ramp(span.a, span.dadx);
+	const __m256i dz = _mm256_set1_epi32(8 * (uint)span.dzdx);
+	const __m256i dr = _mm256_set1_epi32(8 * (uint)span.drdx);
+	const __m256i dg = _mm256_set1_epi32(8 * (uint)span.dgdx);
+	const __m256i db = _mm256_set1_epi32(8 * (uint)span.dbdx);
+	const __m256i da = _mm256_set1_epi32(8 * (uint)span.dadx);
+
+	for (int i = 0; i < span.count; i += 8) {
+		Group group(span.pbuf + i, span.zbuf + i, span.count - i);
+		const __m256i zDst = _mm256_loadu_si256((const __m256i *)group.zbuf());
+		const __m256i pass = _mm256_and_si256(depthTest(ctx, z, zDst), _mm256_and_si256(group.lanes(), laneMask(span.first - i, 8)));
+		const int passMask = _mm256_movemask_ps(_mm256_castsi256_ps(pass));
+		if (passMask) {
+			// The texels are only read for the visible pixels
+			uint32 texels[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+			for (int lane = 0; lane < 8; lane++) {
+				if (passMask & (1 << lane)) {
+					byte c_a, c_r, c_g, c_b;
+					state.texture->getARGBAt(state.wrapS, state.wrapT,
+					                         span.s + (i + lane) * span.dsdx, span.t + (i + lane) * span.dtdx,
+					                         c_a, c_r, c_g, c_b);
+					if (state.nextTexture) {
+						state.nextTexture->blendARGBAt(state.lodFraction, state.wrapS, state.wrapT,
+						                               span.s + (i + lane) * span.dsdx, span.t + (i + lane) * span.dtdx,
+						                               c_a, c_r, c_g, c_b);
+					}
+					texels[lane] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+				}
+			}
+			const __m256i texel = _mm256_loadu_si256((const __m256i *)texels);
+			const __m256i mask = _mm256_set1_epi32(0xff);
+			writePixels(ctx, state, group.pbuf(), group.zbuf(), pass, z, zDst,
+			            modulate(_mm256_srli_epi32(texel, 24), a), modulate(_mm256_and_si256(_mm256_srli_epi32(texel, 16), mask), r),
+			            modulate(_mm256_and_si256(_mm256_srli_epi32(texel, 8), mask), g), modulate(_mm256_and_si256(texel, mask), b));
+		}
+		z = _mm256_add_epi32(z, dz);
+		r = _mm256_add_epi32(r, dr);
+		g = _mm256_add_epi32(g, dg);
+		b = _mm256_add_epi32(b, db);
+		a = _mm256_add_epi32(a, da);
+	}
+}
+
+} // end of anonymous namespace
+
+const SpanFuncs spanFuncsAVX2 = { fillDepth, fillColor, fillTexture };
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,288 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zspan.h"
+#include "graphics/tinygl/texelbuffer.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The span state, expanded to vectors
+struct Context {
+	__m128i depthLess, depthEqual, depthGreater;
+	__m128i srcFactorBase, srcFactorPlus, srcFactorMinus;
+	__m128i dstFactorBase, dstFactorPlus, dstFactorMinus;
+	__m128i aShift, rShift, gShift, bShift, aLoss;
+	__m128i alphaFull;
+
+	Context(const SpanState &state) {
+		depthLess = _mm_set1_epi32(state.depthLess);
+		depthEqual = _mm_set1_epi32(state.depthEqual);
+		depthGreater = _mm_set1_epi32(state.depthGreater);
+		srcFactorBase = _mm_set1_epi32(state.srcFactorBase);
+		srcFactorPlus = _mm_set1_epi32(state.srcFactorSign > 0 ? -1 : 0);
+		srcFactorMinus = _mm_set1_epi32(state.srcFactorSign < 0 ? -1 : 0);
+		dstFactorBase = _mm_set1_epi32(state.dstFactorBase);
+		dstFactorPlus = _mm_set1_epi32(state.dstFactorSign > 0 ? -1 : 0);
+		dstFactorMinus = _mm_set1_epi32(state.dstFactorSign < 0 ? -1 : 0);
+		aShift = _mm_cvtsi32_si128(state.aShift);
+		rShift = _mm_cvtsi32_si128(state.rShift);
+		gShift = _mm_cvtsi32_si128(state.gShift);
+		bShift = _mm_cvtsi32_si128(state.bShift);
+		aLoss = _mm_cvtsi32_si128(state.aLoss);
+		alphaFull = _mm_set1_epi32((0xFF >> state.aLoss) << state.aShift);
+	}
+};
+
+FORCEINLINE __m128i sse2_mul32(__m128i a, __m128i b) {
+	__m128i even = _mm_shuffle_epi32(_mm_mul_epu32(a, b), _MM_SHUFFLE(0, 0, 2, 0));
+	__m128i odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_bsrli_si128(a, 4), _mm_bsrli_si128(b, 4)), _MM_SHUFFLE(0, 0, 2, 0));
+	return _mm_unpacklo_epi32(even, odd);
+}
+
+FORCEINLINE __m128i select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+FORCEINLINE __m128i ramp(uint value, int delta) {
+	return _mm_setr_epi32(value, value + delta, value + 2 * (uint)delta, value + 3 * (uint)delta);
+}
+
+// Lanes from first up to, but not including, last
+FORCEINLINE __m128i laneMask(int first, int last) {
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	return _mm_andnot_si128(_mm_cmplt_epi32(lanes, _mm_set1_epi32(first)), _mm_cmplt_epi32(lanes, _mm_set1_epi32(last)));
+}
+
+FORCEINLINE __m128i depthTest(const Context &ctx, __m128i z, __m128i zDst) {
+	const __m128i sign = _mm_set1_epi32((int)0x80000000);
+	const __m128i less = _mm_cmplt_epi32(_mm_xor_si128(zDst, sign), _mm_xor_si128(z, sign));
+	const __m128i equal = _mm_cmpeq_epi32(zDst, z);
+	const __m128i greater = _mm_andnot_si128(_mm_or_si128(less, equal), _mm_set1_epi32(-1));
+	return _mm_or_si128(_mm_or_si128(_mm_and_si128(less, ctx.depthLess), _mm_and_si128(equal, ctx.depthEqual)),
+	                    _mm_and_si128(greater, ctx.depthGreater));
+}
+
+// The color paths store the depth through a float, which drops the low
+// bits of large values.
+FORCEINLINE __m128i roundDepth(__m128i z) {
+	const __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(z, 16)), _mm_set1_ps(65536.0f));
+	const __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(z, _mm_set1_epi32(0xffff)));
+	__m128 f = _mm_add_ps(hi, lo);
+	const __m128 big = _mm_cmpge_ps(f, _mm_set1_ps(2147483648.0f));
+	f = _mm_sub_ps(f, _mm_and_ps(big, _mm_set1_ps(2147483648.0f)));
+	return _mm_xor_si128(_mm_cvttps_epi32(f), _mm_and_si128(_mm_castps_si128(big), _mm_set1_epi32((int)0x80000000)));
+}
+
+FORCEINLINE __m128i channel(__m128i color, __m128i shift) {
+	return _mm_and_si128(_mm_srl_epi32(color, shift), _mm_set1_epi32(0xff));
+}
+
+// (c * factor) >> 8 for c up to 255 and factor up to 256
+FORCEINLINE __m128i scale(__m128i c, __m128i factor) {
+	return _mm_srli_epi32(_mm_mullo_epi16(c, factor), 8);
+}
+
+// Shade, blend and store the pixels, as in FrameBuffer::writePixel()
+FORCEINLINE void writePixels(const Context &ctx, const SpanState &state, uint32 *pbuf, uint *zbuf,
+                             __m128i pass, __m128i z, __m128i zDst,
+                             __m128i a, __m128i r, __m128i g, __m128i b) {
+	const __m128i dst = _mm_loadu_si128((const __m128i *)pbuf);
+	__m128i color;
+	if (!state.blending) {
+		color = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(a, ctx.aLoss), ctx.aShift), _mm_sll_epi32(r, ctx.rShift)),
+		                     _mm_or_si128(_mm_sll_epi32(g, ctx.gShift), _mm_sll_epi32(b, ctx.bShift)));
+	} else {
+		const __m128i srcFactor = _mm_sub_epi32(_mm_add_epi32(ctx.srcFactorBase, _mm_and_si128(a, ctx.srcFactorPlus)), _mm_and_si128(a, ctx.srcFactorMinus));
+		const __m128i dstFactor = _mm_sub_epi32(_mm_add_epi32(ctx.dstFactorBase, _mm_and_si128(a, ctx.dstFactorPlus)), _mm_and_si128(a, ctx.dstFactorMinus));
+		const __m128i max = _mm_set1_epi32(255);
+		r = _mm_min_epi16(_mm_add_epi32(scale(r, srcFactor), scale(channel(dst, ctx.rShift), dstFactor)), max);
+		g = _mm_min_epi16(_mm_add_epi32(scale(g, srcFactor), scale(channel(dst, ctx.gShift), dstFactor)), max);
+		b = _mm_min_epi16(_mm_add_epi32(scale(b, srcFactor), scale(channel(dst, ctx.bShift), dstFactor)), max);
+		color = _mm_or_si128(_mm_or_si128(ctx.alphaFull, _mm_sll_epi32(r, ctx.rShift)),
+		                     _mm_or_si128(_mm_sll_epi32(g, ctx.gShift), _mm_sll_epi32(b, ctx.bShift)));
+	}
+	_mm_storeu_si128((__m128i *)pbuf, select(pass, color, dst));
+	if (state.depthWrite) {
+		_mm_storeu_si128((__m128i *)zbuf, select(pass, roundDepth(z), zDst));
+	}
+}
+
+// A group of four pixels of a span. The last group of a span goes through
+// temporary buffers, so that the pixels after the span are not touched.
+class Group {
+public:
+	Group(uint32 *pbuf, uint *zbuf, int count) : _pbuf(pbuf), _zbuf(zbuf), _count(count) {
+		if (_count < 4) {
+			if (_pbuf) {
+				memcpy(_pbufRest, _pbuf, _count * sizeof(uint32));
+			}
+			memcpy(_zbufRest, _zbuf, _count * sizeof(uint));
+		}
+	}
+
+	~Group() {
+		if (_count < 4) {
+			if (_pbuf) {
+				memcpy(_pbuf, _pbufRest, _count * sizeof(uint32));
+			}
+			memcpy(_zbuf, _zbufRest, _count * sizeof(uint));
+		}
+	}
+
+	uint32 *pbuf() { return _count < 4 ? _pbufRest : _pbuf; }
+	uint *zbuf() { return _count < 4 ? _zbufRest : _zbuf; }
+	__m128i lanes() const { return laneMask(0, _count); }
+
+private:
+	uint32 *_pbuf;
+	uint *_zbuf;
+	int _count;
+	uint32 _pbufRest[4];
+	uint _zbufRest[4];
+};
+
+void fillDepth(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m128i z = ramp(span.z, span.dzdx);
+	const __m128i dz = _mm_set1_epi32(4 * (uint)span.dzdx);
+
+	for (int i = 0; i < span.count; i += 4) {
+		Group group(nullptr, span.zbuf + i, span.count - i);
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)group.zbuf());
+		const __m128i pass = _mm_and_si128(depthTest(ctx, z, zDst), group.lanes());
+		if (state.depthWrite) {
+			_mm_storeu_si128((__m128i *)group.zbuf(), select(pass, z, zDst));
+		}
+		z = _mm_add_epi32(z, dz);
+	}
+}
+
+void fillColor(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m128i z = ramp(span.z, span.dzdx);
+	__m128i r = ramp(span.r, span.drdx);
+	__m128i g = ramp(span.g, span.dgdx);
+	__m128i b = ramp(span.b, span.dbdx);
+	__m128i a = ramp(span.a, span.dadx);
+	const __m128i dz = _mm_set1_epi32(4 * (uint)span.dzdx);
+	const __m128i dr = _mm_set1_epi32(4 * (uint)span.drdx);
+	const __m128i dg = _mm_set1_epi32(4 * (uint)span.dgdx);
+	const __m128i db = _mm_set1_epi32(4 * (uint)span.dbdx);
+	const __m128i da = _mm_set1_epi32(4 * (uint)span.dadx);
+	const __m128i mask = _mm_set1_epi32(0xff);
+
+	for (int i = 0; i < span.count; i += 4) {
+		Group group(span.pbuf + i, span.zbuf + i, span.count - i);
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)group.zbuf());
+		const __m128i pass = _mm_and_si128(depthTest(ctx, z, zDst), group.lanes());
+		if (_mm_movemask_epi8(pass)) {
+			writePixels(ctx, state, group.pbuf(), group.zbuf(), pass, z, zDst,
+			            _mm_and_si128(_mm_srli_epi32(a, 8), mask), _mm_and_si128(_mm_srli_epi32(r, 8), mask),
+			            _mm_and_si128(_mm_srli_epi32(g, 8), mask), _mm_and_si128(_mm_srli_epi32(b, 8), mask));
+		}
+		z = _mm_add_epi32(z, dz);
+		r = _mm_add_epi32(r, dr);
+		g = _mm_add_epi32(g, dg);
+		b = _mm_add_epi32(b, db);
+		a = _mm_add_epi32(a, da);
+	}
+}
+
+// (c * l) >> 8 with l being the color component in 16.8 fixed point, as in
+// FrameBuffer::putPixelTexture()
+FORCEINLINE __m128i modulate(__m128i c, __m128i l) {
+	return _mm_and_si128(_mm_srli_epi32(sse2_mul32(c, _mm_srli_epi32(l, 8)), 8), _mm_set1_epi32(0xff));
+}
+
+void fillTexture(const SpanState &state, const Span &span) {
+	const Context ctx(state);
+	__m128i z = ramp(span.z, span.dzdx);
+	__m128i r = ramp(span.r, span.drdx);
+	__m128i g = ramp(span.g, span.dgdx);
+	__m128i b = ramp(span.b, span.dbdx);
+	__m128i a = ramp(span.a, span.dadx);
+	const __m128i dz = _mm_set1_epi32(4 * (uint)span.dzdx);
+	const __m128i dr = _mm_set1_epi32(4 * (uint)span.drdx);
+	const __m128i dg = _mm_set1_epi32(4 * (uint)span.dgdx);
+	const __m128i db = _mm_set1_epi32(4 * (uint)span.dbdx);
+	const __m128i da = _mm_set1_epi32(4 * (uint)span.dadx);
+
+	for (int i = 0; i < span.count; i += 4) {
+		Group group(span.pbuf + i, span.zbuf + i, span.count - i);
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)group.zbuf());
+		const __m128i pass = _mm_and_si128(depthTest(ctx, z, zDst), _mm_and_si128(group.lanes(), laneMask(span.first - i, 4)));
+		const int passMask = _mm_movemask_ps(_mm_castsi128_ps(pass));
+		if (passMask) {
+			// The texels are only read for the visible pixels
+			uint32 texels[4] = { 0, 0, 0, 0 };
+			for (int lane = 0; lane < 4; lane++) {
+				if (passMask & (1 << lane)) {
+					byte c_a, c_r, c_g, c_b;
+					state.texture->getARGBAt(state.wrapS, state.wrapT,
+					                         span.s + (i + lane) * span.dsdx, span.t + (i + lane) * span.dtdx,
+					                         c_a, c_r, c_g, c_b);
+					if (state.nextTexture) {
+						state.nextTexture->blendARGBAt(state.lodFraction, state.wrapS, state.wrapT,
+						                               span.s + (i + lane) * span.dsdx, span.t + (i + lane) * span.dtdx,
+						                               c_a, c_r, c_g, c_b);
+					}
+					texels[lane] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+				}
+			}
+			const __m128i texel = _mm_loadu_si128((const __m128i *)texels);
+			const __m128i mask = _mm_set1_epi32(0xff);
+			writePixels(ctx, state, group.pbuf(), group.zbuf(), pass, z, zDst,
+			            modulate(_mm_srli_epi32(texel, 24), a), modulate(_mm_and_si128(_mm_srli_epi32(texel, 16), mask), r),
+			            modulate(_mm_and_si128(_mm_srli_epi32(texel, 8), mask), g), modulate(_mm_and_si128(texel, mask), b));
+		}
+		z = _mm_add_epi32(z, dz);
+		r = _mm_add_epi32(r, dr);
+		g = _mm_add_epi32(g, dg);
+		b = _mm_add_epi32(b, db);
+		a = _mm_add_epi32(a, da);
+	}
+}
+
+} // end of anonymous namespace
+
+const SpanFuncs spanFuncsSSE2 = { fillDepth, fillColor, fillTexture };
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,120 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H
+#define GRAPHICS_TINYGL_ZSPAN_H
+
+#include "common/scummsys.h"
+
+namespace TinyGL {
+
+class TexelBuffer;
+
+/**
+ * The state of the frame buffer used by the span functions, set up once
+ * per triangle.
+ */
+struct SpanState {
+	// Masks selecting which results of comparing the z buffer value with
+	// the z value of the pixel let the pixel pass, as in compareDepth().
+	uint32 depthLess, depthEqual, depthGreater;
+	bool depthWrite;
+
+	// The blending factors are base + sign * source alpha.
+	bool blending;
+	int srcFactorBase, srcFactorSign;
+	int dstFactorBase, dstFactorSign;
+
+	// The color buffer has 32 bits per pixel, with 8 bits per component.
+	byte aShift, rShift, gShift, bShift;
+	byte aLoss;
+
+	const TexelBuffer *texture;
+	const TexelBuffer *nextTexture;
+	uint lodFraction;
+	uint wrapS, wrapT;
+};
+
+/**
+ * A run of pixels on a scan line, with the interpolated values of its
+ * first pixel.
+ */
+struct Span {
+	uint32 *pbuf;
+	uint *zbuf;
+	int count;
+	// Textured spans skip the pixels before this one, which are clipped.
+	int first;
+
+	uint z;
+	int dzdx;
+	uint r, g, b, a;
+	int drdx, dgdx, dbdx, dadx;
+	int s, t;
+	int dsdx, dtdx;
+};
+
+typedef void (*SpanFunc)(const SpanState &state, const Span &span);
+
+/**
+ * Get a blending factor the span functions support, as base + sign * source
+ * alpha. Return false for the other factors.
+ */
+bool getSpanBlendingFactor(int factor, int &base, int &sign);
+
+/**
+ * Vectorized versions of the pixel loops of FrameBuffer::fillTriangle(),
+ * giving the same results. Fog, alpha testing, stencil and other color
+ * formats are left to the generic code.
+ */
+struct SpanFuncs {
+	// Depth test and exact depth write, without color
+	SpanFunc fillDepth;
+	// Flat or smooth color, depth test and write, blending
+	SpanFunc fillColor;
+	// Up to one block of perspective correct texture mapping, modulated
+	// by the color
+	SpanFunc fillTexture;
+};
+
+#ifdef SCUMMVM_SSE2
+extern const SpanFuncs spanFuncsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const SpanFuncs spanFuncsAVX2;
+#endif
+
+namespace Internal {
+/**
+ * Return the span functions for the CPU, or nullptr if there are none.
+ */
+const SpanFuncs *getSpanFuncs();
+
+/**
+ * Override the span functions, for testing. nullptr selects the generic code.
+ */
+void setSpanFuncs(const SpanFuncs *funcs);
+} // end of namespace Internal
+
+} // end of namespace TinyGL
+
+#endif // GRAPHICS_TINYGL_ZSPAN_H
@@ -0,0 +1,249 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/ztransform.h"
+#include "graphics/tinygl/zgl.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The transform state, expanded to vectors
+struct Context {
+	__m256 modelView[4][4];
+	__m256 projection[4][4];
+	__m256 modelViewProjection[4][4];
+	__m256 normalMatrix[3][3];
+	__m256 viewportScale[3], viewportTrans[3];
+
+	Context(const TransformState &state) {
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				modelView[i][j] = _mm256_set1_ps(state.modelView->_m[i][j]);
+				projection[i][j] = _mm256_set1_ps(state.projection->_m[i][j]);
+				modelViewProjection[i][j] = _mm256_set1_ps(state.modelViewProjection->_m[i][j]);
+				if (i < 3 && j < 3) {
+					normalMatrix[i][j] = _mm256_set1_ps(state.normalMatrix->_m[i][j]);
+				}
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			viewportScale[i] = _mm256_set1_ps(state.viewportScale[i]);
+			viewportTrans[i] = _mm256_set1_ps(state.viewportTrans[i]);
+		}
+	}
+};
+
+// Transpose the 4x4 matrices in both halves of the vectors
+FORCEINLINE void transpose(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3) {
+	const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+FORCEINLINE __m256 load2(const float *lo, const float *hi) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+FORCEINLINE void store2(float *lo, float *hi, __m256 value) {
+	_mm_storeu_ps(lo, _mm256_castps256_ps128(value));
+	_mm_storeu_ps(hi, _mm256_extractf128_ps(value, 1));
+}
+
+#define VECTORS(v, member) v[0].member._v, v[1].member._v, v[2].member._v, v[3].member._v, \
+	v[4].member._v, v[5].member._v, v[6].member._v, v[7].member._v
+
+// Load the first four floats at each pointer, one component per vector
+FORCEINLINE void loadTransposed(const float *v0, const float *v1, const float *v2, const float *v3,
+								const float *v4, const float *v5, const float *v6, const float *v7,
+								__m256 &x, __m256 &y, __m256 &z, __m256 &w) {
+	x = load2(v0, v4);
+	y = load2(v1, v5);
+	z = load2(v2, v6);
+	w = load2(v3, v7);
+	transpose(x, y, z, w);
+}
+
+FORCEINLINE void storeTransposed(float *v0, float *v1, float *v2, float *v3,
+								 float *v4, float *v5, float *v6, float *v7,
+								 __m256 x, __m256 y, __m256 z, __m256 w) {
+	transpose(x, y, z, w);
+	store2(v0, v4, x);
+	store2(v1, v5, y);
+	store2(v2, v6, z);
+	store2(v3, v7, w);
+}
+
+// The rows of the matrices are summed up in the same order as in Matrix4
+FORCEINLINE __m256 dot3(const __m256 row[], __m256 x, __m256 y, __m256 z) {
+	__m256 result = _mm256_add_ps(_mm256_mul_ps(x, row[0]), _mm256_mul_ps(y, row[1]));
+	return _mm256_add_ps(result, _mm256_mul_ps(z, row[2]));
+}
+
+FORCEINLINE __m256 dot3x4(const __m256 row[], __m256 x, __m256 y, __m256 z) {
+	return _mm256_add_ps(dot3(row, x, y, z), row[3]);
+}
+
+FORCEINLINE __m256 dot4(const __m256 row[], __m256 x, __m256 y, __m256 z, __m256 w) {
+	return _mm256_add_ps(dot3(row, x, y, z), _mm256_mul_ps(w, row[3]));
+}
+
+FORCEINLINE __m256 select(__m256 mask, __m256 a, __m256 b) {
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+FORCEINLINE __m256i clipBit(__m256 mask, int bit) {
+	return _mm256_and_si256(_mm256_castps_si256(mask), _mm256_set1_epi32(bit));
+}
+
+// Same as gl_clipcode(), including the scaling of W in double precision
+FORCEINLINE __m256i clipCode(__m256 x, __m256 y, __m256 z, __m256 w) {
+	const __m256d factor = _mm256_set1_pd(1.0 + CLIP_EPSILON);
+	const __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(w)), factor));
+	const __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(w, 1)), factor));
+	const __m256 max = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+	const __m256 min = _mm256_xor_ps(max, _mm256_set1_ps(-0.0f));
+
+	__m256i code = _mm256_or_si256(clipBit(_mm256_cmp_ps(x, min, _CMP_LT_OQ), 1), clipBit(_mm256_cmp_ps(x, max, _CMP_GT_OQ), 2));
+	code = _mm256_or_si256(code, _mm256_or_si256(clipBit(_mm256_cmp_ps(y, min, _CMP_LT_OQ), 4), clipBit(_mm256_cmp_ps(y, max, _CMP_GT_OQ), 8)));
+	return _mm256_or_si256(code, _mm256_or_si256(clipBit(_mm256_cmp_ps(z, min, _CMP_LT_OQ), 16), clipBit(_mm256_cmp_ps(z, max, _CMP_GT_OQ), 32)));
+}
+
+FORCEINLINE __m256i viewport(const Context &ctx, int i, __m256 coord, __m256 winv) {
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(coord, winv), ctx.viewportScale[i]), ctx.viewportTrans[i]));
+}
+
+// Transform eight vertices
+void transformBlock(const TransformState &state, const Context &ctx, GLVertex *v) {
+	__m256 x, y, z, w;
+	__m256 px, py, pz, pw;
+	loadTransposed(VECTORS(v, coord), x, y, z, w);
+
+	if (state.eyeCoords) {
+		const __m256 ex = dot3x4(ctx.modelView[0], x, y, z);
+		const __m256 ey = dot3x4(ctx.modelView[1], x, y, z);
+		const __m256 ez = dot3x4(ctx.modelView[2], x, y, z);
+		const __m256 ew = dot3x4(ctx.modelView[3], x, y, z);
+		storeTransposed(VECTORS(v, ec), ex, ey, ez, ew);
+
+		if (state.lighting) {
+			px = dot4(ctx.projection[0], ex, ey, ez, ew);
+			py = dot4(ctx.projection[1], ex, ey, ez, ew);
+			pz = dot4(ctx.projection[2], ex, ey, ez, ew);
+			pw = dot4(ctx.projection[3], ex, ey, ez, ew);
+		}
+	}
+
+	if (state.lighting) {
+		// The normal is followed by the coordinates in GLVertex, so it can
+		// be loaded as four floats
+		__m256 nx, ny, nz, unused;
+		loadTransposed(VECTORS(v, normal), nx, ny, nz, unused);
+
+		__m256 tx = dot3(ctx.normalMatrix[0], nx, ny, nz);
+		__m256 ty = dot3(ctx.normalMatrix[1], nx, ny, nz);
+		__m256 tz = dot3(ctx.normalMatrix[2], nx, ny, nz);
+		if (state.normalize) {
+			const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, tx), _mm256_mul_ps(ty, ty)), _mm256_mul_ps(tz, tz)));
+			const __m256 nonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+			tx = select(nonZero, _mm256_div_ps(tx, length), tx);
+			ty = select(nonZero, _mm256_div_ps(ty, length), ty);
+			tz = select(nonZero, _mm256_div_ps(tz, length), tz);
+		}
+
+		float normals[8][4];
+		storeTransposed(normals[0], normals[1], normals[2], normals[3],
+						normals[4], normals[5], normals[6], normals[7], tx, ty, tz, unused);
+		for (int i = 0; i < 8; i++) {
+			v[i].normal.X = normals[i][0];
+			v[i].normal.Y = normals[i][1];
+			v[i].normal.Z = normals[i][2];
+		}
+	} else {
+		px = dot3x4(ctx.modelViewProjection[0], x, y, z);
+		py = dot3x4(ctx.modelViewProjection[1], x, y, z);
+		pz = dot3x4(ctx.modelViewProjection[2], x, y, z);
+		pw = state.noWTransform ? ctx.modelViewProjection[3][3] : dot3x4(ctx.modelViewProjection[3], x, y, z);
+	}
+
+	storeTransposed(VECTORS(v, pc), px, py, pz, pw);
+
+	int clipCodes[8], zx[8], zy[8], zz[8];
+	const __m256 winv = _mm256_div_ps(_mm256_set1_ps(1.0f), pw);
+	_mm256_storeu_si256((__m256i *)clipCodes, clipCode(px, py, pz, pw));
+	_mm256_storeu_si256((__m256i *)zx, viewport(ctx, 0, px, winv));
+	_mm256_storeu_si256((__m256i *)zy, viewport(ctx, 1, py, winv));
+	_mm256_storeu_si256((__m256i *)zz, viewport(ctx, 2, pz, winv));
+
+	for (int i = 0; i < 8; i++) {
+		v[i].clip_code = clipCodes[i];
+		if (clipCodes[i] == 0) {
+			v[i].zp.x = zx[i];
+			v[i].zp.y = zy[i];
+			v[i].zp.z = zz[i];
+		}
+	}
+}
+
+} // end of anonymous namespace
+
+void transformVerticesAVX2(const TransformState &state, GLVertex *vertices, int count) {
+	const Context ctx(state);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		transformBlock(state, ctx, vertices + i);
+	}
+
+	if (i < count) {
+		// Pad the last block with copies of its last vertex
+		GLVertex rest[8];
+		for (int j = 0; j < 8; j++) {
+			rest[j] = vertices[MIN(i + j, count - 1)];
+		}
+		transformBlock(state, ctx, rest);
+		for (int j = 0; i + j < count; j++) {
+			vertices[i + j] = rest[j];
+		}
+	}
+}
+
+#undef VECTORS
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,228 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/ztransform.h"
+#include "graphics/tinygl/zgl.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace TinyGL {
+
+namespace {
+
+// The transform state, expanded to vectors
+struct Context {
+	__m128 modelView[4][4];
+	__m128 projection[4][4];
+	__m128 modelViewProjection[4][4];
+	__m128 normalMatrix[3][3];
+	__m128 viewportScale[3], viewportTrans[3];
+
+	Context(const TransformState &state) {
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				modelView[i][j] = _mm_set1_ps(state.modelView->_m[i][j]);
+				projection[i][j] = _mm_set1_ps(state.projection->_m[i][j]);
+				modelViewProjection[i][j] = _mm_set1_ps(state.modelViewProjection->_m[i][j]);
+				if (i < 3 && j < 3) {
+					normalMatrix[i][j] = _mm_set1_ps(state.normalMatrix->_m[i][j]);
+				}
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			viewportScale[i] = _mm_set1_ps(state.viewportScale[i]);
+			viewportTrans[i] = _mm_set1_ps(state.viewportTrans[i]);
+		}
+	}
+};
+
+// Load the first four floats at each pointer, one component per vector
+FORCEINLINE void loadTransposed(const float *v0, const float *v1, const float *v2, const float *v3,
+								__m128 &x, __m128 &y, __m128 &z, __m128 &w) {
+	x = _mm_loadu_ps(v0);
+	y = _mm_loadu_ps(v1);
+	z = _mm_loadu_ps(v2);
+	w = _mm_loadu_ps(v3);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+}
+
+FORCEINLINE void storeTransposed(float *v0, float *v1, float *v2, float *v3,
+								 __m128 x, __m128 y, __m128 z, __m128 w) {
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(v0, x);
+	_mm_storeu_ps(v1, y);
+	_mm_storeu_ps(v2, z);
+	_mm_storeu_ps(v3, w);
+}
+
+// The rows of the matrices are summed up in the same order as in Matrix4
+FORCEINLINE __m128 dot3(const __m128 row[], __m128 x, __m128 y, __m128 z) {
+	__m128 result = _mm_add_ps(_mm_mul_ps(x, row[0]), _mm_mul_ps(y, row[1]));
+	return _mm_add_ps(result, _mm_mul_ps(z, row[2]));
+}
+
+FORCEINLINE __m128 dot3x4(const __m128 row[], __m128 x, __m128 y, __m128 z) {
+	return _mm_add_ps(dot3(row, x, y, z), row[3]);
+}
+
+FORCEINLINE __m128 dot4(const __m128 row[], __m128 x, __m128 y, __m128 z, __m128 w) {
+	return _mm_add_ps(dot3(row, x, y, z), _mm_mul_ps(w, row[3]));
+}
+
+FORCEINLINE __m128 select(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+FORCEINLINE __m128i clipBit(__m128 mask, int bit) {
+	return _mm_and_si128(_mm_castps_si128(mask), _mm_set1_epi32(bit));
+}
+
+// Same as gl_clipcode(), including the scaling of W in double precision
+FORCEINLINE __m128i clipCode(__m128 x, __m128 y, __m128 z, __m128 w) {
+	const __m128d factor = _mm_set1_pd(1.0 + CLIP_EPSILON);
+	const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(w), factor));
+	const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(w, w)), factor));
+	const __m128 max = _mm_movelh_ps(lo, hi);
+	const __m128 min = _mm_xor_ps(max, _mm_set1_ps(-0.0f));
+
+	__m128i code = _mm_or_si128(clipBit(_mm_cmplt_ps(x, min), 1), clipBit(_mm_cmpgt_ps(x, max), 2));
+	code = _mm_or_si128(code, _mm_or_si128(clipBit(_mm_cmplt_ps(y, min), 4), clipBit(_mm_cmpgt_ps(y, max), 8)));
+	return _mm_or_si128(code, _mm_or_si128(clipBit(_mm_cmplt_ps(z, min), 16), clipBit(_mm_cmpgt_ps(z, max), 32)));
+}
+
+FORCEINLINE __m128i viewport(const Context &ctx, int i, __m128 coord, __m128 winv) {
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(coord, winv), ctx.viewportScale[i]), ctx.viewportTrans[i]));
+}
+
+// Transform four vertices
+void transformBlock(const TransformState &state, const Context &ctx, GLVertex *v) {
+	__m128 x, y, z, w;
+	__m128 px, py, pz, pw;
+	loadTransposed(v[0].coord._v, v[1].coord._v, v[2].coord._v, v[3].coord._v, x, y, z, w);
+
+	if (state.eyeCoords) {
+		const __m128 ex = dot3x4(ctx.modelView[0], x, y, z);
+		const __m128 ey = dot3x4(ctx.modelView[1], x, y, z);
+		const __m128 ez = dot3x4(ctx.modelView[2], x, y, z);
+		const __m128 ew = dot3x4(ctx.modelView[3], x, y, z);
+		storeTransposed(v[0].ec._v, v[1].ec._v, v[2].ec._v, v[3].ec._v, ex, ey, ez, ew);
+
+		if (state.lighting) {
+			px = dot4(ctx.projection[0], ex, ey, ez, ew);
+			py = dot4(ctx.projection[1], ex, ey, ez, ew);
+			pz = dot4(ctx.projection[2], ex, ey, ez, ew);
+			pw = dot4(ctx.projection[3], ex, ey, ez, ew);
+		}
+	}
+
+	if (state.lighting) {
+		// The normal is followed by the coordinates in GLVertex, so it can
+		// be loaded as four floats
+		__m128 nx, ny, nz, unused;
+		loadTransposed(v[0].normal._v, v[1].normal._v, v[2].normal._v, v[3].normal._v, nx, ny, nz, unused);
+
+		__m128 tx = dot3(ctx.normalMatrix[0], nx, ny, nz);
+		__m128 ty = dot3(ctx.normalMatrix[1], nx, ny, nz);
+		__m128 tz = dot3(ctx.normalMatrix[2], nx, ny, nz);
+		if (state.normalize) {
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz)));
+			const __m128 nonZero = _mm_cmpneq_ps(length, _mm_setzero_ps());
+			tx = select(nonZero, _mm_div_ps(tx, length), tx);
+			ty = select(nonZero, _mm_div_ps(ty, length), ty);
+			tz = select(nonZero, _mm_div_ps(tz, length), tz);
+		}
+
+		_MM_TRANSPOSE4_PS(tx, ty, tz, unused);
+		float normals[4][4];
+		_mm_storeu_ps(normals[0], tx);
+		_mm_storeu_ps(normals[1], ty);
+		_mm_storeu_ps(normals[2], tz);
+		_mm_storeu_ps(normals[3], unused);
+		for (int i = 0; i < 4; i++) {
+			v[i].normal.X = normals[i][0];
+			v[i].normal.Y = normals[i][1];
+			v[i].normal.Z = normals[i][2];
+		}
+	} else {
+		px = dot3x4(ctx.modelViewProjection[0], x, y, z);
+		py = dot3x4(ctx.modelViewProjection[1], x, y, z);
+		pz = dot3x4(ctx.modelViewProjection[2], x, y, z);
+		pw = state.noWTransform ? ctx.modelViewProjection[3][3] : dot3x4(ctx.modelViewProjection[3], x, y, z);
+	}
+
+	storeTransposed(v[0].pc._v, v[1].pc._v, v[2].pc._v, v[3].pc._v, px, py, pz, pw);
+
+	int clipCodes[4], zx[4], zy[4], zz[4];
+	const __m128 winv = _mm_div_ps(_mm_set1_ps(1.0f), pw);
+	_mm_storeu_si128((__m128i *)clipCodes, clipCode(px, py, pz, pw));
+	_mm_storeu_si128((__m128i *)zx, viewport(ctx, 0, px, winv));
+	_mm_storeu_si128((__m128i *)zy, viewport(ctx, 1, py, winv));
+	_mm_storeu_si128((__m128i *)zz, viewport(ctx, 2, pz, winv));
+
+	for (int i = 0; i < 4; i++) {
+		v[i].clip_code = clipCodes[i];
+		if (clipCodes[i] == 0) {
+			v[i].zp.x = zx[i];
+			v[i].zp.y = zy[i];
+			v[i].zp.z = zz[i];
+		}
+	}
+}
+
+} // end of anonymous namespace
+
+void transformVerticesSSE2(const TransformState &state, GLVertex *vertices, int count) {
+	const Context ctx(state);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		transformBlock(state, ctx, vertices + i);
+	}
+
+	if (i < count) {
+		// Pad the last block with copies of its last vertex
+		GLVertex rest[4];
+		for (int j = 0; j < 4; j++) {
+			rest[j] = vertices[MIN(i + j, count - 1)];
+		}
+		transformBlock(state, ctx, rest);
+		for (int j = 0; i + j < count; j++) {
+			vertices[i + j] = rest[j];
+		}
+	}
+}
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZTRANSFORM_H
+#define GRAPHICS_TINYGL_ZTRANSFORM_H
+
+#include "common/scummsys.h"
+
+namespace TinyGL {
+
+struct GLVertex;
+class Matrix4;
+
+/**
+ * The matrices and viewport used to transform the vertices of a draw call.
+ */
+struct TransformState {
+	const Matrix4 *modelView;
+	const Matrix4 *projection;
+	// Without lighting, the vertices are transformed by the product of the
+	// model view and projection matrices, assuming W = 1.
+	const Matrix4 *modelViewProjection;
+	bool noWTransform;
+	// The inverse transposed model view matrix, for the normals
+	const Matrix4 *normalMatrix;
+	bool normalize;
+
+	bool lighting;
+	// Eye coordinates are also needed for fog
+	bool eyeCoords;
+
+	float viewportScale[3];
+	float viewportTrans[3];
+};
+
+/**
+ * Transform a batch of vertices as GLContext::gl_vertex_transform() does,
+ * taking the object normal from the normal of the vertex. This sets the eye
+ * coordinates if needed, the transformed normal with lighting, the
+ * projected coordinates and the clip code, and the window coordinates of
+ * the unclipped vertices. Everything else is left to the caller.
+ */
+typedef void (*TransformFunc)(const TransformState &state, GLVertex *vertices, int count);
+
+void transformVertices(const TransformState &state, GLVertex *vertices, int count);
+#ifdef SCUMMVM_SSE2
+void transformVerticesSSE2(const TransformState &state, GLVertex *vertices, int count);
+#endif
+#ifdef SCUMMVM_AVX2
+void transformVerticesAVX2(const TransformState &state, GLVertex *vertices, int count);
+#endif
+
+namespace Internal {
+/**
+ * Return the vertex transform function for the CPU.
+ */
+TransformFunc getTransformFunc();
+
+/**
+ * Override the vertex transform function, for testing. nullptr selects the
+ * generic code.
+ */
+void setTransformFunc(TransformFunc func);
+} // end of namespace Internal
+
+} // end of namespace TinyGL
+
+#endif // GRAPHICS_TINYGL_ZTRANSFORM_H
@@ -26,43 +26,151 @@
  */
 
 #include "common/endian.h"
+#include "common/system.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
 static const int NB_INTERP = 8;
 
+namespace Internal {
+
+static const SpanFuncs *g_spanFuncs = nullptr;
+static bool g_spanFuncsDetected = false;
+
+const SpanFuncs *getSpanFuncs() {
+	if (!g_spanFuncsDetected) {
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) g_spanFuncs = &spanFuncsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) g_spanFuncs = &spanFuncsAVX2;
+#endif
+		g_spanFuncsDetected = true;
+	}
+	return g_spanFuncs;
+}
+
+void setSpanFuncs(const SpanFuncs *funcs) {
+	g_spanFuncs = funcs;
+	g_spanFuncsDetected = true;
+}
+
+} // end of namespace Internal
+
+bool getSpanBlendingFactor(int factor, int &base, int &sign) {
+	switch (factor) {
+	case TGL_ZERO:
+		base = 0;
+		sign = 0;
+		return true;
+	case TGL_ONE:
+		base = 256;
+		sign = 0;
+		return true;
+	case TGL_SRC_ALPHA:
+		base = 0;
+		sign = 1;
+		return true;
+	case TGL_ONE_MINUS_SRC_ALPHA:
+		base = 255;
+		sign = -1;
+		return true;
+	default:
+		return false;
+	}
+}
+
+template <bool kDepthWrite, bool kBlendingEnabled, bool kDepthTestEnabled>
+bool FrameBuffer::getSpanState(SpanState &state) const {
+	if (_pbufBpp != 4 || _pbufFormat.rLoss || _pbufFormat.gLoss || _pbufFormat.bLoss ||
+	    (_pbufFormat.aLoss != 0 && _pbufFormat.aLoss != 8)) {
+		return false;
+	}
+
+	state.depthLess = state.depthEqual = state.depthGreater = 0;
+	switch (kDepthTestEnabled ? _depthFunc : TGL_ALWAYS) {
+	case TGL_NEVER:
+		break;
+	case TGL_LESS:
+		state.depthLess = ~0;
+		break;
+	case TGL_EQUAL:
+		state.depthEqual = ~0;
+		break;
+	case TGL_LEQUAL:
+		state.depthLess = state.depthEqual = ~0;
+		break;
+	case TGL_GREATER:
+		state.depthGreater = ~0;
+		break;
+	case TGL_NOTEQUAL:
+		state.depthLess = state.depthGreater = ~0;
+		break;
+	case TGL_GEQUAL:
+		state.depthGreater = state.depthEqual = ~0;
+		break;
+	case TGL_ALWAYS:
+		state.depthLess = state.depthEqual = state.depthGreater = ~0;
+		break;
+	default:
+		return false;
+	}
+	state.depthWrite = kDepthWrite;
+
+	state.blending = kBlendingEnabled;
+	if (kBlendingEnabled) {
+		if (!getSpanBlendingFactor(_sourceBlendingFactor, state.srcFactorBase, state.srcFactorSign) ||
+		    !getSpanBlendingFactor(_destinationBlendingFactor, state.dstFactorBase, state.dstFactorSign)) {
+			return false;
+		}
+	}
+
+	state.aShift = _pbufFormat.aShift;
+	state.rShift = _pbufFormat.rShift;
+	state.gShift = _pbufFormat.gShift;
+	state.bShift = _pbufFormat.bShift;
+	state.aLoss = _pbufFormat.aLoss;
+
+	state.texture = _currentTexture;
+	state.nextTexture = _nextTexture;
+	state.lodFraction = _lodFraction;
+	state.wrapS = _wrapS;
+	state.wrapT = _wrapT;
+	return true;
+}
+
 template <bool kDepthWrite, bool kSmoothMode, bool kFogMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled, bool kDepthTestEnabled>
 void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
                                     int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
                                     int &dzdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                     uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
+	// Clipped pixels still advance the interpolated values, so that the
+	// rest of the span looks the same with and without a scissor rectangle
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		if (kStencilEnabled && !stencilTest(ps[_a])) {
+			// Still advance the interpolated values below, like for clipped pixels
 			stencilOp(false, true, ps + _a);
-			return;
+		} else {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (depthTestResult) {
+				writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
+				          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
+				          z, fog, fog_r, fog_g, fog_b);
+			}
 		}
 	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
-		          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
-		          z, fog, fog_r, fog_g, fog_b);
-	}
 	z += dzdx;
 	if (kFogMode) {
 		fog += dfdx;
@@ -82,39 +190,39 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
                                   uint &r, uint &g, uint &b, uint &a,
                                   int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                   uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		if (kStencilEnabled && !stencilTest(ps[_a])) {
+			// Still advance the interpolated values below, like for clipped pixels
 			stencilOp(false, true, ps + _a);
-			return;
-		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		uint8 c_a, c_r, c_g, c_b;
-		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
-		if (kLightsMode) {
-			uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
-			uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
-			uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
-			uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
-			c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
-			c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
-			c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
-			c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+		} else {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (depthTestResult) {
+				uint8 c_a, c_r, c_g, c_b;
+				texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+				if (_nextTexture) {
+					_nextTexture->blendARGBAt(_lodFraction, wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+				}
+				if (kLightsMode) {
+					uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
+					uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
+					uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
+					uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
+					c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
+					c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
+					c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
+					c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+				}
+				writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
+			}
 		}
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
 	}
 	z += dzdx;
 	s += dsdx;
@@ -132,28 +240,25 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
 
 template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		if (kStencilEnabled && !stencilTest(ps[_a])) {
+			// Still advance the interpolated values below, like for clipped pixels
 			stencilOp(false, true, ps + _a);
-			return;
+		} else {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (kDepthWrite && depthTestResult) {
+				pz[_a] = z;
+			}
 		}
 	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (kDepthWrite && depthTestResult) {
-		pz[_a] = z;
-	}
 	z += dzdx;
 }
 
@@ -302,6 +407,33 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		polyOffset = -m * _offsetFactor + -_offsetUnits * (1 << 6);
 	}
 
+	// Triangles hidden behind the tiles of the hierarchical z buffer are
+	// skipped, and so are the hidden spans of the others. The stencil
+	// operations need the result of the depth test of every pixel.
+	const bool depthTiles = kInterpZ && kDepthTestEnabled && !kStencilEnabled && _depthTilesEnabled;
+	const int boxLeft = MIN(MIN(p0->x, p1->x), p2->x);
+	const int boxRight = MAX(MAX(p0->x, p1->x), p2->x);
+	if (depthTiles) {
+		// The interpolated values drift from the vertices by less than one
+		// per step
+		const int margin = 2 * (boxRight - boxLeft + p2->y - p0->y + 1);
+		const int zMin = MIN(MIN(p0->z, p1->z), p2->z) + polyOffset - margin;
+		const int zMax = MAX(MAX(p0->z, p1->z), p2->z) + polyOffset + margin;
+		int left = boxLeft, right = boxRight, top = p0->y, bottom = p2->y;
+		if (kEnableScissor) {
+			left = MAX<int>(left, _clipRectangle.left);
+			right = MIN<int>(right, _clipRectangle.right - 1);
+			top = MAX<int>(top, _clipRectangle.top);
+			bottom = MIN<int>(bottom, _clipRectangle.bottom - 1);
+		}
+		_depthStats.testedTriangles++;
+		if (isDepthHidden(left, top, right, bottom, MAX(zMin, 0), MAX(zMax, 0))) {
+			_depthStats.rejectedTriangles++;
+			_rejectedPixels += (uint32)(0.5f / ABS(fz0));
+			return;
+		}
+	}
+
 	// screen coordinates
 
 	int pp1 = _pbufWidth * p0->y;
@@ -325,6 +457,16 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		ndtzdx = NB_INTERP * dtzdx;
 	}
 
+	// The vectorized span functions, if the CPU and the state allow them
+	const SpanFuncs *spanFuncs = nullptr;
+	SpanState spanState;
+	if (kInterpZ && !kFogMode && !kAlphaTestEnabled && !kStencilEnabled) {
+		spanFuncs = Internal::getSpanFuncs();
+		if (spanFuncs && !getSpanState<kDepthWrite, kBlendingEnabled, kDepthTestEnabled>(spanState)) {
+			spanFuncs = nullptr;
+		}
+	}
+
 	if (fz0 > 0) {
 		l1 = p0;
 		l2 = p2;
@@ -424,7 +566,19 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			// With a scissor rectangle, the pixels left of it are skipped by
+			// advancing the interpolated values, and the span ends at its right
+			// edge. This gives the same result as testing every pixel.
+			int skip = 0, last = 0;
+			if (kEnableScissor) {
+				skip = MAX(_clipRectangle.left - x1, 0);
+				last = MIN(x2 >> 16, _clipRectangle.right - 1);
+			}
+			if (kEnableScissor && (y < _clipRectangle.top || y >= _clipRectangle.bottom || x1 + skip > last)) {
+				// The span is outside of the scissor rectangle
+			} else if (depthTiles && isSpanHidden(x1, x1 + skip, kEnableScissor ? last : x2 >> 16, y, z1, dzdx)) {
+				// The depth test fails for the whole span
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -437,30 +591,51 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
-				while (n >= 3) {
-					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
-					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 1, x, y, z, dzdx);
-					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 2, x, y, z, dzdx);
-					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 3, x, y, z, dzdx);
+				if (kEnableScissor) {
 					if (kInterpZ) {
-						pz += 4;
+						pz += skip;
+						z += dzdx * (uint)skip;
 					}
 					if (kStencilEnabled) {
-						ps += 4;
+						ps += skip;
 					}
-					n -= 4;
-					x += 4;
+					x += skip;
+					n = last - x;
 				}
-				while (n >= 0) {
-					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
-					if (kInterpZ) {
-						pz += 1;
+				_shadedPixels += n + 1;
+				if (kDepthWrite && spanFuncs) {
+					Span span;
+					span.zbuf = pz;
+					span.count = n + 1;
+					span.z = z;
+					span.dzdx = dzdx;
+					spanFuncs->fillDepth(spanState, span);
+				} else {
+					while (n >= 3) {
+						putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
+						putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 1, x, y, z, dzdx);
+						putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 2, x, y, z, dzdx);
+						putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 3, x, y, z, dzdx);
+						if (kInterpZ) {
+							pz += 4;
+						}
+						if (kStencilEnabled) {
+							ps += 4;
+						}
+						n -= 4;
+						x += 4;
 					}
-					if (kStencilEnabled) {
-						ps += 1;
+					while (n >= 0) {
+						putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
+						if (kInterpZ) {
+							pz += 1;
+						}
+						if (kStencilEnabled) {
+							ps += 1;
+						}
+						n -= 1;
+						x += 1;
 					}
-					n -= 1;
-					x += 1;
 				}
 			} else if (!(kInterpST || kInterpSTZ)) {
 				uint *pz;
@@ -483,37 +658,77 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
-				while (n >= 3) {
-					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					                 (pp, pz, ps, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					                 (pp, pz, ps, 2, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					                 (pp, pz, ps, 3, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					pp += 4;
+				if (kEnableScissor) {
+					pp += skip;
+					if (kFogMode) {
+						fog += dfdx * (uint)skip;
+					}
 					if (kInterpZ) {
-						pz += 4;
+						pz += skip;
+						z += dzdx * (uint)skip;
 					}
 					if (kStencilEnabled) {
-						ps += 4;
+						ps += skip;
+					}
+					if (kSmoothMode) {
+						r += drdx * (uint)skip;
+						g += dgdx * (uint)skip;
+						b += dbdx * (uint)skip;
+						a += dadx * (uint)skip;
 					}
-					n -= 4;
-					x += 4;
+					x += skip;
+					n = last - x;
 				}
-				while (n >= 0) {
-					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					pp += 1;
-					if (kInterpZ) {
-						pz += 1;
+				_shadedPixels += n + 1;
+				if (spanFuncs) {
+					Span span;
+					span.pbuf = (uint32 *)_pbuf + pp;
+					span.zbuf = pz;
+					span.count = n + 1;
+					span.z = z;
+					span.dzdx = dzdx;
+					span.r = r;
+					span.g = g;
+					span.b = b;
+					span.a = a;
+					span.drdx = kSmoothMode ? drdx : 0;
+					span.dgdx = kSmoothMode ? dgdx : 0;
+					span.dbdx = kSmoothMode ? dbdx : 0;
+					span.dadx = kSmoothMode ? dadx : 0;
+					spanFuncs->fillColor(spanState, span);
+				} else {
+					while (n >= 3) {
+						putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						                 (pp, pz, ps, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						                 (pp, pz, ps, 2, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						                 (pp, pz, ps, 3, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						pp += 4;
+						if (kInterpZ) {
+							pz += 4;
+						}
+						if (kStencilEnabled) {
+							ps += 4;
+						}
+						n -= 4;
+						x += 4;
 					}
-					if (kStencilEnabled) {
-						ps += 1;
+					while (n >= 0) {
+						putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						pp += 1;
+						if (kInterpZ) {
+							pz += 1;
+						}
+						if (kStencilEnabled) {
+							ps += 1;
+						}
+						n -= 1;
+						x += 1;
 					}
-					n -= 1;
-					x += 1;
 				}
 			} else if (kInterpST || kInterpSTZ) {
 				uint *pz;
@@ -525,6 +740,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				int dsdx, dtdx;
 
 				n = (x2 >> 16) - x1;
+				_shadedPixels += (kEnableScissor ? last - skip - x1 : n) + 1;
 				fz = (float)z1;
 				zinv = (float)(1.0 / fz);
 
@@ -545,7 +761,46 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				g = g1;
 				b = b1;
 				a = a1;
-				while (n >= (NB_INTERP - 1)) {
+				Span span;
+				span.dzdx = dzdx;
+				span.drdx = kSmoothMode ? drdx : 0;
+				span.dgdx = kSmoothMode ? dgdx : 0;
+				span.dbdx = kSmoothMode ? dbdx : 0;
+				span.dadx = kSmoothMode ? dadx : 0;
+				if (kEnableScissor) {
+					// Only whole blocks can be skipped, since the texture
+					// coordinates are interpolated linearly inside of them
+					const int blocks = skip / NB_INTERP;
+					const int pixels = blocks * NB_INTERP;
+					for (int i = 0; i < blocks; i++) {
+						fz += fndzdx;
+						sz += ndszdx;
+						tz += ndtzdx;
+					}
+					if (blocks > 0) {
+						zinv = (float)(1.0 / fz);
+					}
+					pp += pixels;
+					if (kFogMode) {
+						fog += dfdx * (uint)pixels;
+					}
+					if (kInterpZ) {
+						pz += pixels;
+						z += dzdx * (uint)pixels;
+					}
+					if (kStencilEnabled) {
+						ps += pixels;
+					}
+					if (kSmoothMode) {
+						r += drdx * (uint)pixels;
+						g += dgdx * (uint)pixels;
+						b += dbdx * (uint)pixels;
+						a += dadx * (uint)pixels;
+					}
+					n -= pixels;
+					x += pixels;
+				}
+				while (n >= (NB_INTERP - 1) && (!kEnableScissor || x <= last)) {
 					{
 						float ss, tt;
 						ss = sz * zinv;
@@ -557,9 +812,33 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
-					for (int _a = 0; _a < NB_INTERP; _a++) {
-						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+					if (spanFuncs) {
+						span.pbuf = (uint32 *)_pbuf + pp;
+						span.zbuf = pz;
+						span.count = kEnableScissor ? MIN(NB_INTERP, last + 1 - x) : NB_INTERP;
+						span.first = kEnableScissor ? _clipRectangle.left - x : 0;
+						span.z = z;
+						span.r = r;
+						span.g = g;
+						span.b = b;
+						span.a = a;
+						span.s = s;
+						span.t = t;
+						span.dsdx = dsdx;
+						span.dtdx = dtdx;
+						spanFuncs->fillTexture(spanState, span);
+						z += dzdx * (uint)NB_INTERP;
+						if (kSmoothMode) {
+							r += drdx * (uint)NB_INTERP;
+							g += dgdx * (uint)NB_INTERP;
+							b += dbdx * (uint)NB_INTERP;
+							a += dadx * (uint)NB_INTERP;
+						}
+					} else {
+						for (int _a = 0; _a < NB_INTERP; _a++) {
+							putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+							               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						}
 					}
 					pp += NB_INTERP;
 					if (kInterpZ) {
@@ -584,18 +863,38 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 				}
 
-				while (n >= 0) {
-					putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
-					pp += 1;
-					if (kInterpZ) {
-						pz += 1;
-					}
-					if (kStencilEnabled) {
-						ps += 1;
+				if (kEnableScissor) {
+					n = MIN(n, last - x);
+				}
+				if (spanFuncs) {
+					span.pbuf = (uint32 *)_pbuf + pp;
+					span.zbuf = pz;
+					span.count = n + 1;
+					span.first = kEnableScissor ? _clipRectangle.left - x : 0;
+					span.z = z;
+					span.r = r;
+					span.g = g;
+					span.b = b;
+					span.a = a;
+					span.s = s;
+					span.t = t;
+					span.dsdx = dsdx;
+					span.dtdx = dtdx;
+					spanFuncs->fillTexture(spanState, span);
+				} else {
+					while (n >= 0) {
+						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+						               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						pp += 1;
+						if (kInterpZ) {
+							pz += 1;
+						}
+						if (kStencilEnabled) {
+							ps += 1;
+						}
+						n -= 1;
+						x += 1;
 					}
-					n -= 1;
-					x += 1;
 				}
 			}
 
@@ -658,6 +957,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 			y++;
 		}
 	}
+
+	if (kInterpZ && kDepthWrite) {
+		invalidateDepthTiles(boxLeft, p0->y, boxRight, p2->y);
+	}
 }
 
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, bool kSmoothMode, bool kDepthWrite, bool kFogMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled>
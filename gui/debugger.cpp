@@ -34,6 +34,9 @@
 #include "common/stream.h"
 #endif
 
+#include "audio/mixer.h"
+#include "audio/mixer_stats.h"
+
 #include "engines/engine.h"
 
 #include "gui/debugger.h"
@@ -81,6 +84,8 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("mixer_stats",		WRAP_METHOD(Debugger, cmdMixerStats));
 }
 
 Debugger::~Debugger() {
@@ -874,4 +879,49 @@ bool Debugger::debuggerCompletionCallback(GUI::ConsoleDialog *console, const cha
 
 #endif
 
+bool Debugger::cmdMixerStats(int argc, const char **argv) {
+	Audio::Mixer *mixer = g_system->getMixer();
+	if (!mixer) {
+		debugPrintf("No mixer available\n");
+		return true;
+	}
+
+	if (argc == 1) {
+		if (mixer->isTimingStatsEnabled()) {
+			Audio::MixerTimingStats stats;
+			mixer->getTimingStats(stats);
+			debugPrintf("%s", stats.toString().c_str());
+		} else {
+			debugPrintf("Mixer timing statistics are disabled\n");
+			debugPrintf("Usage: %s [on | off | reset | dump [<filename>]]\n", argv[0]);
+		}
+	} else if (!strcmp(argv[1], "on") || !strcmp(argv[1], "off")) {
+		mixer->enableTimingStats(!strcmp(argv[1], "on"));
+		debugPrintf("Mixer timing statistics %s\n", mixer->isTimingStatsEnabled() ? "enabled" : "disabled");
+	} else if (!strcmp(argv[1], "reset")) {
+		mixer->resetTimingStats();
+	} else if (!strcmp(argv[1], "dump")) {
+		Audio::MixerTimingStats stats;
+		mixer->getTimingStats(stats);
+		const Common::String dump = stats.dump();
+
+		if (argc < 3) {
+			debugPrintf("%s", dump.c_str());
+		} else {
+			Common::DumpFile file;
+			if (!file.open(Common::Path(argv[2], Common::Path::kNativeSeparator))) {
+				debugPrintf("Failed to open '%s' for writing\n", argv[2]);
+			} else {
+				file.writeString(dump);
+				file.flush();
+				debugPrintf("Wrote mixer timing statistics to '%s'\n", argv[2]);
+			}
+		}
+	} else {
+		debugPrintf("Usage: %s [on | off | reset | dump [<filename>]]\n", argv[0]);
+	}
+
+	return true;
+}
+
 } // End of namespace GUI
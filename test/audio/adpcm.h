@@ -0,0 +1,190 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+#include "common/crc.h"
+#include "common/debug.h"
+#include "common/memstream.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class ADPCMTestSuite : public CxxTest::TestSuite {
+	struct Result {
+		uint32 numSamples;
+		uint32 checksum;
+	};
+
+	/**
+	 * Create pseudo random ADPCM data, with the block headers patched to
+	 * contain values the decoders accept.
+	 */
+	static byte *createData(Audio::ADPCMType type, int channels, uint32 blockAlign, uint32 size) {
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 0x12345678 + type * 7 + channels;
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+
+		for (uint32 block = 0; block + blockAlign <= size && blockAlign; block += blockAlign) {
+			byte *header = data + block;
+			switch (type) {
+			case Audio::kADPCMMSIma:
+				for (int i = 0; i < channels; i++)
+					WRITE_LE_UINT16(header + i * 4 + 2, header[i * 4 + 2] % 89);
+				break;
+			case Audio::kADPCMDK3:
+				WRITE_LE_UINT16(header + 2, 22050);
+				header[14] %= 89;
+				header[15] %= 89;
+				break;
+			case Audio::kADPCMXA:
+				for (int i = 4; i < 12; i++)
+					header[i] = (((header[i] >> 4) % 5) << 4) | ((header[i] & 0xf) % 13);
+				break;
+			default:
+				break;
+			}
+		}
+
+		return data;
+	}
+
+	static Audio::SeekableAudioStream *createStream(Audio::ADPCMType type, int channels, uint32 blockAlign, uint32 size) {
+		byte *data = createData(type, channels, blockAlign, size);
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+		return Audio::makeADPCMStream(stream, DisposeAfterUse::YES, size, type, 22050, channels, blockAlign);
+	}
+
+	/**
+	 * Decode the whole stream in chunks of varying size, and return the
+	 * number of samples and the checksum of the samples in little endian
+	 * byte order.
+	 */
+	static Result decode(Audio::ADPCMType type, int channels, uint32 blockAlign, uint32 size, const int *chunkSizes, int numChunkSizes) {
+		Audio::SeekableAudioStream *stream = createStream(type, channels, blockAlign, size);
+
+		int16 buffer[4096];
+		Common::CRC32 crc;
+		Result result = { 0, crc.getInitRemainder() };
+
+		for (int i = 0; !stream->endOfData(); i = (i + 1) % numChunkSizes) {
+			const int count = stream->readBuffer(buffer, chunkSizes[i]);
+			if (count <= 0)
+				break;
+
+			for (int j = 0; j < count; j++)
+				WRITE_LE_INT16(&buffer[j], buffer[j]);
+			result.checksum = crc.processBlock((const byte *)buffer, count * sizeof(int16), result.checksum);
+			result.numSamples += count;
+		}
+		result.checksum = crc.finalize(result.checksum);
+
+		delete stream;
+		return result;
+	}
+
+	void check(Audio::ADPCMType type, int channels, uint32 blockAlign, uint32 numSamples, uint32 checksum) {
+		// Reading in small, odd sized chunks has to give the same output as
+		// reading big chunks
+		static const int bigChunks[] = { 4096 };
+		static const int smallChunks[] = { 4, 64, 1000, 12, 4096, 8 };
+
+		// Only complete blocks for all channels
+		uint32 size = 64 * 512;
+		if (blockAlign)
+			size -= size % (blockAlign * channels);
+
+		Result result = decode(type, channels, blockAlign, size, bigChunks, ARRAYSIZE(bigChunks));
+		TS_ASSERT_EQUALS(result.numSamples, numSamples);
+		TS_ASSERT_EQUALS(result.checksum, checksum);
+
+		result = decode(type, channels, blockAlign, size, smallChunks, ARRAYSIZE(smallChunks));
+		TS_ASSERT_EQUALS(result.numSamples, numSamples);
+		TS_ASSERT_EQUALS(result.checksum, checksum);
+	}
+
+public:
+	// The checksums were recorded with the sample by sample decoders, and
+	// make sure the block decoders produce exactly the same output.
+	void test_oki() {
+		check(Audio::kADPCMOki, 1, 0, 65536u, 0x2cdd5940u);
+	}
+
+	void test_dvi() {
+		check(Audio::kADPCMDVI, 1, 0, 65536u, 0xf1e54e47u);
+		check(Audio::kADPCMDVI, 2, 0, 65536u, 0xf5bf33f9u);
+	}
+
+	void test_ms_ima() {
+		check(Audio::kADPCMMSIma, 1, 256, 64512u, 0xd6ba0b8au);
+		check(Audio::kADPCMMSIma, 2, 512, 64512u, 0xfc47d424u);
+	}
+
+	void test_ms() {
+		check(Audio::kADPCMMS, 1, 256, 64000u, 0xfcbb0e8du);
+		check(Audio::kADPCMMS, 2, 512, 64000u, 0x78ddb53bu);
+	}
+
+	void test_apple() {
+		check(Audio::kADPCMApple, 1, 34, 61632u, 0x8b5b7454u);
+		check(Audio::kADPCMApple, 2, 34, 61568u, 0x3e446de0u);
+	}
+
+	void test_dk3() {
+		check(Audio::kADPCMDK3, 2, 256, 81920u, 0xeaa472dcu);
+	}
+
+	void test_xa() {
+		check(Audio::kADPCMXA, 1, 128, 57344u, 0xd8e90997u);
+		check(Audio::kADPCMXA, 2, 128, 57344u, 0xadbbdf38u);
+	}
+
+	void test_adpcm_speed() {
+#if BENCHMARK_TIME
+		if (!g_system)
+			Common::install_null_g_system();
+
+		const uint32 size = benchmarkCount(256 * 1024, 16 * 1024 * 1024);
+		static const struct {
+			const char *name;
+			Audio::ADPCMType type;
+			uint32 blockAlign;
+		} types[] = {
+			{ "Oki", Audio::kADPCMOki, 0 },
+			{ "DVI", Audio::kADPCMDVI, 0 },
+			{ "MS IMA", Audio::kADPCMMSIma, 2048 },
+			{ "MS", Audio::kADPCMMS, 2048 },
+			{ "Apple", Audio::kADPCMApple, 34 },
+			{ "DK3", Audio::kADPCMDK3, 2048 },
+			{ "XA", Audio::kADPCMXA, 128 }
+		};
+
+		int16 *buffer = new int16[4096];
+		for (int i = 0; i < ARRAYSIZE(types); i++) {
+			Audio::SeekableAudioStream *stream = createStream(types[i].type, 2, types[i].blockAlign, size);
+
+			uint32 numSamples = 0;
+			BenchmarkTimer timer;
+			while (!stream->endOfData()) {
+				const int count = stream->readBuffer(buffer, 4096);
+				if (count <= 0)
+					break;
+				numSamples += count;
+			}
+			const uint32 time = timer.stop();
+
+			debug("ADPCM %s: %d samples in %d ms, %d samples/s", types[i].name, numSamples, time, timer.perSecond(numSamples));
+			delete stream;
+		}
+		delete[] buffer;
+#endif
+	}
+};
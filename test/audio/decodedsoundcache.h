@@ -0,0 +1,99 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decodedsoundcache.h"
+#include "audio/audiostream.h"
+
+#include "helper.h"
+
+#include "../null_osystem.h"
+
+class DecodedSoundCacheTestSuite : public CxxTest::TestSuite {
+	static bool checkStream(Audio::SeekableAudioStream *stream, const int16 *expected, int numSamples) {
+		int16 *buffer = new int16[numSamples + 16];
+		const int count = stream->readBuffer(buffer, numSamples + 16);
+		const bool result = (count == numSamples) && !memcmp(buffer, expected, numSamples * sizeof(int16)) && stream->endOfData();
+		delete[] buffer;
+		delete stream;
+		return result;
+	}
+
+public:
+	void setUp() {
+		// The cache uses a mutex
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	void test_add_and_hit() {
+		Audio::DecodedSoundCache cache;
+		Audio::DecodedSoundCache::Key key("sfx.dat", 100);
+
+		TS_ASSERT(!cache.createStream(key));
+
+		int16 *sine;
+		Audio::SeekableAudioStream *stream = cache.addStream(key, createSineStream<int16>(11025, 1, &sine, true, true));
+		TS_ASSERT(stream);
+		TS_ASSERT(stream->isStereo());
+		TS_ASSERT_EQUALS(stream->getRate(), 11025);
+		TS_ASSERT(checkStream(stream, sine, 11025 * 2));
+
+		TS_ASSERT(cache.contains(key));
+		TS_ASSERT(!cache.contains(Audio::DecodedSoundCache::Key("sfx.dat", 100, 1)));
+		TS_ASSERT(!cache.contains(Audio::DecodedSoundCache::Key("sfx.dat", 200)));
+
+		// Several streams can play the same data at the same time
+		Audio::SeekableAudioStream *first = cache.createStream(key);
+		Audio::SeekableAudioStream *second = cache.createStream(key);
+		TS_ASSERT(checkStream(first, sine, 11025 * 2));
+		TS_ASSERT(checkStream(second, sine, 11025 * 2));
+
+		Audio::DecodedSoundCache::Stats stats = cache.getStats();
+		TS_ASSERT_EQUALS(stats.hits, 2u);
+		TS_ASSERT_EQUALS(stats.misses, 1u);
+		TS_ASSERT_EQUALS(stats.numSounds, 1u);
+		TS_ASSERT_EQUALS(stats.bytesUsed, 11025u * 2 * 2);
+
+		delete[] sine;
+	}
+
+	void test_lru_eviction() {
+		// Room for two sounds of one second each
+		Audio::DecodedSoundCache cache(2 * 8000 * 2, 8000 * 2);
+		Audio::DecodedSoundCache::Key a("a"), b("b"), c("c");
+
+		delete cache.addStream(a, createSineStream<int16>(8000, 1, nullptr, true, false));
+		delete cache.addStream(b, createSineStream<int16>(8000, 1, nullptr, true, false));
+
+		// Use a, so b is the least recently used sound
+		delete cache.createStream(a);
+
+		delete cache.addStream(c, createSineStream<int16>(8000, 1, nullptr, true, false));
+		TS_ASSERT(cache.contains(a));
+		TS_ASSERT(!cache.contains(b));
+		TS_ASSERT(cache.contains(c));
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 1u);
+
+		// A playing stream stays valid after its sound was evicted
+		int16 *sine;
+		delete cache.addStream(b, createSineStream<int16>(8000, 1, &sine, true, false));
+		Audio::SeekableAudioStream *stream = cache.createStream(b);
+		cache.clear();
+		TS_ASSERT(!cache.contains(b));
+		TS_ASSERT(checkStream(stream, sine, 8000));
+
+		delete[] sine;
+	}
+
+	void test_too_big() {
+		Audio::DecodedSoundCache cache(1024 * 1024, 1000);
+		Audio::DecodedSoundCache::Key key("music");
+
+		Audio::SeekableAudioStream *original = createSineStream<int16>(8000, 1, nullptr, true, false);
+		Audio::SeekableAudioStream *stream = cache.addStream(key, original);
+		TS_ASSERT_EQUALS(stream, original);
+		TS_ASSERT(!cache.contains(key));
+		TS_ASSERT_EQUALS(cache.getStats().uncacheable, 1u);
+
+		delete stream;
+	}
+};
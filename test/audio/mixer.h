@@ -0,0 +1,357 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/mixer_render.h"
+#include "audio/mixer_stats.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+#include "common/debug.h"
+#include "common/memstream.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class MixerTestSuite : public CxxTest::TestSuite {
+	// Negates the samples of a sound type
+	class InvertEffect : public Audio::MixerEffect {
+	public:
+		InvertEffect() : _calls(0) {}
+
+		void process(int32 *buffer, uint numFrames, bool stereo) override {
+			for (uint i = 0; i < numFrames * (stereo ? 2 : 1); i++)
+				buffer[i] = -buffer[i];
+			_calls++;
+		}
+
+		int _calls;
+	};
+
+	/**
+	 * Create a 16-bit stream with a saw tooth wave, or with a constant
+	 * value if step is 0.
+	 */
+	static Audio::SeekableAudioStream *createStream(uint rate, bool stereo, uint numFrames, int16 start, int16 step) {
+		const uint numSamples = numFrames * (stereo ? 2 : 1);
+		int16 *data = (int16 *)malloc(numSamples * sizeof(int16));
+		for (uint i = 0; i < numSamples; i++)
+			data[i] = start + (int16)(((stereo ? i / 2 + (i & 1) * 37 : i) * step) & 0x1fff);
+
+		byte flags = Audio::FLAG_16BITS;
+		if (stereo)
+			flags |= Audio::FLAG_STEREO;
+#ifdef SCUMM_LITTLE_ENDIAN
+		flags |= Audio::FLAG_LITTLE_ENDIAN;
+#endif
+		return Audio::makeRawStream((const byte *)data, numSamples * sizeof(int16), rate, flags, DisposeAfterUse::YES);
+	}
+
+	static Audio::MixerImpl *createMixer(bool stereo) {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(44100, stereo);
+		mixer->setReady(true);
+		return mixer;
+	}
+
+	static void play(Audio::Mixer *mixer, Audio::Mixer::SoundType type, Audio::AudioStream *stream, byte volume = Audio::Mixer::kMaxChannelVolume, int8 balance = 0, bool reverseStereo = false) {
+		mixer->playStream(type, nullptr, stream, -1, volume, balance, DisposeAfterUse::YES, false, reverseStereo);
+	}
+
+	static void mix(Audio::MixerImpl *mixer, int16 *buffer, uint numSamples) {
+		// Use callbacks of varying size, like the backends do
+		static const uint chunkSizes[] = { 1024, 100, 2048, 2, 512 };
+		for (uint i = 0, pos = 0; pos < numSamples; i = (i + 1) % ARRAYSIZE(chunkSizes)) {
+			const uint count = MIN(chunkSizes[i], numSamples - pos);
+			mixer->mixCallback((byte *)(buffer + pos), count * sizeof(int16));
+			pos += count;
+		}
+	}
+
+public:
+	void setUp() {
+		// The channels query the time
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	// A single channel at full volume has to give the same output as the
+	// rate converter on its own
+	void test_single_channel() {
+		const uint numSamples = 8192;
+		int16 *expected = new int16[numSamples];
+		int16 *buffer = new int16[numSamples];
+
+		Audio::SeekableAudioStream *stream = createStream(22050, true, 3000, -4000, 3);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, true, true, false);
+		memset(expected, 0, numSamples * sizeof(int16));
+		converter->convert(*stream, expected, numSamples / 2, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		delete converter;
+		delete stream;
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		play(mixer, Audio::Mixer::kPlainSoundType, createStream(22050, true, 3000, -4000, 3));
+		mix(mixer, buffer, numSamples);
+		delete mixer;
+
+		TS_ASSERT_SAME_DATA(buffer, expected, numSamples * sizeof(int16));
+
+		delete[] buffer;
+		delete[] expected;
+	}
+
+	// As long as nothing clips, the mix has to be the sum of the channels
+	// played on their own
+	void test_sum() {
+		static const struct {
+			uint rate;
+			bool stereo;
+			int16 start, step;
+			byte volume;
+			int8 balance;
+			bool reverseStereo;
+		} channels[] = {
+			{ 44100, true, -3000, 5, 200, 0, false },
+			{ 22050, false, 1000, 7, 255, -60, false },
+			{ 11025, true, -2000, 11, 128, 90, true },
+			{ 32000, true, 0, 13, 90, -127, false }
+		};
+
+		for (int stereo = 0; stereo < 2; stereo++) {
+			const uint numSamples = 4096 * (stereo ? 2 : 1);
+			int16 *expected = new int16[numSamples];
+			int16 *buffer = new int16[numSamples];
+			memset(expected, 0, numSamples * sizeof(int16));
+
+			Audio::MixerImpl *all = createMixer(stereo);
+			for (int i = 0; i < ARRAYSIZE(channels); i++) {
+				Audio::MixerImpl *single = createMixer(stereo);
+				play(single, Audio::Mixer::kPlainSoundType, createStream(channels[i].rate, channels[i].stereo, 2000, channels[i].start, channels[i].step),
+				     channels[i].volume, channels[i].balance, channels[i].reverseStereo);
+				mix(single, buffer, numSamples);
+				delete single;
+
+				for (uint j = 0; j < numSamples; j++)
+					expected[j] += buffer[j];
+
+				play(all, Audio::Mixer::kPlainSoundType, createStream(channels[i].rate, channels[i].stereo, 2000, channels[i].start, channels[i].step),
+				     channels[i].volume, channels[i].balance, channels[i].reverseStereo);
+			}
+
+			mix(all, buffer, numSamples);
+			delete all;
+
+			TS_ASSERT_SAME_DATA(buffer, expected, numSamples * sizeof(int16));
+
+			delete[] buffer;
+			delete[] expected;
+		}
+	}
+
+	// The sum is only clamped once, so the order of the channels does not
+	// matter
+	void test_clamp() {
+		static const int16 values[] = { 30000, 30000, -30000, -30000, -30000 };
+		static const int16 expected[] = { 32767, 30000, 0, -30000 };
+		int16 buffer[256];
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		for (int i = 0; i < ARRAYSIZE(values); i++) {
+			play(mixer, Audio::Mixer::kPlainSoundType, createStream(44100, false, 1000, values[i], 0));
+
+			if (i >= 1) {
+				mixer->mixCallback((byte *)buffer, sizeof(buffer));
+				TS_ASSERT_EQUALS(buffer[0], expected[i - 1]);
+				TS_ASSERT_EQUALS(buffer[ARRAYSIZE(buffer) - 1], expected[i - 1]);
+			}
+		}
+		delete mixer;
+	}
+
+	void test_effect() {
+		int16 buffer[512];
+		InvertEffect effect;
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		mixer->setSoundTypeEffect(Audio::Mixer::kSFXSoundType, &effect);
+
+		// The effect runs even without any channel of its type
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(effect._calls, 1);
+
+		// The same stream as music and as inverted sound effect cancel out
+		play(mixer, Audio::Mixer::kMusicSoundType, createStream(22050, true, 1000, -1000, 9));
+		play(mixer, Audio::Mixer::kSFXSoundType, createStream(22050, true, 1000, -1000, 9));
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(effect._calls, 2);
+
+		bool silent = true;
+		for (int i = 0; i < ARRAYSIZE(buffer); i++)
+			silent = silent && buffer[i] == 0;
+		TS_ASSERT(silent);
+
+		// Without the effect, they add up again
+		mixer->setSoundTypeEffect(Audio::Mixer::kSFXSoundType, nullptr);
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(effect._calls, 2);
+
+		silent = true;
+		for (int i = 0; i < ARRAYSIZE(buffer); i++)
+			silent = silent && buffer[i] == 0;
+		TS_ASSERT(!silent);
+
+		delete mixer;
+	}
+
+	void test_histogram() {
+		Audio::MixerTimingStats::Histogram histogram;
+		static const uint64 values[] = { 0, 1, 3, 3, 100, 1000, 1000, 1000, 1000, 0xFFFFFFFFFFULL };
+		for (int i = 0; i < ARRAYSIZE(values); i++)
+			histogram.add(values[i]);
+
+		TS_ASSERT_EQUALS(histogram.count, 10u);
+		TS_ASSERT_EQUALS(histogram.max, 0xFFFFFFFFu);
+		TS_ASSERT_EQUALS(histogram.buckets[0], 1u);
+		TS_ASSERT_EQUALS(histogram.buckets[1], 1u);
+		TS_ASSERT_EQUALS(histogram.buckets[2], 2u);
+		TS_ASSERT_EQUALS(histogram.buckets[7], 1u);
+		TS_ASSERT_EQUALS(histogram.buckets[10], 4u);
+		TS_ASSERT_EQUALS(histogram.buckets[Audio::MixerTimingStats::kNumBuckets - 1], 1u);
+		TS_ASSERT_EQUALS(histogram.percentile(40), 4u);
+		TS_ASSERT_EQUALS(histogram.percentile(50), 128u);
+		TS_ASSERT_EQUALS(histogram.percentile(100), 0xFFFFFFFFu);
+	}
+
+	void test_timing_stats() {
+		int16 buffer[1024];
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		TS_ASSERT(!mixer->isTimingStatsEnabled());
+
+		play(mixer, Audio::Mixer::kMusicSoundType, createStream(22050, true, 10000, 0, 5));
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+
+		Audio::MixerTimingStats stats;
+		mixer->getTimingStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 0u);
+
+		mixer->enableTimingStats(true);
+		for (int i = 0; i < 5; i++)
+			mixer->mixCallback((byte *)buffer, sizeof(buffer));
+
+		mixer->getTimingStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 5u);
+		TS_ASSERT_EQUALS(stats.frames, 5u * ARRAYSIZE(buffer) / 2);
+		TS_ASSERT_EQUALS(stats.callback.count, 5u);
+		TS_ASSERT_EQUALS(stats.interval.count, 4u);
+		TS_ASSERT_EQUALS(stats.read[Audio::Mixer::kMusicSoundType].count, 5u);
+		TS_ASSERT_EQUALS(stats.mix[Audio::Mixer::kMusicSoundType].count, 5u);
+		TS_ASSERT_EQUALS(stats.read[Audio::Mixer::kSFXSoundType].count, 0u);
+
+		TS_ASSERT_EQUALS(stats.channels.size(), 1u);
+		TS_ASSERT_EQUALS(stats.channels[0].type, Audio::Mixer::kMusicSoundType);
+		TS_ASSERT_EQUALS(stats.channels[0].rate, 22050);
+		TS_ASSERT(stats.channels[0].stereo);
+		TS_ASSERT_EQUALS(stats.channels[0].calls, 5u);
+
+		TS_ASSERT(stats.dump().contains("\"callbacks\": 5,"));
+		TS_ASSERT(stats.toString().contains("5 callbacks"));
+
+		mixer->resetTimingStats();
+		mixer->getTimingStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 0u);
+		TS_ASSERT_EQUALS(stats.channels[0].calls, 0u);
+
+		mixer->enableTimingStats(false);
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		mixer->getTimingStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 0u);
+
+		delete mixer;
+	}
+
+	// The rendered WAV file has to contain the same samples as the mixer
+	// callback gives
+	void test_render() {
+		const uint numFrames = 3000;
+		int16 *expected = new int16[numFrames * 2];
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		play(mixer, Audio::Mixer::kPlainSoundType, createStream(22050, true, 2000, -4000, 3));
+		mixer->mixCallback((byte *)expected, numFrames * 2 * sizeof(int16));
+		delete mixer;
+
+		Common::MemoryWriteStreamDynamic output(DisposeAfterUse::YES);
+		mixer = createMixer(true);
+		play(mixer, Audio::Mixer::kPlainSoundType, createStream(22050, true, 2000, -4000, 3));
+		{
+			Audio::MixerRenderer renderer(mixer, &output, DisposeAfterUse::NO);
+			TS_ASSERT(renderer.render(1000));
+			TS_ASSERT(renderer.render(numFrames - 1000));
+			TS_ASSERT_EQUALS(renderer.getFramesRendered(), numFrames);
+			TS_ASSERT_EQUALS(renderer.getRenderedMillis(), numFrames * 1000 / 44100);
+			TS_ASSERT(renderer.finish());
+		}
+		delete mixer;
+
+		const byte *data = output.getData();
+		TS_ASSERT_EQUALS(output.size(), (int64)(44 + numFrames * 4));
+		TS_ASSERT_EQUALS(READ_BE_UINT32(data), MKTAG('R', 'I', 'F', 'F'));
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 4), 36 + numFrames * 4);
+		TS_ASSERT_EQUALS(READ_BE_UINT32(data + 8), MKTAG('W', 'A', 'V', 'E'));
+		TS_ASSERT_EQUALS(READ_LE_UINT16(data + 22), 2);
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 24), 44100u);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(data + 34), 16);
+		TS_ASSERT_EQUALS(READ_BE_UINT32(data + 36), MKTAG('d', 'a', 't', 'a'));
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 40), numFrames * 4);
+
+		for (uint i = 0; i < numFrames * 2; i++)
+			TS_ASSERT_EQUALS((int16)READ_LE_UINT16(data + 44 + i * 2), expected[i]);
+
+		delete[] expected;
+	}
+
+	void test_mixer_speed() {
+#if BENCHMARK_TIME
+		const uint seconds = benchmarkCount(5, 120);
+		const uint numFrames = 1024;
+		int16 *buffer = new int16[numFrames * 2];
+
+		// Fill all channels with a mix of rates, to use every conversion
+		Audio::MixerImpl *mixer = createMixer(true);
+		for (int i = 0; i < 32; i++) {
+			Audio::SeekableAudioStream *stream;
+			switch (i % 4) {
+			case 0:
+				stream = createStream(44100, true, 44100, -2000, i + 1);
+				break;
+			case 1:
+				stream = createStream(22050, false, 22050, -1000, i + 1);
+				break;
+			case 2:
+				stream = createStream(88200, true, 88200, 0, i + 1);
+				break;
+			default:
+				stream = createStream(11025, true, 11025, 1000, i + 1);
+				break;
+			}
+			play(mixer, Audio::Mixer::kPlainSoundType, Audio::makeLoopingAudioStream(stream, 0), 128, (i % 5) * 30 - 60);
+		}
+
+		const uint numCallbacks = seconds * 44100 / numFrames;
+		BenchmarkTimer timer;
+		for (uint i = 0; i < numCallbacks; i++)
+			mixer->mixCallback((byte *)buffer, numFrames * 2 * sizeof(int16));
+		const uint32 time = timer.stop();
+
+		debug("Mixer: 32 channels, %d frames in %d ms, %d frames/s, %d x realtime", numCallbacks * numFrames, time,
+		      timer.perSecond(numCallbacks * numFrames), timer.perSecond(numCallbacks * numFrames) / 44100);
+
+		delete mixer;
+		delete[] buffer;
+#endif
+	}
+};
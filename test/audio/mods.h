@@ -0,0 +1,195 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mods/mod_xm_s3m.h"
+#include "audio/mods/protracker.h"
+#include "common/crc.h"
+#include "common/debug.h"
+#include "common/memstream.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class ModsTestSuite : public CxxTest::TestSuite {
+	/**
+	 * Create a small four channel Protracker module, using looped and
+	 * unlooped samples and some of the common effects.
+	 */
+	static Common::SeekableReadStream *createModule() {
+		static const uint16 periods[] = { 856, 678, 570, 428, 339, 285, 214, 170, 143, 113 };
+		static const uint16 effects[] = { 0x000, 0x037, 0xA02, 0x444, 0x102, 0xC20 };
+		static const struct {
+			uint16 length, repeat, repeatLength;
+			byte volume;
+		} samples[] = {
+			{ 1024,   0, 1024, 64 },
+			{  750,   0,    1, 48 },
+			{   32,   0,   32, 40 },
+			{ 1500, 500, 1000, 56 }
+		};
+		const int numPatterns = 2;
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+
+		byte name[22];
+		memset(name, 0, sizeof(name));
+		out.write(name, 20);
+
+		for (int i = 0; i < 31; i++) {
+			out.write(name, 22);
+			if (i < ARRAYSIZE(samples)) {
+				out.writeUint16BE(samples[i].length);
+				out.writeByte(0);
+				out.writeByte(samples[i].volume);
+				out.writeUint16BE(samples[i].repeat);
+				out.writeUint16BE(samples[i].repeatLength);
+			} else {
+				out.writeUint16BE(0);
+				out.writeByte(0);
+				out.writeByte(0);
+				out.writeUint16BE(0);
+				out.writeUint16BE(1);
+			}
+		}
+
+		// Song length, restart position and the order list
+		out.writeByte(4);
+		out.writeByte(0);
+		for (int i = 0; i < 128; i++)
+			out.writeByte(i < 4 ? i % numPatterns : 0);
+		out.writeUint32BE(MKTAG('M', '.', 'K', '.'));
+
+		for (int pattern = 0; pattern < numPatterns; pattern++) {
+			for (int row = 0; row < 64; row++) {
+				for (int channel = 0; channel < 4; channel++) {
+					uint32 note = 0;
+					if ((row + channel * 2) % 4 == 0) {
+						const uint32 sample = (channel + row / 16) % ARRAYSIZE(samples) + 1;
+						const uint32 period = periods[(row / 4 + channel * 3 + pattern * 5) % ARRAYSIZE(periods)];
+						const uint32 effect = effects[(row / 4 + channel) % ARRAYSIZE(effects)];
+						note = ((sample & 0xf0) << 24) | (period << 16) | ((sample & 0x0f) << 12) | effect;
+					} else if (row == 1 && channel == 3) {
+						// Set speed
+						note = 0xF05;
+					}
+					out.writeUint32BE(note);
+				}
+			}
+		}
+
+		uint32 seed = 1;
+		for (int i = 0; i < ARRAYSIZE(samples); i++) {
+			for (int j = 0; j < samples[i].length * 2; j++) {
+				int8 value;
+				switch (i) {
+				case 0:
+					value = j * 4;
+					break;
+				case 1:
+					seed = seed * 1103515245 + 12345;
+					value = seed >> 24;
+					break;
+				case 2:
+					value = (int8)(sin(j * 2 * M_PI / 64) * 120);
+					break;
+				default:
+					value = (j & 0x100) ? 127 - (j & 0xff) : -128 + (j & 0xff);
+					break;
+				}
+				out.writeByte(value);
+			}
+		}
+
+		return new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES);
+	}
+
+	// Checksum of the samples in little endian byte order. The buffer is
+	// converted in place.
+	static uint32 checksum(int16 *buffer, int numSamples) {
+		for (int i = 0; i < numSamples; i++)
+			buffer[i] = (int16)TO_LE_16(buffer[i]);
+		return Common::CRC32().crcFast((const byte *)buffer, numSamples * sizeof(int16));
+	}
+
+	// Render in chunks of varying size, like the mixer does
+	static void render(Audio::AudioStream *stream, int16 *buffer, int numSamples) {
+		static const int chunkSizes[] = { 2048, 100, 4096, 2, 512, 1000 };
+		for (int i = 0, pos = 0; pos < numSamples; i = (i + 1) % ARRAYSIZE(chunkSizes)) {
+			const int count = stream->readBuffer(buffer + pos, MIN(chunkSizes[i], numSamples - pos));
+			if (count <= 0)
+				break;
+			pos += count;
+		}
+	}
+
+	static Audio::AudioStream *createStream(int player, Common::SeekableReadStream *module) {
+		switch (player) {
+		case 0:
+			return Audio::makeProtrackerStream(module, 0, 44100, true);
+		case 1:
+			return Audio::makeModXmS3mStream(module, DisposeAfterUse::NO, 0, 44100, 0);
+		default:
+			return Audio::makeModXmS3mStream(module, DisposeAfterUse::NO, 0, 44100, 1);
+		}
+	}
+
+public:
+	void setUp() {
+		// Paula uses the mutex of the mixer
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	// The checksums were recorded with the sample by sample mixing loops,
+	// to make sure the span based ones produce the same output.
+	void test_output() {
+		static const uint32 checksums[] = { 0x44684297u, 0xbd73b549u, 0xbd995474u };
+		const int numSamples = 44100 * 2 * 2;
+		int16 *buffer = new int16[numSamples];
+
+		for (int player = 0; player < ARRAYSIZE(checksums); player++) {
+			Common::SeekableReadStream *module = createModule();
+			Audio::AudioStream *stream = createStream(player, module);
+			TS_ASSERT(stream);
+
+			memset(buffer, 0, numSamples * sizeof(int16));
+			render(stream, buffer, numSamples);
+			TS_ASSERT_EQUALS(checksum(buffer, numSamples), checksums[player]);
+
+			delete stream;
+			delete module;
+		}
+
+		delete[] buffer;
+	}
+
+	void test_mods_speed() {
+#if BENCHMARK_TIME
+		static const char *const names[] = { "protracker", "modxms3m", "modxms3m interpolated" };
+		const int numSamples = benchmarkCount(44100 * 2, 44100 * 2 * 60);
+		int16 *buffer = new int16[numSamples];
+
+		for (int player = 0; player < ARRAYSIZE(names); player++) {
+			Common::SeekableReadStream *module = createModule();
+			Audio::AudioStream *stream = createStream(player, module);
+
+			BenchmarkTimer timer;
+			render(stream, buffer, numSamples);
+			const uint32 time = timer.stop();
+
+			debug("MOD %s: %d samples in %d ms, %d samples/s", names[player], numSamples, time, timer.perSecond(numSamples));
+
+			delete stream;
+			delete module;
+		}
+
+		delete[] buffer;
+#endif
+	}
+};
@@ -0,0 +1,191 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "audio/softsynth/opl/mame.h"
+#include "audio/softsynth/opl/nuked.h"
+#include "common/crc.h"
+#include "common/debug.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+// The emulators are driven through their cores here, since the OPL
+// classes need a running mixer.
+class OPLTestSuite : public CxxTest::TestSuite {
+	class Core {
+	public:
+		virtual ~Core() {}
+		virtual void writeReg(int reg, int val) = 0;
+		virtual void generate(int16 *buffer, int numFrames) = 0;
+	};
+
+#ifndef DISABLE_NUKED_OPL
+	class NukedCore : public Core {
+	public:
+		NukedCore(uint rate) { OPL::NUKED::OPL3_Reset(&_chip, rate); }
+		void writeReg(int reg, int val) override { OPL::NUKED::OPL3_WriteRegBuffered(&_chip, reg, val); }
+		void generate(int16 *buffer, int numFrames) override { OPL::NUKED::OPL3_GenerateStream(&_chip, buffer, numFrames); }
+
+	private:
+		OPL::NUKED::opl3_chip _chip;
+	};
+#endif
+
+#ifndef DISABLE_DOSBOX_OPL
+	class DOSBoxCore : public Core {
+	public:
+		DOSBoxCore(uint rate) {
+			OPL::DOSBox::DBOPL::InitTables();
+			_chip.Setup(rate);
+		}
+		void writeReg(int reg, int val) override { _chip.WriteReg(reg, val); }
+		void generate(int16 *buffer, int numFrames) override {
+			int32 tempBuffer[512 * 2];
+			while (numFrames > 0) {
+				const int count = MIN(numFrames, 512);
+				_chip.GenerateBlock3(count, tempBuffer);
+				for (int i = 0; i < count * 2; i++)
+					buffer[i] = CLIP<int32>(tempBuffer[i], -32768, 32767);
+				buffer += count * 2;
+				numFrames -= count;
+			}
+		}
+
+	private:
+		OPL::DOSBox::DBOPL::Chip _chip;
+	};
+#endif
+
+	class MAMECore : public Core {
+	public:
+		MAMECore(uint rate) : _opl(OPL::MAME::makeAdLibOPL(rate)) {}
+		~MAMECore() override { OPL::MAME::OPLDestroy(_opl); }
+		void writeReg(int reg, int val) override {
+			// OPL2 only
+			if (reg < 0x100)
+				OPL::MAME::OPLWriteReg(_opl, reg, val);
+		}
+		void generate(int16 *buffer, int numFrames) override {
+			// Mono output
+			OPL::MAME::YM3812UpdateOne(_opl, buffer, numFrames);
+		}
+
+	private:
+		OPL::MAME::FM_OPL *_opl;
+	};
+
+	static void setupVoices(Core *core) {
+		static const byte voice[][2] = {
+			{ 0x20, 0x21 }, { 0x23, 0x31 }, { 0x40, 0x1a }, { 0x43, 0x00 },
+			{ 0x60, 0xf2 }, { 0x63, 0xf5 }, { 0x80, 0x53 }, { 0x83, 0x74 },
+			{ 0xe0, 0x00 }, { 0xe3, 0x01 }, { 0xc0, 0x3a }
+		};
+		static const byte slotOffsets[9] = { 0, 1, 2, 8, 9, 10, 16, 17, 18 };
+
+		core->writeReg(0x01, 0x20);
+		core->writeReg(0x105, 0x01);
+
+		// Play a chord on all nine melodic channels of both banks, using
+		// the same instrument with slightly changed parameters
+		for (int bank = 0; bank < 2; bank++) {
+			for (int ch = 0; ch < 9; ch++) {
+				for (int i = 0; i < ARRAYSIZE(voice); i++) {
+					int reg = voice[i][0];
+					if (reg >= 0xc0)
+						reg += ch;
+					else
+						reg += slotOffsets[ch];
+					core->writeReg(bank * 0x100 + reg, voice[i][1] + ch);
+				}
+				core->writeReg(bank * 0x100 + 0xa0 + ch, 0x41 + ch * 23 + bank * 7);
+				core->writeReg(bank * 0x100 + 0xb0 + ch, 0x2d + (ch % 3) * 4);
+			}
+		}
+
+		// Enable vibrato/tremolo depth and rhythm mode with all drums
+		core->writeReg(0xbd, 0xff);
+	}
+
+	static void releaseVoices(Core *core) {
+		for (int bank = 0; bank < 2; bank++) {
+			for (int ch = 0; ch < 9; ch++)
+				core->writeReg(bank * 0x100 + 0xb0 + ch, 0x0d);
+		}
+		core->writeReg(0xbd, 0xc0);
+	}
+
+	// Checksum of the samples in little endian byte order. The buffer is
+	// converted in place.
+	static uint32 checksum(int16 *buffer, int numSamples) {
+		for (int i = 0; i < numSamples; i++)
+			buffer[i] = (int16)TO_LE_16(buffer[i]);
+		return Common::CRC32().crcFast((const byte *)buffer, numSamples * sizeof(int16));
+	}
+
+	static void benchmarkCore(const char *name, Core *core) {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(22050, 22050 * 60);
+		int16 *buffer = new int16[numFrames * 2];
+		setupVoices(core);
+
+		BenchmarkTimer timer;
+		core->generate(buffer, numFrames);
+		const uint32 time = timer.stop();
+
+		debug("OPL %s: %d samples in %d ms, %d samples/s", name, numFrames, time, timer.perSecond(numFrames));
+
+		delete[] buffer;
+#endif
+		delete core;
+	}
+
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+#ifndef DISABLE_NUKED_OPL
+	// Checks the Nuked OPL output against checksums recorded with the
+	// reference implementation, to make sure optimizations stay bit-exact.
+	void test_nuked_output() {
+		const int numFrames = 22050;
+		int16 *buffer = new int16[numFrames * 2];
+
+		NukedCore *core = new NukedCore(22050);
+		setupVoices(core);
+		core->generate(buffer, numFrames);
+		TS_ASSERT_EQUALS(checksum(buffer, numFrames * 2), 0x4f390104u);
+
+		// Let the notes decay in the release phase
+		releaseVoices(core);
+		core->generate(buffer, numFrames);
+		TS_ASSERT_EQUALS(checksum(buffer, numFrames * 2), 0xe7b0134fu);
+
+		// Render some more of the release phase
+		core->generate(buffer, numFrames);
+		TS_ASSERT_EQUALS(checksum(buffer, numFrames * 2), 0xfc2de1deu);
+
+		delete core;
+		delete[] buffer;
+	}
+#endif
+
+	void test_opl_speed() {
+		benchmarkCore("mame", new MAMECore(22050));
+#ifndef DISABLE_DOSBOX_OPL
+		benchmarkCore("db", new DOSBoxCore(22050));
+#endif
+#ifndef DISABLE_NUKED_OPL
+		benchmarkCore("nuked", new NukedCore(22050));
+#endif
+	}
+};
@@ -0,0 +1,132 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/soundfont/rawfile.h"
+#include "audio/soundfont/sf2file.h"
+#include "audio/soundfont/sf2stream.h"
+#include "audio/soundfont/synthfile.h"
+#include "audio/soundfont/vgmsamp.h"
+
+class SoundFontTestSuite : public CxxTest::TestSuite {
+	// Sample producing a pattern instead of decoding data
+	class TestSamp : public VGMSamp {
+	public:
+		TestSamp(VGMSampColl *sampColl, uint32 numSamples, uint16 bps, int seed) :
+				VGMSamp(sampColl, 0, 0, 0, numSamples * bps / 8, 1, bps, 22050), _seed(seed) {
+			_ulUncompressedSize = _dataLength;
+		}
+
+		void ConvertToStdWave(uint8 *buf) override {
+			for (uint32 i = 0; i < _ulUncompressedSize; i++)
+				buf[i] = (uint8)(i * 7 + _seed * 31 + (i >> 5));
+		}
+
+	private:
+		int _seed;
+	};
+
+	static const int kNumWaves = 5;
+
+	static SynthFile *createSynthFile(Common::Array<VGMSamp *> &samps, bool lazy) {
+		SynthFile *synthfile = new SynthFile("Test");
+		for (uint32 i = 0; i < samps.size(); i++) {
+			VGMSamp *samp = samps[i];
+			uint8 *data = nullptr;
+			if (!lazy) {
+				data = new uint8[samp->_ulUncompressedSize];
+				samp->ConvertToStdWave(data);
+			}
+
+			const uint16 blockAlign = samp->_bps / 8;
+			SynthWave *wave = synthfile->AddWave(1, 1, samp->_rate, samp->_rate * blockAlign, blockAlign,
+												 samp->_bps, samp->_ulUncompressedSize, data, "Wave");
+			if (lazy)
+				wave->SetSource(samp);
+			wave->AddSampInfo();
+
+			SynthInstr *instr = synthfile->AddInstr(0, i);
+			SynthRgn *rgn = instr->AddRgn();
+			rgn->SetRanges();
+			rgn->SetWaveLinkInfo(0, 0, 1, i);
+			rgn->AddSampInfo();
+			rgn->AddArt();
+		}
+		return synthfile;
+	}
+
+	static SF2File *createSF2File(Common::Array<VGMSamp *> &samps, bool lazy) {
+		SynthFile *synthfile = createSynthFile(samps, lazy);
+		SF2File *file = new SF2File(synthfile, lazy);
+		delete synthfile;
+		return file;
+	}
+
+	// Read the whole stream in chunks of the given sizes
+	static bool compareStream(Common::SeekableReadStream *stream, const uint8 *expected, uint32 size, const uint32 *chunkSizes, int numChunkSizes) {
+		uint8 *buffer = new uint8[size + 16];
+		uint32 pos = 0;
+		stream->seek(0);
+		for (int i = 0; !stream->eos(); i = (i + 1) % numChunkSizes)
+			pos += stream->read(buffer + pos, MIN(chunkSizes[i], size + 16 - pos));
+
+		const bool result = pos == size && !memcmp(buffer, expected, size);
+		delete[] buffer;
+		return result;
+	}
+
+public:
+	void test_lazy_samples() {
+		byte *rawData = (byte *)malloc(16);
+		memset(rawData, 0, 16);
+		RawFile *rawFile = new MemFile(rawData, 16);
+		VGMSampColl *sampColl = new VGMSampColl(rawFile, 0u, 16u);
+
+		Common::Array<VGMSamp *> samps;
+		for (int i = 0; i < kNumWaves; i++) {
+			TestSamp *samp = new TestSamp(sampColl, 1000 + i * 700, i == 2 ? 8 : 16, i);
+			sampColl->_samples.push_back(samp);
+			samps.push_back(samp);
+		}
+
+		// The SoundFont with lazy samples must be identical to the regular one
+		SF2File *file = createSF2File(samps, false);
+		const uint32 size = file->GetSize();
+		const uint8 *expected = (const uint8 *)file->SaveToMem();
+		delete file;
+
+		file = createSF2File(samps, true);
+		TS_ASSERT(file->GetSampleChunk()->IsLazy());
+		TS_ASSERT_EQUALS(file->GetSize(), size);
+		const uint8 *saved = (const uint8 *)file->SaveToMem();
+		TS_ASSERT(!memcmp(saved, expected, size));
+		delete[] saved;
+
+		// Reading whole waves does not use the cache, reading them in parts
+		// keeps it within its size
+		const uint32 cacheSize = 8000;
+		SF2SampleStream *stream = new SF2SampleStream(file, cacheSize);
+		TS_ASSERT_EQUALS(stream->size(), size);
+
+		static const uint32 bigChunks[] = { 1024 * 1024 };
+		TS_ASSERT(compareStream(stream, expected, size, bigChunks, ARRAYSIZE(bigChunks)));
+		TS_ASSERT_EQUALS(stream->getStats().residentBytes, 0u);
+		TS_ASSERT_EQUALS(stream->getStats().decodes, (uint32)kNumWaves);
+
+		static const uint32 smallChunks[] = { 100, 3, 1000, 4096, 17 };
+		TS_ASSERT(compareStream(stream, expected, size, smallChunks, ARRAYSIZE(smallChunks)));
+		TS_ASSERT_LESS_THAN_EQUALS(stream->getStats().peakResidentBytes, cacheSize);
+		TS_ASSERT(stream->getStats().hits > 0);
+		TS_ASSERT(stream->getStats().evictions > 0);
+
+		// Reading a wave somewhere in the middle
+		const uint32 offset = file->GetHeaderSize() + file->GetSampleChunk()->GetWaveOffset(3) + 10;
+		uint8 buffer[64];
+		TS_ASSERT(stream->seek(offset));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		TS_ASSERT(!memcmp(buffer, expected + offset, sizeof(buffer)));
+
+		stream->setSourceFiles(nullptr, rawFile);
+		delete stream;
+		delete sampColl;
+		delete[] expected;
+	}
+};
@@ -0,0 +1,45 @@
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+// Note that "common/util.h" would be test/common/util.h from here
+#include "common/system.h"
+
+/**
+ * Number of iterations of a speed test. Builds with SLOW_TESTS use the
+ * larger count for more stable numbers.
+ */
+inline int benchmarkCount(int count, int slowCount) {
+#ifdef SLOW_TESTS
+	return slowCount;
+#else
+	return count;
+#endif
+}
+
+/**
+ * Measures the time of a speed test, from its construction until stop().
+ * This needs g_system, so only use it if BENCHMARK_TIME is set.
+ */
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() : _start(g_system->getMillis()), _time(1) {}
+
+	/** Stop the timer and return the time in ms, which is at least 1. */
+	uint32 stop() {
+		_time = g_system->getMillis() - _start;
+		if (!_time)
+			_time = 1;
+		return _time;
+	}
+
+	/** The number of operations per second, for count operations until stop(). */
+	int perSecond(uint64 count) const {
+		return (int)(count * 1000 / _time);
+	}
+
+private:
+	uint32 _start;
+	uint32 _time;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/arena.h"
+
+class ArenaTestSuite : public CxxTest::TestSuite {
+public:
+	void test_alignment() {
+		Common::Arena arena(256, 4);
+
+		for (uint i = 0; i < 64; i++) {
+			arena.allocate(1 + (i % 7));
+			TS_ASSERT_EQUALS((size_t)arena.allocate(3) % 4, 0U);
+			TS_ASSERT_EQUALS((size_t)arena.allocate(5, 16) % 16, 0U);
+			TS_ASSERT_EQUALS((size_t)arena.allocArray<uint64>(2) % alignof(uint64), 0U);
+		}
+	}
+
+	void test_reset_reuses_pages() {
+		Common::Arena arena(128);
+
+		for (uint frame = 0; frame < 4; frame++) {
+			for (uint i = 0; i < 20; i++) {
+				byte *ptr = (byte *)arena.allocate(30);
+				memset(ptr, i, 30);
+			}
+			arena.reset();
+		}
+
+		const Common::Arena::Stats &stats = arena.getStats();
+		TS_ASSERT_EQUALS(stats.numAllocations, 80U);
+		TS_ASSERT_EQUALS(stats.numResets, 4U);
+		TS_ASSERT_EQUALS(stats.bytesInUse, 0U);
+		// Only the first frame had to obtain pages from the heap
+		TS_ASSERT_EQUALS(stats.bytesReserved, stats.numPageAllocs * 128U);
+		TS_ASSERT_LESS_THAN(stats.numPageAllocs, 20U);
+		TS_ASSERT_LESS_THAN_EQUALS(stats.bytesReserved, stats.peakBytesInUse + 128U);
+	}
+
+	void test_oversized() {
+		Common::Arena arena(64);
+
+		byte *small = (byte *)arena.allocate(16);
+		byte *big = (byte *)arena.allocate(1000);
+		memset(big, 0xAB, 1000);
+		byte *after = (byte *)arena.allocate(16);
+
+		TS_ASSERT(small != big);
+		TS_ASSERT(after < big || after >= big + 1000);
+		TS_ASSERT_EQUALS(big[999], 0xAB);
+		TS_ASSERT_EQUALS(arena.getStats().numPageAllocs, 3U);
+	}
+
+	void test_scope() {
+		Common::Arena arena(64);
+
+		arena.allocate(8);
+		size_t before = arena.getStats().bytesInUse;
+		void *first;
+		{
+			Common::ArenaScope scope(arena);
+			first = arena.allocate(40);
+			arena.allocate(40);
+			arena.allocate(40);
+			TS_ASSERT_LESS_THAN(before, arena.getStats().bytesInUse);
+		}
+		TS_ASSERT_EQUALS(arena.getStats().bytesInUse, before);
+		TS_ASSERT_EQUALS(arena.allocate(40), first);
+
+		arena.reset();
+		arena.freeUnusedPages();
+		TS_ASSERT_EQUALS(arena.getStats().bytesReserved, 0U);
+	}
+
+	void test_objects() {
+		struct Point {
+			Point(int x_, int y_) : x(x_), y(y_) {}
+			int x, y;
+		};
+
+		Common::Arena arena;
+		Point *p = arena.newObject<Point>(3, 4);
+		TS_ASSERT_EQUALS(p->x, 3);
+		TS_ASSERT_EQUALS(p->y, 4);
+
+		char *str = arena.copyString("arena");
+		TS_ASSERT_EQUALS(strcmp(str, "arena"), 0);
+
+		Common::ArenaAllocator<uint16> alloc(arena);
+		Common::ArenaAllocator<uint32> alloc2(alloc);
+		TS_ASSERT(alloc == alloc2);
+		uint32 *values = alloc2.allocate(10);
+		for (uint i = 0; i < 10; i++)
+			values[i] = i * i;
+		TS_ASSERT_EQUALS(values[9], 81U);
+	}
+};
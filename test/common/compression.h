@@ -0,0 +1,152 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/crc.h"
+#include "common/system.h"
+#include "common/debug.h"
+#include "common/compression/deflate.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+namespace {
+
+const char *const testWords[] = {
+	"the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "scumm",
+	"engine", "room", "actor", "verb", "script", "palette", "sound", "music", "costume"
+};
+
+// Generates the text which has been compressed into testZlibData
+void generateTestText(byte *dst, uint32 size) {
+	uint32 seed = 1;
+	uint32 pos = 0;
+	while (pos < size) {
+		seed = seed * 1103515245 + 12345;
+		const char *word = testWords[(seed >> 16) % ARRAYSIZE(testWords)];
+		for (const char *c = word; *c && pos < size; c++)
+			dst[pos++] = *c;
+		if (pos < size)
+			dst[pos++] = ' ';
+	}
+}
+
+const uint32 testTextSize = 4096;
+const uint32 testTextCRC = 0x601894f4;
+
+// zlib stream (level 9, dynamic Huffman codes) of generateTestText(4096)
+const byte testZlibData[] = {
+	0x78, 0xda, 0x6d, 0x57, 0xd9, 0x62, 0xdb, 0x30, 0x0c, 0xfb, 0x15, 0xff, 0x5a, 0x9a, 0x7a, 0x5d,
+	0xb6, 0x26, 0x4e, 0x73, 0xec, 0xfa, 0xfa, 0x85, 0x80, 0x28, 0x02, 0xb2, 0x1e, 0x62, 0x5b, 0x12,
+	0xc5, 0x9b, 0x20, 0x73, 0x3f, 0x3e, 0xcf, 0xe7, 0xe5, 0xf3, 0xf0, 0xef, 0xef, 0x72, 0xdf, 0x9e,
+	0x97, 0xf7, 0x65, 0xbd, 0x7c, 0x9c, 0x2e, 0x6b, 0xbe, 0xbe, 0x9e, 0xa7, 0xe3, 0xcf, 0xe5, 0x7a,
+	0xf8, 0x5c, 0x1f, 0x8f, 0x75, 0x39, 0x1c, 0x1f, 0xdb, 0x6d, 0x79, 0xbb, 0x6d, 0xbf, 0x2f, 0xcb,
+	0xe3, 0xfb, 0xba, 0xdc, 0x8f, 0xb7, 0xd3, 0xf5, 0xb1, 0x6c, 0xbf, 0xd6, 0xdb, 0xf2, 0xfa, 0xbd,
+	0xbd, 0x36, 0x82, 0x1b, 0xd6, 0xbc, 0x89, 0x4f, 0x3c, 0x8e, 0xdb, 0xfd, 0xf1, 0x3c, 0xaf, 0x9d,
+	0xd7, 0x6d, 0xdb, 0xce, 0x60, 0x42, 0xa6, 0x26, 0x1c, 0xbc, 0xbe, 0x6d, 0x7f, 0x52, 0x00, 0x68,
+	0x7f, 0x3c, 0xcf, 0xd7, 0x7b, 0x7b, 0x92, 0xf9, 0xf9, 0x79, 0x3f, 0x1d, 0xdb, 0x93, 0x3b, 0x4a,
+	0x4f, 0x8e, 0x29, 0x16, 0x16, 0x62, 0x3f, 0x15, 0x68, 0xb2, 0x42, 0x8c, 0x5b, 0x99, 0x57, 0xb8,
+	0x8b, 0x3b, 0x34, 0x0e, 0x0c, 0x45, 0x97, 0xf7, 0xed, 0xa3, 0x5f, 0xe2, 0x0e, 0xed, 0x77, 0xc9,
+	0x4d, 0x4e, 0x10, 0x37, 0xf5, 0xda, 0x6b, 0xb8, 0x8a, 0x4b, 0xf4, 0x6d, 0x5e, 0x85, 0xe3, 0x78,
+	0x0c, 0x0d, 0xf8, 0x09, 0x0d, 0xca, 0x1e, 0x7c, 0xe1, 0x61, 0x3e, 0x70, 0x4e, 0x5c, 0xa9, 0x7b,
+	0xc5, 0x24, 0xf1, 0xc4, 0x2c, 0xd2, 0x64, 0xcb, 0x1d, 0xb9, 0xd5, 0xe4, 0xd0, 0xfd, 0x2e, 0x87,
+	0x04, 0x11, 0xdc, 0xc6, 0x1a, 0xea, 0x29, 0x4f, 0x7e, 0xa7, 0x34, 0x63, 0x05, 0xa3, 0xda, 0x3d,
+	0x55, 0x00, 0x3c, 0x42, 0x47, 0x0d, 0x3b, 0x3d, 0x82, 0xa3, 0x54, 0x41, 0xf3, 0x84, 0xf1, 0x88,
+	0x4b, 0x79, 0xaa, 0x11, 0x8a, 0x90, 0xe0, 0xaa, 0xe7, 0xbc, 0x72, 0x4e, 0x0d, 0xf3, 0x2d, 0x11,
+	0x21, 0x19, 0x39, 0xa5, 0x34, 0x98, 0x61, 0xa5, 0x43, 0x43, 0xc3, 0x15, 0xa1, 0x45, 0xbc, 0x43,
+	0x6a, 0x23, 0x01, 0x37, 0x52, 0x90, 0xba, 0xed, 0x37, 0x46, 0xdc, 0x8b, 0x3b, 0xfc, 0x0a, 0x0e,
+	0x71, 0x9b, 0x2b, 0x4b, 0x92, 0x38, 0x92, 0xb0, 0x4a, 0x19, 0x60, 0xc3, 0x53, 0x8d, 0xd5, 0x0e,
+	0x47, 0x04, 0xbb, 0x21, 0x51, 0x7b, 0x92, 0xc6, 0xb9, 0x19, 0x36, 0x96, 0x30, 0x49, 0xfa, 0xca,
+	0xb2, 0x3e, 0x18, 0xc7, 0x8f, 0x0c, 0x72, 0x17, 0xca, 0xa8, 0xc1, 0xbd, 0xd2, 0xcb, 0x42, 0xd8,
+	0x23, 0xe8, 0x02, 0x92, 0xa6, 0x9b, 0x81, 0x47, 0x32, 0x25, 0x50, 0x84, 0x2a, 0xfb, 0xac, 0xcd,
+	0x92, 0x28, 0x5b, 0x3c, 0xf3, 0x0c, 0x11, 0x48, 0x10, 0xec, 0xc6, 0x34, 0x83, 0x4e, 0x70, 0x1b,
+	0xd7, 0x14, 0x31, 0x0a, 0xee, 0x39, 0x06, 0x4f, 0x24, 0xd7, 0x8a, 0x5f, 0xc5, 0xa3, 0xee, 0x4b,
+	0x65, 0xc4, 0x92, 0x5f, 0x3d, 0x31, 0x05, 0x54, 0xbb, 0x6b, 0x2a, 0xcc, 0x20, 0x09, 0x5a, 0xb5,
+	0xd8, 0xa3, 0x08, 0x92, 0xd0, 0x80, 0x24, 0x60, 0xa0, 0x89, 0x6b, 0xd0, 0xac, 0x89, 0xaf, 0x29,
+	0x54, 0xb1, 0x91, 0x4b, 0x69, 0x1e, 0x34, 0x71, 0x0e, 0x56, 0xce, 0x93, 0xda, 0x6c, 0xe7, 0xb4,
+	0x95, 0xcf, 0xa6, 0x35, 0xcf, 0x1b, 0x88, 0x68, 0x11, 0x54, 0x19, 0x91, 0x24, 0x0b, 0xc9, 0x20,
+	0x8f, 0x47, 0x82, 0xb7, 0xc8, 0x22, 0x2d, 0x50, 0x7c, 0x4b, 0x30, 0xa0, 0xdc, 0x44, 0x28, 0xc5,
+	0x49, 0x1b, 0x69, 0xb0, 0x61, 0x05, 0x1e, 0xdc, 0xe1, 0x0a, 0xd3, 0x34, 0xfd, 0x22, 0xf9, 0xad,
+	0x98, 0x23, 0xbd, 0x51, 0x84, 0x50, 0x05, 0x9c, 0x89, 0xfa, 0x38, 0xd2, 0xf6, 0x38, 0x29, 0xa3,
+	0xdc, 0xca, 0x37, 0xee, 0xa4, 0xed, 0x09, 0x3b, 0x42, 0x5f, 0x2e, 0x71, 0x63, 0x46, 0x07, 0x83,
+	0x0f, 0x14, 0x1a, 0xb3, 0x56, 0x1d, 0xaa, 0x89, 0x57, 0x63, 0x81, 0xbb, 0x60, 0xd2, 0xd2, 0x9a,
+	0xe8, 0x0c, 0x62, 0xfe, 0x48, 0x69, 0x25, 0x59, 0x10, 0x82, 0x6d, 0x6f, 0x36, 0xd4, 0x04, 0x31,
+	0x74, 0x91, 0xd6, 0x02, 0x43, 0x8a, 0x84, 0x61, 0x5f, 0xec, 0x32, 0xfc, 0xec, 0xea, 0x03, 0x17,
+	0x5d, 0xea, 0x34, 0xd7, 0x2b, 0x17, 0xf7, 0xb8, 0x33, 0xa0, 0xa7, 0x22, 0x88, 0xe1, 0x58, 0x55,
+	0x7c, 0x87, 0xf4, 0xf9, 0x0c, 0xe4, 0x63, 0x44, 0xf5, 0x32, 0x8d, 0x4f, 0xc2, 0x40, 0x3f, 0xb4,
+	0x4a, 0xf7, 0x74, 0xea, 0x29, 0xb2, 0x33, 0xc6, 0xa2, 0xd6, 0x32, 0x51, 0x6b, 0xad, 0x03, 0x15,
+	0x2d, 0xa5, 0x02, 0xd6, 0x2b, 0x73, 0x21, 0xf8, 0xa3, 0xc3, 0x5b, 0x75, 0x21, 0x99, 0xae, 0x64,
+	0x98, 0xe9, 0xf1, 0xd1, 0xe1, 0x44, 0x02, 0x66, 0x91, 0xd6, 0xf2, 0x2e, 0x6c, 0xa6, 0xa0, 0xec,
+	0xbe, 0x02, 0x4a, 0x02, 0xed, 0x3a, 0x21, 0x48, 0xbe, 0x28, 0x6f, 0xf0, 0xb2, 0xdc, 0x54, 0xf7,
+	0xc5, 0xa5, 0xd9, 0x74, 0xa9, 0xfd, 0xd5, 0xe7, 0x4a, 0x05, 0x05, 0x99, 0x94, 0x20, 0xd9, 0xf1,
+	0x7f, 0xd6, 0x5c, 0x72, 0xc5, 0x33, 0x19, 0x9c, 0xba, 0x39, 0x89, 0x01, 0x02, 0x22, 0x24, 0x13,
+	0x1c, 0xa8, 0x69, 0xbd, 0x8b, 0x8d, 0x9f, 0xf8, 0x48, 0x21, 0x08, 0xd4, 0x32, 0x87, 0xf6, 0x46,
+	0x3d, 0x1b, 0x01, 0x6b, 0x2a, 0xd5, 0x46, 0x66, 0x73, 0x2f, 0x09, 0xab, 0x15, 0x0e, 0x76, 0xb6,
+	0xda, 0xe9, 0x2a, 0xca, 0x00, 0x2d, 0xb5, 0xd0, 0xdc, 0xd6, 0x61, 0x4f, 0xea, 0x78, 0x98, 0x19,
+	0xc8, 0x5e, 0x2a, 0x7c, 0x3e, 0xf7, 0xf8, 0x6a, 0xde, 0xd2, 0xa5, 0x2c, 0xa5, 0x99, 0xcc, 0x8a,
+	0xb3, 0x10, 0x54, 0x86, 0xec, 0xd1, 0xbf, 0xfb, 0x7f, 0x13, 0xdd, 0x9c, 0x5e, 0x9a, 0x66, 0xad,
+	0x81, 0x7d, 0x8d, 0x07, 0x54, 0x92, 0xdc, 0x6b, 0xea, 0x98, 0x14, 0x65, 0xef, 0x5c, 0x56, 0x51,
+	0xe0, 0x56, 0x68, 0x8f, 0x3d, 0x43, 0x8d, 0xc2, 0x98, 0x0a, 0x97, 0x0d, 0xbb, 0xb3, 0xf1, 0xd5,
+	0x3d, 0x28, 0x08, 0x23, 0x08, 0x68, 0x52, 0x0c, 0x66, 0x66, 0x50, 0x27, 0x75, 0x5b, 0xd9, 0x27,
+	0xed, 0x41, 0x33, 0xc7, 0x6a, 0xd8, 0x10, 0x5b, 0x5a, 0x82, 0x49, 0xa4, 0xd6, 0x32, 0x28, 0x0b,
+	0x1a, 0x75, 0xfb, 0xc6, 0x71, 0xb2, 0x92, 0xd6, 0xb2, 0x46, 0x22, 0xa7, 0xf8, 0x65, 0x7f, 0xc6,
+	0xf6, 0xec, 0xab, 0xe7, 0xc5, 0x25, 0x12, 0x57, 0x6a, 0x53, 0xa0, 0x54, 0xa0, 0xfe, 0x83, 0xa9,
+	0xbf, 0xdb, 0x82, 0xd8, 0x35, 0x31, 0x8d, 0x83, 0xdc, 0xcb, 0x21, 0xff, 0x01, 0xc7, 0x23, 0xff,
+	0xbf,
+};
+
+} // End of anonymous namespace
+
+class CompressionTestSuite : public CxxTest::TestSuite {
+public:
+	void test_inflate_zlib() {
+		byte expected[testTextSize];
+		generateTestText(expected, testTextSize);
+
+		byte *out = new byte[testTextSize];
+		unsigned long outLen = testTextSize;
+		TS_ASSERT(Common::inflateZlib(out, &outLen, testZlibData, sizeof(testZlibData)));
+		TS_ASSERT_EQUALS(outLen, testTextSize);
+		TS_ASSERT_EQUALS(memcmp(out, expected, testTextSize), 0);
+
+		Common::CRC32 crc;
+		TS_ASSERT_EQUALS(crc.crcFast(out, outLen), testTextCRC);
+
+		delete[] out;
+	}
+
+	void test_inflate_speed() {
+#if BENCHMARK_TIME
+		if (!g_system)
+			Common::install_null_g_system();
+
+		const int iters = benchmarkCount(1, 20000);
+		byte *out = new byte[testTextSize];
+		Common::CRC32 crc;
+
+		BenchmarkTimer inflateTimer;
+		for (int i = 0; i < iters; i++) {
+			unsigned long outLen = testTextSize;
+			Common::inflateZlib(out, &outLen, testZlibData, sizeof(testZlibData));
+		}
+		const uint32 inflateTime = inflateTimer.stop();
+
+		uint32 result = 0;
+		BenchmarkTimer crcTimer;
+		for (int i = 0; i < iters; i++)
+			result ^= crc.crcFast(out, testTextSize);
+		const uint32 crcTime = crcTimer.stop();
+
+		TS_ASSERT_EQUALS(crc.crcFast(out, testTextSize), testTextCRC);
+
+		debug("inflateZlib: %d iters of %u bytes in %u ms, %d bytes/s", iters, testTextSize, inflateTime, inflateTimer.perSecond((uint64)iters * testTextSize));
+		debug("CRC32::crcFast: %d iters of %u bytes in %u ms, %d bytes/s", iters, testTextSize, crcTime, crcTimer.perSecond((uint64)iters * testTextSize));
+
+		delete[] out;
+#endif
+	}
+};
@@ -21,6 +21,29 @@ public:
 		TS_ASSERT_EQUALS(crc.finalize(running), 0x414fa339U);
 	}
 
+	void test_crc32_slicing() {
+		byte data[300];
+		for (int i = 0; i < 300; i++)
+			data[i] = (byte)(i * 37 + (i >> 3));
+
+		// Compare against the byte-wise implementation, for all
+		// alignments and lengths not divisible by the slice size
+		Common::CRC32 crc;
+		for (int start = 0; start < 8; start++) {
+			for (int len = 0; len < 300 - start; len += 13) {
+				uint32 running = crc.getInitRemainder();
+				for (int i = 0; i < len; i++)
+					running = crc.processByte(data[start + i], running);
+
+				TS_ASSERT_EQUALS(crc.crcFast(data + start, len), crc.finalize(running));
+			}
+		}
+
+		uint32 running = crc.processBlock(testStringCRC, 10, crc.getInitRemainder());
+		running = crc.processBlock(testStringCRC + 10, testLenCRC - 10, running);
+		TS_ASSERT_EQUALS(crc.finalize(running), 0x414fa339U);
+	}
+
 	void test_crc16() {
 		Common::CRC16 crc;
 		TS_ASSERT_EQUALS(crc.crcFast(testStringCRC, testLenCRC), 0xfcdfU);
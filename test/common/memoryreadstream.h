@@ -1,5 +1,6 @@
 #include <cxxtest/TestSuite.h>
 
+#include "common/archive.h"
 #include "common/memstream.h"
 
 class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
@@ -105,3 +106,52 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT(!ms.eos());
 	}
 };
+
+class SharedMemoryReadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_slice() {
+		byte *contents = new byte[10];
+		for (int i = 0; i < 10; i++)
+			contents[i] = i;
+		Common::SharedPtr<byte> buffer(contents, Common::ArrayDeleter<byte>());
+
+		Common::MemoryReadStream first(buffer, 2, 3);
+		Common::MemoryReadStream second(buffer, 4, 6);
+		TS_ASSERT_EQUALS(buffer.refCount(), 3);
+
+		TS_ASSERT_EQUALS(first.size(), 3);
+		TS_ASSERT_EQUALS(first.readByte(), 2);
+		first.seek(-1, SEEK_END);
+		TS_ASSERT_EQUALS(first.readByte(), 4);
+		first.readByte();
+		TS_ASSERT(first.eos());
+
+		TS_ASSERT_EQUALS(second.size(), 6);
+		second.seek(5);
+		TS_ASSERT_EQUALS(second.readByte(), 9);
+	}
+
+	void test_archive_contents_slice() {
+		byte *contents = new byte[10];
+		for (int i = 0; i < 10; i++)
+			contents[i] = i * 2;
+
+		Common::SharedArchiveContents whole(contents, 10);
+		Common::SharedArchiveContents member = whole.slice(3, 5);
+		Common::SharedArchiveContents nested = member.slice(1, 2);
+
+		Common::SeekableReadStream *stream = nested.createReadStream();
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 2);
+		TS_ASSERT_EQUALS(stream->readByte(), 8);
+		TS_ASSERT_EQUALS(stream->readByte(), 10);
+		delete stream;
+
+		stream = member.createReadStream();
+		TS_ASSERT_EQUALS(stream->size(), 5);
+		TS_ASSERT_EQUALS(stream->readByte(), 6);
+		delete stream;
+
+		TS_ASSERT(!Common::SharedArchiveContents().createReadStream());
+	}
+};
@@ -0,0 +1,152 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/bufferedstream.h"
+#include "common/system.h"
+
+#include "backends/timer/default/default-timer.h"
+
+#include "../null_osystem.h"
+
+class ReadAheadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void setUp() {
+		// The stream uses a mutex, which needs a backend
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	// Wait for the timer callbacks to be due, and run them. The test
+	// backend has no thread of its own which would do that.
+	static void runTimers() {
+		g_system->delayMillis(11);
+		((DefaultTimerManager *)g_system->getTimerManager())->handler();
+	}
+
+	void test_background_prefetch() {
+		const uint32 blockSize = 32 * 1024;
+		const uint32 size = blockSize * 8;
+		byte *contents = new byte[size];
+		for (uint32 i = 0; i < size; ++i)
+			contents[i] = i * 7;
+		Common::MemoryReadStream ms(contents, size);
+
+		Common::ReadAheadStream *stream = Common::wrapReadAheadStream(&ms, blockSize, 5, DisposeAfterUse::NO, true);
+
+		// The first block is read right away
+		byte *buf = new byte[size];
+		TS_ASSERT_EQUALS(stream->read(buf, 1), 1U);
+		Common::ReadAheadStream::Stats stats = stream->getStats();
+		TS_ASSERT_EQUALS(stats.stalls, 1U);
+		TS_ASSERT_EQUALS(stats.prefetches, 0U);
+
+		// A tick stops after 64 KB, so filling the other four blocks of
+		// the window takes two of them
+		runTimers();
+		TS_ASSERT_EQUALS(stream->getStats().prefetches, 2U);
+		runTimers();
+		TS_ASSERT_EQUALS(stream->getStats().prefetches, 4U);
+		runTimers();
+		TS_ASSERT_EQUALS(stream->getStats().prefetches, 4U);
+
+		// Reading the window only hits prefetched blocks
+		TS_ASSERT_EQUALS(stream->read(buf + 1, blockSize * 5 - 1), blockSize * 5 - 1);
+		stats = stream->getStats();
+		TS_ASSERT_EQUALS(stats.stalls, 1U);
+		TS_ASSERT_EQUALS(stats.hits, 5U);
+
+		// The following blocks are prefetched after the read position
+		// has moved on
+		runTimers();
+		runTimers();
+		TS_ASSERT_EQUALS(stream->read(buf + blockSize * 5, size), blockSize * 3);
+		stats = stream->getStats();
+		TS_ASSERT_EQUALS(stats.stalls, 1U);
+		TS_ASSERT_EQUALS(stats.hits, 8U);
+		TS_ASSERT_EQUALS(stats.prefetches, 7U);
+		TS_ASSERT_EQUALS(stats.discards, 0U);
+		TS_ASSERT_EQUALS(memcmp(buf, contents, size), 0);
+
+		delete stream;
+		delete[] buf;
+		delete[] contents;
+	}
+
+	void test_traverse() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::ReadAheadStream *stream = Common::wrapReadAheadStream(&ms, 4, 2, DisposeAfterUse::NO, false);
+
+		byte i, b;
+		for (i = 0; i < 10; ++i) {
+			TS_ASSERT(!stream->eos());
+			TS_ASSERT_EQUALS(i, stream->pos());
+
+			stream->read(&b, 1);
+			TS_ASSERT_EQUALS(i, b);
+		}
+
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS((uint)0, stream->read(&b, 1));
+		TS_ASSERT(stream->eos());
+
+		Common::ReadAheadStream::Stats stats = stream->getStats();
+		TS_ASSERT_EQUALS(stats.stalls, 3U);
+		TS_ASSERT_EQUALS(stats.hits, 7U);
+
+		delete stream;
+	}
+
+	void test_read_across_blocks() {
+		byte contents[20];
+		for (int i = 0; i < 20; ++i)
+			contents[i] = i * 3;
+		Common::MemoryReadStream ms(contents, 20);
+
+		Common::ReadAheadStream *stream = Common::wrapReadAheadStream(&ms, 3, 4, DisposeAfterUse::NO, false);
+
+		byte buf[20];
+		TS_ASSERT_EQUALS(stream->read(buf, 11), 11U);
+		TS_ASSERT_EQUALS(memcmp(buf, contents, 11), 0);
+		TS_ASSERT_EQUALS(stream->pos(), 11);
+
+		TS_ASSERT_EQUALS(stream->read(buf, 20), 9U);
+		TS_ASSERT_EQUALS(memcmp(buf, contents + 11, 9), 0);
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+	}
+
+	void test_seek() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::ReadAheadStream *stream = Common::wrapReadAheadStream(&ms, 4, 2, DisposeAfterUse::NO, false);
+		byte b;
+
+		TS_ASSERT(stream->seek(8));
+		TS_ASSERT_EQUALS(stream->readByte(), 8);
+
+		TS_ASSERT(stream->seek(-3, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), 6);
+
+		TS_ASSERT(stream->seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(stream->readByte(), 9);
+		TS_ASSERT_EQUALS((uint)0, stream->read(&b, 1));
+		TS_ASSERT(stream->eos());
+
+		TS_ASSERT(stream->seek(1));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->readByte(), 1);
+
+		TS_ASSERT(!stream->seek(11));
+		TS_ASSERT(!stream->seek(-1));
+		TS_ASSERT_EQUALS(stream->pos(), 2);
+
+		// Every block which was loaded has been read from
+		TS_ASSERT_EQUALS(stream->getStats().discards, 0U);
+
+		delete stream;
+	}
+};
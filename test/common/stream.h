@@ -1,6 +1,17 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/memstream.h"
+#include "common/system.h"
+#include "common/debug.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
 
 class ReadLineStreamTestSuite : public CxxTest::TestSuite {
 	public:
@@ -44,3 +55,111 @@ class ReadLineStreamTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT(ms.eos());
 	}
 };
+
+class ReadArrayStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_read_array_16() {
+		// Odd sizes make sure the tails of the SIMD loops are exercised
+		byte contents[2 * 19 + 1];
+		for (int i = 0; i < (int)sizeof(contents); i++)
+			contents[i] = i * 7 + 1;
+
+		uint16 le[20], be[20];
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(ms.readArrayUint16LE(le, 20), 19U);
+		TS_ASSERT(ms.eos());
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readArrayUint16BE(be, 19), 19U);
+
+		for (int i = 0; i < 19; i++) {
+			TS_ASSERT_EQUALS(le[i], READ_LE_UINT16(contents + i * 2));
+			TS_ASSERT_EQUALS(be[i], READ_BE_UINT16(contents + i * 2));
+		}
+
+		int16 sle[3];
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readArraySint16LE(sle, 3), 3U);
+		TS_ASSERT_EQUALS(sle[2], (int16)READ_LE_UINT16(contents + 4));
+	}
+
+	void test_read_array_32() {
+		byte contents[4 * 11];
+		for (int i = 0; i < (int)sizeof(contents); i++)
+			contents[i] = i * 13 + 5;
+
+		uint32 le[11], be[11];
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(ms.readArrayUint32LE(le, 11), 11U);
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readArrayUint32BE(be, 11), 11U);
+
+		for (int i = 0; i < 11; i++) {
+			TS_ASSERT_EQUALS(le[i], READ_LE_UINT32(contents + i * 4));
+			TS_ASSERT_EQUALS(be[i], READ_BE_UINT32(contents + i * 4));
+		}
+
+		float f[2];
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readArrayFloatBE(f, 2), 2U);
+		TS_ASSERT_EQUALS(f[1], READ_BE_FLOAT32(contents + 4));
+
+		Common::MemoryReadStreamEndian mse(contents, sizeof(contents), true);
+		TS_ASSERT_EQUALS(mse.readArrayUint32(be, 3), 3U);
+		TS_ASSERT_EQUALS(be[2], READ_BE_UINT32(contents + 8));
+	}
+
+	void test_read_array_64() {
+		byte contents[8 * 5];
+		for (int i = 0; i < (int)sizeof(contents); i++)
+			contents[i] = i * 29 + 3;
+
+		uint64 le[5], be[5];
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(ms.readArrayUint64LE(le, 5), 5U);
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readArrayUint64BE(be, 5), 5U);
+
+		for (int i = 0; i < 5; i++) {
+			TS_ASSERT_EQUALS(le[i], READ_LE_UINT64(contents + i * 8));
+			TS_ASSERT_EQUALS(be[i], READ_BE_UINT64(contents + i * 8));
+		}
+	}
+
+	void test_read_array_speed() {
+#if BENCHMARK_TIME
+		if (!g_system)
+			Common::install_null_g_system();
+
+		const int iters = benchmarkCount(1, 2000);
+		const uint32 count = 64 * 1024;
+		byte *contents = new byte[count * 2];
+		for (uint32 i = 0; i < count * 2; i++)
+			contents[i] = i;
+		uint16 *values = new uint16[count];
+		Common::MemoryReadStream ms(contents, count * 2);
+
+		BenchmarkTimer singleTimer;
+		for (int it = 0; it < iters; it++) {
+			ms.seek(0);
+			for (uint32 i = 0; i < count; i++)
+				values[i] = ms.readUint16BE();
+		}
+		const uint32 singleTime = singleTimer.stop();
+
+		BenchmarkTimer arrayTimer;
+		for (int it = 0; it < iters; it++) {
+			ms.seek(0);
+			ms.readArrayUint16BE(values, count);
+		}
+		const uint32 arrayTime = arrayTimer.stop();
+
+		TS_ASSERT_EQUALS(values[count - 1], READ_BE_UINT16(contents + count * 2 - 2));
+
+		debug("readUint16BE: %d iters of %u values in %u ms, %d values/s", iters, count, singleTime, singleTimer.perSecond((uint64)iters * count));
+		debug("readArrayUint16BE: %d iters of %u values in %u ms, %d values/s", iters, count, arrayTime, arrayTimer.perSecond((uint64)iters * count));
+
+		delete[] values;
+		delete[] contents;
+#endif
+	}
+};
@@ -0,0 +1,1696 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "graphics/managed_surface.h"
+#include "graphics/surface.h"
+#include "graphics/tinygl/texelbuffer.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zblitrow.h"
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zspan.h"
+#include "graphics/tinygl/ztransform.h"
+
+#include "test/instrset_detect.h"
+
+#include "../benchmark.h"
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class TinyGLTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 320;
+	static const int kHeight = 240;
+
+	static Graphics::PixelFormat getFormat() {
+		return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	}
+
+	TinyGL::ContextHandle *_context;
+	TGLuint _texture;
+	TinyGL::BlitImage *_blitImage;
+	Graphics::Surface _image;
+	uint32 _seed;
+
+	float randomFloat(float min, float max) {
+		_seed = _seed * 1103515245 + 12345;
+		return min + (max - min) * ((_seed >> 8) & 0xffff) / 65535.0f;
+	}
+
+	void createContext(bool dirtyRects) {
+		_context = TinyGL::createContext(kWidth, kHeight, getFormat(), 256, true, dirtyRects);
+		TinyGL::setContext(_context);
+
+		// A checkerboard with a transparent corner
+		_image.create(64, 64, getFormat());
+		for (int y = 0; y < _image.h; y++) {
+			for (int x = 0; x < _image.w; x++) {
+				const byte c = ((x / 8) ^ (y / 8)) & 1 ? 255 : 64;
+				const byte a = (x < 16 && y < 16) ? 0 : (x + y < 64 ? 128 : 255);
+				*(uint32 *)_image.getBasePtr(x, y) = _image.format.ARGBToColor(a, c, x * 4, y * 4);
+			}
+		}
+
+		tglGenTextures(1, &_texture);
+		tglBindTexture(TGL_TEXTURE_2D, _texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, _image.w, _image.h, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, _image.getPixels());
+
+		_blitImage = tglGenBlitImage();
+		tglUploadBlitImage(_blitImage, _image, 0, false);
+	}
+
+	void destroyContext() {
+		tglDeleteTextures(1, &_texture);
+		tglDeleteBlitImage(_blitImage);
+		TinyGL::destroyContext(_context);
+		_image.free();
+	}
+
+	/**
+	 * Draw a frame with smooth, flat, textured, blended, fogged, depth only
+	 * and clipped triangles, and some blits on top of them.
+	 */
+	void drawScene(int numTriangles, bool transformedBlits) {
+		_seed = 1;
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 20.0);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglDisable(TGL_LIGHTING);
+		tglShadeModel(TGL_SMOOTH);
+
+		for (int i = 0; i < numTriangles; i++) {
+			const int kind = i % 7;
+			if (kind == 1 || kind == 5) {
+				tglEnable(TGL_TEXTURE_2D);
+				tglBindTexture(TGL_TEXTURE_2D, _texture);
+			} else {
+				tglDisable(TGL_TEXTURE_2D);
+			}
+			if (kind == 2 || kind == 5) {
+				tglEnable(TGL_BLEND);
+				tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+			} else if (kind == 4) {
+				tglEnable(TGL_BLEND);
+				tglBlendFunc(TGL_ONE, TGL_ONE_MINUS_SRC_ALPHA);
+			} else {
+				tglDisable(TGL_BLEND);
+			}
+			if (kind == 3) {
+				tglFogi(TGL_FOG_MODE, TGL_LINEAR);
+				tglFogf(TGL_FOG_START, 2.0f);
+				tglFogf(TGL_FOG_END, 15.0f);
+				tglEnable(TGL_FOG);
+			} else {
+				tglDisable(TGL_FOG);
+			}
+			tglShadeModel(kind == 4 || kind == 5 ? TGL_FLAT : TGL_SMOOTH);
+			tglDepthFunc(kind == 4 ? TGL_LEQUAL : TGL_LESS);
+			tglDepthMask(kind == 5 ? TGL_FALSE : TGL_TRUE);
+			// Only write to the depth buffer
+			const TGLboolean color = kind == 6 ? TGL_FALSE : TGL_TRUE;
+			tglColorMask(color, color, color, color);
+
+			// Some of the triangles reach outside of the screen
+			const float x = randomFloat(-5.0f, 5.0f), y = randomFloat(-4.0f, 4.0f), z = randomFloat(-15.0f, -2.0f);
+			const float size = randomFloat(0.5f, 4.0f);
+			tglBegin(i % 8 == 5 ? TGL_QUADS : TGL_TRIANGLES);
+			const int numVertices = i % 8 == 5 ? 4 : 3;
+			for (int v = 0; v < numVertices; v++) {
+				tglColor4f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.3f, 1.0f));
+				tglTexCoord2f(randomFloat(0.0f, 2.0f), randomFloat(0.0f, 2.0f));
+				tglVertex3f(x + randomFloat(-size, size), y + randomFloat(-size, size), z + randomFloat(-1.0f, 1.0f));
+			}
+			tglEnd();
+		}
+
+		tglDisable(TGL_TEXTURE_2D);
+		tglDisable(TGL_FOG);
+		tglShadeModel(TGL_SMOOTH);
+		tglDepthFunc(TGL_LESS);
+		tglDepthMask(TGL_TRUE);
+		tglColorMask(TGL_TRUE, TGL_TRUE, TGL_TRUE, TGL_TRUE);
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+
+		for (int i = 0; i < 6; i++) {
+			int x = (int)randomFloat(-40.0f, kWidth), y = (int)randomFloat(-40.0f, kHeight);
+			if (transformedBlits && i >= 4) {
+				// Scaled blits are not clipped exactly at the top left edges
+				x = MAX(x, 0);
+				y = MAX(y, 0);
+			}
+			TinyGL::BlitTransform transform(x, y);
+			if (i % 2)
+				transform.tint(0.75f, 1.0f, 0.5f, 0.25f);
+			if (i == 3)
+				transform.sourceRectangle(8, 4, 40, 50);
+			if (transformedBlits && i == 4) {
+				transform._destinationRectangle.setWidth(100);
+				transform._destinationRectangle.setHeight(30);
+			}
+			if (transformedBlits && i == 5)
+				transform.flip(true, false);
+			tglBlit(_blitImage, transform);
+		}
+		tglBlitFast(_blitImage, 200, 100);
+	}
+
+	/**
+	 * Mark the pixels of some triangles in the stencil buffer, and draw
+	 * smooth, textured and depth only triangles where the mark is set.
+	 */
+	void drawStencilScene(int numTriangles) {
+		tglClear(TGL_STENCIL_BUFFER_BIT);
+		tglEnable(TGL_STENCIL_TEST);
+		tglDisable(TGL_BLEND);
+
+		for (int pass = 0; pass < 2; pass++) {
+			if (pass == 0) {
+				tglStencilFunc(TGL_ALWAYS, 1, 0xff);
+				tglStencilOp(TGL_KEEP, TGL_KEEP, TGL_REPLACE);
+			} else {
+				tglStencilFunc(TGL_EQUAL, 1, 0xff);
+				tglStencilOp(TGL_KEEP, TGL_KEEP, TGL_KEEP);
+			}
+
+			for (int i = 0; i < numTriangles; i++) {
+				const int kind = pass == 0 ? 2 : i % 3;
+				if (kind == 1) {
+					tglEnable(TGL_TEXTURE_2D);
+					tglBindTexture(TGL_TEXTURE_2D, _texture);
+				} else {
+					tglDisable(TGL_TEXTURE_2D);
+				}
+				const TGLboolean color = kind == 2 ? TGL_FALSE : TGL_TRUE;
+				tglColorMask(color, color, color, color);
+
+				// The triangles drawn over the mark are large, so that their
+				// spans start on pixels failing the stencil test
+				const float x = randomFloat(-3.0f, 3.0f), y = randomFloat(-2.0f, 2.0f), z = randomFloat(-10.0f, -2.0f);
+				const float size = pass == 0 ? randomFloat(0.5f, 1.5f) : randomFloat(2.0f, 5.0f);
+				tglBegin(TGL_TRIANGLES);
+				for (int v = 0; v < 3; v++) {
+					tglColor4f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), 1.0f);
+					tglTexCoord2f(randomFloat(0.0f, 2.0f), randomFloat(0.0f, 2.0f));
+					tglVertex3f(x + randomFloat(-size, size), y + randomFloat(-size, size), z + randomFloat(-1.0f, 1.0f));
+				}
+				tglEnd();
+			}
+		}
+
+		tglDisable(TGL_TEXTURE_2D);
+		tglDisable(TGL_STENCIL_TEST);
+		tglColorMask(TGL_TRUE, TGL_TRUE, TGL_TRUE, TGL_TRUE);
+	}
+
+	Graphics::Surface *render(int tileSize, int numTriangles, bool transformedBlits, bool stencil = false) {
+		TinyGL::setTileSize(tileSize);
+		drawScene(numTriangles, transformedBlits);
+		if (stencil)
+			drawStencilScene(numTriangles / 4);
+		TinyGL::presentBuffer();
+		return TinyGL::copyFromFrameBuffer(getFormat());
+	}
+
+	static bool equals(const Graphics::Surface *a, const Graphics::Surface *b) {
+		for (int y = 0; y < a->h; y++) {
+			if (memcmp(a->getBasePtr(0, y), b->getBasePtr(0, y), a->w * a->format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	static void freeSurface(Graphics::Surface *surface) {
+		surface->free();
+		delete surface;
+	}
+
+	/**
+	 * Draw a frame like the cube, texture and fade tests of the playground3d
+	 * engine: spinning cubes with smooth shaded faces, textured quads and a
+	 * translucent rectangle over the whole screen.
+	 */
+	void drawPlaygroundScene(float angle) {
+		static const float faceColors[6][3] = {
+			{ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+			{ 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }
+		};
+		static const float faceVertices[6][4][3] = {
+			{ { -1, -1,  1 }, {  1, -1,  1 }, { -1,  1,  1 }, {  1,  1,  1 } },
+			{ {  1, -1, -1 }, { -1, -1, -1 }, {  1,  1, -1 }, { -1,  1, -1 } },
+			{ { -1, -1, -1 }, { -1, -1,  1 }, { -1,  1, -1 }, { -1,  1,  1 } },
+			{ {  1, -1,  1 }, {  1, -1, -1 }, {  1,  1,  1 }, {  1,  1, -1 } },
+			{ { -1,  1,  1 }, {  1,  1,  1 }, { -1,  1, -1 }, {  1,  1, -1 } },
+			{ { -1, -1, -1 }, {  1, -1, -1 }, { -1, -1,  1 }, {  1, -1,  1 } }
+		};
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 50.0);
+		tglEnable(TGL_DEPTH_TEST);
+		tglDisable(TGL_LIGHTING);
+		tglShadeModel(TGL_SMOOTH);
+
+		for (int i = 0; i < 24; i++) {
+			tglMatrixMode(TGL_MODELVIEW);
+			tglLoadIdentity();
+			tglTranslatef((i % 6) * 2.5f - 6.25f, (i / 6) * 2.5f - 3.75f, -10.0f - (i % 3) * 2.0f);
+			tglRotatef(angle + i * 15.0f, 1.0f, 0.0f, 0.0f);
+			tglRotatef(angle * 0.5f, 0.0f, 1.0f, 0.0f);
+			for (int face = 0; face < 6; face++) {
+				tglBegin(TGL_TRIANGLE_STRIP);
+				for (int v = 0; v < 4; v++) {
+					tglColor3f(faceColors[face][0] * (v + 1) / 4.0f, faceColors[face][1], faceColors[face][2]);
+					tglVertex3f(faceVertices[face][v][0], faceVertices[face][v][1], faceVertices[face][v][2]);
+				}
+				tglEnd();
+			}
+		}
+
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_TEXTURE_2D);
+		tglBindTexture(TGL_TEXTURE_2D, _texture);
+		tglColor3f(1.0f, 1.0f, 1.0f);
+		for (int i = 0; i < 8; i++) {
+			const float x = (i % 4) * 2.0f - 3.0f, y = (i / 4) * 2.0f - 1.0f;
+			tglBegin(TGL_QUADS);
+			tglTexCoord2f(0.0f, 0.0f);
+			tglVertex3f(x - 0.8f, y - 0.8f, -4.0f);
+			tglTexCoord2f(1.0f, 0.0f);
+			tglVertex3f(x + 0.8f, y - 0.8f, -4.5f);
+			tglTexCoord2f(1.0f, 1.0f);
+			tglVertex3f(x + 0.8f, y + 0.8f, -4.5f);
+			tglTexCoord2f(0.0f, 1.0f);
+			tglVertex3f(x - 0.8f, y + 0.8f, -4.0f);
+			tglEnd();
+		}
+		tglDisable(TGL_TEXTURE_2D);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_ONE, TGL_ONE_MINUS_SRC_ALPHA);
+		tglDisable(TGL_DEPTH_TEST);
+		tglDepthMask(TGL_FALSE);
+		tglColor4f(0.0f, 0.0f, 0.0f, 0.5f);
+		tglBegin(TGL_TRIANGLE_STRIP);
+		tglVertex3f(-1.0f, 1.0f, 0.0f);
+		tglVertex3f(1.0f, 1.0f, 0.0f);
+		tglVertex3f(-1.0f, -1.0f, 0.0f);
+		tglVertex3f(1.0f, -1.0f, 0.0f);
+		tglEnd();
+		tglDisable(TGL_BLEND);
+		tglDepthMask(TGL_TRUE);
+	}
+
+	// The vectorized span functions the CPU can run
+	static int getSpanFuncs(const TinyGL::SpanFuncs *funcs[], const char *names[]) {
+		int count = 0;
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			names[count] = "SSE2";
+			funcs[count++] = &TinyGL::spanFuncsSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			names[count] = "AVX2";
+			funcs[count++] = &TinyGL::spanFuncsAVX2;
+		}
+#endif
+		return count;
+	}
+
+	// A wavy grid, both indexed and as separate triangles
+	struct Mesh {
+		Common::Array<float> vertices, normals, colors, texCoords;
+		Common::Array<uint16> indices;
+		Common::Array<float> triangleVertices, triangleNormals, triangleColors, triangleTexCoords;
+	};
+
+	static void buildMesh(Mesh &mesh, int size) {
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				const float u = x * 2.0f / (size - 1) - 1.0f, v = y * 2.0f / (size - 1) - 1.0f;
+				mesh.vertices.push_back(u * 3.0f);
+				mesh.vertices.push_back(v * 2.5f);
+				mesh.vertices.push_back(0.5f * sinf(u * 4.0f) * cosf(v * 3.0f));
+				// Not normalized
+				mesh.normals.push_back(-2.0f * cosf(u * 4.0f) * cosf(v * 3.0f));
+				mesh.normals.push_back(1.5f * sinf(u * 4.0f) * sinf(v * 3.0f));
+				mesh.normals.push_back(3.0f);
+				mesh.colors.push_back((u + 1.0f) / 2.0f);
+				mesh.colors.push_back((v + 1.0f) / 2.0f);
+				mesh.colors.push_back(0.5f);
+				mesh.colors.push_back(1.0f);
+				mesh.texCoords.push_back(u * 2.0f);
+				mesh.texCoords.push_back(v * 2.0f);
+			}
+		}
+
+		for (int y = 0; y < size - 1; y++) {
+			for (int x = 0; x < size - 1; x++) {
+				const uint16 i = y * size + x;
+				mesh.indices.push_back(i);
+				mesh.indices.push_back(i + 1);
+				mesh.indices.push_back(i + size);
+				mesh.indices.push_back(i + 1);
+				mesh.indices.push_back(i + size + 1);
+				mesh.indices.push_back(i + size);
+			}
+		}
+
+		for (uint i = 0; i < mesh.indices.size(); i++) {
+			const int index = mesh.indices[i];
+			for (int c = 0; c < 3; c++) {
+				mesh.triangleVertices.push_back(mesh.vertices[index * 3 + c]);
+				mesh.triangleNormals.push_back(mesh.normals[index * 3 + c]);
+			}
+			for (int c = 0; c < 4; c++) {
+				mesh.triangleColors.push_back(mesh.colors[index * 4 + c]);
+			}
+			for (int c = 0; c < 2; c++) {
+				mesh.triangleTexCoords.push_back(mesh.texCoords[index * 2 + c]);
+			}
+		}
+	}
+
+	/**
+	 * Draw the mesh twice, once by its indices and once as separate
+	 * triangles, either from vertex arrays or vertex by vertex. The passes
+	 * use the texture matrix, lighting with and without normalization, and
+	 * fog.
+	 */
+	void drawMesh(const Mesh &mesh, int pass, bool arrays) {
+		static const float ambient[] = { 0.2f, 0.2f, 0.2f, 1.0f };
+		static const float diffuse[] = { 0.8f, 0.7f, 0.6f, 1.0f };
+		static const float specular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		static const float direction[] = { 0.3f, 0.5f, 1.0f, 0.0f };
+		static const float position[] = { -2.0f, 1.0f, -3.0f, 1.0f };
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 20.0);
+		tglMatrixMode(TGL_TEXTURE);
+		tglLoadIdentity();
+		if (pass == 0) {
+			tglRotatef(30.0f, 0.0f, 0.0f, 1.0f);
+			tglScalef(1.5f, 0.5f, 1.0f);
+		}
+		tglEnable(TGL_DEPTH_TEST);
+
+		if (pass == 0) {
+			tglEnable(TGL_TEXTURE_2D);
+			tglBindTexture(TGL_TEXTURE_2D, _texture);
+		} else {
+			tglDisable(TGL_TEXTURE_2D);
+		}
+		if (pass == 1 || pass == 3) {
+			tglLightfv(TGL_LIGHT0, TGL_AMBIENT, ambient);
+			tglLightfv(TGL_LIGHT0, TGL_DIFFUSE, diffuse);
+			tglLightfv(TGL_LIGHT0, TGL_POSITION, direction);
+			tglLightfv(TGL_LIGHT1, TGL_DIFFUSE, diffuse);
+			tglLightfv(TGL_LIGHT1, TGL_SPECULAR, specular);
+			tglLightfv(TGL_LIGHT1, TGL_POSITION, position);
+			tglMaterialfv(TGL_FRONT_AND_BACK, TGL_SPECULAR, specular);
+			tglMaterialf(TGL_FRONT_AND_BACK, TGL_SHININESS, 20.0f);
+			tglEnable(TGL_LIGHT0);
+			tglEnable(TGL_LIGHT1);
+			tglEnable(TGL_LIGHTING);
+		} else {
+			tglDisable(TGL_LIGHTING);
+		}
+		if (pass == 1) {
+			tglEnable(TGL_NORMALIZE);
+		} else {
+			tglDisable(TGL_NORMALIZE);
+		}
+		if (pass >= 2) {
+			tglFogi(TGL_FOG_MODE, TGL_LINEAR);
+			tglFogf(TGL_FOG_START, 3.0f);
+			tglFogf(TGL_FOG_END, 12.0f);
+			tglEnable(TGL_FOG);
+		} else {
+			tglDisable(TGL_FOG);
+		}
+
+		for (int copy = 0; copy < 2; copy++) {
+			const bool indexed = copy == 0;
+			const float *vertices = indexed ? mesh.vertices.data() : mesh.triangleVertices.data();
+			const float *normals = indexed ? mesh.normals.data() : mesh.triangleNormals.data();
+			const float *colors = indexed ? mesh.colors.data() : mesh.triangleColors.data();
+			const float *texCoords = indexed ? mesh.texCoords.data() : mesh.triangleTexCoords.data();
+
+			// The second copy reaches outside of the screen
+			tglMatrixMode(TGL_MODELVIEW);
+			tglLoadIdentity();
+			tglTranslatef(copy * 2.5f - 1.0f, copy * 1.0f, -6.0f + copy * 3.0f);
+			tglRotatef(35.0f + pass * 20.0f, 1.0f, 0.0f, 0.0f);
+			tglRotatef(-20.0f + copy * 40.0f, 0.0f, 1.0f, 0.0f);
+
+			if (arrays) {
+				tglEnableClientState(TGL_VERTEX_ARRAY);
+				tglEnableClientState(TGL_NORMAL_ARRAY);
+				tglEnableClientState(TGL_COLOR_ARRAY);
+				tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+				tglVertexPointer(3, TGL_FLOAT, 0, vertices);
+				tglNormalPointer(TGL_FLOAT, 0, normals);
+				tglColorPointer(4, TGL_FLOAT, 4 * sizeof(float), colors);
+				tglTexCoordPointer(2, TGL_FLOAT, 0, texCoords);
+				if (indexed)
+					tglDrawElements(TGL_TRIANGLES, mesh.indices.size(), TGL_UNSIGNED_SHORT, mesh.indices.data());
+				else
+					tglDrawArrays(TGL_TRIANGLES, 0, mesh.indices.size());
+				tglDisableClientState(TGL_VERTEX_ARRAY);
+				tglDisableClientState(TGL_NORMAL_ARRAY);
+				tglDisableClientState(TGL_COLOR_ARRAY);
+				tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
+			} else {
+				tglBegin(TGL_TRIANGLES);
+				for (uint i = 0; i < mesh.indices.size(); i++) {
+					const int index = indexed ? mesh.indices[i] : i;
+					tglColor4fv(colors + index * 4);
+					tglNormal3fv(normals + index * 3);
+					tglTexCoord2fv(texCoords + index * 2);
+					tglVertex3fv(vertices + index * 3);
+				}
+				tglEnd();
+			}
+		}
+	}
+
+	/**
+	 * Issue the ops of a display list drawing static geometry: blocks of
+	 * triangles and quads which can be joined, strips, state changes
+	 * repeated needlessly, colors set after the last vertex of a block or
+	 * only after its first vertex, and the color material.
+	 */
+	void drawListOps() {
+		static const float specular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+		_seed = 7;
+		for (int i = 0; i < 60; i++) {
+			const int kind = i % 6;
+
+			tglShadeModel(TGL_SMOOTH);
+			tglEnable(TGL_DEPTH_TEST);
+			if (kind == 1) {
+				tglEnable(TGL_TEXTURE_2D);
+				tglBindTexture(TGL_TEXTURE_2D, _texture);
+				tglBindTexture(TGL_TEXTURE_2D, _texture);
+			} else {
+				tglDisable(TGL_TEXTURE_2D);
+			}
+			if (kind == 4) {
+				tglMaterialfv(TGL_FRONT_AND_BACK, TGL_SPECULAR, specular);
+				tglColorMaterial(TGL_FRONT_AND_BACK, TGL_AMBIENT_AND_DIFFUSE);
+				tglEnable(TGL_COLOR_MATERIAL);
+				tglEnable(TGL_LIGHT0);
+				tglEnable(TGL_LIGHTING);
+			} else {
+				tglDisable(TGL_LIGHTING);
+				tglDisable(TGL_COLOR_MATERIAL);
+			}
+			if (kind == 5) {
+				tglPushMatrix();
+				tglRotatef(i * 10.0f, 0.0f, 0.0f, 1.0f);
+			}
+
+			const float x = randomFloat(-4.0f, 4.0f), y = randomFloat(-3.0f, 3.0f), z = randomFloat(-12.0f, -3.0f);
+			const float size = randomFloat(0.3f, 1.5f);
+			const TGLenum types[] = { TGL_TRIANGLES, TGL_QUADS, TGL_TRIANGLES, TGL_TRIANGLE_STRIP, TGL_TRIANGLES, TGL_TRIANGLE_FAN };
+			const int numVertices = kind == 1 ? 4 : (kind == 3 || kind == 5 ? 5 : 3);
+
+			tglColor3f(0.5f, 0.5f, 0.5f);
+			tglBegin(types[kind]);
+			for (int v = 0; v < numVertices; v++) {
+				// Only set after the first vertex, or set twice
+				if (kind != 2 || v > 0)
+					tglColor4f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), 1.0f);
+				if (kind == 3)
+					tglColor4f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), 1.0f);
+				tglNormal3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), 1.0f);
+				tglTexCoord2f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f));
+				tglVertex3f(x + randomFloat(-size, size), y + randomFloat(-size, size), z + randomFloat(-0.5f, 0.5f));
+			}
+			if (kind == 0)
+				tglColor3f(1.0f, 0.0f, 0.0f);
+			tglEnd();
+
+			if (kind == 5)
+				tglPopMatrix();
+		}
+		tglDisable(TGL_LIGHTING);
+		tglDisable(TGL_COLOR_MATERIAL);
+		tglDisable(TGL_TEXTURE_2D);
+	}
+
+	// Draw the ops of drawListOps() twice, directly or through a list
+	void drawListScene(TGLuint list) {
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 20.0);
+
+		for (int i = 0; i < 2; i++) {
+			tglMatrixMode(TGL_MODELVIEW);
+			tglLoadIdentity();
+			tglTranslatef(i * 0.5f, 0.0f, -i * 2.0f);
+			tglRotatef(i * 20.0f, 0.0f, 1.0f, 0.0f);
+			if (list)
+				tglCallList(list);
+			else
+				drawListOps();
+
+			// A block without colors, using the last one of the list
+			tglBegin(TGL_TRIANGLES);
+			tglVertex3f(-1.0f, -1.0f, -5.0f);
+			tglVertex3f(1.0f, -1.0f, -5.0f);
+			tglVertex3f(0.0f, 1.0f, -5.0f);
+			tglEnd();
+		}
+	}
+
+	// The vectorized vertex transforms the CPU can run
+	static int getTransformFuncs(TinyGL::TransformFunc funcs[], const char *names[]) {
+		int count = 0;
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			names[count] = "SSE2";
+			funcs[count++] = TinyGL::transformVerticesSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			names[count] = "AVX2";
+			funcs[count++] = TinyGL::transformVerticesAVX2;
+		}
+#endif
+		return count;
+	}
+
+	// The vectorized blit row functions the CPU can run
+	static int getBlitRowFuncs(TinyGL::BlitRowFunc funcs[], const char *names[]) {
+		int count = 0;
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			names[count] = "SSE2";
+			funcs[count++] = TinyGL::blitRowSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			names[count] = "AVX2";
+			funcs[count++] = TinyGL::blitRowAVX2;
+		}
+#endif
+		return count;
+	}
+
+	/**
+	 * Draw a checkerboard of black and white texels, minified by four in
+	 * each direction on a quad facing the screen, and on a floor going
+	 * away to the horizon.
+	 */
+	void drawMinifiedScene(TGLenum minFilter) {
+		Graphics::Surface image;
+		image.create(64, 64, getFormat());
+		for (int y = 0; y < image.h; y++) {
+			for (int x = 0; x < image.w; x++) {
+				const byte c = (x ^ y) & 1 ? 255 : 0;
+				*(uint32 *)image.getBasePtr(x, y) = image.format.ARGBToColor(255, c, c, c);
+			}
+		}
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, minFilter);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, image.w, image.h, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, image.getPixels());
+		image.free();
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglEnable(TGL_TEXTURE_2D);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglOrtho(0.0, kWidth, 0.0, kHeight, -1.0, 1.0);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglBegin(TGL_QUADS);
+		tglTexCoord2f(0.0f, 0.0f);
+		tglVertex3f(16.0f, kHeight - 32.0f, 0.0f);
+		tglTexCoord2f(1.0f, 0.0f);
+		tglVertex3f(32.0f, kHeight - 32.0f, 0.0f);
+		tglTexCoord2f(1.0f, 1.0f);
+		tglVertex3f(32.0f, kHeight - 16.0f, 0.0f);
+		tglTexCoord2f(0.0f, 1.0f);
+		tglVertex3f(16.0f, kHeight - 16.0f, 0.0f);
+		tglEnd();
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 100.0);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_DEPTH_TEST);
+		tglBegin(TGL_QUADS);
+		for (int z = 0; z < 20; z++) {
+			tglTexCoord2f(0.0f, z * 2.0f);
+			tglVertex3f(-4.0f, -1.0f, -2.0f - z * 4.0f);
+			tglTexCoord2f(8.0f, z * 2.0f);
+			tglVertex3f(4.0f, -1.0f, -2.0f - z * 4.0f);
+			tglTexCoord2f(8.0f, z * 2.0f + 2.0f);
+			tglVertex3f(4.0f, -1.0f, -6.0f - z * 4.0f);
+			tglTexCoord2f(0.0f, z * 2.0f + 2.0f);
+			tglVertex3f(-4.0f, -1.0f, -6.0f - z * 4.0f);
+		}
+		tglEnd();
+		tglDisable(TGL_DEPTH_TEST);
+		tglDisable(TGL_TEXTURE_2D);
+
+		tglDeleteTextures(1, &texture);
+	}
+
+	/**
+	 * Draw a wall over most of the screen with lots of triangles behind it,
+	 * and a few in front of it or going through it.
+	 */
+	void drawOccludedScene(int numTriangles) {
+		_seed = 5;
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 20.0);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_DEPTH_TEST);
+		tglShadeModel(TGL_SMOOTH);
+
+		tglBegin(TGL_QUADS);
+		tglColor3f(0.5f, 0.5f, 0.5f);
+		tglVertex3f(-2.5f, -2.0f, -3.0f);
+		tglVertex3f(2.0f, -2.0f, -3.0f);
+		tglVertex3f(2.0f, 1.2f, -3.0f);
+		tglVertex3f(-2.5f, 1.2f, -3.0f);
+		tglEnd();
+
+		tglBegin(TGL_TRIANGLES);
+		for (int i = 0; i < numTriangles; i++) {
+			const float x = randomFloat(-4.0f, 4.0f), y = randomFloat(-3.0f, 3.0f);
+			const float z = i % 10 ? randomFloat(-15.0f, -4.0f) : randomFloat(-3.5f, -2.0f);
+			const float size = randomFloat(0.3f, 2.0f);
+			for (int v = 0; v < 3; v++) {
+				tglColor3f(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f));
+				tglVertex3f(x + randomFloat(-size, size), y + randomFloat(-size, size), z + randomFloat(-1.0f, 1.0f));
+			}
+		}
+		tglEnd();
+	}
+
+	/**
+	 * Draw a frame of a 2.5D scene: static geometry with overlapping blits
+	 * on top of it. The second frame inserts a blit before the others, the
+	 * third one swaps two of them, and the last one is the same as the first.
+	 */
+	void drawDirtyRectScene(int frame) {
+		drawOccludedScene(50);
+
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		if (frame == 1)
+			tglBlit(_blitImage, 250, 170);
+		for (int i = 0; i < 12; i++) {
+			const int blit = frame == 2 && i < 2 ? 1 - i : i;
+			TinyGL::BlitTransform transform(10 + (blit % 4) * 50, 10 + (blit / 4) * 50);
+			if (blit % 2)
+				transform.tint(0.75f, 1.0f, 0.5f, 0.25f);
+			tglBlit(_blitImage, transform);
+		}
+		tglBlendFunc(TGL_ONE, TGL_ZERO);
+		tglDisable(TGL_BLEND);
+	}
+
+	/**
+	 * Blit images with partial alpha, with a color key and opaque ones,
+	 * tinted, flipped, scaled, rotated and clipped by the edges of the
+	 * screen. The blending states include some the blit row functions
+	 * leave to the per pixel code.
+	 */
+	void drawBlitScene() {
+		_seed = 3;
+
+		Graphics::Surface keyed, opaque;
+		keyed.create(48, 40, getFormat());
+		opaque.create(48, 40, getFormat());
+		const uint32 key = getFormat().ARGBToColor(255, 255, 0, 255);
+		for (int y = 0; y < keyed.h; y++) {
+			for (int x = 0; x < keyed.w; x++) {
+				const uint32 color = getFormat().ARGBToColor(255, x * 5, y * 6, (x * y) & 0xff);
+				*(uint32 *)keyed.getBasePtr(x, y) = (x + y) % 7 == 0 ? key : color;
+				*(uint32 *)opaque.getBasePtr(x, y) = color;
+			}
+		}
+		TinyGL::BlitImage *images[3] = { _blitImage, tglGenBlitImage(), tglGenBlitImage() };
+		tglUploadBlitImage(images[1], keyed, key, true);
+		tglUploadBlitImage(images[2], opaque, 0, false);
+		keyed.free();
+		opaque.free();
+
+		tglViewport(0, 0, kWidth, kHeight);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglDisable(TGL_DEPTH_TEST);
+
+		for (int mode = 0; mode < 6; mode++) {
+			tglEnable(TGL_BLEND);
+			tglDisable(TGL_ALPHA_TEST);
+			if (mode == 0) {
+				tglDisable(TGL_BLEND);
+			} else if (mode == 1) {
+				tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+			} else if (mode == 2) {
+				tglBlendFunc(TGL_ONE, TGL_ONE_MINUS_SRC_ALPHA);
+			} else if (mode == 3) {
+				tglBlendFunc(TGL_ONE, TGL_ONE);
+			} else if (mode == 4) {
+				// Left to the per pixel code
+				tglBlendFunc(TGL_DST_COLOR, TGL_ZERO);
+			} else {
+				tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+				tglEnable(TGL_ALPHA_TEST);
+				tglAlphaFunc(TGL_GREATER, 0.6f);
+			}
+
+			for (int i = 0; i < 36; i++) {
+				const int kind = i % 12;
+				// Transformed blits stay inside of the top left edges
+				const float min = kind < 5 ? -40.0f : 0.0f;
+				TinyGL::BlitTransform transform((int)randomFloat(min, kWidth - 20), (int)randomFloat(min, kHeight - 20));
+				if (kind % 3 == 1)
+					transform.tint(0.75f, 1.0f, 0.5f, 0.25f);
+				else if (kind % 3 == 2)
+					transform.tint(0.3f, 0.9f, 0.1f, 1.0f / 3);
+				if (kind == 3 || kind == 7)
+					transform.flip(false, true);
+				if (kind == 4 || kind == 10)
+					transform.flip(true, kind == 4);
+				if (kind == 2 || kind == 11)
+					transform.sourceRectangle(8, 4, 30, 20);
+				if (kind >= 5 && kind <= 7) {
+					// Scaled up by integer and fractional factors, and down
+					static const int sizes[3][2] = { { 128, 80 }, { 100, 30 }, { 36, 50 } };
+					transform._destinationRectangle.setWidth(sizes[kind - 5][0]);
+					transform._destinationRectangle.setHeight(sizes[kind - 5][1]);
+				}
+				if (kind >= 8) {
+					static const int rotations[4] = { 30, 180, 360, 90 };
+					transform.rotate(rotations[kind - 8], 20, 16);
+					if (kind == 9 || kind == 10) {
+						transform._destinationRectangle.setWidth(96);
+						transform._destinationRectangle.setHeight(80);
+					}
+				}
+				tglBlit(images[i / 12], transform);
+			}
+		}
+		tglDisable(TGL_ALPHA_TEST);
+		tglBlendFunc(TGL_ONE, TGL_ZERO);
+		tglDisable(TGL_BLEND);
+
+		tglDeleteBlitImage(images[1]);
+		tglDeleteBlitImage(images[2]);
+	}
+
+	/**
+	 * Draw a frame of a 2.5D scene made of blits only: a background scaled
+	 * up to the whole screen, and moving sprites on top of it which are
+	 * tinted, flipped, scaled and rotated.
+	 */
+	void drawSpriteScene(TinyGL::BlitImage *background, int frame) {
+		tglDisable(TGL_BLEND);
+		TinyGL::BlitTransform transform(0, 0);
+		transform._destinationRectangle.setWidth(kWidth);
+		transform._destinationRectangle.setHeight(kHeight);
+		tglBlit(background, transform);
+
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		for (int i = 0; i < 32; i++) {
+			TinyGL::BlitTransform sprite((i * 37 + frame * 3) % (kWidth - 64), (i * 23 + frame) % (kHeight - 64));
+			sprite.tint(0.75f, 1.0f, 0.5f, 0.25f);
+			if (i % 4 == 1)
+				sprite.flip(false, true);
+			if (i % 4 == 2) {
+				sprite._destinationRectangle.setWidth(96);
+				sprite._destinationRectangle.setHeight(48);
+			}
+			if (i % 4 == 3)
+				sprite.rotate(frame * 5 + i, 32, 32);
+			tglBlit(_blitImage, sprite);
+		}
+		tglBlendFunc(TGL_ONE, TGL_ZERO);
+		tglDisable(TGL_BLEND);
+	}
+
+	// The color of the textured pixels of the quad facing the screen
+	static void getMinifiedColors(const Graphics::Surface *surface, int &minimum, int &maximum) {
+		minimum = 255;
+		maximum = 0;
+		for (int y = 0; y < 48; y++) {
+			for (int x = 0; x < 48; x++) {
+				byte r, g, b;
+				surface->format.colorToRGB(surface->getPixel(x, y), r, g, b);
+				if (r == 255 && g == 0 && b == 0)
+					continue;
+				minimum = MIN<int>(minimum, g);
+				maximum = MAX<int>(maximum, g);
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+		// The null backend has no graphics manager to ask for the CPU
+		// features, so select the functions the backend would with the
+		// detection of the tests
+		const char *names[2];
+		const TinyGL::SpanFuncs *spanFuncs[2];
+		const int numSpanFuncs = getSpanFuncs(spanFuncs, names);
+		TinyGL::Internal::setSpanFuncs(numSpanFuncs ? spanFuncs[numSpanFuncs - 1] : nullptr);
+		TinyGL::TransformFunc transformFuncs[2];
+		const int numTransformFuncs = getTransformFuncs(transformFuncs, names);
+		TinyGL::Internal::setTransformFunc(numTransformFuncs ? transformFuncs[numTransformFuncs - 1] : nullptr);
+		TinyGL::BlitRowFunc blitRowFuncs[2];
+		const int numBlitRowFuncs = getBlitRowFuncs(blitRowFuncs, names);
+		TinyGL::Internal::setBlitRowFunc(numBlitRowFuncs ? blitRowFuncs[numBlitRowFuncs - 1] : TinyGL::blitRow);
+	}
+
+	// Rendering tile by tile has to give the same pixels as rendering the
+	// draw calls one after the other
+	void test_tiled_rendering() {
+		static const int tileSizes[] = { 16, 37, 64, 1000 };
+
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			for (int transformedBlits = 0; transformedBlits < 2; transformedBlits++) {
+				for (int stencil = 0; stencil < 2; stencil++) {
+					createContext(dirtyRects);
+					Graphics::Surface *expected = render(0, 200, transformedBlits, stencil);
+					destroyContext();
+
+					for (int i = 0; i < ARRAYSIZE(tileSizes); i++) {
+						createContext(dirtyRects);
+						Graphics::Surface *tiled = render(tileSizes[i], 200, transformedBlits, stencil);
+						TS_ASSERT(equals(tiled, expected));
+						freeSurface(tiled);
+						destroyContext();
+					}
+
+					freeSurface(expected);
+				}
+			}
+		}
+	}
+
+	// The vectorized span functions have to give the same pixels as the
+	// generic code
+	void test_span_funcs() {
+		static const int tileSizes[] = { 0, 37 };
+		const TinyGL::SpanFuncs *funcs[2];
+		const char *names[2];
+		const int numFuncs = getSpanFuncs(funcs, names);
+
+		for (int i = 0; i < ARRAYSIZE(tileSizes); i++) {
+			TinyGL::Internal::setSpanFuncs(nullptr);
+			createContext(false);
+			Graphics::Surface *expected = render(tileSizes[i], 300, false);
+			destroyContext();
+
+			for (int f = 0; f < numFuncs; f++) {
+				TinyGL::Internal::setSpanFuncs(funcs[f]);
+				createContext(false);
+				Graphics::Surface *surface = render(tileSizes[i], 300, false);
+				TS_ASSERT(equals(surface, expected));
+				freeSurface(surface);
+				destroyContext();
+			}
+
+			freeSurface(expected);
+		}
+
+		for (int f = 0; f < numFuncs; f++) {
+			TinyGL::Internal::setSpanFuncs(nullptr);
+			createContext(false);
+			drawPlaygroundScene(30.0f);
+			TinyGL::presentBuffer();
+			Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+			destroyContext();
+
+			TinyGL::Internal::setSpanFuncs(funcs[f]);
+			createContext(false);
+			drawPlaygroundScene(30.0f);
+			TinyGL::presentBuffer();
+			Graphics::Surface *surface = TinyGL::copyFromFrameBuffer(getFormat());
+			TS_ASSERT(equals(surface, expected));
+			freeSurface(surface);
+			destroyContext();
+
+			freeSurface(expected);
+		}
+		TinyGL::Internal::setSpanFuncs(nullptr);
+	}
+
+	// The blit row functions have to give the same pixels as the per pixel
+	// code of the blits, and the vectorized ones the same as the generic one
+	void test_blit_rows() {
+		TinyGL::BlitRowFunc funcs[3] = { TinyGL::blitRow };
+		const char *names[3] = { "generic" };
+		const int numFuncs = getBlitRowFuncs(funcs + 1, names + 1) + 1;
+		const TinyGL::BlitRowFunc savedFunc = TinyGL::Internal::getBlitRowFunc();
+
+		TinyGL::Internal::setBlitRowFunc(nullptr);
+		createContext(false);
+		drawBlitScene();
+		TinyGL::presentBuffer();
+		Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+		destroyContext();
+
+		for (int f = 0; f < numFuncs; f++) {
+			TinyGL::Internal::setBlitRowFunc(funcs[f]);
+			createContext(false);
+			drawBlitScene();
+			TinyGL::presentBuffer();
+			Graphics::Surface *surface = TinyGL::copyFromFrameBuffer(getFormat());
+			TS_ASSERT(equals(surface, expected));
+			freeSurface(surface);
+			destroyContext();
+		}
+		freeSurface(expected);
+		TinyGL::Internal::setBlitRowFunc(savedFunc);
+
+		// Rows of random pixels of any length, in other formats and with
+		// all the blending factors
+		_seed = 11;
+		for (int i = 0; i < 200; i++) {
+			TinyGL::BlitRowState state;
+			state.srcAShift = 24;
+			state.srcRShift = 0;
+			state.srcGShift = 8;
+			state.srcBShift = 16;
+			state.srcAlphaMask = i % 5 == 0 ? 0xff : 0;
+			state.aTint = (uint)randomFloat(0.0f, 65536.0f);
+			state.rTint = i % 3 == 0 ? 65536 : (uint)randomFloat(0.0f, 65536.0f);
+			state.gTint = (uint)randomFloat(0.0f, 65536.0f);
+			state.bTint = i % 4 == 0 ? 65536 : (uint)randomFloat(0.0f, 65536.0f);
+			static const int factors[4][2] = { { 0, 0 }, { 256, 0 }, { 0, 1 }, { 255, -1 } };
+			state.blending = i % 6 != 0;
+			state.srcFactorBase = factors[i % 4][0];
+			state.srcFactorSign = factors[i % 4][1];
+			state.dstFactorBase = factors[(i / 4) % 4][0];
+			state.dstFactorSign = factors[(i / 4) % 4][1];
+			state.storeOpaque = i % 7 == 0;
+			state.aShift = i % 2 ? 24 : 0;
+			state.rShift = i % 2 ? 16 : 24;
+			state.gShift = i % 2 ? 8 : 16;
+			state.bShift = i % 2 ? 0 : 8;
+			state.aLoss = i % 8 == 1 ? 8 : 0;
+
+			const int count = i % 20;
+			uint32 src[20], dst[21];
+			for (int x = 0; x < count; x++) {
+				src[x] = (uint32)randomFloat(0.0f, 65535.0f) << 16 | (uint32)randomFloat(0.0f, 65535.0f);
+				// Some pixels are opaque and some transparent
+				if (x % 3 == 0)
+					src[x] |= 0xff000000;
+				else if (x % 3 == 1)
+					src[x] &= 0x00ffffff;
+			}
+			for (int x = 0; x < 21; x++)
+				dst[x] = (uint32)randomFloat(0.0f, 65535.0f) << 16 | (uint32)randomFloat(0.0f, 65535.0f);
+
+			uint32 expectedRow[21];
+			memcpy(expectedRow, dst, sizeof(dst));
+			TinyGL::blitRow(state, expectedRow, src, count);
+			for (int f = 1; f < numFuncs; f++) {
+				uint32 row[21];
+				memcpy(row, dst, sizeof(dst));
+				funcs[f](state, row, src, count);
+				TS_ASSERT_EQUALS(memcmp(row, expectedRow, sizeof(row)), 0);
+			}
+		}
+	}
+
+	// Texels are stored in tiles and read back through them, at any size
+	void test_texel_buffers() {
+		// The bytes are in RGBA order
+#if defined(SCUMM_LITTLE_ENDIAN)
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 0, 8, 16, 24);
+#else
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+#endif
+		const uint width = 13, height = 7, textureSize = 16;
+		uint32 pixels[width * height];
+		_seed = 3;
+		for (uint i = 0; i < width * height; i++)
+			pixels[i] = format.ARGBToColor((byte)randomFloat(0, 255), (byte)randomFloat(0, 255), (byte)randomFloat(0, 255), (byte)randomFloat(0, 255));
+
+		TinyGL::TexelBuffer *buffers[2] = {
+			TinyGL::createNearestTexelBuffer((const byte *)pixels, format, TGL_RGBA, TGL_UNSIGNED_BYTE, width, height, textureSize),
+			TinyGL::createBilinearTexelBuffer((byte *)pixels, format, TGL_RGBA, TGL_UNSIGNED_BYTE, width, height, textureSize)
+		};
+		// 4x2 tiles of 4x4 texels
+		TS_ASSERT_EQUALS(buffers[0]->getMemorySize(), 8u * 16 * 4);
+		TS_ASSERT_EQUALS(buffers[1]->getMemorySize(), 8u * 16 * 16);
+
+		for (int i = 0; i < 2; i++) {
+			for (uint y = 0; y < height; y++) {
+				for (uint x = 0; x < width; x++) {
+					byte a, r, g, b, ea, er, eg, eb;
+					format.colorToARGB(pixels[y * width + x], ea, er, eg, eb);
+					buffers[i]->getTexelAt(x, y, a, r, g, b);
+					TS_ASSERT(a == ea && r == er && g == eg && b == eb);
+					if (i == 0) {
+						// The center of the texel
+						const int s = ((2 * x + 1) * (textureSize << ZB_POINT_ST_FRAC_BITS)) / (2 * width);
+						const int t = ((2 * y + 1) * (textureSize << ZB_POINT_ST_FRAC_BITS)) / (2 * height);
+						buffers[i]->getARGBAt(TGL_REPEAT, TGL_REPEAT, s, t, a, r, g, b);
+						TS_ASSERT(a == ea && r == er && g == eg && b == eb);
+					}
+				}
+			}
+		}
+
+		// Each texel of the next level is the average of 2x2 texels
+		TinyGL::TexelBuffer *mipmap = TinyGL::createMipmapTexelBuffer(buffers[0], false, textureSize);
+		TS_ASSERT_EQUALS(mipmap->getWidth(), 6u);
+		TS_ASSERT_EQUALS(mipmap->getHeight(), 3u);
+		for (uint y = 0; y < mipmap->getHeight(); y++) {
+			for (uint x = 0; x < mipmap->getWidth(); x++) {
+				uint sum[4] = { 2, 2, 2, 2 };
+				for (int i = 0; i < 4; i++) {
+					byte c[4];
+					buffers[0]->getTexelAt(x * 2 + (i & 1), y * 2 + (i >> 1), c[0], c[1], c[2], c[3]);
+					for (int j = 0; j < 4; j++)
+						sum[j] += c[j];
+				}
+				byte a, r, g, b;
+				mipmap->getTexelAt(x, y, a, r, g, b);
+				TS_ASSERT(a == sum[0] / 4 && r == sum[1] / 4 && g == sum[2] / 4 && b == sum[3] / 4);
+			}
+		}
+
+		delete mipmap;
+		delete buffers[0];
+		delete buffers[1];
+	}
+
+	// Minified textures are sampled from the mipmap levels, so a fine
+	// checkerboard turns grey instead of aliasing
+	void test_mipmaps() {
+		static const TGLenum filters[] = { TGL_NEAREST_MIPMAP_NEAREST, TGL_NEAREST_MIPMAP_LINEAR, TGL_LINEAR_MIPMAP_NEAREST, TGL_LINEAR_MIPMAP_LINEAR };
+		int minimum, maximum;
+
+		createContext(false);
+		drawMinifiedScene(TGL_NEAREST);
+		TinyGL::presentBuffer();
+		Graphics::Surface *surface = TinyGL::copyFromFrameBuffer(getFormat());
+		getMinifiedColors(surface, minimum, maximum);
+		TS_ASSERT(minimum < 120 || maximum > 136);
+		freeSurface(surface);
+		destroyContext();
+
+		const TinyGL::SpanFuncs *funcs[2];
+		const char *names[2];
+		const int numFuncs = getSpanFuncs(funcs, names);
+		for (int i = 0; i < ARRAYSIZE(filters); i++) {
+			TinyGL::Internal::setSpanFuncs(nullptr);
+			createContext(false);
+			drawMinifiedScene(filters[i]);
+			TinyGL::presentBuffer();
+			Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+			getMinifiedColors(expected, minimum, maximum);
+			TS_ASSERT(minimum <= maximum && minimum >= 120 && maximum <= 136);
+			destroyContext();
+
+			for (int f = 0; f < numFuncs; f++) {
+				TinyGL::Internal::setSpanFuncs(funcs[f]);
+				createContext(false);
+				drawMinifiedScene(filters[i]);
+				TinyGL::presentBuffer();
+				surface = TinyGL::copyFromFrameBuffer(getFormat());
+				TSM_ASSERT(names[f], equals(surface, expected));
+				freeSurface(surface);
+				destroyContext();
+			}
+
+			freeSurface(expected);
+		}
+		TinyGL::Internal::setSpanFuncs(nullptr);
+	}
+
+	// Skipping the triangles and spans hidden behind the tiles of the
+	// hierarchical z buffer has to give the same pixels as testing them
+	void test_hierarchical_depth() {
+		for (int scene = 0; scene < 4; scene++) {
+			Graphics::Surface *surfaces[2];
+			for (int enable = 0; enable < 2; enable++) {
+				createContext(false);
+				TinyGL::enableHierarchicalDepth(enable);
+				if (scene == 0) {
+					drawScene(300, false);
+				} else if (scene == 1) {
+					TinyGL::setTileSize(37);
+					drawScene(300, false);
+				} else if (scene == 2) {
+					drawPlaygroundScene(30.0f);
+				} else {
+					drawOccludedScene(500);
+				}
+				TinyGL::presentBuffer();
+				surfaces[enable] = TinyGL::copyFromFrameBuffer(getFormat());
+
+				TinyGL::DepthStats stats;
+				TinyGL::getDepthStats(stats);
+				if (!enable) {
+					TS_ASSERT_EQUALS(stats.rejectedTriangles + stats.rejectedSpans, 0u);
+				} else if (scene == 3) {
+					// Most of the triangles are behind the wall
+					TS_ASSERT_LESS_THAN(250u, stats.rejectedTriangles);
+					TS_ASSERT_LESS_THAN(0u, stats.rejectedTiles);
+				}
+				destroyContext();
+			}
+			TSM_ASSERT(scene, equals(surfaces[0], surfaces[1]));
+			freeSurface(surfaces[0]);
+			freeSurface(surfaces[1]);
+		}
+	}
+
+	void test_frame_stats() {
+		// The counters of the draw calls add up to the ones of the frame,
+		// and profiling does not change the pixels
+		Graphics::Surface *surfaces[2];
+		for (int enable = 0; enable < 2; enable++) {
+			createContext(false);
+			TinyGL::enableProfiling(enable);
+			drawScene(300, false);
+			TinyGL::presentBuffer();
+			surfaces[enable] = TinyGL::copyFromFrameBuffer(getFormat());
+
+			TinyGL::FrameStats frame;
+			Common::Array<TinyGL::DrawCallStats> drawCalls;
+			TinyGL::getFrameStats(frame);
+			TinyGL::getDrawCallStats(drawCalls);
+			if (!enable) {
+				TS_ASSERT_EQUALS(frame.drawCalls, 0u);
+				TS_ASSERT(drawCalls.empty());
+				destroyContext();
+				continue;
+			}
+
+			// A clear, 300 primitives, of which 37 quads, and 7 blits
+			TS_ASSERT_EQUALS(frame.drawCalls, 308u);
+			TS_ASSERT_EQUALS(frame.executedDrawCalls, 308u);
+			TS_ASSERT_EQUALS(frame.blitCalls, 7u);
+			TS_ASSERT_EQUALS(frame.trianglesIn, 337u);
+			TS_ASSERT_EQUALS(frame.dirtyArea, (uint32)(kWidth * kHeight));
+			TS_ASSERT_LESS_THAN(0u, frame.trianglesOut);
+			TS_ASSERT_LESS_THAN(0u, frame.texturedTriangles);
+			TS_ASSERT_LESS_THAN(0u, frame.pixelsShaded);
+
+			TS_ASSERT_EQUALS(drawCalls.size(), 308u);
+			TS_ASSERT_EQUALS(drawCalls[0].description, "clear color depth");
+			TS_ASSERT_EQUALS(drawCalls[1].description, "triangles, 3 vertices");
+			TS_ASSERT(drawCalls[307].description.hasPrefix("fast blit"));
+			uint32 triangles = 0, pixels = 0, time = 0;
+			for (uint i = 0; i < drawCalls.size(); i++) {
+				TS_ASSERT_EQUALS(drawCalls[i].executions, 1u);
+				triangles += drawCalls[i].triangles;
+				pixels += drawCalls[i].pixelsShaded;
+				time += drawCalls[i].executeTime;
+			}
+			TS_ASSERT_EQUALS(triangles, frame.trianglesOut);
+			TS_ASSERT_EQUALS(pixels, frame.pixelsShaded);
+			TS_ASSERT_EQUALS(time, frame.executeTime);
+
+			// The summary, a blank line, the table header and the draw calls
+			const Common::String text = TinyGL::formatFrameStats(5);
+			TS_ASSERT(text.hasPrefix(Common::String::format("Draw calls: %u queued", frame.drawCalls)));
+			uint lines = 0;
+			for (uint i = 0; i < text.size(); i++)
+				lines += text[i] == '\n';
+			TS_ASSERT_EQUALS(lines, 4u + 2u + 5u);
+			TS_ASSERT_EQUALS(TinyGL::formatFrameStats(0).find('#'), Common::String::npos);
+			destroyContext();
+		}
+		TS_ASSERT(equals(surfaces[0], surfaces[1]));
+		freeSurface(surfaces[0]);
+		freeSurface(surfaces[1]);
+
+		// Tiles execute the draw calls once for each tile they cover, and
+		// nothing is drawn again for an unchanged frame. The first frame
+		// starts with another blending function than the next ones.
+		createContext(true);
+		TinyGL::enableProfiling(true);
+		TinyGL::setTileSize(37);
+		for (int frame = 0; frame < 3; frame++) {
+			drawScene(300, false);
+			TinyGL::presentBuffer();
+
+			TinyGL::FrameStats stats;
+			TinyGL::getFrameStats(stats);
+			TS_ASSERT_LESS_THAN(0u, stats.drawCalls);
+			if (frame == 0) {
+				TS_ASSERT_LESS_THAN(stats.drawCalls, stats.executedDrawCalls);
+				TS_ASSERT_LESS_THAN(0u, stats.dirtyArea);
+			} else if (frame == 2) {
+				TS_ASSERT_EQUALS(stats.executedDrawCalls, 0u);
+				TS_ASSERT_EQUALS(stats.dirtyArea, 0u);
+				TS_ASSERT_EQUALS(stats.pixelsShaded, 0u);
+			}
+		}
+		destroyContext();
+	}
+
+	// The draw calls of the previous frame are found even when calls were
+	// inserted or moved, and only the changed regions are drawn again
+	void test_dirty_rectangles() {
+		static const int kFrames = 4;
+		Graphics::Surface *surfaces[kFrames];
+		createContext(true);
+		TinyGL::enableProfiling(true);
+		for (int frame = 0; frame < kFrames; frame++) {
+			drawDirtyRectScene(frame);
+			TinyGL::presentBuffer();
+			surfaces[frame] = TinyGL::copyFromFrameBuffer(getFormat());
+
+			TinyGL::FrameStats stats;
+			TinyGL::getFrameStats(stats);
+			if (frame == 1) {
+				// Only the inserted blit, with a pixel more around it
+				TS_ASSERT_EQUALS(stats.changedDrawCalls, 1u);
+				TS_ASSERT_LESS_THAN_EQUALS(stats.dirtyArea, 66u * 66u);
+			} else if (frame > 1) {
+				TS_ASSERT_LESS_THAN_EQUALS(stats.changedDrawCalls, 2u);
+				TS_ASSERT_LESS_THAN(stats.dirtyArea, (uint32)(kWidth * kHeight / 4));
+			}
+		}
+		destroyContext();
+
+		createContext(false);
+		for (int frame = 0; frame < kFrames; frame++) {
+			drawDirtyRectScene(frame);
+			TinyGL::presentBuffer();
+			Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+			TSM_ASSERT(frame, equals(surfaces[frame], expected));
+			freeSurface(expected);
+			freeSurface(surfaces[frame]);
+		}
+		destroyContext();
+	}
+
+	// Vertex arrays are transformed in batches, which has to give the same
+	// pixels as passing the vertices one by one
+	void test_vertex_arrays() {
+		TinyGL::TransformFunc funcs[3] = { nullptr };
+		const char *names[3] = { "generic" };
+		const int numFuncs = getTransformFuncs(funcs + 1, names + 1) + 1;
+		Mesh mesh;
+		buildMesh(mesh, 20);
+
+		for (int pass = 0; pass < 4; pass++) {
+			createContext(false);
+			drawMesh(mesh, pass, false);
+			TinyGL::presentBuffer();
+			Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+			destroyContext();
+
+			for (int f = 0; f < numFuncs; f++) {
+				TinyGL::Internal::setTransformFunc(funcs[f]);
+				createContext(false);
+				drawMesh(mesh, pass, true);
+				TinyGL::presentBuffer();
+				Graphics::Surface *surface = TinyGL::copyFromFrameBuffer(getFormat());
+				TSM_ASSERT(names[f], equals(surface, expected));
+				freeSurface(surface);
+				destroyContext();
+			}
+
+			freeSurface(expected);
+		}
+		TinyGL::Internal::setTransformFunc(nullptr);
+	}
+
+	// Calling an optimized display list has to give the same pixels as
+	// issuing its ops directly
+	void test_display_lists() {
+		for (int mode = 0; mode < 2; mode++) {
+			createContext(false);
+			drawListScene(0);
+			TinyGL::presentBuffer();
+			Graphics::Surface *expected = TinyGL::copyFromFrameBuffer(getFormat());
+			destroyContext();
+
+			createContext(false);
+			const TGLuint list = tglGenLists(1);
+			tglNewList(list, mode ? TGL_COMPILE_AND_EXECUTE : TGL_COMPILE);
+			drawListOps();
+			tglEndList();
+			drawListScene(list);
+			TinyGL::presentBuffer();
+			Graphics::Surface *surface = TinyGL::copyFromFrameBuffer(getFormat());
+			TS_ASSERT(equals(surface, expected));
+			freeSurface(surface);
+			destroyContext();
+
+			freeSurface(expected);
+		}
+	}
+
+	void test_tiled_rendering_speed() {
+#if BENCHMARK_TIME
+		static const int tileSizes[] = { 0, 32, 64, 128 };
+		const int numFrames = benchmarkCount(5, 100);
+
+		for (int i = 0; i < ARRAYSIZE(tileSizes); i++) {
+			createContext(false);
+			TinyGL::setTileSize(tileSizes[i]);
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				drawScene(2000, false);
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			debug("TinyGL tile size %d: %d frames in %d ms, %d frames/s", tileSizes[i], numFrames, time, timer.perSecond(numFrames));
+
+			destroyContext();
+		}
+#endif
+	}
+
+	void test_rasterization_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(10, 500);
+		const TinyGL::SpanFuncs *funcs[3] = { nullptr };
+		const char *names[3] = { "generic" };
+		const int numFuncs = getSpanFuncs(funcs + 1, names + 1) + 1;
+
+		for (int f = 0; f < numFuncs; f++) {
+			TinyGL::Internal::setSpanFuncs(funcs[f]);
+			createContext(false);
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				drawPlaygroundScene(frame * 2.0f);
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			debug("TinyGL %s spans: %d frames in %d ms, %d frames/s", names[f], numFrames, time, timer.perSecond(numFrames));
+
+			destroyContext();
+		}
+		TinyGL::Internal::setSpanFuncs(nullptr);
+#endif
+	}
+
+	void test_blit_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(10, 500);
+		TinyGL::BlitRowFunc funcs[4] = { nullptr, TinyGL::blitRow };
+		const char *names[4] = { "per pixel", "generic row" };
+		const int numFuncs = getBlitRowFuncs(funcs + 2, names + 2) + 2;
+		const TinyGL::BlitRowFunc savedFunc = TinyGL::Internal::getBlitRowFunc();
+
+		Graphics::ManagedSurface background(kWidth / 2, kHeight / 2, getFormat());
+		for (int y = 0; y < background.h; y++) {
+			for (int x = 0; x < background.w; x++)
+				background.setPixel(x, y, getFormat().ARGBToColor(255, x, y, x ^ y));
+		}
+
+		for (int f = 0; f < numFuncs; f++) {
+			TinyGL::Internal::setBlitRowFunc(funcs[f]);
+			createContext(false);
+			TinyGL::BlitImage *backgroundImage = tglGenBlitImage();
+			tglUploadBlitImage(backgroundImage, *background.surfacePtr(), 0, false);
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				drawSpriteScene(backgroundImage, frame);
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			debug("TinyGL %s blits: %d frames in %d ms, %d frames/s", names[f], numFrames, time, timer.perSecond(numFrames));
+
+			tglDeleteBlitImage(backgroundImage);
+			destroyContext();
+		}
+		TinyGL::Internal::setBlitRowFunc(savedFunc);
+
+		// The same scene through graphics/blit, which does not rotate, so the
+		// rotated sprites are only tinted
+		createContext(false);
+		Graphics::ManagedSurface sprite;
+		sprite.copyFrom(_image);
+		Graphics::ManagedSurface screen(kWidth, kHeight, getFormat());
+		BenchmarkTimer timer;
+		for (int frame = 0; frame < numFrames; frame++) {
+			background.blendBlitTo(screen, 0, 0, Graphics::FLIP_NONE, nullptr, MS_ARGB(255, 255, 255, 255),
+			                       kWidth, kHeight, Graphics::BLEND_NORMAL, Graphics::ALPHA_OPAQUE);
+			for (int i = 0; i < 32; i++) {
+				const int width = i % 4 == 2 ? 96 : -1, height = i % 4 == 2 ? 48 : -1;
+				sprite.blendBlitTo(screen, (i * 37 + frame * 3) % (kWidth - 64), (i * 23 + frame) % (kHeight - 64),
+				                   i % 4 == 1 ? Graphics::FLIP_H : Graphics::FLIP_NONE, nullptr, MS_ARGB(191, 255, 128, 64),
+				                   width, height);
+			}
+		}
+		const uint32 time = timer.stop();
+		debug("Graphics::BlendBlit blits: %d frames in %d ms, %d frames/s", numFrames, time, timer.perSecond(numFrames));
+		destroyContext();
+#endif
+	}
+
+	void test_vertex_transform_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(5, 200);
+		TinyGL::TransformFunc funcs[3] = { nullptr };
+		const char *names[3] = { "generic" };
+		const int numFuncs = getTransformFuncs(funcs + 1, names + 1) + 1;
+		Mesh mesh;
+		buildMesh(mesh, 50);
+
+		// Only the transform, with the mesh far away so that it covers a few pixels
+		for (int pass = 0; pass < 2; pass++) {
+			const char *lighting = pass == 1 ? "lit" : "unlit";
+			for (int f = -1; f < numFuncs; f++) {
+				TinyGL::Internal::setTransformFunc(f < 0 ? nullptr : funcs[f]);
+				createContext(false);
+
+				BenchmarkTimer timer;
+				for (int frame = 0; frame < numFrames; frame++) {
+					tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+					tglMatrixMode(TGL_PROJECTION);
+					tglLoadIdentity();
+					tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 2000.0);
+					tglMatrixMode(TGL_MODELVIEW);
+					tglLoadIdentity();
+					tglTranslatef(0.0f, 0.0f, -1000.0f);
+					tglRotatef(frame * 5.0f, 1.0f, 0.0f, 0.0f);
+					tglEnable(TGL_DEPTH_TEST);
+					if (pass == 1) {
+						tglEnable(TGL_LIGHT0);
+						tglEnable(TGL_LIGHTING);
+					}
+
+					if (f < 0) {
+						tglBegin(TGL_TRIANGLES);
+						for (uint i = 0; i < mesh.indices.size(); i++) {
+							const int index = mesh.indices[i];
+							tglColor4fv(&mesh.colors[index * 4]);
+							tglNormal3fv(&mesh.normals[index * 3]);
+							tglVertex3fv(&mesh.vertices[index * 3]);
+						}
+						tglEnd();
+					} else {
+						tglEnableClientState(TGL_VERTEX_ARRAY);
+						tglEnableClientState(TGL_NORMAL_ARRAY);
+						tglEnableClientState(TGL_COLOR_ARRAY);
+						tglVertexPointer(3, TGL_FLOAT, 0, mesh.vertices.data());
+						tglNormalPointer(TGL_FLOAT, 0, mesh.normals.data());
+						tglColorPointer(4, TGL_FLOAT, 4 * sizeof(float), mesh.colors.data());
+						tglDrawElements(TGL_TRIANGLES, mesh.indices.size(), TGL_UNSIGNED_SHORT, mesh.indices.data());
+						tglDisableClientState(TGL_VERTEX_ARRAY);
+						tglDisableClientState(TGL_NORMAL_ARRAY);
+						tglDisableClientState(TGL_COLOR_ARRAY);
+					}
+					TinyGL::presentBuffer();
+				}
+				const uint32 time = timer.stop();
+				const int numVertices = numFrames * mesh.indices.size();
+				debug("TinyGL %s vertices, %s: %d vertices in %d ms, %d vertices/ms", lighting,
+				      f < 0 ? "one by one" : names[f], numVertices, time, numVertices / time);
+
+				destroyContext();
+			}
+		}
+		TinyGL::Internal::setTransformFunc(nullptr);
+#endif
+	}
+
+	void test_texture_sampling_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(5, 200);
+		const int numSamples = benchmarkCount(500000, 10000000);
+		static const TGLenum filters[] = { TGL_NEAREST, TGL_LINEAR, TGL_NEAREST_MIPMAP_NEAREST, TGL_LINEAR_MIPMAP_LINEAR };
+		static const char *filterNames[] = { "nearest", "linear", "nearest mipmap nearest", "linear mipmap linear" };
+#if defined(SCUMM_LITTLE_ENDIAN)
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 0, 8, 16, 24);
+#else
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+#endif
+		const uint size = 256;
+		uint32 *pixels = new uint32[size * size];
+		for (uint i = 0; i < size * size; i++)
+			pixels[i] = format.ARGBToColor(255, i, i >> 8, i >> 3);
+
+		// The memory of the whole chain, and the samples of a texture walked
+		// diagonally with four texels between pixels, from level 0 and from
+		// the level two steps down
+		for (int bilinear = 0; bilinear < 2; bilinear++) {
+			TinyGL::TexelBuffer *levels[9];
+			if (bilinear)
+				levels[0] = TinyGL::createBilinearTexelBuffer((byte *)pixels, format, TGL_RGBA, TGL_UNSIGNED_BYTE, size, size, size);
+			else
+				levels[0] = TinyGL::createNearestTexelBuffer((const byte *)pixels, format, TGL_RGBA, TGL_UNSIGNED_BYTE, size, size, size);
+			uint memory = levels[0]->getMemorySize();
+			for (int i = 1; i < 9; i++) {
+				levels[i] = TinyGL::createMipmapTexelBuffer(levels[i - 1], bilinear, size);
+				memory += levels[i]->getMemorySize();
+			}
+			debug("TinyGL %s %dx%d texture: %d bytes, %d bytes with mipmaps", bilinear ? "bilinear" : "nearest",
+			      size, size, levels[0]->getMemorySize(), memory);
+
+			for (int level = 0; level <= 2; level += 2) {
+				uint32 checksum = 0;
+				BenchmarkTimer timer;
+				for (int i = 0; i < numSamples; i++) {
+					// Wrapped around the texture many times
+					const int s = (int)((uint)i * (4 << ZB_POINT_ST_FRAC_BITS) + i * 37);
+					const int t = (int)((uint)i * (3 << ZB_POINT_ST_FRAC_BITS) + (uint)(i / 256) * (5 << ZB_POINT_ST_FRAC_BITS));
+					byte a, r, g, b;
+					levels[level]->getARGBAt(TGL_REPEAT, TGL_REPEAT, s, t, a, r, g, b);
+					checksum += r + g + b;
+				}
+				const uint32 time = timer.stop();
+				debug("TinyGL %s samples from level %d: %d samples in %d ms, %d samples/ms (%u)", bilinear ? "bilinear" : "nearest",
+				      level, numSamples, time, numSamples / time, checksum);
+			}
+
+			for (int i = 0; i < 9; i++)
+				delete levels[i];
+		}
+		delete[] pixels;
+
+		for (int i = 0; i < ARRAYSIZE(filters); i++) {
+			createContext(false);
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				drawMinifiedScene(filters[i]);
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			debug("TinyGL %s minified textures: %d frames in %d ms, %d frames/s", filterNames[i], numFrames, time, timer.perSecond(numFrames));
+			destroyContext();
+		}
+#endif
+	}
+
+	void test_hierarchical_depth_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(5, 200);
+		for (int enable = 0; enable < 2; enable++) {
+			createContext(false);
+			TinyGL::enableHierarchicalDepth(enable);
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				drawOccludedScene(2000);
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			TinyGL::DepthStats stats;
+			TinyGL::getDepthStats(stats);
+			debug("TinyGL hierarchical z buffer %s: %d frames in %d ms, %d frames/s, %u/%u triangles and %u spans rejected, %u tiles updated",
+			      enable ? "on" : "off", numFrames, time, timer.perSecond(numFrames),
+			      stats.rejectedTriangles, stats.testedTriangles, stats.rejectedSpans, stats.updatedTiles);
+
+			destroyContext();
+		}
+#endif
+	}
+
+	void test_display_list_speed() {
+#if BENCHMARK_TIME
+		const int numFrames = benchmarkCount(5, 200);
+		for (int useList = 0; useList < 2; useList++) {
+			createContext(false);
+			TGLuint list = 0;
+			if (useList) {
+				list = tglGenLists(1);
+				tglNewList(list, TGL_COMPILE);
+				drawListOps();
+				tglEndList();
+			}
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < numFrames; frame++) {
+				// The same set drawn from several points of view
+				for (int i = 0; i < 10; i++) {
+					drawListScene(list);
+				}
+				TinyGL::presentBuffer();
+			}
+			const uint32 time = timer.stop();
+			debug("TinyGL %s: %d frames in %d ms, %d frames/s", useList ? "display list" : "direct ops", numFrames, time, timer.perSecond(numFrames));
+
+			destroyContext();
+		}
+#endif
+	}
+};
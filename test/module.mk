@@ -15,7 +15,9 @@ TEST_LIBS += test/null_osystem.o \
 	backends/fs/posix/posix-iostream.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
-	backends/modular-backend.o
+	backends/mixer/null/null-mixer.o \
+	backends/modular-backend.o \
+	backends/timer/default/default-timer.o
 endif
 
 ifdef WIN32
@@ -24,12 +26,18 @@ TEST_LIBS += test/null_osystem.o \
 	backends/fs/windows/windows-fs.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
+	backends/mixer/null/null-mixer.o \
 	backends/modular-backend.o \
+	backends/timer/default/default-timer.o \
 	backends/platform/sdl/win32/win32_wrapper.o
 endif
 
 TEST_LIBS +=	audio/libaudio.a math/libmath.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a image/libimage.a graphics/libgraphics.a
 
+ifdef USE_TINYGL
+	TESTS += $(srcdir)/test/graphics/*.h
+endif
+
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
 	TEST_LIBS += engines/wintermute/libwintermute.a
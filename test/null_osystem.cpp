@@ -4,6 +4,7 @@
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
 #include "../backends/platform/null/null.cpp"
+#include "../backends/timer/default/default-timer.h"
 
 //#define DISPLAY_ERROR_MESSAGES
 
@@ -14,7 +15,25 @@ void Common::install_null_g_system() {
 	const bool silenceLogs = true;
 #endif
 
-	g_system = OSystem_NULL_create(silenceLogs);
+	// The mixer needs g_system to be set up already
+	OSystem_NULL *system = new OSystem_NULL(silenceLogs);
+	g_system = system;
+	system->initMixer();
+	system->initTimer();
+}
+
+void OSystem_NULL::initMixer() {
+	// The backend is not initialized for the tests, but the audio code
+	// needs a mixer. It is never started; the tests read the audio
+	// streams themselves.
+	_mixerManager = new NullMixerManager();
+	_mixerManager->init();
+}
+
+void OSystem_NULL::initTimer() {
+	// Nothing calls the timer handler either. The tests which use timers
+	// call it themselves.
+	_timerManager = new DefaultTimerManager();
 }
 
 void OSystem_NULL::quit() {